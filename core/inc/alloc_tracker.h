@@ -0,0 +1,54 @@
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2026-10-20 01:10:00
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2026-10-20 01:10:00
+ * @FilePath: \SparseArrayAnalyzer\core\inc\alloc_tracker.h
+ * @Description: 堆分配统计：替换全局 operator new / delete，记录压缩 / 解压阶段的分配次数、字节数与存活峰值；
+ *               默认关闭，未开启时每次分配只多一次线程局部变量判断
+ *
+ */
+#ifndef _ALLOC_TRACKER_H_
+#define _ALLOC_TRACKER_H_
+
+#include "sparse_array_analyzer.h"
+
+void EnableAllocTracking();
+bool AllocTrackingEnabled();
+
+// 阶段的共享计数，阶段内创建的线程通过 AllocContextGuard 挂到同一计数上
+struct AllocContext;
+AllocContext *CurrentAllocContext();
+
+// 压缩 / 解压阶段统计：构造时开始，stop() 或析构时停止并写入 stats；
+// 同一线程上嵌套的阶段只由最外层统计
+class AllocPhase
+{
+public:
+    explicit AllocPhase(AllocStats &stats);
+    ~AllocPhase();
+    void stop();
+
+    AllocPhase(const AllocPhase &) = delete;
+    AllocPhase &operator=(const AllocPhase &) = delete;
+
+private:
+    AllocStats *_stats = nullptr;
+    AllocContext *_context = nullptr;
+};
+
+// 工作线程入口处使用：把本线程的分配计入创建线程的阶段（context 为空时不统计）
+class AllocContextGuard
+{
+public:
+    explicit AllocContextGuard(AllocContext *context);
+    ~AllocContextGuard();
+
+    AllocContextGuard(const AllocContextGuard &) = delete;
+    AllocContextGuard &operator=(const AllocContextGuard &) = delete;
+
+private:
+    AllocContext *_previous = nullptr;
+};
+
+#endif // _ALLOC_TRACKER_H_
@@ -0,0 +1,46 @@
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2026-10-19 23:40:00
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2026-10-19 23:40:00
+ * @FilePath: \SparseArrayAnalyzer\core\inc\batch_analyzer.h
+ * @Description: 批量分析：一个进程内把（文件 × 算法）任务分发到工作窃取线程池，结果逐条写入同一份 CSV / JSON 报告
+ *
+ */
+#ifndef _BATCH_ANALYZER_H_
+#define _BATCH_ANALYZER_H_
+
+#include "result_report.h"
+
+// 单个输入文件
+typedef struct batch_job
+{
+    std::string path;
+    bool isBinary = false;
+    ElemType elemType = ELEM_UINT32;
+    ArrayDimension dimension = ARRAY_1D;
+    uint32_t rows = 0; // 仅二维文本输入需要，二进制输入以文件头为准
+    uint32_t cols = 0;
+    uint64_t fileBytes = 0;
+} BatchJob;
+
+typedef struct batch_stats
+{
+    uint64_t fileCount = 0;
+    uint64_t failedFiles = 0;  // 加载失败的文件数
+    uint64_t taskCount = 0;    // 完成的（文件 × 算法）任务数
+    uint64_t failedTasks = 0;  // 不含维度不支持的任务
+    uint64_t stolenTasks = 0;  // 被空闲线程窃取的任务数
+    uint32_t threadCount = 0;
+    double wallTimeMs = 0;
+} BatchStats;
+
+// 收集输入：目录下的 SAAB 二进制文件与 .txt / .csv 文本文件（文本按一维分析）；
+// 或清单文件，每行 `<path> [1/2] [ROW] [COL]`，# 开头为注释，相对路径相对清单所在目录
+int8_t CollectBatchJobs(const std::string &source, ElemType textType, std::vector<BatchJob> &jobs);
+
+// 分析所有输入，报告格式按 reportPath 扩展名选择；algorithms 为空时使用全部已注册算法；threadCount 为 0 时取硬件线程数
+int8_t RunBatchAnalysis(const std::vector<BatchJob> &jobs, const std::vector<std::string> &algorithms,
+                        uint32_t threadCount, const std::string &reportPath, BatchStats &stats);
+
+#endif // _BATCH_ANALYZER_H_
@@ -0,0 +1,44 @@
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2026-10-19 21:10:00
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2026-10-19 21:10:00
+ * @FilePath: \SparseArrayAnalyzer\core\inc\byte_stage.h
+ * @Description: 第二级通用字节压缩：对任一算法的序列化结果再做 LZ 压缩，统计组合压缩率与额外耗时
+ *
+ */
+#ifndef _BYTE_STAGE_H_
+#define _BYTE_STAGE_H_
+
+#include "sparse_array_analyzer.h"
+
+typedef enum stage2_codec
+{
+    STAGE2_NONE = 0,
+    STAGE2_LZ = 1, // 树内 LZ77 实现（LZ4 风格的 token + 字面量 + 偏移）
+} Stage2Codec;
+
+typedef struct stage2_result
+{
+    std::string modeName;
+    uint64_t serializedBytes = 0; // 第一级序列化后的字节数
+    uint64_t stage2Bytes = 0;     // 第二级压缩后的字节数
+    double compressTimeMs = 0;    // 第二级额外压缩耗时（不含序列化）
+    double decompressTimeMs = 0;  // 第二级额外解压耗时
+    double combinedRatio = 0.0;   // stage2Bytes / 原始字节数 * 100
+} Stage2Result;
+
+// 按名称解析第二级编码器（none / lz）
+int8_t ParseStage2Codec(const std::string &name, Stage2Codec &codec);
+
+// 通用 LZ 字节压缩，输出自带原始长度
+void LzCompress(const std::vector<uint8_t> &input, std::vector<uint8_t> &output);
+
+// 解压并校验边界，数据损坏时返回 ERROR_CALCULATE_ERROR
+int8_t LzDecompress(const std::vector<uint8_t> &input, std::vector<uint8_t> &output);
+
+// 序列化已完成 Compress 的压缩器，做第二级压缩与解压往返校验
+int8_t RunStage2(const SparseArrayCompressor &compressor, Stage2Codec codec, uint64_t originSizeBytes,
+                 Stage2Result &result);
+
+#endif // _BYTE_STAGE_H_
@@ -37,6 +37,7 @@
 #define ERROR_CALCULATE_ERROR     (-4)
 #define ERROR_UNKNOW_ERROR        (-5)
 #define ERROR_INDEX_OUT_OF_RANGE  (-6)
+#define ERROR_UNSUPPORT_FEATURE   (-7)
 
 /* ---------------------------- Algorithm enable ---------------------------- */
 #define ENABLE                    (1)
@@ -44,11 +45,14 @@
 
 #define ALGORITHM_DENSE           (ENABLE)
 #define ALGORITHM_COORDINATE      (ENABLE)
-#define ALGORITHM_RUN_LENGTH      (BYPASS)
+#define ALGORITHM_RUN_LENGTH      (ENABLE)
 #define ALGORITHM_BITMAP_PAYLOAD  (ENABLE)
 #define ALGORITHM_DICTIONARY      (ENABLE)
 #define ALGORITHM_CSR             (ENABLE)
 #define ALGORITHM_CSC             (ENABLE)
+#define ALGORITHM_PFOR            (ENABLE)
+#define ALGORITHM_ROARING         (ENABLE)
+#define ALGORITHM_COMPACT_RLE     (ENABLE)
 
 /* -------------------------------- function -------------------------------- */
 typedef enum array_dimension
@@ -57,20 +61,129 @@ typedef enum array_dimension
     ARRAY_2D = 1, // 二维数组
 } ArrayDimension;
 
-std::vector<uint32_t> LoadArrayFromTxt(const std::string& filename);
+/* ------------------------------ Element type ------------------------------ */
+typedef enum elem_type
+{
+    ELEM_UINT8 = 0,
+    ELEM_UINT16 = 1,
+    ELEM_UINT32 = 2,
+    ELEM_UINT64 = 3,
+    ELEM_INT32 = 4,
+    ELEM_FLOAT = 5,
+    ELEM_TYPE_COUNT,
+} ElemType;
+
+// 对所有支持的元素类型展开宏（用于显式实例化）
+#define SAA_FOR_EACH_ELEM_TYPE(MACRO) \
+    MACRO(uint8_t)                    \
+    MACRO(uint16_t)                   \
+    MACRO(uint32_t)                   \
+    MACRO(uint64_t)                   \
+    MACRO(int32_t)                    \
+    MACRO(float)
+
+template <typename T>
+struct ElemTraits;
+
+#define SAA_ELEM_TRAITS(TYPE, ENUM, NAME)              \
+    template <>                                        \
+    struct ElemTraits<TYPE>                            \
+    {                                                  \
+        static constexpr ElemType type = ENUM;         \
+        static constexpr const char *name = NAME;      \
+    };
+
+SAA_ELEM_TRAITS(uint8_t, ELEM_UINT8, "u8")
+SAA_ELEM_TRAITS(uint16_t, ELEM_UINT16, "u16")
+SAA_ELEM_TRAITS(uint32_t, ELEM_UINT32, "u32")
+SAA_ELEM_TRAITS(uint64_t, ELEM_UINT64, "u64")
+SAA_ELEM_TRAITS(int32_t, ELEM_INT32, "i32")
+SAA_ELEM_TRAITS(float, ELEM_FLOAT, "f32")
+
+// 按运行期元素类型调用 func(T{})，在编译期为每种类型生成一份实现
+template <typename Func>
+auto DispatchElemType(ElemType type, Func &&func)
+{
+    switch (type)
+    {
+    case ELEM_UINT8:
+        return func(uint8_t{});
+    case ELEM_UINT16:
+        return func(uint16_t{});
+    case ELEM_UINT64:
+        return func(uint64_t{});
+    case ELEM_INT32:
+        return func(int32_t{});
+    case ELEM_FLOAT:
+        return func(float{});
+    case ELEM_UINT32:
+    default:
+        return func(uint32_t{});
+    }
+}
+
+const char *ElemTypeName(ElemType type);
+int8_t ParseElemType(const std::string &name, ElemType &type);
+
+/* ------------------------------ Binary input ------------------------------ */
+#define SAA_BIN_MAGIC       "SAAB"
+#define SAA_BIN_VERSION     (1)
+#define SAA_BIN_HEADER_SIZE (24)
+
+// 二进制数组文件头（小端），其后紧跟 rows * cols 个元素
+typedef struct binary_array_header
+{
+    uint8_t version = SAA_BIN_VERSION;
+    ElemType elemType = ELEM_UINT32;
+    ArrayDimension dimension = ARRAY_1D;
+    uint64_t rows = 0;
+    uint64_t cols = 0;
+} BinaryArrayHeader;
+
+bool IsBinaryArrayFile(const std::string &filename);
+int8_t ReadBinaryArrayHeader(const std::string &filename, BinaryArrayHeader &header);
+int8_t WriteBinaryArrayHeader(std::ostream &os, const BinaryArrayHeader &header);
+
+// 按元素类型解析单个文本数值，格式错误或超出类型范围返回 false
+template <typename T>
+bool ParseTextValue(const std::string &token, T &value);
+template <typename T>
+std::vector<T> LoadArrayFromTxt(const std::string &filename);
+// 头部损坏、元素数溢出或与文件大小不符时返回错误码，data 为空
+template <typename T>
+int8_t LoadArrayFromBin(const std::string &filename, BinaryArrayHeader &header, std::vector<T> &data);
+
 uint32_t ParseInt(const char* str);
-int8_t ReshapeTo2D(const std::vector<uint32_t>& input, const uint32_t row, const uint32_t col, std::vector<std::vector<uint32_t>>& output);
+template <typename T>
+int8_t ReshapeTo2D(const std::vector<T>& input, const uint32_t row, const uint32_t col, std::vector<std::vector<T>>& output);
 
 void PrintBuffer(const std::vector<uint8_t>& vec, size_t perLine = 8);
-void PrintVector1D(const std::vector<uint32_t>& data, const std::string commit = "\" No commit.\"", size_t elemsPerLine = 16);
-void PrintVector2D(const std::vector<std::vector<uint32_t>>& data, const uint32_t row, const uint32_t col, const std::string commit = "\" No commit.\"");
+template <typename T>
+void PrintVector1D(const std::vector<T>& data, const std::string commit = "\" No commit.\"", size_t elemsPerLine = 16);
+template <typename T>
+void PrintVector2D(const std::vector<std::vector<T>>& data, const uint32_t row, const uint32_t col, const std::string commit = "\" No commit.\"");
+
+template <typename T>
+uint64_t GetArrayTotalSize1D(const std::vector<T> &data);
+template <typename T>
+uint64_t GetArrayTotalSize2D(const std::vector<std::vector<T>> &data);
 
-uint32_t GetArrayTotalSize1D(const std::vector<uint32_t> &data);
-uint32_t GetArrayTotalSize2D(const std::vector<std::vector<uint32_t>> &data);
+template <typename T>
+uint64_t GetArrayElemCount1D(const std::vector<T> &data);
+template <typename T>
+uint64_t GetArrayElemCount2D(const std::vector<std::vector<T>> &data);
 
-uint32_t GetArrayElemCount1D(const std::vector<uint32_t> &data);
-uint32_t GetArrayElemCount2D(const std::vector<std::vector<uint32_t>> &data);
+// 按位模式逐元素比较（与 FlatDictionary 判等一致）：NaN 与自身相等，+0.0 / -0.0 视为不同
+template <typename T>
+bool Compare1D(const std::vector<T> &a, const std::vector<T> &b);
+template <typename T>
+bool Compare2D(const std::vector<std::vector<T>> &a, const std::vector<std::vector<T>> &b);
 
-bool Compare2D(const std::vector<std::vector<uint32_t>> &a, const std::vector<std::vector<uint32_t>> &b);
+// 清空各行内容但保留行及其容量，压缩器 Reset 后再次拷贝输入时不重新分配
+template <typename T>
+void ClearRows2D(std::vector<std::vector<T>> &data);
+// 调整为 row 行、每行 col 个 value，复用已有行的容量
+template <typename T>
+void FillArray2D(std::vector<std::vector<T>> &data, uint32_t row, uint32_t col, T value);
 
 #endif // _COMMON_H_
\ No newline at end of file
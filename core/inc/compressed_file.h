@@ -0,0 +1,72 @@
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2026-10-19 21:40:00
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2026-10-19 21:40:00
+ * @FilePath: \SparseArrayAnalyzer\core\inc\compressed_file.h
+ * @Description: 压缩结果容器文件：定长头 + 算法名 + 按 8 字节对齐的序列化负载，以只读映射方式加载
+ *
+ */
+#ifndef _COMPRESSED_FILE_H_
+#define _COMPRESSED_FILE_H_
+
+#include "sparse_array_analyzer.h"
+
+#define SAA_PACK_MAGIC       "SAAC"
+#define SAA_PACK_VERSION     (1)
+#define SAA_PACK_HEADER_SIZE (48)
+#define SAA_PACK_ALIGN       (8)
+
+// 容器文件头（小端）：
+//   0 magic[4] | 4 version u16 | 6 elemType u8 | 7 dimension u8 | 8 rows u32 | 12 cols u32
+//  16 payloadOffset u64 | 24 payloadBytes u64 | 32 checksum u64 (FNV-1a) | 40 nameLength u32 | 44 保留
+//  48 算法注册名，填充到 8 字节对齐后为负载
+typedef struct compressed_file_header
+{
+    uint16_t version = SAA_PACK_VERSION;
+    ElemType elemType = ELEM_UINT32;
+    ArrayDimension dimension = ARRAY_1D;
+    uint32_t rows = 0;
+    uint32_t cols = 0;
+    std::string algorithm; // CompressorRegistry 中的注册名
+    uint64_t payloadOffset = 0;
+    uint64_t payloadBytes = 0;
+    uint64_t checksum = 0;
+} CompressedFileHeader;
+
+// 序列化已完成 Compress 的压缩器并写入容器文件（header 中的 payload/checksum 字段由本函数填写）
+int8_t WriteCompressedFile(const std::string &path, CompressedFileHeader header, const SparseArrayCompressor &compressor);
+
+// 只读映射的容器文件；映射起点按页对齐，负载偏移按 8 字节对齐，可直接交给 Deserialize
+class MappedCompressedFile
+{
+public:
+    MappedCompressedFile() = default;
+    ~MappedCompressedFile();
+    MappedCompressedFile(const MappedCompressedFile &) = delete;
+    MappedCompressedFile &operator=(const MappedCompressedFile &) = delete;
+
+    // verifyChecksum 为 false 时跳过负载校验和（O(n)），只检查头部
+    int8_t Open(const std::string &path, bool verifyChecksum = true);
+    void Close();
+
+    const CompressedFileHeader &Header() const { return _header; }
+    const uint8_t *Payload() const { return _base ? _base + _header.payloadOffset : nullptr; }
+
+    // 按头部记录的算法名与元素类型创建压缩器并反序列化负载；
+    // 零拷贝格式直接引用映射内存，压缩器存活期间须保持本对象打开
+    int8_t CreateCompressor(std::unique_ptr<SparseArrayCompressor> &compressor) const;
+
+private:
+    const uint8_t *_base = nullptr;
+    size_t _size = 0;
+#ifdef _WIN32
+    void *_file = nullptr;
+    void *_mapping = nullptr;
+#else
+    int _fd = -1;
+#endif
+    CompressedFileHeader _header;
+};
+
+#endif // _COMPRESSED_FILE_H_
@@ -0,0 +1,39 @@
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2026-10-19 22:20:00
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2026-10-19 22:20:00
+ * @FilePath: \SparseArrayAnalyzer\core\inc\header_export.h
+ * @Description: 把选定格式的压缩表导出为 C/C++ 头文件，供固件直接编译进 Flash
+ *
+ */
+#ifndef _HEADER_EXPORT_H_
+#define _HEADER_EXPORT_H_
+
+#include "sparse_array_analyzer.h"
+
+// 导出布局族，同一族的变体（-FOR / -CI / 线性化顺序等）共用一种布局，索引宽度按实际取值最小化
+typedef enum header_layout
+{
+    LAYOUT_UNSUPPORTED = 0,
+    LAYOUT_DENSE,      // 原始数组
+    LAYOUT_CSR,        // 行偏移 + 列号 + 值，行内二分查找
+    LAYOUT_CSC,        // 列偏移 + 行号 + 值，列内二分查找
+    LAYOUT_COORDINATE, // 行优先下标 + 值，全局二分查找
+    LAYOUT_BITMAP,     // 非主值位图 + 每字前缀计数 + 值，popcount 定位
+    LAYOUT_DICTIONARY, // 字典 + 定宽位打包下标
+    LAYOUT_RUNS,       // 行优先游程终点 + 值，二分查找
+} HeaderLayout;
+
+// 按注册名选择布局族
+HeaderLayout SelectHeaderLayout(const std::string &algorithm);
+
+// 由输出路径生成合法的 C 标识符（取文件名主干）
+std::string HeaderSymbolFromPath(const std::string &path);
+
+// 生成头文件文本：static const 表 + 内联访问函数 <symbol>_get(index)（二维另有 <symbol>_at(row, col)）；
+// C++14 及以上表与访问函数为 constexpr，常量下标的查询在编译期折叠
+int8_t ExportHeader(const std::string &algorithm, const ArrayInput &input, const std::string &symbol,
+                    std::string &header);
+
+#endif // _HEADER_EXPORT_H_
@@ -0,0 +1,38 @@
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2026-10-20 00:40:00
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2026-10-20 00:40:00
+ * @FilePath: \SparseArrayAnalyzer\core\inc\perf_counters.h
+ * @Description: Linux perf_event_open 硬件计数器：周期、指令、L1D / LLC 缺失、分支预测失败；
+ *               默认关闭，未开启或无权限时 PerfPhase 不做任何系统调用
+ *
+ */
+#ifndef _PERF_COUNTERS_H_
+#define _PERF_COUNTERS_H_
+
+#include "sparse_array_analyzer.h"
+
+// 开启计数器采集：在当前线程试开各计数器，全部不可用时返回 ERROR_UNSUPPORT_FEATURE 并给出原因
+int8_t EnablePerfCounters(std::string &reason);
+bool PerfCountersEnabled();
+const char *PerfCounterName(PerfCounterId id);
+
+// 压缩 / 解压阶段计数：构造时记下起始读数并开始，stop() 或析构时停止并把差值写入 sample；
+// 计数包含阶段内创建并已结束的子线程
+class PerfPhase
+{
+public:
+    explicit PerfPhase(PerfCounterSample &sample);
+    ~PerfPhase();
+    void stop();
+
+    PerfPhase(const PerfPhase &) = delete;
+    PerfPhase &operator=(const PerfPhase &) = delete;
+
+private:
+    PerfCounterSample *_sample = nullptr; // 最外层阶段才写入
+    bool _counted = false;
+};
+
+#endif // _PERF_COUNTERS_H_
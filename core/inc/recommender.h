@@ -0,0 +1,51 @@
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2026-10-19 11:02:00
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2026-10-19 11:02:00
+ * @FilePath: \SparseArrayAnalyzer\core\inc\recommender.h
+ * @Description: 根据目标设备代价模型给出压缩建议
+ *
+ */
+#ifndef _RECOMMENDER_H_
+#define _RECOMMENDER_H_
+
+#include "sparse_array_analyzer.h"
+
+// 目标设备代价模型，可从内置配置或 key=value 配置文件加载
+typedef struct device_profile
+{
+    std::string name;
+    double clockMHz = 1000.0;     // 主频
+    double cyclesPerOp = 1.0;     // 每个抽象操作的周期数
+    uint64_t flashBytes = 0;      // Flash 容量（0 表示无 Flash 约束）
+    uint64_t ramBytes = 0;        // RAM 预算（0 表示不限制）
+    bool tableInFlash = false;    // 压缩表存放在 Flash（否则占用 RAM）
+    bool decodeToRam = false;     // 访问前需整体解压到 RAM
+    bool useMeasuredTime = false; // 顺序访问开销使用本机实测解压时间
+    double seqAccessRatio = 0.5;  // 顺序访问占比，其余为随机访问
+    double sizeWeight = 0.5;      // 评分中存储占用的权重
+    double timeWeight = 0.5;      // 评分中访问开销的权重
+} DeviceProfile;
+
+typedef struct recommend_item
+{
+    std::string modeName;
+    bool feasible = false;
+    uint64_t flashUsed = 0;
+    uint64_t ramUsed = 0;
+    double cyclesPerAccess = 0.0;
+    double score = 0.0; // 越小越好，Dense 为 1.0
+    std::string reason;
+} RecommendItem;
+
+std::vector<std::string> ListBuiltinProfiles();
+
+// 先按内置配置名查找，找不到时作为配置文件路径加载
+int8_t LoadDeviceProfile(const std::string &nameOrPath, DeviceProfile &profile);
+
+// 对每个 CalResult 评分，结果按“可行优先、分数升序”排序
+int8_t RecommendCompression(const std::vector<CalResult> &results, const DeviceProfile &profile,
+                            std::vector<RecommendItem> &ranked);
+
+#endif // _RECOMMENDER_H_
@@ -0,0 +1,73 @@
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2026-10-20 00:10:00
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2026-10-20 00:10:00
+ * @FilePath: \SparseArrayAnalyzer\core\inc\result_report.h
+ * @Description: 机器可读的分析报告（CSV / JSON）：全部 CalResult 字段 + 运行环境；读取两份报告比较压缩率与吞吐回退
+ *
+ */
+#ifndef _RESULT_REPORT_H_
+#define _RESULT_REPORT_H_
+
+#include "sparse_array_analyzer.h"
+#include <ostream>
+
+#define REPORT_DEFAULT_RATIO_TOL      (1.0)  // 压缩率允许变差的百分比
+#define REPORT_DEFAULT_THROUGHPUT_TOL (10.0) // 吞吐允许下降的百分比
+
+typedef enum report_format
+{
+    REPORT_CSV = 0,
+    REPORT_JSON,
+} ReportFormat;
+
+int8_t ParseReportFormat(const std::string &name, ReportFormat &format);
+// 按扩展名选择报告格式：.json 为 JSON，其余为 CSV
+ReportFormat ReportFormatFromPath(const std::string &path);
+
+// CSV 字段 / JSON 字符串转义
+std::string CsvField(const std::string &text);
+std::string JsonString(const std::string &text);
+
+typedef struct report_environment
+{
+    std::string cpuModel;
+    uint32_t threadCount = 0; // 硬件线程数
+    std::string compiler;
+    std::string buildFlags;
+    std::string input;        // 输入描述（文件、类型、形状）
+} ReportEnvironment;
+
+// 报告中的一行：注册名 + 结果
+typedef struct report_entry
+{
+    std::string algorithm;
+    CalResult result;
+} ReportEntry;
+
+void CollectEnvironment(const std::string &input, ReportEnvironment &env);
+
+// CSV 以 "# key: value" 注释行记录环境；JSON 为 {"environment": {...}, "results": [...]}；
+// 硬件计数器列不可用、堆分配未统计时 CSV 留空、JSON 为 null
+void WriteResultReport(std::ostream &out, ReportFormat format, const ReportEnvironment &env,
+                       const std::vector<ReportEntry> &entries);
+int8_t ReadResultReport(const std::string &path, ReportEnvironment &env, std::vector<ReportEntry> &entries);
+
+typedef struct compare_item
+{
+    std::string key;              // 注册名（缺失时为结果名）
+    bool missing = false;         // 当前报告中缺失
+    double baseRatio = 0;         // 压缩率（压缩后 / 原始，%，越小越好）
+    double currentRatio = 0;
+    double baseThroughput = 0;    // 压缩 + 解压吞吐（MB/s，越大越好）
+    double currentThroughput = 0;
+    bool ratioRegressed = false;
+    bool throughputRegressed = false;
+} CompareItem;
+
+// 按注册名匹配两份报告；ratioTol / throughputTol 为允许变差的百分比，返回出现回退的条目数
+uint32_t CompareReports(const std::vector<ReportEntry> &baseline, const std::vector<ReportEntry> &current,
+                        double ratioTol, double throughputTol, std::vector<CompareItem> &items);
+
+#endif // _RESULT_REPORT_H_
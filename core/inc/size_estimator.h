@@ -0,0 +1,29 @@
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2026-10-19 09:30:00
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2026-10-19 09:30:00
+ * @FilePath: \SparseArrayAnalyzer\core\inc\size_estimator.h
+ * @Description: 抽样预估各压缩算法的结果大小，避免对超大输入逐一完整压缩
+ *
+ */
+#ifndef _SIZE_ESTIMATOR_H_
+#define _SIZE_ESTIMATOR_H_
+
+#include "sparse_array_analyzer.h"
+
+#define SAMPLE_CHUNK_ELEMS   (1024) // 一维输入的抽样单元大小
+#define SAMPLE_DEFAULT_UNITS (256)  // 默认抽样单元数（每层抽 2 个）
+#define SAMPLE_Z_95          (1.96) // 95% 置信区间系数
+#define SAMPLE_RANDOM_SEED   (0x5AAu)
+
+// 分层抽样：把行（二维）或块（一维）等分为若干层，每层随机抽取 2 个单元
+int8_t CollectSampleStats(const ArrayInput &input, uint32_t sampleUnits, SampleStats &stats);
+
+// 线性模型预估：bytes = fixedBytes + bytesPerNonMain * 非主值数量
+void EstimateByNonMain(const SampleStats &stats, double fixedBytes, double bytesPerNonMain, SizeEstimate &estimate);
+
+// 线性模型预估：bytes = fixedBytes + bytesPerRun * 游程数量
+void EstimateByRuns(const SampleStats &stats, double fixedBytes, double bytesPerRun, SizeEstimate &estimate);
+
+#endif // _SIZE_ESTIMATOR_H_
@@ -13,37 +13,99 @@
 #include <cstdint>
 #include <vector>
 #include <memory>
+#include <memory_resource>
 #include <string>
 #include <unordered_map>
 #include <functional>
 #include <variant>
 #include <iomanip>
+#include <type_traits>
+#include "common.h"
 
+template <typename T>
 struct ArrayData1D
 {
-    std::vector<uint32_t> arrayData;
+    using value_type = T;
+    std::vector<T> arrayData;
 };
 
+template <typename T>
 struct ArrayData2D
 {
+    using value_type = T;
     uint32_t rowCount = 0;
     uint32_t colCount = 0;
-    std::vector<std::vector<uint32_t>> arrayData;
+    std::vector<std::vector<T>> arrayData;
 };
 
-using ArrayInput = std::variant<ArrayData1D, ArrayData2D>;
+// 所有元素类型的一维 / 二维输入
+using ArrayInput = std::variant<ArrayData1D<uint8_t>, ArrayData1D<uint16_t>, ArrayData1D<uint32_t>,
+                                ArrayData1D<uint64_t>, ArrayData1D<int32_t>, ArrayData1D<float>,
+                                ArrayData2D<uint8_t>, ArrayData2D<uint16_t>, ArrayData2D<uint32_t>,
+                                ArrayData2D<uint64_t>, ArrayData2D<int32_t>, ArrayData2D<float>>;
+
+template <typename T>
+struct IsArrayData2D : std::false_type
+{
+};
+
+template <typename T>
+struct IsArrayData2D<ArrayData2D<T>> : std::true_type
+{
+};
+
+// 获取输入的元素类型与维度
+inline ElemType GetInputElemType(const ArrayInput &input)
+{
+    return std::visit([](const auto &data)
+                      { return ElemTraits<typename std::decay_t<decltype(data)>::value_type>::type; },
+                      input);
+}
+
+inline ArrayDimension GetInputDimension(const ArrayInput &input)
+{
+    return std::visit([](const auto &data)
+                      { return IsArrayData2D<std::decay_t<decltype(data)>>::value ? ARRAY_2D : ARRAY_1D; },
+                      input);
+}
+
+// 硬件性能计数器（--perf-counters 时在压缩 / 解压阶段采集）
+typedef enum perf_counter_id
+{
+    PERF_CYCLES = 0,
+    PERF_INSTRUCTIONS,
+    PERF_L1D_MISSES,    // L1 数据缓存读缺失
+    PERF_LLC_MISSES,    // 末级缓存缺失
+    PERF_BRANCH_MISSES,
+    PERF_COUNTER_COUNT,
+} PerfCounterId;
+
+typedef struct perf_counter_sample
+{
+    uint32_t validMask = 0; // 第 i 位表示 values[i] 有效，计数器不可用时为 0
+    uint64_t values[PERF_COUNTER_COUNT] = {0};
+} PerfCounterSample;
+
+// 堆分配统计（--track-alloc 时在压缩 / 解压阶段采集）
+typedef struct alloc_stats
+{
+    bool tracked = false;    // 未开启统计时为 false
+    uint64_t allocCount = 0; // 分配次数
+    uint64_t allocBytes = 0; // 累计分配字节数（按分配器实际块大小）
+    uint64_t peakBytes = 0;  // 阶段内存活字节数的峰值，相对阶段开始时
+} AllocStats;
 
 // 统一分析结果
 typedef struct cal_result
 {
     std::string modeName; // 压缩算法名称
     //  Array element count
-    uint32_t originElementCount = 0;     // 原数组元素数量
-    uint32_t compressedElementCount = 0; // 压缩后元素数量
+    uint64_t originElementCount = 0;     // 原数组元素数量
+    uint64_t compressedElementCount = 0; // 压缩后元素数量
 
     // Array size in bytes
-    uint32_t originSizeBytes = 0;     // 原数组大小
-    uint32_t compressedSizeBytes = 0; // 压缩后数组大小
+    uint64_t originSizeBytes = 0;     // 原数组大小
+    uint64_t compressedSizeBytes = 0; // 压缩后数组大小
 
     // Compression cost
     double compressTimeMs = 0;
@@ -51,8 +113,53 @@ typedef struct cal_result
 
     // Compression ratio
     double compressionRatio = 0.0;
+
+    // Access cost model (按压缩结构估算的每次访问操作数)
+    double seqAccessOps = 1.0;    // 顺序遍历时每元素操作数
+    double randomAccessOps = 1.0; // 随机读取单个元素操作数
+    // Hardware counters
+    PerfCounterSample compressPerf;
+    PerfCounterSample decompressPerf;
+    // Heap allocations
+    AllocStats compressAlloc;
+    AllocStats decompressAlloc;
 } CalResult;
 
+// 抽样统计信息（由 CollectSampleStats 生成，供各算法预估压缩大小）
+typedef struct sample_stats
+{
+    bool is2D = false;
+    uint64_t rows = 0;           // 二维行数，一维为 1
+    uint64_t cols = 0;           // 二维列数，一维为元素数量
+    uint64_t elemCount = 0;      // 总元素数量
+    uint64_t sampledCount = 0;   // 抽样元素数量
+    uint32_t totalUnits = 0;     // 抽样单元总数（二维按行，一维按块）
+    uint32_t sampledUnits = 0;   // 实际抽取的单元数
+    uint32_t elemBytes = sizeof(uint32_t);
+
+    double mainValue = 0;            // 样本中的主值（仅用于展示）
+    double nonMainFraction = 0.0;    // 非主值比例
+    double nonMainFractionSE = 0.0;  // 非主值比例标准误差
+    double runFraction = 0.0;        // 每元素游程数
+    double runFractionSE = 0.0;
+    double distinctEstimate = 0.0;   // 不同值数量估计（Chao1）
+    double distinctLow = 0.0;
+    double distinctHigh = 0.0;
+    double unitNnzMean = 0.0;        // 每单元非主值数量均值
+    double unitNnzVar = 0.0;         // 每单元非主值数量方差
+    uint32_t packedBitWidth = 0;     // 样本非主值做参考帧位打包所需位宽
+} SampleStats;
+
+// 单个算法的压缩大小预估（95% 置信区间）
+typedef struct size_estimate
+{
+    std::string modeName;
+    double predictedBytes = 0.0;
+    double lowBytes = 0.0;
+    double highBytes = 0.0;
+    double predictedRatio = 0.0;
+} SizeEstimate;
+
 // 接口定义
 class SparseArrayCompressor
 {
@@ -67,10 +174,62 @@ public:
 
     // 获取压缩结果
     virtual int8_t GetResult(CalResult &result) const = 0; //= 结果不一定只有一个，如一维与二维
+
+    // 清空输入副本、压缩结构与结果，保留容器容量，同一实例可在重复运行与多个文件间复用；Compress 开始时自动调用
+    virtual void Reset() = 0;
+
+    // 单次压缩 / 解压内的临时容器从 resource 分配（默认全局堆）；传入 WorkArena 时由调用方在两次运行之间 Rewind()，
+    // 资源只在调用线程上使用
+    void SetMemoryResource(std::pmr::memory_resource *resource)
+    {
+        _workResource = resource ? resource : std::pmr::get_default_resource();
+    }
+
+    // 根据抽样统计预估压缩大小，不支持的算法返回 ERROR_UNSUPPORT_DIMENSION
+    virtual int8_t EstimateSize(const SampleStats &stats, SizeEstimate &estimate) const
+    {
+        (void)stats;
+        (void)estimate;
+        return ERROR_UNSUPPORT_DIMENSION;
+    }
+
+    // 序列化压缩结构（小端，数组按 8 字节对齐），需在 Compress 之后调用；不支持的算法返回 ERROR_UNSUPPORT_FEATURE
+    virtual int8_t Serialize(std::vector<uint8_t> &out) const
+    {
+        (void)out;
+        return ERROR_UNSUPPORT_FEATURE;
+    }
+
+    // 从 Serialize 的输出恢复压缩结构，之后可直接 Decompress / GetElement（无原始输入，跳过解压校验）；
+    // data 须按 8 字节对齐，零拷贝实现只保存指向 data 的视图，调用方须保证 data 在对象存活期间有效
+    virtual int8_t Deserialize(const uint8_t *data, size_t size)
+    {
+        (void)data;
+        (void)size;
+        return ERROR_UNSUPPORT_FEATURE;
+    }
+
+    // 随机读取行优先下标 index 处的元素，value 指向与压缩器元素类型一致的变量
+    virtual int8_t GetElement(uint64_t index, void *value) const
+    {
+        (void)index;
+        (void)value;
+        return ERROR_UNSUPPORT_FEATURE;
+    }
+
+protected:
+    std::pmr::memory_resource *_workResource = std::pmr::get_default_resource();
 };
 
-// 工厂注册器
-using CompressorFactory = std::function<std::unique_ptr<SparseArrayCompressor>()>;
+// 工厂注册器，按元素类型创建对应的模板实例
+using CompressorFactory = std::function<std::unique_ptr<SparseArrayCompressor>(ElemType)>;
+
+template <template <typename> class Compressor, typename... Args>
+std::unique_ptr<SparseArrayCompressor> MakeTypedCompressor(ElemType type, Args... args)
+{
+    return DispatchElemType(type, [&](auto tag) -> std::unique_ptr<SparseArrayCompressor>
+                            { return std::make_unique<Compressor<decltype(tag)>>(args...); });
+}
 
 class CompressorRegistry
 {
@@ -78,7 +237,7 @@ public:
     static CompressorRegistry &Instance();
 
     void Register(const std::string &name, CompressorFactory factory);
-    std::unique_ptr<SparseArrayCompressor> Create(const std::string &name) const;
+    std::unique_ptr<SparseArrayCompressor> Create(const std::string &name, ElemType type = ELEM_UINT32) const;
     std::vector<std::string> ListAlgorithms() const;
 
 private:
@@ -0,0 +1,50 @@
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2026-10-19 22:50:00
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2026-10-19 22:50:00
+ * @FilePath: \SparseArrayAnalyzer\core\inc\stream_analyzer.h
+ * @Description: 超出内存的输入：按块读取文件，喂给增量编码器统计压缩结果，不持有稠密数组
+ *
+ */
+#ifndef _STREAM_ANALYZER_H_
+#define _STREAM_ANALYZER_H_
+
+#include "sparse_array_analyzer.h"
+
+#define STREAM_DEFAULT_MEM_LIMIT (64ull << 20) // 未指定 --mem-limit 时的工作内存上限
+#define STREAM_MIN_MEM_LIMIT     (1ull << 20)
+
+// 流式输入：二进制文件读取 SAAB 头之后的数据，文本文件逐个解析数值
+typedef struct stream_source
+{
+    std::string path;
+    bool isBinary = false;
+    ElemType elemType = ELEM_UINT32;
+    ArrayDimension dimension = ARRAY_1D;
+    uint64_t rows = 1; // 一维为 1
+    uint64_t cols = 0; // 一维文本输入为 0，表示读到文件末尾
+} StreamSource;
+
+typedef struct stream_stats
+{
+    uint64_t elemCount = 0;
+    uint64_t chunkElems = 0;      // 每块元素数
+    uint64_t chunkCount = 0;      // 每遍读取的块数
+    uint32_t workerCount = 0;     // 第二遍的编码线程数（另有一个读线程）
+    uint64_t peakBytes = 0;       // 工作内存峰值估计（块缓冲池 + 频率表 / 字典）
+    bool mainValueExact = true;   // 频率表未超出预算，主值为精确众数
+    double readTimeMs = 0;        // 两遍读取与解析耗时（读线程）
+    double encodeTimeMs = 0;      // 两遍中最慢消费线程的计算耗时
+    double wallTimeMs = 0;        // 两遍端到端耗时，读取与计算重叠时趋近两者的较大值
+} StreamStats;
+
+// 解析内存大小，支持 K / M / G 后缀（1024 进制）
+int8_t ParseMemLimit(const std::string &text, uint64_t &bytes);
+
+// 两遍扫描：第一遍求主值，第二遍把每块同时喂给所有流式编码器；读线程与编码线程流水线执行；
+// 支持 BitmapPayload(-FOR)、RunLengthEnc(-FOR，行优先)、HashDictionary、CompressedSparseRow(-FOR，仅二维)
+int8_t RunStreamAnalysis(const StreamSource &source, uint64_t memLimit, std::vector<CalResult> &results,
+                         StreamStats &stats);
+
+#endif // _STREAM_ANALYZER_H_
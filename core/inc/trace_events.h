@@ -0,0 +1,61 @@
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2026-10-20 02:20:00
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2026-10-20 02:20:00
+ * @FilePath: \SparseArrayAnalyzer\core\inc\trace_events.h
+ * @Description: 作用域追踪，输出 Chrome trace-event JSON（chrome://tracing / Perfetto 可直接打开）；
+ *               默认关闭，关闭时 TraceSpan 只做一次原子读
+ *
+ */
+#ifndef _TRACE_EVENTS_H_
+#define _TRACE_EVENTS_H_
+
+#include <cstdint>
+#include <string>
+
+#define TRACE_THREAD_RESERVE (1024) // 每个线程首次记录时预留的事件数
+
+void EnableTracing();
+bool TracingEnabled();
+
+// 当前线程在时间线上显示的名称，未设置时为 "thread-<tid>"
+void SetTraceThreadName(const std::string &name);
+
+// 写出所有线程已记录的事件；调用时不应再有线程在记录
+int8_t WriteTrace(const std::string &path);
+
+// 一个完整事件（ph = "X"）：构造时开始，stop() 或析构时结束并记入本线程缓冲；
+// name 须为静态字符串，detail 写入 args，用于区分算法、文件等
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char *name);
+    TraceSpan(const char *name, const std::string &detail);
+    ~TraceSpan();
+    void stop();
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+    const char *_name = nullptr; // 为空表示未开启或已结束
+    std::string _detail;
+    int64_t _startNs = 0;
+};
+
+// main 中使用：path 非空时开启追踪并把当前线程命名为 main，析构时写出文件
+class TraceSession
+{
+public:
+    explicit TraceSession(const std::string &path);
+    ~TraceSession();
+
+    TraceSession(const TraceSession &) = delete;
+    TraceSession &operator=(const TraceSession &) = delete;
+
+private:
+    std::string _path;
+};
+
+#endif // _TRACE_EVENTS_H_
@@ -0,0 +1,56 @@
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2026-10-20 01:40:00
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2026-10-20 01:40:00
+ * @FilePath: \SparseArrayAnalyzer\core\inc\work_arena.h
+ * @Description: 压缩器临时容器使用的单线程线性分配器（std::pmr::memory_resource）：释放为空操作，
+ *               Rewind() 回到起点但保留内存，规模不变的重复运行不再向上游申请
+ *
+ */
+#ifndef _WORK_ARENA_H_
+#define _WORK_ARENA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+#define WORK_ARENA_DEFAULT_BYTES (64u << 10) // 首块大小，之后按已用总量倍增
+
+class WorkArena : public std::pmr::memory_resource
+{
+public:
+    explicit WorkArena(size_t initialBytes = WORK_ARENA_DEFAULT_BYTES) : _initialBytes(initialBytes) {}
+    ~WorkArena() override;
+
+    WorkArena(const WorkArena &) = delete;
+    WorkArena &operator=(const WorkArena &) = delete;
+
+    // 回到起点，之前分配的内存全部失效；上一轮用了多个块时合并为一个总大小相同的块
+    void Rewind();
+
+    uint64_t UpstreamAllocations() const { return _upstreamAllocations; } // 向上游申请块的累计次数
+    size_t CapacityBytes() const;
+
+private:
+    void *do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void *ptr, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+    void addBlock(size_t bytes);
+
+    typedef struct arena_block
+    {
+        char *data;
+        size_t size;
+    } ArenaBlock;
+
+    std::vector<ArenaBlock> _blocks;
+    size_t _current = 0; // 正在使用的块
+    size_t _offset = 0;  // 当前块内已用字节
+    size_t _initialBytes;
+    uint64_t _upstreamAllocations = 0;
+};
+
+#endif // _WORK_ARENA_H_
@@ -1,236 +1,540 @@
-/*
- * @Author: FeOAr feoar@outlook.com
- * @Date: 2025-07-18 19:16:11
- * @LastEditors: FeOAr feoar@outlook.com
- * @LastEditTime: 2025-08-16 10:20:55
- * @FilePath: \SparseArrayAnalyzer\core\src\algorithm_CSR.cpp
- * @Description:
- *
- */
-#include "sparse_array_analyzer.h"
-#include "common.h"
-#include <chrono>
-#include <cmath>
-
-typedef struct csr_compressed_indo
-{
-    std::vector<uint32_t> values;
-    std::vector<uint32_t> colInd;
-    std::vector<uint32_t> rowOffset;
-    uint32_t mainValue;
-    uint32_t rows;
-    uint32_t cols;
-} CSRCompressed;
-
-class CompressedSparseRow : public SparseArrayCompressor
-{
-public:
-    int8_t Compress(const ArrayInput &input) override;
-    int8_t Decompress(ArrayInput &output) override;
-    int8_t GetResult(CalResult &result) const override;
-
-private:
-    int8_t startCompress();
-    int8_t startDecompress(ArrayData2D &output);
-
-    // Input
-    ArrayDimension _arrayType;
-    ArrayData2D _inputData2D;
-
-    // Output
-    CSRCompressed _compressedData;
-    CalResult _result;
-};
-
-int8_t CompressedSparseRow::Compress(const ArrayInput &input)
-{
-    // 1. 解析数据类型
-    if (std::holds_alternative<ArrayData1D>(input))
-    {
-        std::cerr << LOG_WARN << "Input data is unsupported dimension.\n";
-        return ERROR_UNSUPPORT_DIMENSION;
-    }
-    else if (std::holds_alternative<ArrayData2D>(input))
-    {
-        auto &mat = std::get<ArrayData2D>(input);
-        _inputData2D = mat;
-        _arrayType = ARRAY_2D;
-    }
-    else
-    {
-        std::cerr << LOG_ERROR << "Input data is empty.\n";
-        return ERROR_INPUT_EMPTY;
-    }
-
-    auto start = std::chrono::high_resolution_clock::now();
-    startCompress();
-    auto end = std::chrono::high_resolution_clock::now();
-
-    // 2. 计算压缩结果
-    _result.modeName = "CompressedSparseRow";
-    _result.originElementCount = GetArrayElemCount2D(_inputData2D.arrayData);
-    _result.compressedElementCount = _compressedData.values.size() + _compressedData.colInd.size() + _compressedData.rowOffset.size(); // 每个坐标信息包含3个元素：x_coord, y_coord, value
-
-    _result.originSizeBytes = GetArrayTotalSize2D(_inputData2D.arrayData);
-    _result.compressedSizeBytes = GetArrayTotalSize1D(_compressedData.values) +
-                                  GetArrayTotalSize1D(_compressedData.colInd) +
-                                  GetArrayTotalSize1D(_compressedData.rowOffset) +
-                                  3 * sizeof(uint32_t);
-
-    _result.compressTimeMs = std::chrono::duration<double, std::milli>(end - start).count();
-    _result.decompressTimeMs = 0;
-
-    _result.compressionRatio = (static_cast<double>(_result.compressedSizeBytes) / _result.originSizeBytes) * 100.0;
-
-    return SAA_SUCCESS;
-}
-
-int8_t CompressedSparseRow::startCompress()
-{
-#if 1
-    uint32_t row = _inputData2D.rowCount;
-    uint32_t col = _inputData2D.colCount;
-
-    // 1. 分析数组，统计各个值的出现次数
-    std::unordered_map<uint32_t, uint32_t> valueCount;
-    for (const auto &row : _inputData2D.arrayData)
-    {
-        for (const auto &val : row)
-        {
-            valueCount[val]++;
-        }
-    }
-
-    uint32_t mainVal = 0;               // 主值
-    uint32_t mainValCount = 0;          // 主值出现次数
-    for (const auto &pair : valueCount)
-    {
-        if (pair.second > mainValCount)
-        {
-            mainVal = pair.first;
-            mainValCount = pair.second;
-        }
-    }
-
-    _compressedData.mainValue = mainVal; // 记录原始信息
-    _compressedData.rows = row;
-    _compressedData.cols = col;
-
-    // std::cout << LOG_DEBUG << "Main value: " << mainVal << ", Count: " << mainValCount << "\n";
-
-    // 2. 根据主值进行坐标法压缩
-    uint32_t count = 0;
-    _compressedData.rowOffset.push_back(0);
-    for (uint32_t i = 0; i < row; i++)
-    {
-        for (uint32_t n = 0; n < col; n++)
-        {
-            if (_inputData2D.arrayData[i][n] != mainVal)
-            {
-                _compressedData.values.push_back(_inputData2D.arrayData[i][n]);
-                _compressedData.colInd.push_back(n);
-                ++count;
-            }
-        }
-        _compressedData.rowOffset.push_back(count);
-    }
-    
-#if 0
-    std::cout << LOG_DEBUG << "CompressedData: \n";
-    PrintVector1D(_compressedData.rowOffset, "Row Offset");
-    PrintVector1D(_compressedData.colInd, "Column Indices");
-    PrintVector1D(_compressedData.values, "Values");
-    std::cout << LOG_DEBUG << "mainValue: " << _compressedData.mainValue << "\n";
-#endif
-
-#endif
-    return SAA_SUCCESS; // 返回值可以根据实际需要调整
-}
-
-int8_t CompressedSparseRow::Decompress(ArrayInput &output)
-{
-    // 0. 检查
-    if (_inputData2D.arrayData.empty())
-    {
-        std::cerr << LOG_ERROR << "Input data is empty.\n";
-        return ERROR_INPUT_EMPTY;
-    }
-
-    if (_arrayType != ARRAY_2D)
-    {
-        std::cerr << LOG_ERROR << "ArrayInput is not compatible with 2D array.\n";
-        return ERROR_UNSUPPORT_DIMENSION;
-    }
-
-    if (_compressedData.rowOffset.empty() || _compressedData.colInd.empty() || _compressedData.values.empty())
-    {
-        std::cerr << LOG_ERROR << "Compressed data is empty.\n";
-        return ERROR_INPUT_EMPTY;
-    }
-
-    auto *ptr2d = std::get_if<ArrayData2D>(&output);
-    if (!ptr2d)
-    {
-        std::cerr << LOG_ERROR << "ArrayInput is not compatible with 2D array.\n";
-        return ERROR_PARAM_INVALID;
-    }
-
-    // 1. 解压
-    ArrayData2D tempData;
-    auto start = std::chrono::high_resolution_clock::now();
-    if (startDecompress(tempData) != SAA_SUCCESS)
-    {
-        std::cerr << LOG_ERROR << "Decompressed something error.\n";
-        return ERROR_CALCULATE_ERROR;
-    }
-    auto end = std::chrono::high_resolution_clock::now();
-    *ptr2d = tempData;
-
-    _result.decompressTimeMs = std::chrono::duration<double, std::milli>(end - start).count();
-
-    // 2. 校验
-    if (!Compare2D(_inputData2D.arrayData, tempData.arrayData))
-    {
-        std::cerr << LOG_ERROR << "Decompressed result error.\n";
-        return ERROR_CALCULATE_ERROR;
-    }
-    return SAA_SUCCESS;
-}
-
-int8_t CompressedSparseRow::startDecompress(ArrayData2D &outData2D)
-{
-    // 1. 填充主值
-
-    outData2D.arrayData.resize(_compressedData.rows, std::vector<uint32_t>(_compressedData.cols, _compressedData.mainValue));
-
-    outData2D.rowCount = _compressedData.rows;
-    outData2D.colCount = _compressedData.cols;
-
-    // 2. 填充非主值
-    for (uint32_t i = 0; i < outData2D.rowCount; ++i)
-    {
-        for (uint32_t idx = _compressedData.rowOffset[i]; idx < _compressedData.rowOffset[i + 1]; ++idx)
-        {
-            int j = _compressedData.colInd[idx];
-            outData2D.arrayData[i][j] = _compressedData.values[idx];
-        }
-    }
-
-    // PrintVector2D(outData2D.arrayData, outData2D.rowCount, outData2D.colCount);
-    return SAA_SUCCESS;
-}
-
-int8_t CompressedSparseRow::GetResult(CalResult &ret) const
-{
-    ret = _result;
-    return SAA_SUCCESS;
-}
-
-#if ALGORITHM_CSR
-static bool coord_registered = []
-{
-    CompressorRegistry::Instance().Register("CSR", []
-                                            { return std::make_unique<CompressedSparseRow>(); });
-    return true;
-}();
-#endif
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2025-07-18 19:16:11
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2025-08-16 10:20:55
+ * @FilePath: \SparseArrayAnalyzer\core\src\algorithm_CSR.cpp
+ * @Description:
+ *
+ */
+#include "sparse_array_analyzer.h"
+#include "alloc_tracker.h"
+#include "perf_counters.h"
+#include "trace_events.h"
+#include "common.h"
+#include "size_estimator.h"
+#include "index_storage.hpp"
+#include "bit_packing.hpp"
+#include "index_codec.hpp"
+#include "serialization.hpp"
+#include <chrono>
+#include <cmath>
+
+template <typename T>
+struct CSRCompressed
+{
+    std::vector<T> values;
+    PackedValues<T> packedValues; // 参考帧位打包后的 values（可选）
+    IndexStorage colInd;  // 宽度按列数自动选择（8/16/32 位）
+    IndexStorage rowOffset; // 宽度按元素总数自动选择（8/16/32/64 位）
+    EliasFano packedOffset;   // 压缩索引时的行偏移（可选）
+    GroupVarint packedIndex;  // 压缩索引时的行内列号差分（可选）
+    T mainValue;
+    uint32_t rows;
+    uint32_t cols;
+};
+
+template <typename T>
+class CompressedSparseRow : public SparseArrayCompressor
+{
+public:
+    explicit CompressedSparseRow(bool packValues = false, bool compressIndex = false)
+        : _packValues(packValues), _compressIndex(compressIndex) {}
+
+    int8_t Compress(const ArrayInput &input) override;
+    int8_t Decompress(ArrayInput &output) override;
+    int8_t GetResult(CalResult &result) const override;
+    void Reset() override;
+    int8_t Serialize(std::vector<uint8_t> &out) const override;
+    int8_t Deserialize(const uint8_t *data, size_t size) override;
+    int8_t EstimateSize(const SampleStats &stats, SizeEstimate &estimate) const override;
+
+private:
+    int8_t startCompress();
+    int8_t startDecompress(ArrayData2D<T> &output);
+
+    void compressIndex();
+    uint64_t indexBytes() const;
+    std::string modeName() const;
+
+    bool _packValues;    // 负载是否做参考帧位打包
+    bool _compressIndex; // 索引是否做差分 + Group Varint / Elias-Fano 压缩
+
+    // Input
+    ArrayDimension _arrayType;
+    ArrayData2D<T> _inputData2D;
+
+    // Output
+    CSRCompressed<T> _compressedData;
+    CalResult _result;
+};
+
+template <typename T>
+int8_t CompressedSparseRow<T>::Compress(const ArrayInput &input)
+{
+    // 0. 清空上一次的结果，保留容量
+    Reset();
+
+    // 1. 解析数据类型
+    if (std::holds_alternative<ArrayData1D<T>>(input))
+    {
+        std::cerr << LOG_WARN << "Input data is unsupported dimension.\n";
+        return ERROR_UNSUPPORT_DIMENSION;
+    }
+    else if (std::holds_alternative<ArrayData2D<T>>(input))
+    {
+        auto &mat = std::get<ArrayData2D<T>>(input);
+        _inputData2D = mat;
+        _arrayType = ARRAY_2D;
+    }
+    else
+    {
+        std::cerr << LOG_ERROR << "Input element type is not " << ElemTraits<T>::name << ".\n";
+        return ERROR_PARAM_INVALID;
+    }
+
+    TraceSpan compressTrace("compress");
+    AllocPhase compressAlloc(_result.compressAlloc);
+    PerfPhase compressPhase(_result.compressPerf);
+    auto start = std::chrono::high_resolution_clock::now();
+    startCompress();
+    auto end = std::chrono::high_resolution_clock::now();
+    compressPhase.stop();
+    compressAlloc.stop();
+    compressTrace.stop();
+
+    // 2. 计算压缩结果
+    _result.modeName = modeName();
+    _result.originElementCount = GetArrayElemCount2D(_inputData2D.arrayData);
+    uint64_t indexCount = _compressIndex ? _compressedData.packedIndex.count + _compressedData.packedOffset.count
+                                         : IndexStorageCount(_compressedData.colInd) + IndexStorageCount(_compressedData.rowOffset);
+    _result.compressedElementCount = _compressedData.packedValues.count + indexCount;
+
+    _result.originSizeBytes = GetArrayTotalSize2D(_inputData2D.arrayData);
+    _result.compressedSizeBytes = (_packValues ? PackedValuesBytes(_compressedData.packedValues) : GetArrayTotalSize1D(_compressedData.values)) +
+                                  indexBytes() +
+                                  2 * sizeof(uint32_t) + sizeof(T);
+
+    _result.compressTimeMs = std::chrono::duration<double, std::milli>(end - start).count();
+    _result.decompressTimeMs = 0;
+
+    _result.compressionRatio = (static_cast<double>(_result.compressedSizeBytes) / _result.originSizeBytes) * 100.0;
+
+    // 顺序：主值填充 + 逐个写入非主值；随机：读行偏移后在行内二分列号
+    double nnz = static_cast<double>(_compressedData.packedValues.count);
+    _result.seqAccessOps = 1.0 + 2.0 * nnz / std::max<uint64_t>(_result.originElementCount, 1);
+    _result.randomAccessOps = 2.0 + std::log2(nnz / std::max<uint32_t>(_compressedData.rows, 1) + 1.0);
+
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+int8_t CompressedSparseRow<T>::startCompress()
+{
+#if 1
+    uint32_t row = _inputData2D.rowCount;
+    uint32_t col = _inputData2D.colCount;
+
+    // 1. 分析数组，统计各个值的出现次数
+    std::pmr::unordered_map<uint64_t, uint64_t> valueCount(_workResource);
+    for (const auto &row : _inputData2D.arrayData)
+    {
+        for (const auto &val : row)
+        {
+            valueCount[ToOrderedKey(val)]++;
+        }
+    }
+
+    T mainVal = 0;                      // 主值
+    uint64_t mainValCount = 0;          // 主值出现次数
+    for (const auto &pair : valueCount)
+    {
+        if (pair.second > mainValCount)
+        {
+            mainVal = FromOrderedKey<T>(pair.first);
+            mainValCount = pair.second;
+        }
+    }
+
+    _compressedData.mainValue = mainVal; // 记录原始信息
+    _compressedData.rows = row;
+    _compressedData.cols = col;
+
+    // std::cout << LOG_DEBUG << "Main value: " << mainVal << ", Count: " << mainValCount << "\n";
+
+    // 2. 根据主值进行坐标法压缩，行偏移宽度由元素总数决定，列号宽度由列数决定
+    uint64_t nonMainCount = GetArrayElemCount2D(_inputData2D.arrayData) - mainValCount;
+    ResetIndexStorage(_compressedData.rowOffset, static_cast<uint64_t>(row) * col);
+    ResetIndexStorage(_compressedData.colInd, col ? col - 1 : 0);
+    std::visit([&](auto &rowOffset, auto &colInd)
+               {
+                   using OffsetType = typename std::decay_t<decltype(rowOffset)>::value_type;
+                   using IndexType = typename std::decay_t<decltype(colInd)>::value_type;
+                   OffsetType count = 0;
+                   rowOffset.reserve(static_cast<size_t>(row) + 1);
+                   _compressedData.values.reserve(nonMainCount); // 非主值数量已知，按实际容量分配
+                   colInd.reserve(nonMainCount);
+                   rowOffset.push_back(0);
+                   for (uint32_t i = 0; i < row; i++)
+                   {
+                       for (uint32_t n = 0; n < col; n++)
+                       {
+                           if (!SameBits(_inputData2D.arrayData[i][n], mainVal))
+                           {
+                               _compressedData.values.push_back(_inputData2D.arrayData[i][n]);
+                               colInd.push_back(static_cast<IndexType>(n));
+                               ++count;
+                           }
+                       }
+                       rowOffset.push_back(count);
+                   } },
+               _compressedData.rowOffset, _compressedData.colInd);
+
+    // 3. 负载位打包（可选），未打包时只记录数量
+    if (_packValues)
+    {
+        PackValues(_compressedData.values, _compressedData.packedValues);
+        _compressedData.values.clear(); // 保留容量供下一次压缩复用
+    }
+    else
+    {
+        _compressedData.packedValues.count = _compressedData.values.size();
+    }
+
+    // 4. 索引压缩（可选）
+    if (_compressIndex)
+    {
+        compressIndex();
+    }
+
+#if 0
+    std::cout << LOG_DEBUG << "CompressedData: \n";
+    std::visit([](const auto &offset) { PrintVector1D(offset, "Row Offset"); }, _compressedData.rowOffset);
+    std::visit([](const auto &index) { PrintVector1D(index, "Column Indices"); }, _compressedData.colInd);
+    PrintVector1D(_compressedData.values, "Values");
+    std::cout << LOG_DEBUG << "mainValue: " << _compressedData.mainValue << "\n";
+#endif
+
+#endif
+    return SAA_SUCCESS; // 返回值可以根据实际需要调整
+}
+
+template <typename T>
+int8_t CompressedSparseRow<T>::Decompress(ArrayInput &output)
+{
+    // 0. 检查
+    if (_arrayType != ARRAY_2D)
+    {
+        std::cerr << LOG_ERROR << "ArrayInput is not compatible with 2D array.\n";
+        return ERROR_UNSUPPORT_DIMENSION;
+    }
+
+    if (IndexStorageEmpty(_compressedData.rowOffset) && _compressedData.packedOffset.count == 0)
+    {
+        std::cerr << LOG_ERROR << "Compressed data is empty.\n";
+        return ERROR_INPUT_EMPTY;
+    }
+
+    auto *ptr2d = std::get_if<ArrayData2D<T>>(&output);
+    if (!ptr2d)
+    {
+        std::cerr << LOG_ERROR << "ArrayInput is not compatible with 2D array.\n";
+        return ERROR_PARAM_INVALID;
+    }
+
+    // 1. 解压，直接写入调用方的输出以复用其容量
+    TraceSpan decompressTrace("decompress");
+    AllocPhase decompressAlloc(_result.decompressAlloc);
+    PerfPhase decompressPhase(_result.decompressPerf);
+    auto start = std::chrono::high_resolution_clock::now();
+    if (startDecompress(*ptr2d) != SAA_SUCCESS)
+    {
+        std::cerr << LOG_ERROR << "Decompressed something error.\n";
+        return ERROR_CALCULATE_ERROR;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    decompressPhase.stop();
+    decompressAlloc.stop();
+    decompressTrace.stop();
+
+    _result.decompressTimeMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+    // 2. 校验，反序列化得到的对象没有原始输入，跳过
+    if (!_inputData2D.arrayData.empty() && !Compare2D(_inputData2D.arrayData, ptr2d->arrayData))
+    {
+        std::cerr << LOG_ERROR << "Decompressed result error.\n";
+        return ERROR_CALCULATE_ERROR;
+    }
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+int8_t CompressedSparseRow<T>::startDecompress(ArrayData2D<T> &outData2D)
+{
+    // 1. 填充主值
+
+    FillArray2D(outData2D.arrayData, _compressedData.rows, _compressedData.cols, _compressedData.mainValue);
+
+    outData2D.rowCount = _compressedData.rows;
+    outData2D.colCount = _compressedData.cols;
+
+    // 2. 负载先整体解包
+    std::pmr::vector<T> unpacked(_workResource);
+    if (_packValues)
+    {
+        UnpackValues(_compressedData.packedValues, unpacked);
+    }
+    const T *values = _packValues ? unpacked.data() : _compressedData.values.data();
+
+    // 3. 压缩索引：批量解码偏移与差分，再按差分累加还原列号
+    if (_compressIndex)
+    {
+        std::pmr::vector<uint64_t> rowOffset(_workResource);
+        std::pmr::vector<uint32_t> gaps(_workResource);
+        DecodeEliasFano(_compressedData.packedOffset, rowOffset);
+        DecodeGroupVarint(_compressedData.packedIndex, gaps);
+        for (uint32_t i = 0; i < outData2D.rowCount; ++i)
+        {
+            auto &outRow = outData2D.arrayData[i];
+            uint32_t next = 0;
+            for (uint64_t idx = rowOffset[i]; idx < rowOffset[i + 1]; ++idx)
+            {
+                uint32_t j = next + gaps[idx];
+                outRow[j] = values[idx];
+                next = j + 1;
+            }
+        }
+        return SAA_SUCCESS;
+    }
+
+    // 4. 填充非主值（按行偏移/列号宽度组合特化）
+    std::visit([&](const auto &rowOffset, const auto &colInd)
+               {
+                   for (uint32_t i = 0; i < outData2D.rowCount; ++i)
+                   {
+                       auto &outRow = outData2D.arrayData[i];
+                       for (uint64_t idx = rowOffset[i]; idx < rowOffset[i + 1]; ++idx)
+                       {
+                           outRow[colInd[idx]] = values[idx];
+                       }
+                   } },
+               _compressedData.rowOffset, _compressedData.colInd);
+
+    // PrintVector2D(outData2D.arrayData, outData2D.rowCount, outData2D.colCount);
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+int8_t CompressedSparseRow<T>::EstimateSize(const SampleStats &stats, SizeEstimate &estimate) const
+{
+    if (!stats.is2D)
+    {
+        return ERROR_UNSUPPORT_DIMENSION;
+    }
+
+    // 固定开销 + 每个非主值的存储开销
+    estimate.modeName = modeName();
+    double offsetBytes = (stats.rows + 1.0) * SelectIndexWidth(stats.rows * stats.cols);
+    double indexBytes = SelectIndexWidth(stats.cols ? stats.cols - 1 : 0);
+    if (_compressIndex)
+    {
+        // 偏移按 Elias-Fano 每项约 2 + log2(平均非主值数) 位；差分按平均间隔的字节数 + 1/4 控制字节
+        double perOuter = stats.nonMainFraction * stats.elemCount / std::max<double>(stats.rows, 1.0) + 1.0;
+        double meanGap = 1.0 / std::max(stats.nonMainFraction, 1e-9);
+        offsetBytes = (stats.rows + 1.0) * (2.0 + std::log2(perOuter)) / 8.0 + 3 * sizeof(uint64_t) + 1;
+        indexBytes = VarintByteCount(static_cast<uint32_t>(std::min(meanGap, 4e9))) + 0.25;
+    }
+
+    double fixedBytes = offsetBytes + 2 * sizeof(uint32_t) + stats.elemBytes;
+    double valueBytes = stats.elemBytes;
+    if (_packValues)
+    {
+        fixedBytes += sizeof(uint64_t) + 1; // 参考帧 + 位宽
+        valueBytes = stats.packedBitWidth / 8.0;
+    }
+    EstimateByNonMain(stats, fixedBytes, valueBytes + indexBytes, estimate);
+    return SAA_SUCCESS;
+}
+
+// 行偏移单调不减，改用 Elias-Fano；行内列号在每段内严格递增，记录相邻差值 - 1（段首为自身）
+template <typename T>
+void CompressedSparseRow<T>::compressIndex()
+{
+    std::pmr::vector<uint64_t> offsets(_workResource);
+    std::pmr::vector<uint32_t> gaps(_workResource);
+    std::visit([&](const auto &rowOffset, const auto &colInd)
+               {
+                   offsets.assign(rowOffset.begin(), rowOffset.end());
+                   gaps.reserve(colInd.size());
+                   for (size_t k = 0; k + 1 < rowOffset.size(); ++k)
+                   {
+                       uint32_t next = 0;
+                       for (uint64_t idx = rowOffset[k]; idx < rowOffset[k + 1]; ++idx)
+                       {
+                           gaps.push_back(static_cast<uint32_t>(colInd[idx] - next));
+                           next = static_cast<uint32_t>(colInd[idx]) + 1;
+                       }
+                   } },
+               _compressedData.rowOffset, _compressedData.colInd);
+
+    EncodeEliasFano(offsets, _compressedData.packedOffset);
+    EncodeGroupVarint(gaps, _compressedData.packedIndex);
+    IndexStorageClear(_compressedData.rowOffset);
+    IndexStorageClear(_compressedData.colInd);
+}
+
+template <typename T>
+uint64_t CompressedSparseRow<T>::indexBytes() const
+{
+    if (_compressIndex)
+    {
+        return EliasFanoBytes(_compressedData.packedOffset) + GroupVarintBytes(_compressedData.packedIndex);
+    }
+    return IndexStorageBytes(_compressedData.colInd) + IndexStorageBytes(_compressedData.rowOffset);
+}
+
+template <typename T>
+std::string CompressedSparseRow<T>::modeName() const
+{
+    std::string name = "CompressedSparseRow";
+    if (_packValues)
+        name += "-FOR";
+    if (_compressIndex)
+        name += "-CI";
+    return name;
+}
+
+template <typename T>
+int8_t CompressedSparseRow<T>::GetResult(CalResult &ret) const
+{
+    ret = _result;
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+void CompressedSparseRow<T>::Reset()
+{
+    ClearRows2D(_inputData2D.arrayData);
+    _inputData2D.rowCount = 0;
+    _inputData2D.colCount = 0;
+    _compressedData.values.clear();
+    PackedValuesClear(_compressedData.packedValues);
+    IndexStorageClear(_compressedData.colInd);
+    IndexStorageClear(_compressedData.rowOffset);
+    EliasFanoClear(_compressedData.packedOffset);
+    GroupVarintClear(_compressedData.packedIndex);
+    _result = CalResult();
+}
+
+template <typename T>
+int8_t CompressedSparseRow<T>::Serialize(std::vector<uint8_t> &out) const
+{
+    ByteWriter writer(out);
+
+    // 1. 模式与形状
+    writer.put(static_cast<uint8_t>(_packValues));
+    writer.put(static_cast<uint8_t>(_compressIndex));
+    writer.put(_compressedData.rows);
+    writer.put(_compressedData.cols);
+    writer.put(_compressedData.mainValue);
+
+    // 2. 负载
+    if (_packValues)
+        writer.putPacked(_compressedData.packedValues);
+    else
+        writer.putArray(_compressedData.values);
+
+    // 3. 索引
+    if (_compressIndex)
+    {
+        writer.putEliasFano(_compressedData.packedOffset);
+        writer.putGroupVarint(_compressedData.packedIndex);
+    }
+    else
+    {
+        writer.putIndex(_compressedData.rowOffset);
+        writer.putIndex(_compressedData.colInd);
+    }
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+int8_t CompressedSparseRow<T>::Deserialize(const uint8_t *data, size_t size)
+{
+    ByteReader reader(data, size);
+    CSRCompressed<T> compressed;
+    uint8_t packValues = 0;
+    uint8_t compressIndex = 0;
+
+    // 1. 模式与形状
+    reader.get(packValues);
+    reader.get(compressIndex);
+    reader.get(compressed.rows);
+    reader.get(compressed.cols);
+    reader.get(compressed.mainValue);
+
+    // 2. 负载
+    if (packValues)
+        reader.getPacked(compressed.packedValues);
+    else
+        reader.getArray(compressed.values);
+
+    // 3. 索引
+    if (compressIndex)
+    {
+        reader.getEliasFano(compressed.packedOffset);
+        reader.getGroupVarint(compressed.packedIndex);
+    }
+    else
+    {
+        reader.getIndex(compressed.rowOffset);
+        reader.getIndex(compressed.colInd);
+    }
+
+    uint64_t valueCount = packValues ? compressed.packedValues.count : compressed.values.size();
+    uint64_t offsetCount = compressIndex ? compressed.packedOffset.count : IndexStorageCount(compressed.rowOffset);
+    uint64_t indexCount = compressIndex ? compressed.packedIndex.count : IndexStorageCount(compressed.colInd);
+    bool valid = reader.finished() && offsetCount == static_cast<uint64_t>(compressed.rows) + 1 && indexCount == valueCount;
+
+    // 4. 偏移从 0 单调不减到非主值数，列号小于列数；压缩索引时解码后按行累加差分再检查
+    if (valid && compressIndex)
+    {
+        std::vector<uint64_t> offsets;
+        std::vector<uint32_t> gaps;
+        DecodeEliasFano(compressed.packedOffset, offsets);
+        DecodeGroupVarint(compressed.packedIndex, gaps);
+        valid = OffsetsValid(offsets, valueCount) && SegmentGapsValid(offsets, gaps, compressed.cols);
+    }
+    else if (valid)
+    {
+        valid = OffsetsValid(compressed.rowOffset, valueCount) &&
+                (compressed.cols ? IndicesInRange(compressed.colInd, 0, compressed.cols - 1) : valueCount == 0);
+    }
+    if (!valid)
+    {
+        std::cerr << LOG_ERROR << "Serialized CompressedSparseRow is corrupted.\n";
+        return ERROR_PARAM_INVALID;
+    }
+
+    _packValues = packValues;
+    _compressIndex = compressIndex;
+    _arrayType = ARRAY_2D;
+    _inputData2D = ArrayData2D<T>();
+    _compressedData = std::move(compressed);
+    _result = CalResult();
+    _result.modeName = modeName();
+    return SAA_SUCCESS;
+}
+
+#if ALGORITHM_CSR
+static bool coord_registered = []
+{
+    CompressorRegistry::Instance().Register("CSR", [](ElemType type)
+                                            { return MakeTypedCompressor<CompressedSparseRow>(type); });
+    CompressorRegistry::Instance().Register("CSR-FOR", [](ElemType type)
+                                            { return MakeTypedCompressor<CompressedSparseRow>(type, true); });
+    CompressorRegistry::Instance().Register("CSR-CI", [](ElemType type)
+                                            { return MakeTypedCompressor<CompressedSparseRow>(type, false, true); });
+    return true;
+}();
+#endif
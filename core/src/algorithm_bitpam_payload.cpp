@@ -8,108 +8,214 @@
  *
  */
 #include "sparse_array_analyzer.h"
+#include "alloc_tracker.h"
+#include "perf_counters.h"
+#include "trace_events.h"
 #include "common.h"
+#include "size_estimator.h"
+#include "bit_packing.hpp"
+#include "serialization.hpp"
 #include <chrono>
 #include <cmath>
 
-typedef struct bitmap_enc_out
+#define BITMAP_VERIFY_STRIDE (97) // 解压校验时抽查随机访问的步长
+
+template <typename T>
+struct BitMapCompressed1D
 {
-    uint32_t bitNum;
-    uint32_t mainValue;
+    uint64_t bitNum;
+    T mainValue;
     uint32_t rows;
     uint32_t cols;
     std::vector<uint8_t> bitmap;
-    std::vector<uint32_t> valueTable;
-} BitMapCompressed1D;
+    std::vector<T> valueTable;
+    PackedValues<T> packedTable; // 参考帧位打包后的 valueTable（可选）
+
+    // 两级位图（可选）：summary 每位对应一个 64 位位图字，只保存非零字
+    std::vector<uint64_t> summary;
+    std::vector<uint64_t> words;
+    std::vector<uint32_t> wordRank;  // 每个 summary 字之前的非零字数量
+    std::vector<uint32_t> valueRank; // 每个 summary 字之前的非主值数量
+};
+
+// 反序列化校验：位图在 bitNum 之外没有置位且置位数等于非主值数；两级位图的 summary 置位数等于非零字数，
+// 每个保存的字非零，wordRank / valueRank 等于之前各 summary 字覆盖的非零字数 / 非主值数
+template <typename T>
+static bool BitmapLayoutValid(const BitMapCompressed1D<T> &compressed, bool hierarchical, uint64_t valueCount)
+{
+    const uint64_t wordCount = (compressed.bitNum + 63) / 64;
+    if (!hierarchical)
+    {
+        if (compressed.bitmap.size() != (compressed.bitNum + 7) / 8)
+            return false;
+        if ((compressed.bitNum & 7) && (compressed.bitmap.back() >> (compressed.bitNum & 7)))
+            return false;
+        uint64_t ones = 0;
+        for (uint8_t byte : compressed.bitmap)
+            ones += __builtin_popcount(byte);
+        return ones == valueCount;
+    }
+
+    const uint64_t summaryCount = (wordCount + 63) / 64;
+    if (compressed.summary.size() != summaryCount || compressed.wordRank.size() != summaryCount ||
+        compressed.valueRank.size() != summaryCount)
+        return false;
 
+    uint64_t wordIndex = 0;
+    uint64_t ones = 0;
+    for (uint64_t s = 0; s < summaryCount; ++s)
+    {
+        uint64_t summaryBits = compressed.summary[s];
+        if (compressed.wordRank[s] != wordIndex || compressed.valueRank[s] != ones ||
+            (s + 1 == summaryCount && (wordCount & 63) && (summaryBits >> (wordCount & 63))))
+            return false;
+        for (; summaryBits; summaryBits &= summaryBits - 1, ++wordIndex)
+        {
+            if (wordIndex >= compressed.words.size() || compressed.words[wordIndex] == 0)
+                return false;
+            uint64_t w = s * 64 + __builtin_ctzll(summaryBits);
+            uint64_t bits = compressed.words[wordIndex];
+            if (w + 1 == wordCount && (compressed.bitNum & 63) && (bits >> (compressed.bitNum & 63)))
+                return false;
+            ones += __builtin_popcountll(bits);
+        }
+    }
+    return wordIndex == compressed.words.size() && ones == valueCount;
+}
+
+template <typename T>
 class BitmapPayloadEnc : public SparseArrayCompressor
 {
+public:
+    explicit BitmapPayloadEnc(bool packValues = false, bool hierarchical = false)
+        : _packValues(packValues), _hierarchical(hierarchical) {}
+
     int8_t Compress(const ArrayInput &input) override;
     int8_t Decompress(ArrayInput &output) override;
     int8_t GetResult(CalResult &result) const override;
+    void Reset() override;
+    int8_t Serialize(std::vector<uint8_t> &out) const override;
+    int8_t Deserialize(const uint8_t *data, size_t size) override;
+    int8_t GetElement(uint64_t index, void *value) const override;
+    int8_t EstimateSize(const SampleStats &stats, SizeEstimate &estimate) const override;
 
 private:
     int8_t startCompress();
-    int8_t startDecompress(ArrayData1D &output);
+    int8_t startDecompress(ArrayData1D<T> &output);
+    void buildHierarchical();
+    void decompressHierarchical(const T *valueTable, ArrayData1D<T> &outData1D) const;
+    T lookupHierarchical(uint64_t index) const;
+    uint64_t valueTableBytes() const;
+    uint64_t bitmapBytes() const;
+    std::string modeName() const;
+
+    bool _packValues;   // 负载是否做参考帧位打包
+    bool _hierarchical; // 是否使用两级位图
 
     // Input
-    ArrayData1D _inputData1D;
+    ArrayData1D<T> _inputData1D;
+    ArrayData1D<T> _decodeBuffer; // 解压输出缓冲，与调用方的数组交换后在下一轮复用
     ArrayDimension _arrayType;
 
     // Output
-    BitMapCompressed1D _compressedData;
+    BitMapCompressed1D<T> _compressedData;
     CalResult _result;
 };
 
-int8_t BitmapPayloadEnc::Compress(const ArrayInput &input)
+template <typename T>
+int8_t BitmapPayloadEnc<T>::Compress(const ArrayInput &input)
 {
+    // 0. 清空上一次的结果，保留容量
+    Reset();
+
     // 1. 预处理输入数据
-    if (std::holds_alternative<ArrayData1D>(input))
+    if (std::holds_alternative<ArrayData1D<T>>(input))
     {
-        const auto &vec = std::get<ArrayData1D>(input);
+        const auto &vec = std::get<ArrayData1D<T>>(input);
         _inputData1D = vec;
         _arrayType = ARRAY_1D;
+        _compressedData.rows = 1;
+        _compressedData.cols = static_cast<uint32_t>(vec.arrayData.size());
     }
-    else if (std::holds_alternative<ArrayData2D>(input))
+    else if (std::holds_alternative<ArrayData2D<T>>(input))
     {
         _arrayType = ARRAY_2D;
-        const auto &vec2d = std::get<ArrayData2D>(input);
+        const auto &vec2d = std::get<ArrayData2D<T>>(input);
                 
         _compressedData.rows = vec2d.rowCount;
         _compressedData.cols = vec2d.colCount;
 
-        std::vector<uint32_t> flat;
-        flat.reserve(_compressedData.rows * _compressedData.cols);
+        // 直接展平到输入副本，复用其容量
+        _inputData1D.arrayData.clear();
+        _inputData1D.arrayData.reserve(static_cast<size_t>(_compressedData.rows) * _compressedData.cols);
         for (const auto &row : vec2d.arrayData)
         {
-            flat.insert(flat.end(), row.begin(), row.end());
+            _inputData1D.arrayData.insert(_inputData1D.arrayData.end(), row.begin(), row.end());
         }
-
-        _inputData1D.arrayData = std::move(flat);
     }
     else
     {
-        std::cerr << LOG_ERROR << "Input data is empty.\n";
-        return ERROR_INPUT_EMPTY;
+        std::cerr << LOG_ERROR << "Input element type is not " << ElemTraits<T>::name << ".\n";
+        return ERROR_PARAM_INVALID;
     }
 
+    TraceSpan compressTrace("compress");
+    AllocPhase compressAlloc(_result.compressAlloc);
+    PerfPhase compressPhase(_result.compressPerf);
     auto start = std::chrono::high_resolution_clock::now();
     startCompress();
     auto end = std::chrono::high_resolution_clock::now();
+    compressPhase.stop();
+    compressAlloc.stop();
+    compressTrace.stop();
 
     // 2. 计算压缩结果
-    _result.modeName = "BitmapPayload";
+    _result.modeName = modeName();
     _result.originElementCount = GetArrayElemCount1D(_inputData1D.arrayData);
-    _result.compressedElementCount = _compressedData.bitmap.size() + _compressedData.valueTable.size() + 4;
+    _result.compressedElementCount = _compressedData.bitmap.size() + _compressedData.summary.size() + _compressedData.words.size() +
+                                     _compressedData.packedTable.count + 4;
 
     _result.originSizeBytes = GetArrayTotalSize1D(_inputData1D.arrayData);
-    _result.compressedSizeBytes = _compressedData.bitmap.size() + GetArrayTotalSize1D(_compressedData.valueTable) + 4 * sizeof(uint32_t);
+    _result.compressedSizeBytes = bitmapBytes() + valueTableBytes() + 3 * sizeof(uint32_t) + sizeof(T);
 
     _result.compressTimeMs = std::chrono::duration<double, std::milli>(end - start).count();
     _result.decompressTimeMs = 0;
 
     _result.compressionRatio = (static_cast<double>(_result.compressedSizeBytes) / _result.originSizeBytes) * 100.0;
 
+    // 顺序：测位 + 按需读值；随机：无 rank 索引，需统计前缀中置位数（平均半个位图）
+    double nonMainRatio = static_cast<double>(_compressedData.packedTable.count) / std::max<uint64_t>(_result.originElementCount, 1);
+    _result.seqAccessOps = 1.0 + nonMainRatio;
+    _result.randomAccessOps = 2.0 + _compressedData.bitmap.size() / 2.0;
+    if (_hierarchical)
+    {
+        // 顺序：只访问非零字；随机：summary 测位 + rank 前缀，组内最多 64 次 popcount
+        double wordRatio = static_cast<double>(_compressedData.words.size()) * 64 / std::max<uint64_t>(_result.originElementCount, 1);
+        _result.seqAccessOps = 1.0 + nonMainRatio + wordRatio / 64.0;
+        _result.randomAccessOps = 3.0 + std::min(32.0, _compressedData.words.size() / std::max<double>(_compressedData.summary.size(), 1.0) / 2.0);
+    }
+
     return SAA_SUCCESS;
 }
 
-int8_t BitmapPayloadEnc::startCompress()
+template <typename T>
+int8_t BitmapPayloadEnc<T>::startCompress()
 {
 #if 1
     // 1. 分析数组，统计各个值的出现次数
-    std::unordered_map<uint32_t, uint32_t> valueCount;
+    std::pmr::unordered_map<uint64_t, uint64_t> valueCount(_workResource);
     for (const auto &val : _inputData1D.arrayData)
     {
-        valueCount[val]++;
+        valueCount[ToOrderedKey(val)]++;
     }
 
     _compressedData.mainValue = 0;
-    uint32_t mainValueCount = 0;
+    uint64_t mainValueCount = 0;
     for (const auto &pair : valueCount)
     {
         if (pair.second > mainValueCount)
         {
-            _compressedData.mainValue = pair.first;
+            _compressedData.mainValue = FromOrderedKey<T>(pair.first);
             mainValueCount = pair.second;
         }
     }
@@ -118,20 +224,39 @@ int8_t BitmapPayloadEnc::startCompress()
 
     // 2. 根据主值进行压缩
     _compressedData.bitNum = _inputData1D.arrayData.size();
-    uint32_t numBytes = (_compressedData.bitNum + 8 - 1) / 8;
-    _compressedData.bitmap.resize(numBytes, 0);
-
-    for (uint32_t i = 0; i < _compressedData.bitNum; i++)
+    _compressedData.valueTable.reserve(_compressedData.bitNum - mainValueCount); // 非主值数量已知，按实际容量分配
+    if (_hierarchical)
     {
-        if (_inputData1D.arrayData[i] != _compressedData.mainValue)
+        buildHierarchical();
+    }
+    else
+    {
+        uint64_t numBytes = (_compressedData.bitNum + 8 - 1) / 8;
+        _compressedData.bitmap.resize(numBytes, 0);
+
+        for (uint64_t i = 0; i < _compressedData.bitNum; i++)
         {
-            uint32_t byteIndex = i / 8;
-            uint8_t bitOffset = i % 8;
-            _compressedData.bitmap[byteIndex] |= (1 << bitOffset);
-            _compressedData.valueTable.push_back(_inputData1D.arrayData[i]);
+            if (!SameBits(_inputData1D.arrayData[i], _compressedData.mainValue))
+            {
+                uint64_t byteIndex = i / 8;
+                uint8_t bitOffset = i % 8;
+                _compressedData.bitmap[byteIndex] |= (1 << bitOffset);
+                _compressedData.valueTable.push_back(_inputData1D.arrayData[i]);
+            }
         }
     }
 
+    // 3. 负载位打包（可选），未打包时只记录数量
+    if (_packValues)
+    {
+        PackValues(_compressedData.valueTable, _compressedData.packedTable);
+        _compressedData.valueTable.clear(); // 保留容量供下一次压缩复用
+    }
+    else
+    {
+        _compressedData.packedTable.count = _compressedData.valueTable.size();
+    }
+
 #if 0
     std::cout << LOG_DEBUG << "CompressedData: \n";
     std::cout << LOG_DEBUG << "Bitmap+Payload info: ( " << _compressedData.bitmap.size() << ", " << _compressedData.valueTable.size() << " )\n";
@@ -155,23 +280,21 @@ int8_t BitmapPayloadEnc::startCompress()
     return SAA_SUCCESS; // 返回值可以根据实际需要调整
 }
 
-int8_t BitmapPayloadEnc::Decompress(ArrayInput &output)
+template <typename T>
+int8_t BitmapPayloadEnc<T>::Decompress(ArrayInput &output)
 {
     // 0. 检查
-    if (_inputData1D.arrayData.empty())
-    {
-        std::cerr << LOG_ERROR << "Input data is empty.\n";
-        return ERROR_INPUT_EMPTY;
-    }
-
-    if (_compressedData.bitmap.empty() && _compressedData.valueTable.empty())
+    if (_compressedData.bitmap.empty() && _compressedData.summary.empty())
     {
         std::cerr << LOG_ERROR << "Compressed data is empty.\n";
         return ERROR_INPUT_EMPTY;
     }
 
     // 1. 解压
-    ArrayData1D tempData;
+    ArrayData1D<T> &tempData = _decodeBuffer; // 复用上一轮的缓冲，startDecompress 覆盖全部内容
+    TraceSpan decompressTrace("decompress");
+    AllocPhase decompressAlloc(_result.decompressAlloc);
+    PerfPhase decompressPhase(_result.decompressPerf);
     auto start = std::chrono::high_resolution_clock::now();
     if (startDecompress(tempData) != SAA_SUCCESS)
     {
@@ -179,22 +302,39 @@ int8_t BitmapPayloadEnc::Decompress(ArrayInput &output)
         return ERROR_CALCULATE_ERROR;
     }
     auto end = std::chrono::high_resolution_clock::now();
+    decompressPhase.stop();
+    decompressAlloc.stop();
+    decompressTrace.stop();
 
     _result.decompressTimeMs = std::chrono::duration<double, std::milli>(end - start).count();
 
-    // 2. 校验
-    if (_inputData1D.arrayData != tempData.arrayData)
+    // 2. 校验，反序列化得到的对象没有原始输入，跳过
+    TraceSpan verifyTrace("verify");
+    if (!_inputData1D.arrayData.empty() && !Compare1D(_inputData1D.arrayData, tempData.arrayData))
     {
         std::cerr << LOG_ERROR << "Decompressed result error.\n";
         return ERROR_CALCULATE_ERROR;
     }
 
+    if (_hierarchical && !_inputData1D.arrayData.empty())
+    {
+        for (uint64_t i = 0; i < _compressedData.bitNum; i += BITMAP_VERIFY_STRIDE)
+        {
+            if (lookupHierarchical(i) != _inputData1D.arrayData[i])
+            {
+                std::cerr << LOG_ERROR << "Random access result error at " << i << ".\n";
+                return ERROR_CALCULATE_ERROR;
+            }
+        }
+    }
+    verifyTrace.stop();
+
     // 3. 维度复原
     if (_arrayType == ARRAY_1D)
     {
-        if (auto *ptr1d = std::get_if<ArrayData1D>(&output))
+        if (auto *ptr1d = std::get_if<ArrayData1D<T>>(&output))
         {
-            *ptr1d = std::move(tempData);
+            ptr1d->arrayData.swap(tempData.arrayData); // 与缓冲交换，两块内存在重复运行间轮流使用
         }
         else
         {
@@ -204,19 +344,18 @@ int8_t BitmapPayloadEnc::Decompress(ArrayInput &output)
     }
     else if (_arrayType == ARRAY_2D)
     {
-        if (auto *ptr2d = std::get_if<ArrayData2D>(&output))
+        if (auto *ptr2d = std::get_if<ArrayData2D<T>>(&output))
         {
-            ArrayData2D out;
+            ArrayData2D<T> &out = *ptr2d; // 复用调用方已有行的容量
             out.arrayData.resize(_compressedData.rows);
             for (uint32_t r = 0; r < _compressedData.rows; ++r)
             {
                 out.arrayData[r].assign(
-                    tempData.arrayData.begin() + r * _compressedData.cols,
-                    tempData.arrayData.begin() + (r + 1) * _compressedData.cols);
+                    tempData.arrayData.begin() + static_cast<size_t>(r) * _compressedData.cols,
+                    tempData.arrayData.begin() + static_cast<size_t>(r + 1) * _compressedData.cols);
             }
             out.rowCount = _compressedData.rows;
             out.colCount = _compressedData.cols;
-            *ptr2d = std::move(out);
         }
         else
         {
@@ -228,21 +367,38 @@ int8_t BitmapPayloadEnc::Decompress(ArrayInput &output)
     return SAA_SUCCESS;
 }
 
-int8_t BitmapPayloadEnc::startDecompress(ArrayData1D &outData1D)
+template <typename T>
+int8_t BitmapPayloadEnc<T>::startDecompress(ArrayData1D<T> &outData1D)
 {
-    uint32_t valIndex = 0;
+    uint64_t valIndex = 0;
+
+    // 0. 负载先整体解包
+    std::pmr::vector<T> unpacked(_workResource);
+    if (_packValues)
+    {
+        UnpackValues(_compressedData.packedTable, unpacked);
+    }
+    const T *valueTable = _packValues ? unpacked.data() : _compressedData.valueTable.data();
+
+    if (_hierarchical)
+    {
+        decompressHierarchical(valueTable, outData1D);
+        return SAA_SUCCESS;
+    }
 
     // std::cout << LOG_DEBUG << "bitNum: " << _compressedData.bitNum << " bitmap: " << _compressedData.bitmap.size() << "\n";
+    outData1D.arrayData.clear();
+    outData1D.arrayData.reserve(_compressedData.bitNum);
 
-    for (uint32_t i = 0; i < _compressedData.bitNum; i++)
+    for (uint64_t i = 0; i < _compressedData.bitNum; i++)
     {
-        uint32_t byteIndex = i / 8;
+        uint64_t byteIndex = i / 8;
         uint8_t bitOffset = i % 8;
 
         bool bitSet = (_compressedData.bitmap[byteIndex] >> bitOffset) & 1;
         if (bitSet)
         {
-            outData1D.arrayData.push_back(_compressedData.valueTable[valIndex++]);
+            outData1D.arrayData.push_back(valueTable[valIndex++]);
         }
         else
         {
@@ -254,17 +410,293 @@ int8_t BitmapPayloadEnc::startDecompress(ArrayData1D &outData1D)
     return SAA_SUCCESS;
 }
 
-int8_t BitmapPayloadEnc::GetResult(CalResult &ret) const
+template <typename T>
+void BitmapPayloadEnc<T>::buildHierarchical()
+{
+    const uint64_t wordCount = (_compressedData.bitNum + 63) / 64;
+    const uint64_t summaryCount = (wordCount + 63) / 64;
+    _compressedData.summary.assign(summaryCount, 0);
+    _compressedData.wordRank.assign(summaryCount, 0);
+    _compressedData.valueRank.assign(summaryCount, 0);
+
+    // 每 64 个元素组成一个位图字，全主值的字不保存，只在 summary 中留 0 位
+    const T *data = _inputData1D.arrayData.data();
+    for (uint64_t w = 0; w < wordCount; ++w)
+    {
+        uint64_t s = w / 64;
+        if ((w & 63) == 0)
+        {
+            _compressedData.wordRank[s] = static_cast<uint32_t>(_compressedData.words.size());
+            _compressedData.valueRank[s] = static_cast<uint32_t>(_compressedData.valueTable.size());
+        }
+
+        uint64_t begin = w * 64;
+        uint64_t end = std::min(begin + 64, _compressedData.bitNum);
+        uint64_t bits = 0;
+        for (uint64_t i = begin; i < end; ++i)
+        {
+            if (!SameBits(data[i], _compressedData.mainValue))
+            {
+                bits |= 1ull << (i - begin);
+                _compressedData.valueTable.push_back(data[i]);
+            }
+        }
+
+        if (bits)
+        {
+            _compressedData.summary[s] |= 1ull << (w & 63);
+            _compressedData.words.push_back(bits);
+        }
+    }
+}
+
+template <typename T>
+void BitmapPayloadEnc<T>::decompressHierarchical(const T *valueTable, ArrayData1D<T> &outData1D) const
+{
+    // 先整体填充主值，再只按非零字回填非主值
+    outData1D.arrayData.assign(_compressedData.bitNum, _compressedData.mainValue);
+    T *out = outData1D.arrayData.data();
+    uint64_t wordIndex = 0;
+    uint64_t valIndex = 0;
+    for (uint64_t s = 0; s < _compressedData.summary.size(); ++s)
+    {
+        uint64_t summaryBits = _compressedData.summary[s];
+        while (summaryBits)
+        {
+            uint64_t base = (s * 64 + __builtin_ctzll(summaryBits)) * 64;
+            uint64_t bits = _compressedData.words[wordIndex++];
+            while (bits)
+            {
+                out[base + __builtin_ctzll(bits)] = valueTable[valIndex++];
+                bits &= bits - 1;
+            }
+            summaryBits &= summaryBits - 1;
+        }
+    }
+}
+
+template <typename T>
+T BitmapPayloadEnc<T>::lookupHierarchical(uint64_t index) const
+{
+    uint64_t w = index / 64;
+    uint64_t s = w / 64;
+    uint64_t summaryBits = _compressedData.summary[s];
+    uint64_t summaryBit = 1ull << (w & 63);
+    if (!(summaryBits & summaryBit))
+    {
+        return _compressedData.mainValue;
+    }
+
+    uint64_t bitInWord = 1ull << (index & 63);
+    uint64_t wordIndex = _compressedData.wordRank[s] + __builtin_popcountll(summaryBits & (summaryBit - 1));
+    uint64_t bits = _compressedData.words[wordIndex];
+    if (!(bits & bitInWord))
+    {
+        return _compressedData.mainValue;
+    }
+
+    // 值下标 = 组前缀 + 组内前面各非零字的置位数 + 本字内的置位数
+    uint64_t valIndex = _compressedData.valueRank[s] + __builtin_popcountll(bits & (bitInWord - 1));
+    for (uint64_t k = _compressedData.wordRank[s]; k < wordIndex; ++k)
+    {
+        valIndex += __builtin_popcountll(_compressedData.words[k]);
+    }
+    return _packValues ? UnpackValue(_compressedData.packedTable, valIndex) : _compressedData.valueTable[valIndex];
+}
+
+template <typename T>
+int8_t BitmapPayloadEnc<T>::EstimateSize(const SampleStats &stats, SizeEstimate &estimate) const
+{
+    // 固定开销 + 每个非主值的存储开销
+    estimate.modeName = modeName();
+    double fixedBytes = std::ceil(stats.elemCount / 8.0) + 3 * sizeof(uint32_t) + stats.elemBytes;
+    if (_hierarchical)
+    {
+        // 均匀分布时一个字非零的概率为 1 - (1 - p)^64；聚集分布时非零字数不超过非主值游程数 + 非主值数 / 64
+        double wordCount = std::ceil(stats.elemCount / 64.0);
+        double summaryCount = std::ceil(wordCount / 64.0);
+        double uniformWords = wordCount * (1.0 - std::pow(1.0 - stats.nonMainFraction, 64.0));
+        double clusteredWords = stats.elemCount * (stats.runFraction / 2.0 + stats.nonMainFraction / 64.0);
+        double nonZeroWords = std::min(uniformWords, clusteredWords);
+        fixedBytes = summaryCount * (sizeof(uint64_t) + 2 * sizeof(uint32_t)) + nonZeroWords * sizeof(uint64_t) +
+                     3 * sizeof(uint32_t) + stats.elemBytes;
+    }
+    if (_packValues)
+    {
+        EstimateByNonMain(stats, fixedBytes + sizeof(uint64_t) + 1, stats.packedBitWidth / 8.0, estimate);
+    }
+    else
+    {
+        EstimateByNonMain(stats, fixedBytes, stats.elemBytes, estimate);
+    }
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+uint64_t BitmapPayloadEnc<T>::valueTableBytes() const
+{
+    return _packValues ? PackedValuesBytes(_compressedData.packedTable) : GetArrayTotalSize1D(_compressedData.valueTable);
+}
+
+template <typename T>
+uint64_t BitmapPayloadEnc<T>::bitmapBytes() const
+{
+    if (!_hierarchical)
+    {
+        return _compressedData.bitmap.size();
+    }
+    return (_compressedData.summary.size() + _compressedData.words.size()) * sizeof(uint64_t) +
+           (_compressedData.wordRank.size() + _compressedData.valueRank.size()) * sizeof(uint32_t);
+}
+
+template <typename T>
+std::string BitmapPayloadEnc<T>::modeName() const
+{
+    std::string name = "BitmapPayload";
+    if (_packValues)
+        name += "-FOR";
+    if (_hierarchical)
+        name += "-H";
+    return name;
+}
+
+template <typename T>
+int8_t BitmapPayloadEnc<T>::GetResult(CalResult &ret) const
 {
     ret = _result;
     return SAA_SUCCESS;
 }
 
+template <typename T>
+void BitmapPayloadEnc<T>::Reset()
+{
+    _inputData1D.arrayData.clear();
+    _compressedData.bitmap.clear();
+    _compressedData.valueTable.clear();
+    PackedValuesClear(_compressedData.packedTable);
+    _compressedData.summary.clear();
+    _compressedData.words.clear();
+    _compressedData.wordRank.clear();
+    _compressedData.valueRank.clear();
+    _result = CalResult();
+}
+
+template <typename T>
+int8_t BitmapPayloadEnc<T>::Serialize(std::vector<uint8_t> &out) const
+{
+    ByteWriter writer(out);
+
+    // 1. 模式、维度与形状
+    writer.put(static_cast<uint8_t>(_packValues));
+    writer.put(static_cast<uint8_t>(_hierarchical));
+    writer.put(static_cast<uint8_t>(_arrayType));
+    writer.put(_compressedData.rows);
+    writer.put(_compressedData.cols);
+    writer.put(_compressedData.bitNum);
+    writer.put(_compressedData.mainValue);
+
+    // 2. 位图
+    if (_hierarchical)
+    {
+        writer.putArray(_compressedData.summary);
+        writer.putArray(_compressedData.words);
+        writer.putArray(_compressedData.wordRank);
+        writer.putArray(_compressedData.valueRank);
+    }
+    else
+    {
+        writer.putArray(_compressedData.bitmap);
+    }
+
+    // 3. 非主值
+    if (_packValues)
+        writer.putPacked(_compressedData.packedTable);
+    else
+        writer.putArray(_compressedData.valueTable);
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+int8_t BitmapPayloadEnc<T>::Deserialize(const uint8_t *data, size_t size)
+{
+    ByteReader reader(data, size);
+    BitMapCompressed1D<T> compressed{};
+    uint8_t packValues = 0;
+    uint8_t hierarchical = 0;
+    uint8_t dimension = 0;
+
+    // 1. 模式、维度与形状
+    reader.get(packValues);
+    reader.get(hierarchical);
+    reader.get(dimension);
+    reader.get(compressed.rows);
+    reader.get(compressed.cols);
+    reader.get(compressed.bitNum);
+    reader.get(compressed.mainValue);
+
+    // 2. 位图
+    if (hierarchical)
+    {
+        reader.getArray(compressed.summary);
+        reader.getArray(compressed.words);
+        reader.getArray(compressed.wordRank);
+        reader.getArray(compressed.valueRank);
+    }
+    else
+    {
+        reader.getArray(compressed.bitmap);
+    }
+
+    // 3. 非主值
+    if (packValues)
+        reader.getPacked(compressed.packedTable);
+    else
+        reader.getArray(compressed.valueTable);
+
+    uint64_t valueCount = packValues ? compressed.packedTable.count : compressed.valueTable.size();
+    if (!reader.finished() || dimension > ARRAY_2D ||
+        compressed.bitNum != static_cast<uint64_t>(compressed.rows) * compressed.cols ||
+        !BitmapLayoutValid(compressed, hierarchical, valueCount))
+    {
+        std::cerr << LOG_ERROR << "Serialized BitmapPayload is corrupted.\n";
+        return ERROR_PARAM_INVALID;
+    }
+
+    _packValues = packValues;
+    _hierarchical = hierarchical;
+    _arrayType = static_cast<ArrayDimension>(dimension);
+    _inputData1D.arrayData.clear();
+    _compressedData = std::move(compressed);
+    _result = CalResult();
+    _result.modeName = modeName();
+    return SAA_SUCCESS;
+}
+
+// 只有两级位图带 rank 索引，平铺位图不支持随机读取
+template <typename T>
+int8_t BitmapPayloadEnc<T>::GetElement(uint64_t index, void *value) const
+{
+    if (!_hierarchical)
+    {
+        return ERROR_UNSUPPORT_FEATURE;
+    }
+    if (index >= _compressedData.bitNum)
+    {
+        return ERROR_INDEX_OUT_OF_RANGE;
+    }
+    *static_cast<T *>(value) = lookupHierarchical(index);
+    return SAA_SUCCESS;
+}
+
 #if ALGORITHM_BITMAP_PAYLOAD
 static bool coord_registered = []
 {
-    CompressorRegistry::Instance().Register("BitmapPayloadEnc", []
-                                            { return std::make_unique<BitmapPayloadEnc>(); });
+    CompressorRegistry::Instance().Register("BitmapPayloadEnc", [](ElemType type)
+                                            { return MakeTypedCompressor<BitmapPayloadEnc>(type); });
+    CompressorRegistry::Instance().Register("BitmapPayloadEnc-FOR", [](ElemType type)
+                                            { return MakeTypedCompressor<BitmapPayloadEnc>(type, true); });
+    CompressorRegistry::Instance().Register("BitmapPayloadEnc-H", [](ElemType type)
+                                            { return MakeTypedCompressor<BitmapPayloadEnc>(type, false, true); });
     return true;
 }();
 #endif
\ No newline at end of file
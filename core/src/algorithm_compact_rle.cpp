@@ -0,0 +1,577 @@
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2026-10-19 19:10:00
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2026-10-19 19:10:00
+ * @FilePath: \SparseArrayAnalyzer\core\src\algorithm_compact_rle.cpp
+ * @Description: 紧凑游程编码：主值游程只作为间隔隐式记录，间隔/长度用 Varint，值做参考帧位打包，
+ *               每 N 个游程一个前缀和检查点，支持 O(log n) 随机访问与按检查点分段并行解压
+ *
+ */
+#include "sparse_array_analyzer.h"
+#include "alloc_tracker.h"
+#include "perf_counters.h"
+#include "trace_events.h"
+#include "common.h"
+#include "size_estimator.h"
+#include "bit_packing.hpp"
+#include "index_codec.hpp"
+#include "serialization.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#define CRLE_CHECKPOINT_RUNS   (32)        // 每多少个非主值游程记录一个检查点
+#define CRLE_PARALLEL_MIN_ELEMS (1u << 18) // 元素数不少于此值才并行解压
+#define CRLE_VERIFY_STRIDE     (97)        // 解压校验时抽查随机访问的步长
+
+template <typename T>
+struct CrleCompressed
+{
+    uint64_t count;
+    T mainValue;
+    uint32_t rows;
+    uint32_t cols;
+    uint64_t runCount;                       // 非主值游程数
+    std::vector<uint8_t> runBytes;           // 每个游程：Varint(间隔) + Varint(长度 - 1)
+    PackedValues<T> values;                  // 每个游程的值
+    // 第 k 个检查点对应第 k * CRLE_CHECKPOINT_RUNS 个游程，按字段分开存放以便序列化后原样映射
+    std::vector<uint64_t> checkpointPos;    // 该游程前间隔的起始元素下标
+    std::vector<uint32_t> checkpointOffset; // 该游程在 runBytes 中的起始偏移
+};
+
+// 解码只通过视图读取：指向 CrleCompressed 自身的数组，或反序列化时映射的缓冲区（零拷贝）
+template <typename T>
+struct CrleView
+{
+    ArrayView<uint8_t> runBytes;
+    PackedValuesView<T> values;
+    ArrayView<uint64_t> checkpointPos;
+    ArrayView<uint32_t> checkpointOffset;
+};
+
+// 反序列化校验：顺序回放全部游程，Varint 不越过字节流，间隔与长度累加不超过总数，
+// 每个检查点的位置与偏移与回放结果一致，字节流恰好用完；此后 decodeSegment / lookup 无需边界判断
+template <typename T>
+static bool CrleStreamValid(const CrleCompressed<T> &header, const CrleView<T> &view)
+{
+    const uint8_t *begin = view.runBytes.begin();
+    const uint8_t *in = begin;
+    const uint8_t *end = view.runBytes.end();
+    uint64_t pos = 0;
+    for (uint64_t run = 0; run < header.runCount; ++run)
+    {
+        if (run % CRLE_CHECKPOINT_RUNS == 0)
+        {
+            uint64_t k = run / CRLE_CHECKPOINT_RUNS;
+            if (view.checkpointPos[k] != pos || view.checkpointOffset[k] != static_cast<uint64_t>(in - begin))
+                return false;
+        }
+
+        uint64_t gap = 0;
+        uint64_t lengthMinusOne = 0;
+        if (!DecodeVarintChecked(in, end, gap) || !DecodeVarintChecked(in, end, lengthMinusOne) ||
+            gap >= header.count - pos || lengthMinusOne >= header.count - pos - gap)
+            return false;
+        pos += gap + lengthMinusOne + 1;
+    }
+    return in == end;
+}
+
+template <typename T>
+class CompactRunLengthEnc : public SparseArrayCompressor
+{
+public:
+    int8_t Compress(const ArrayInput &input) override;
+    int8_t Decompress(ArrayInput &output) override;
+    int8_t GetResult(CalResult &result) const override;
+    void Reset() override;
+    int8_t Serialize(std::vector<uint8_t> &out) const override;
+    int8_t Deserialize(const uint8_t *data, size_t size) override;
+    int8_t GetElement(uint64_t index, void *value) const override;
+    int8_t EstimateSize(const SampleStats &stats, SizeEstimate &estimate) const override;
+
+private:
+    int8_t startCompress();
+    int8_t startDecompress(ArrayData1D<T> &output);
+    void decodeSegment(uint64_t firstCheckpoint, uint64_t lastCheckpoint, T *out) const;
+    T lookup(uint64_t index) const;
+    uint64_t compressedBytes() const;
+
+    // Input
+    ArrayData1D<T> _inputData1D;
+    ArrayData1D<T> _decodeBuffer; // 解压输出缓冲，与调用方的数组交换后在下一轮复用
+    ArrayDimension _arrayType;
+
+    // Output
+    CrleCompressed<T> _compressedData;
+    CrleView<T> _view;
+    CalResult _result;
+};
+
+template <typename T>
+int8_t CompactRunLengthEnc<T>::Compress(const ArrayInput &input)
+{
+    // 0. 清空上一次的结果，保留容量
+    Reset();
+
+    // 1. 预处理输入数据，二维按行展平
+    if (std::holds_alternative<ArrayData1D<T>>(input))
+    {
+        _inputData1D = std::get<ArrayData1D<T>>(input);
+        _arrayType = ARRAY_1D;
+        _compressedData.rows = 1;
+        _compressedData.cols = static_cast<uint32_t>(_inputData1D.arrayData.size());
+    }
+    else if (std::holds_alternative<ArrayData2D<T>>(input))
+    {
+        _arrayType = ARRAY_2D;
+        const auto &vec2d = std::get<ArrayData2D<T>>(input);
+        _compressedData.rows = vec2d.rowCount;
+        _compressedData.cols = vec2d.colCount;
+
+        // 直接展平到输入副本，复用其容量
+        _inputData1D.arrayData.clear();
+        _inputData1D.arrayData.reserve(static_cast<size_t>(_compressedData.rows) * _compressedData.cols);
+        for (const auto &row : vec2d.arrayData)
+        {
+            _inputData1D.arrayData.insert(_inputData1D.arrayData.end(), row.begin(), row.end());
+        }
+    }
+    else
+    {
+        std::cerr << LOG_ERROR << "Input element type is not " << ElemTraits<T>::name << ".\n";
+        return ERROR_PARAM_INVALID;
+    }
+
+    if (_inputData1D.arrayData.empty())
+    {
+        std::cerr << LOG_ERROR << "Input data is empty.\n";
+        return ERROR_INPUT_EMPTY;
+    }
+
+    TraceSpan compressTrace("compress");
+    AllocPhase compressAlloc(_result.compressAlloc);
+    PerfPhase compressPhase(_result.compressPerf);
+    auto start = std::chrono::high_resolution_clock::now();
+    startCompress();
+    auto end = std::chrono::high_resolution_clock::now();
+    compressPhase.stop();
+    compressAlloc.stop();
+    compressTrace.stop();
+
+    // 2. 计算压缩结果
+    _result.modeName = "CompactRLE";
+    _result.originElementCount = GetArrayElemCount1D(_inputData1D.arrayData);
+    _result.compressedElementCount = _compressedData.runCount * 2 + _compressedData.checkpointPos.size() * 2 + 4;
+
+    _result.originSizeBytes = GetArrayTotalSize1D(_inputData1D.arrayData);
+    _result.compressedSizeBytes = compressedBytes();
+
+    _result.compressTimeMs = std::chrono::duration<double, std::milli>(end - start).count();
+    _result.decompressTimeMs = 0;
+
+    _result.compressionRatio = (static_cast<double>(_result.compressedSizeBytes) / _result.originSizeBytes) * 100.0;
+
+    // 顺序：每游程两次 Varint 解码 + 批量填充；随机：检查点二分 + 段内平均回放半段游程
+    double runs = static_cast<double>(_compressedData.runCount);
+    _result.seqAccessOps = 1.0 + 2.0 * runs / std::max<uint64_t>(_result.originElementCount, 1);
+    _result.randomAccessOps = 1.0 + std::log2(_compressedData.checkpointPos.size() + 1.0) +
+                              std::min<double>(runs, CRLE_CHECKPOINT_RUNS) / 2.0;
+
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+int8_t CompactRunLengthEnc<T>::startCompress()
+{
+    const std::vector<T> &data = _inputData1D.arrayData;
+    _compressedData.count = data.size();
+
+    // 1. 统计主值
+    std::pmr::unordered_map<uint64_t, uint64_t> valueCount(_workResource);
+    for (const auto &val : data)
+    {
+        valueCount[ToOrderedKey(val)]++;
+    }
+    _compressedData.mainValue = data[0];
+    uint64_t mainValueCount = 0;
+    for (const auto &pair : valueCount)
+    {
+        if (pair.second > mainValueCount)
+        {
+            _compressedData.mainValue = FromOrderedKey<T>(pair.first);
+            mainValueCount = pair.second;
+        }
+    }
+
+    // 2. 只对非主值游程编码，主值游程作为前一游程到本游程之间的间隔
+    std::pmr::vector<T> runValues(_workResource);
+    uint64_t prevEnd = 0;
+    uint64_t i = 0;
+    while (i < data.size())
+    {
+        if (SameBits(data[i], _compressedData.mainValue))
+        {
+            ++i;
+            continue;
+        }
+
+        uint64_t runStart = i;
+        while (i < data.size() && SameBits(data[i], data[runStart]))
+        {
+            ++i;
+        }
+
+        if (runValues.size() % CRLE_CHECKPOINT_RUNS == 0)
+        {
+            _compressedData.checkpointPos.push_back(prevEnd);
+            _compressedData.checkpointOffset.push_back(static_cast<uint32_t>(_compressedData.runBytes.size()));
+        }
+        EncodeVarint(runStart - prevEnd, _compressedData.runBytes);
+        EncodeVarint(i - runStart - 1, _compressedData.runBytes);
+        runValues.push_back(data[runStart]);
+        prevEnd = i;
+    }
+
+    _compressedData.runCount = runValues.size();
+    PackValues(runValues, _compressedData.values);
+
+    // 3. 解码视图指向自身数组
+    _view.runBytes = ViewOf(_compressedData.runBytes);
+    _view.values = ViewOf(_compressedData.values);
+    _view.checkpointPos = ViewOf(_compressedData.checkpointPos);
+    _view.checkpointOffset = ViewOf(_compressedData.checkpointOffset);
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+int8_t CompactRunLengthEnc<T>::Decompress(ArrayInput &output)
+{
+    // 0. 检查
+    if (_compressedData.count == 0)
+    {
+        std::cerr << LOG_ERROR << "Compressed data is empty.\n";
+        return ERROR_INPUT_EMPTY;
+    }
+
+    // 1. 解压
+    ArrayData1D<T> &tempData = _decodeBuffer; // 复用上一轮的缓冲，startDecompress 覆盖全部内容
+    TraceSpan decompressTrace("decompress");
+    AllocPhase decompressAlloc(_result.decompressAlloc);
+    PerfPhase decompressPhase(_result.decompressPerf);
+    auto start = std::chrono::high_resolution_clock::now();
+    if (startDecompress(tempData) != SAA_SUCCESS)
+    {
+        std::cerr << LOG_ERROR << "Decompressed something error.\n";
+        return ERROR_CALCULATE_ERROR;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    decompressPhase.stop();
+    decompressAlloc.stop();
+    decompressTrace.stop();
+
+    _result.decompressTimeMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+    // 2. 校验（含随机访问抽查），反序列化得到的对象没有原始输入，跳过
+    TraceSpan verifyTrace("verify");
+    if (!_inputData1D.arrayData.empty())
+    {
+        if (!Compare1D(_inputData1D.arrayData, tempData.arrayData))
+        {
+            std::cerr << LOG_ERROR << "Decompressed result error.\n";
+            return ERROR_CALCULATE_ERROR;
+        }
+
+        for (uint64_t i = 0; i < _compressedData.count; i += CRLE_VERIFY_STRIDE)
+        {
+            if (lookup(i) != _inputData1D.arrayData[i])
+            {
+                std::cerr << LOG_ERROR << "Random access result error at " << i << ".\n";
+                return ERROR_CALCULATE_ERROR;
+            }
+        }
+    }
+    verifyTrace.stop();
+
+    // 3. 维度复原
+    if (_arrayType == ARRAY_1D)
+    {
+        if (auto *ptr1d = std::get_if<ArrayData1D<T>>(&output))
+        {
+            ptr1d->arrayData.swap(tempData.arrayData); // 与缓冲交换，两块内存在重复运行间轮流使用
+        }
+        else
+        {
+            std::cerr << LOG_ERROR << "ArrayInput is not compatible with 1D array.\n";
+            return ERROR_PARAM_INVALID;
+        }
+    }
+    else if (_arrayType == ARRAY_2D)
+    {
+        if (auto *ptr2d = std::get_if<ArrayData2D<T>>(&output))
+        {
+            ArrayData2D<T> &out = *ptr2d; // 复用调用方已有行的容量
+            out.arrayData.resize(_compressedData.rows);
+            for (uint32_t r = 0; r < _compressedData.rows; ++r)
+            {
+                out.arrayData[r].assign(
+                    tempData.arrayData.begin() + static_cast<size_t>(r) * _compressedData.cols,
+                    tempData.arrayData.begin() + static_cast<size_t>(r + 1) * _compressedData.cols);
+            }
+            out.rowCount = _compressedData.rows;
+            out.colCount = _compressedData.cols;
+        }
+        else
+        {
+            std::cerr << LOG_ERROR << "ArrayInput is not compatible with 2D array.\n";
+            return ERROR_PARAM_INVALID;
+        }
+    }
+
+    return SAA_SUCCESS;
+}
+
+// 解压检查点 [firstCheckpoint, lastCheckpoint) 覆盖的元素区间，out 指向整个输出的起点
+template <typename T>
+void CompactRunLengthEnc<T>::decodeSegment(uint64_t firstCheckpoint, uint64_t lastCheckpoint, T *out) const
+{
+    const uint8_t *in = _view.runBytes.data + _view.checkpointOffset[firstCheckpoint];
+    uint64_t run = firstCheckpoint * CRLE_CHECKPOINT_RUNS;
+    uint64_t runEnd = std::min<uint64_t>(lastCheckpoint * CRLE_CHECKPOINT_RUNS, _compressedData.runCount);
+    uint64_t segmentEnd = (lastCheckpoint < _view.checkpointPos.size())
+                              ? _view.checkpointPos[lastCheckpoint]
+                              : _compressedData.count;
+
+    T *dst = out + _view.checkpointPos[firstCheckpoint];
+    for (; run < runEnd; ++run)
+    {
+        uint64_t gap = DecodeVarint(in);
+        uint64_t length = DecodeVarint(in) + 1;
+        dst = std::fill_n(dst, gap, _compressedData.mainValue);
+        dst = std::fill_n(dst, length, UnpackValue(_view.values, run));
+    }
+    std::fill(dst, out + segmentEnd, _compressedData.mainValue);
+}
+
+template <typename T>
+int8_t CompactRunLengthEnc<T>::startDecompress(ArrayData1D<T> &outData1D)
+{
+    outData1D.arrayData.resize(_compressedData.count);
+    T *out = outData1D.arrayData.data();
+
+    // 1. 没有非主值游程：整体填充主值
+    const uint64_t checkpointCount = _view.checkpointPos.size();
+    if (checkpointCount == 0)
+    {
+        std::fill_n(out, _compressedData.count, _compressedData.mainValue);
+        return SAA_SUCCESS;
+    }
+
+    // 2. 首个游程之前的主值间隔不属于任何分段
+    std::fill_n(out, _view.checkpointPos[0], _compressedData.mainValue);
+
+    // 3. 数据量足够时按检查点均分给多个线程，各段输出区间互不重叠
+    uint64_t threadCount = 1;
+    if (_compressedData.count >= CRLE_PARALLEL_MIN_ELEMS)
+    {
+        threadCount = std::min<uint64_t>(std::max(1u, std::thread::hardware_concurrency()), checkpointCount);
+    }
+
+    if (threadCount <= 1)
+    {
+        decodeSegment(0, checkpointCount, out);
+        return SAA_SUCCESS;
+    }
+
+    AllocContext *allocContext = CurrentAllocContext();
+    std::vector<std::thread> workers;
+    workers.reserve(threadCount);
+    for (uint64_t t = 0; t < threadCount; ++t)
+    {
+        uint64_t first = checkpointCount * t / threadCount;
+        uint64_t last = checkpointCount * (t + 1) / threadCount;
+        workers.emplace_back([this, first, last, out, allocContext]
+                             {
+                                 AllocContextGuard allocGuard(allocContext);
+                                 decodeSegment(first, last, out); });
+    }
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+    return SAA_SUCCESS;
+}
+
+// 随机访问：二分定位检查点，再在段内最多回放 CRLE_CHECKPOINT_RUNS 个游程
+template <typename T>
+T CompactRunLengthEnc<T>::lookup(uint64_t index) const
+{
+    const ArrayView<uint64_t> &checkpoints = _view.checkpointPos;
+    const uint64_t *it = std::upper_bound(checkpoints.begin(), checkpoints.end(), index);
+    if (it == checkpoints.begin())
+    {
+        return _compressedData.mainValue;
+    }
+
+    uint64_t k = static_cast<uint64_t>(it - checkpoints.begin()) - 1;
+    const uint8_t *in = _view.runBytes.data + _view.checkpointOffset[k];
+    uint64_t pos = checkpoints[k];
+    uint64_t runEnd = std::min<uint64_t>((k + 1) * CRLE_CHECKPOINT_RUNS, _compressedData.runCount);
+    for (uint64_t run = k * CRLE_CHECKPOINT_RUNS; run < runEnd; ++run)
+    {
+        pos += DecodeVarint(in);
+        if (index < pos)
+        {
+            return _compressedData.mainValue;
+        }
+        pos += DecodeVarint(in) + 1;
+        if (index < pos)
+        {
+            return UnpackValue(_view.values, run);
+        }
+    }
+    return _compressedData.mainValue;
+}
+
+// 游程字节流 + 打包的值 + 检查点；外加总数、游程数、主值与行列
+template <typename T>
+uint64_t CompactRunLengthEnc<T>::compressedBytes() const
+{
+    return _compressedData.runBytes.size() +
+           PackedValuesBytes(_compressedData.values) +
+           _compressedData.checkpointPos.size() * (sizeof(uint64_t) + sizeof(uint32_t)) +
+           2 * sizeof(uint64_t) + sizeof(T) + 2 * sizeof(uint32_t);
+}
+
+template <typename T>
+int8_t CompactRunLengthEnc<T>::EstimateSize(const SampleStats &stats, SizeEstimate &estimate) const
+{
+    // 非主值游程数不超过非主值数与游程数中的较小者；每个游程：间隔 Varint（按平均间隔估字节数）
+    // + 长度 Varint（按 1 字节）+ 打包值 + 分摊的检查点
+    estimate.modeName = "CompactRLE";
+    double fixedBytes = 3 * sizeof(uint64_t) + stats.elemBytes + 2 * sizeof(uint32_t) + 1;
+    double runRatio = std::min(stats.nonMainFraction, stats.runFraction);
+    double meanGap = (runRatio > 0) ? (1.0 - stats.nonMainFraction) / runRatio : 0.0;
+    double gapBytes = std::max(1.0, std::ceil(std::log2(meanGap + 1.0) / 7.0));
+    double bytesPerRun = gapBytes + 1.0 + stats.packedBitWidth / 8.0 +
+                         (sizeof(uint64_t) + sizeof(uint32_t)) / static_cast<double>(CRLE_CHECKPOINT_RUNS);
+    if (stats.nonMainFraction <= stats.runFraction)
+    {
+        EstimateByNonMain(stats, fixedBytes, bytesPerRun, estimate);
+    }
+    else
+    {
+        EstimateByRuns(stats, fixedBytes, bytesPerRun, estimate);
+    }
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+int8_t CompactRunLengthEnc<T>::GetResult(CalResult &ret) const
+{
+    ret = _result;
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+void CompactRunLengthEnc<T>::Reset()
+{
+    _inputData1D.arrayData.clear();
+    _compressedData.count = 0;
+    _compressedData.runCount = 0;
+    _compressedData.runBytes.clear();
+    PackedValuesClear(_compressedData.values);
+    _compressedData.checkpointPos.clear();
+    _compressedData.checkpointOffset.clear();
+    _view = CrleView<T>();
+    _result = CalResult();
+}
+
+template <typename T>
+int8_t CompactRunLengthEnc<T>::Serialize(std::vector<uint8_t> &out) const
+{
+    ByteWriter writer(out);
+
+    // 1. 维度、形状与游程数
+    writer.put(static_cast<uint8_t>(_arrayType));
+    writer.put(_compressedData.count);
+    writer.put(_compressedData.rows);
+    writer.put(_compressedData.cols);
+    writer.put(_compressedData.runCount);
+    writer.put(_compressedData.mainValue);
+
+    // 2. 游程字节流与值
+    writer.putArray(_compressedData.runBytes);
+    writer.putPacked(_compressedData.values);
+
+    // 3. 检查点
+    writer.putArray(_compressedData.checkpointPos);
+    writer.putArray(_compressedData.checkpointOffset);
+    return SAA_SUCCESS;
+}
+
+// 零拷贝：数组只保存指向 data 的视图；校验时顺序回放一遍游程流，不拷贝
+template <typename T>
+int8_t CompactRunLengthEnc<T>::Deserialize(const uint8_t *data, size_t size)
+{
+    ByteReader reader(data, size);
+    CrleCompressed<T> header;
+    CrleView<T> view;
+    uint8_t dimension = 0;
+
+    // 1. 维度、形状与游程数
+    reader.get(dimension);
+    reader.get(header.count);
+    reader.get(header.rows);
+    reader.get(header.cols);
+    reader.get(header.runCount);
+    reader.get(header.mainValue);
+
+    // 2. 游程字节流、值与检查点
+    reader.getView(view.runBytes);
+    reader.getPackedView(view.values);
+    reader.getView(view.checkpointPos);
+    reader.getView(view.checkpointOffset);
+
+    uint64_t checkpointCount = (header.runCount + CRLE_CHECKPOINT_RUNS - 1) / CRLE_CHECKPOINT_RUNS;
+    if (!reader.finished() || dimension > ARRAY_2D ||
+        header.count != static_cast<uint64_t>(header.rows) * header.cols ||
+        view.values.count != header.runCount ||
+        view.checkpointPos.size() != checkpointCount || view.checkpointOffset.size() != checkpointCount ||
+        !CrleStreamValid(header, view))
+    {
+        std::cerr << LOG_ERROR << "Serialized CompactRLE is corrupted.\n";
+        return ERROR_PARAM_INVALID;
+    }
+
+    // 3. 只保留标量，数组不拷贝
+    _arrayType = static_cast<ArrayDimension>(dimension);
+    _inputData1D.arrayData.clear();
+    _compressedData = std::move(header);
+    _view = view;
+    _result = CalResult();
+    _result.modeName = "CompactRLE";
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+int8_t CompactRunLengthEnc<T>::GetElement(uint64_t index, void *value) const
+{
+    if (index >= _compressedData.count)
+    {
+        return ERROR_INDEX_OUT_OF_RANGE;
+    }
+    *static_cast<T *>(value) = lookup(index);
+    return SAA_SUCCESS;
+}
+
+#if ALGORITHM_COMPACT_RLE
+static bool compact_rle_registered = []
+{
+    CompressorRegistry::Instance().Register("CompactRLE", [](ElemType type)
+                                            { return MakeTypedCompressor<CompactRunLengthEnc>(type); });
+    return true;
+}();
+#endif
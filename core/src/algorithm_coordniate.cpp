@@ -1,225 +1,548 @@
-/*
- * @Author: FeOAr feoar@outlook.com
- * @Date: 2025-07-02 20:30:05
- * @LastEditors: FeOAr feoar@outlook.com
- * @LastEditTime: 2025-08-16 10:21:00
- * @FilePath: \SparseArrayAnalyzer\core\src\algorithm_coordniate.cpp
- * @Description:
- *
- */
-#include "sparse_array_analyzer.h"
-#include "common.h"
-#include <chrono>
-#include <cmath>
-
-typedef struct coord_info
-{
-    //~ 本例中非主值从行列1开始，(0,0)记录规模和主值
-    uint32_t x_coord;  
-    uint32_t y_coord;
-    uint32_t value;
-}CoordInfo;
-
-class CoordinateList : public SparseArrayCompressor
-{
-public:
-    int8_t Compress(const ArrayInput &input) override;
-    int8_t Decompress(ArrayInput &output) override;
-    int8_t GetResult(CalResult &result) const override;
-
-private:
-    int8_t startCompress();
-    int8_t startDecompress(ArrayData2D &output);
-
-    // Input
-    ArrayDimension _arrayType;
-    ArrayData2D _inputData2D;
-    
-    // Output
-    CalResult _result;
-    std::vector<CoordInfo> _compressedData;
-};
-
-int8_t CoordinateList::Compress(const ArrayInput &input)
-{
-    // 1. 解析数据类型
-    if(std::holds_alternative<ArrayData1D>(input))
-    {
-        std::cerr << LOG_WARN << "Input data is unsupported dimension.\n";
-        return ERROR_UNSUPPORT_DIMENSION;
-    }
-    else if (std::holds_alternative<ArrayData2D>(input))
-    {
-        auto &mat = std::get<ArrayData2D>(input);
-        _inputData2D = mat;
-        _arrayType = ARRAY_2D;
-    }
-    else
-    {
-        std::cerr << LOG_ERROR << "Input data is empty.\n";
-        return ERROR_INPUT_EMPTY;
-    }
-
-    auto start = std::chrono::high_resolution_clock::now();
-    startCompress();
-    auto end = std::chrono::high_resolution_clock::now();
-
-    // 2. 计算压缩结果
-    _result.modeName = "CoordinateList";
-    _result.originElementCount = GetArrayElemCount2D(_inputData2D.arrayData);
-    _result.compressedElementCount = _compressedData.size() * 3; // 每个坐标信息包含3个元素：x_coord, y_coord, value
-
-    _result.originSizeBytes = GetArrayTotalSize2D(_inputData2D.arrayData);
-    _result.compressedSizeBytes = _compressedData.size() * sizeof(CoordInfo);
-
-    _result.compressTimeMs = std::chrono::duration<double, std::milli>(end - start).count();
-    _result.decompressTimeMs = 0;
-
-    _result.compressionRatio = (static_cast<double>(_result.compressedSizeBytes) / _result.originSizeBytes) * 100.0;
-
-    return SAA_SUCCESS;
-}
-
-int8_t CoordinateList::startCompress() 
-{
-#if 1
-    uint32_t row = _inputData2D.rowCount;
-    uint32_t col = _inputData2D.colCount;
-    
-    // 1. 分析数组，统计各个值的出现次数
-    std::unordered_map<uint32_t, uint32_t> valueCount;
-    for (const auto &row : _inputData2D.arrayData)
-    {
-        for (const auto &val : row)
-        {
-            valueCount[val]++;
-        }
-    }
-
-    uint32_t mainValue = 0;  // 主值
-    uint32_t mainValueCount = 0;  // 主值出现次数
-    for (const auto &pair : valueCount)
-    {
-        if (pair.second > mainValueCount)
-        {
-            mainValue = pair.first;
-            mainValueCount = pair.second;
-        }
-    }
-
-    _compressedData.push_back({row, col, mainValue});  // 记录原始信息
-
-    // std::cout << LOG_DEBUG << "Main value: " << mainValue << ", Count: " << mainValueCount << "\n";
-
-    // 2. 根据主值进行坐标法压缩
-    for (uint32_t i = 0; i < row; i++)
-    {
-        for (uint32_t n = 0; n < col; n++)
-        {
-            if(_inputData2D.arrayData[i][n] != mainValue)
-            {
-                CoordInfo coord;
-                coord.x_coord =i + 1;       // 行号从1开始
-                coord.y_coord = n + 1;      // 列号从1开始
-                coord.value = _inputData2D.arrayData[i][n];
-                _compressedData.push_back(coord);
-            }
-        }
-    }
-# if 0
-    std::cout << LOG_DEBUG << "CompressedData: \n";
-    for (const auto &coord : _compressedData)
-    {
-        std::cout << "Coord: (" << coord.x_coord << ", " << coord.y_coord << ") Value: " << coord.value << "\n";
-    }
-#endif
- 
-#endif
-    return SAA_SUCCESS;  // 返回值可以根据实际需要调整
-}
-
-int8_t CoordinateList::Decompress(ArrayInput &output)
-{
-    // 0. 检查
-    if (_inputData2D.arrayData.empty())
-    {
-        std::cerr << LOG_ERROR << "Input data is empty.\n";
-        return ERROR_INPUT_EMPTY;
-    }
-
-    if (_arrayType != ARRAY_2D)
-    {
-        std::cerr << LOG_ERROR << "ArrayInput is not compatible with 2D array.\n";
-        return ERROR_UNSUPPORT_DIMENSION;
-    }
-
-    if (_compressedData.empty())
-    {
-        std::cerr << LOG_ERROR << "Compressed data is empty.\n";
-        return ERROR_INPUT_EMPTY;
-    }
-
-    auto *ptr2d = std::get_if<ArrayData2D>(&output);
-    if (!ptr2d)
-    {
-        std::cerr << LOG_ERROR << "ArrayInput is not compatible with 2D array.\n";
-        return ERROR_PARAM_INVALID;
-    }
-
-    // 1. 解压
-    ArrayData2D tempData;
-    auto start = std::chrono::high_resolution_clock::now();
-    if (startDecompress(tempData) != SAA_SUCCESS)
-    {
-        std::cerr << LOG_ERROR << "Decompressed something error.\n";
-        return ERROR_CALCULATE_ERROR;
-    }
-    auto end = std::chrono::high_resolution_clock::now();
-    *ptr2d = tempData;
-    
-    _result.decompressTimeMs = std::chrono::duration<double, std::milli>(end - start).count();
-
-    // 2. 校验
-    if(!Compare2D(_inputData2D.arrayData, tempData.arrayData))
-    {
-        std::cerr << LOG_ERROR << "Decompressed result error.\n";
-        return ERROR_CALCULATE_ERROR;
-    }
-    return SAA_SUCCESS;
-}
-
-int8_t CoordinateList::startDecompress(ArrayData2D &outData2D)
-{
-    // 1. 填充主值
-    _compressedData[0].x_coord = std::max(_compressedData[0].x_coord, 1u);
-    _compressedData[0].y_coord = std::max(_compressedData[0].y_coord, 1u);
-    outData2D.arrayData.resize(_compressedData[0].x_coord, std::vector<uint32_t>(_compressedData[0].y_coord, _compressedData[0].value));
-
-    outData2D.rowCount = _compressedData[0].x_coord;
-    outData2D.colCount = _compressedData[0].y_coord;
-
-    // 2. 填充非主值
-    for(auto valIt = _compressedData.begin(); valIt !=  _compressedData.end(); valIt++)
-    {
-        outData2D.arrayData[valIt->x_coord - 1][valIt->y_coord - 1] = valIt->value;
-    }
-
-    // PrintVector2D(outData2D.arrayData, outData2D.rowCount, outData2D.colCount);
-    return SAA_SUCCESS;
-}
-
-
-int8_t CoordinateList::GetResult(CalResult &ret) const
-{
-    ret = _result;
-    return SAA_SUCCESS;
-}
-
-#if ALGORITHM_COORDINATE
-static bool coord_registered = []
-{
-    CompressorRegistry::Instance().Register("CoordinateList", []
-                                            { return std::make_unique<CoordinateList>(); });
-    return true;
-}();
-#endif
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2025-07-02 20:30:05
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2025-08-16 10:21:00
+ * @FilePath: \SparseArrayAnalyzer\core\src\algorithm_coordniate.cpp
+ * @Description:
+ *
+ */
+#include "sparse_array_analyzer.h"
+#include "alloc_tracker.h"
+#include "perf_counters.h"
+#include "trace_events.h"
+#include "common.h"
+#include "size_estimator.h"
+#include "index_storage.hpp"
+#include "bit_packing.hpp"
+#include "index_codec.hpp"
+#include "serialization.hpp"
+#include <chrono>
+#include <cmath>
+
+template <typename T>
+struct CoordInfo
+{
+    //~ 本例中非主值从行列1开始，第 0 项记录规模和主值
+    IndexStorage x_coord; // 宽度按行数自动选择（8/16/32 位）
+    IndexStorage y_coord; // 宽度按列数自动选择（8/16/32 位）
+    std::vector<T> value;
+    PackedValues<T> packedValue; // 参考帧位打包后的非主值 value[1..]（可选，此时 value 只保留第 0 项）
+    EliasFano packedX;           // 压缩索引时的行坐标 x_coord[1..]（可选，此时坐标只保留第 0 项）
+    GroupVarint packedY;         // 压缩索引时的同行列坐标差分 y_coord[1..]（可选）
+};
+
+template <typename T>
+class CoordinateList : public SparseArrayCompressor
+{
+public:
+    explicit CoordinateList(bool packValues = false, bool compressIndex = false)
+        : _packValues(packValues), _compressIndex(compressIndex) {}
+
+    int8_t Compress(const ArrayInput &input) override;
+    int8_t Decompress(ArrayInput &output) override;
+    int8_t GetResult(CalResult &result) const override;
+    void Reset() override;
+    int8_t Serialize(std::vector<uint8_t> &out) const override;
+    int8_t Deserialize(const uint8_t *data, size_t size) override;
+    int8_t EstimateSize(const SampleStats &stats, SizeEstimate &estimate) const override;
+
+private:
+    int8_t startCompress();
+    int8_t startDecompress(ArrayData2D<T> &output);
+
+    void compressIndex();
+    uint64_t coordCount() const;
+    std::string modeName() const;
+
+    bool _packValues;    // 负载是否做参考帧位打包
+    bool _compressIndex; // 坐标是否做 Elias-Fano / 差分 + Group Varint 压缩
+
+    // Input
+    ArrayDimension _arrayType;
+    ArrayData2D<T> _inputData2D;
+    
+    // Output
+    CalResult _result;
+    CoordInfo<T> _compressedData;
+};
+
+template <typename T>
+int8_t CoordinateList<T>::Compress(const ArrayInput &input)
+{
+    // 0. 清空上一次的结果，保留容量
+    Reset();
+
+    // 1. 解析数据类型
+    if(std::holds_alternative<ArrayData1D<T>>(input))
+    {
+        std::cerr << LOG_WARN << "Input data is unsupported dimension.\n";
+        return ERROR_UNSUPPORT_DIMENSION;
+    }
+    else if (std::holds_alternative<ArrayData2D<T>>(input))
+    {
+        auto &mat = std::get<ArrayData2D<T>>(input);
+        _inputData2D = mat;
+        _arrayType = ARRAY_2D;
+    }
+    else
+    {
+        std::cerr << LOG_ERROR << "Input element type is not " << ElemTraits<T>::name << ".\n";
+        return ERROR_PARAM_INVALID;
+    }
+
+    TraceSpan compressTrace("compress");
+    AllocPhase compressAlloc(_result.compressAlloc);
+    PerfPhase compressPhase(_result.compressPerf);
+    auto start = std::chrono::high_resolution_clock::now();
+    startCompress();
+    auto end = std::chrono::high_resolution_clock::now();
+    compressPhase.stop();
+    compressAlloc.stop();
+    compressTrace.stop();
+
+    // 2. 计算压缩结果
+    _result.modeName = modeName();
+    _result.originElementCount = GetArrayElemCount2D(_inputData2D.arrayData);
+    _result.compressedElementCount = coordCount() * 3; // 每个坐标信息包含3个元素：x_coord, y_coord, value
+
+    _result.originSizeBytes = GetArrayTotalSize2D(_inputData2D.arrayData);
+    _result.compressedSizeBytes = IndexStorageBytes(_compressedData.x_coord) +
+                                  IndexStorageBytes(_compressedData.y_coord) +
+                                  GetArrayTotalSize1D(_compressedData.value) +
+                                  (_packValues ? PackedValuesBytes(_compressedData.packedValue) : 0) +
+                                  (_compressIndex ? EliasFanoBytes(_compressedData.packedX) + GroupVarintBytes(_compressedData.packedY) : 0);
+
+    _result.compressTimeMs = std::chrono::duration<double, std::milli>(end - start).count();
+    _result.decompressTimeMs = 0;
+
+    _result.compressionRatio = (static_cast<double>(_result.compressedSizeBytes) / _result.originSizeBytes) * 100.0;
+
+    // 顺序：主值填充 + 逐条写入坐标；随机：坐标按行主序有序，可二分查找
+    double coords = static_cast<double>(coordCount());
+    _result.seqAccessOps = 1.0 + 3.0 * coords / std::max<uint64_t>(_result.originElementCount, 1);
+    _result.randomAccessOps = 1.0 + std::log2(coords + 1.0);
+
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+int8_t CoordinateList<T>::startCompress() 
+{
+#if 1
+    uint32_t row = _inputData2D.rowCount;
+    uint32_t col = _inputData2D.colCount;
+    
+    // 1. 分析数组，统计各个值的出现次数
+    std::pmr::unordered_map<uint64_t, uint64_t> valueCount(_workResource);
+    for (const auto &row : _inputData2D.arrayData)
+    {
+        for (const auto &val : row)
+        {
+            valueCount[ToOrderedKey(val)]++;
+        }
+    }
+
+    T mainValue = 0;  // 主值
+    uint64_t mainValueCount = 0;  // 主值出现次数
+    for (const auto &pair : valueCount)
+    {
+        if (pair.second > mainValueCount)
+        {
+            mainValue = FromOrderedKey<T>(pair.first);
+            mainValueCount = pair.second;
+        }
+    }
+
+    // std::cout << LOG_DEBUG << "Main value: " << mainValue << ", Count: " << mainValueCount << "\n";
+
+    // 2. 根据主值进行坐标法压缩，坐标从 1 开始，行/列坐标的最大取值即行数/列数
+    uint64_t nonMainCount = GetArrayElemCount2D(_inputData2D.arrayData) - mainValueCount;
+    ResetIndexStorage(_compressedData.x_coord, row);
+    ResetIndexStorage(_compressedData.y_coord, col);
+    std::visit([&](auto &xCoord, auto &yCoord)
+               {
+                   using XIndexT = typename std::decay_t<decltype(xCoord)>::value_type;
+                   using YIndexT = typename std::decay_t<decltype(yCoord)>::value_type;
+
+                   xCoord.reserve(nonMainCount + 1); // 首项记录原始信息，其余为非主值，按实际容量分配
+                   yCoord.reserve(nonMainCount + 1);
+                   _compressedData.value.reserve(nonMainCount + 1);
+                   xCoord.push_back(static_cast<XIndexT>(row)); // 记录原始信息
+                   yCoord.push_back(static_cast<YIndexT>(col));
+                   _compressedData.value.push_back(mainValue);
+
+                   for (uint32_t i = 0; i < row; i++)
+                   {
+                       for (uint32_t n = 0; n < col; n++)
+                       {
+                           if (!SameBits(_inputData2D.arrayData[i][n], mainValue))
+                           {
+                               xCoord.push_back(static_cast<XIndexT>(i + 1)); // 行号从1开始
+                               yCoord.push_back(static_cast<YIndexT>(n + 1)); // 列号从1开始
+                               _compressedData.value.push_back(_inputData2D.arrayData[i][n]);
+                           }
+                       }
+                   } },
+               _compressedData.x_coord, _compressedData.y_coord);
+
+    // 3. 非主值位打包（可选），第 0 项主值保持原样
+    if (_packValues)
+    {
+        std::pmr::vector<T> nonMain(_compressedData.value.begin() + 1, _compressedData.value.end(), _workResource);
+        PackValues(nonMain, _compressedData.packedValue);
+        _compressedData.value.resize(1); // 保留容量供复用，大小只按 value.size() 计算
+    }
+
+    // 4. 坐标压缩（可选），第 0 项规模信息保持原样
+    if (_compressIndex)
+    {
+        compressIndex();
+    }
+# if 0
+    std::cout << LOG_DEBUG << "CompressedData: \n";
+    std::visit([](const auto &x) { PrintVector1D(x, "x_coord"); }, _compressedData.x_coord);
+    std::visit([](const auto &y) { PrintVector1D(y, "y_coord"); }, _compressedData.y_coord);
+    PrintVector1D(_compressedData.value, "value");
+#endif
+ 
+#endif
+    return SAA_SUCCESS;  // 返回值可以根据实际需要调整
+}
+
+template <typename T>
+int8_t CoordinateList<T>::Decompress(ArrayInput &output)
+{
+    // 0. 检查
+    if (_arrayType != ARRAY_2D)
+    {
+        std::cerr << LOG_ERROR << "ArrayInput is not compatible with 2D array.\n";
+        return ERROR_UNSUPPORT_DIMENSION;
+    }
+
+    if (_compressedData.value.empty())
+    {
+        std::cerr << LOG_ERROR << "Compressed data is empty.\n";
+        return ERROR_INPUT_EMPTY;
+    }
+
+    auto *ptr2d = std::get_if<ArrayData2D<T>>(&output);
+    if (!ptr2d)
+    {
+        std::cerr << LOG_ERROR << "ArrayInput is not compatible with 2D array.\n";
+        return ERROR_PARAM_INVALID;
+    }
+
+    // 1. 解压，直接写入调用方的输出以复用其容量
+    TraceSpan decompressTrace("decompress");
+    AllocPhase decompressAlloc(_result.decompressAlloc);
+    PerfPhase decompressPhase(_result.decompressPerf);
+    auto start = std::chrono::high_resolution_clock::now();
+    if (startDecompress(*ptr2d) != SAA_SUCCESS)
+    {
+        std::cerr << LOG_ERROR << "Decompressed something error.\n";
+        return ERROR_CALCULATE_ERROR;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    decompressPhase.stop();
+    decompressAlloc.stop();
+    decompressTrace.stop();
+    
+    _result.decompressTimeMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+    // 2. 校验，反序列化得到的对象没有原始输入，跳过
+    if (!_inputData2D.arrayData.empty() && !Compare2D(_inputData2D.arrayData, ptr2d->arrayData))
+    {
+        std::cerr << LOG_ERROR << "Decompressed result error.\n";
+        return ERROR_CALCULATE_ERROR;
+    }
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+int8_t CoordinateList<T>::startDecompress(ArrayData2D<T> &outData2D)
+{
+    // 0. 非主值先整体解包，重新拼回第 0 项主值之后
+    std::pmr::vector<T> unpacked(_workResource);
+    if (_packValues)
+    {
+        UnpackValues(_compressedData.packedValue, unpacked);
+        unpacked.insert(unpacked.begin(), _compressedData.value[0]);
+    }
+    const T *value = _packValues ? unpacked.data() : _compressedData.value.data();
+    size_t valueCount = _packValues ? unpacked.size() : _compressedData.value.size();
+
+    // 压缩坐标：批量解码行坐标与列差分，换行时列差分重新累加
+    if (_compressIndex)
+    {
+        std::pmr::vector<uint64_t> xCoord(_workResource);
+        std::pmr::vector<uint32_t> gaps(_workResource);
+        DecodeEliasFano(_compressedData.packedX, xCoord);
+        DecodeGroupVarint(_compressedData.packedY, gaps);
+
+        uint32_t rows = std::max<uint32_t>(std::visit([](const auto &x) { return static_cast<uint32_t>(x[0]); }, _compressedData.x_coord), 1u);
+        uint32_t cols = std::max<uint32_t>(std::visit([](const auto &y) { return static_cast<uint32_t>(y[0]); }, _compressedData.y_coord), 1u);
+        FillArray2D(outData2D.arrayData, rows, cols, value[0]);
+        outData2D.rowCount = rows;
+        outData2D.colCount = cols;
+
+        uint64_t prevX = 0;
+        uint32_t nextY = 0;
+        for (size_t idx = 0; idx < xCoord.size(); ++idx)
+        {
+            if (xCoord[idx] != prevX)
+            {
+                prevX = xCoord[idx];
+                nextY = 0;
+            }
+            uint32_t y = nextY + gaps[idx];
+            outData2D.arrayData[prevX - 1][y] = value[idx + 1];
+            nextY = y + 1;
+        }
+        return SAA_SUCCESS;
+    }
+
+    // 按坐标宽度特化解压
+    std::visit([&](const auto &xCoord, const auto &yCoord)
+               {
+                   // 1. 填充主值
+                   uint32_t rows = std::max<uint32_t>(static_cast<uint32_t>(xCoord[0]), 1u);
+                   uint32_t cols = std::max<uint32_t>(static_cast<uint32_t>(yCoord[0]), 1u);
+                   FillArray2D(outData2D.arrayData, rows, cols, value[0]);
+
+                   outData2D.rowCount = rows;
+                   outData2D.colCount = cols;
+
+                   // 2. 填充非主值
+                   for (size_t idx = 1; idx < valueCount; ++idx)
+                   {
+                       outData2D.arrayData[xCoord[idx] - 1][yCoord[idx] - 1] = value[idx];
+                   } },
+               _compressedData.x_coord, _compressedData.y_coord);
+
+    // PrintVector2D(outData2D.arrayData, outData2D.rowCount, outData2D.colCount);
+    return SAA_SUCCESS;
+}
+
+
+template <typename T>
+int8_t CoordinateList<T>::EstimateSize(const SampleStats &stats, SizeEstimate &estimate) const
+{
+    if (!stats.is2D)
+    {
+        return ERROR_UNSUPPORT_DIMENSION;
+    }
+
+    // 固定开销 + 每个非主值的存储开销
+    estimate.modeName = modeName();
+    double headBytes = SelectIndexWidth(stats.rows) + SelectIndexWidth(stats.cols) + stats.elemBytes; // 第 0 项
+    double indexBytes = SelectIndexWidth(stats.rows) + SelectIndexWidth(stats.cols);
+    double fixedBytes = _compressIndex ? headBytes : 0.0;
+    if (_compressIndex)
+    {
+        // 行坐标 Elias-Fano 每项约 2 + log2(行数 / 非主值数) 位；列差分按平均间隔的字节数 + 1/4 控制字节
+        double nnz = std::max(stats.nonMainFraction * stats.elemCount, 1.0);
+        double meanGap = 1.0 / std::max(stats.nonMainFraction, 1e-9);
+        fixedBytes += 3 * sizeof(uint64_t) + 1;
+        indexBytes = (2.0 + std::log2(std::max(stats.rows / nnz, 1.0))) / 8.0 +
+                     VarintByteCount(static_cast<uint32_t>(std::min(meanGap, 4e9))) + 0.25;
+    }
+    else
+    {
+        fixedBytes = indexBytes + stats.elemBytes;
+    }
+
+    double valueBytes = stats.elemBytes;
+    if (_packValues)
+    {
+        fixedBytes += sizeof(uint64_t) + 1; // 参考帧 + 位宽
+        valueBytes = stats.packedBitWidth / 8.0;
+    }
+    EstimateByNonMain(stats, fixedBytes, indexBytes + valueBytes, estimate);
+    return SAA_SUCCESS;
+}
+
+// 行坐标单调不减，改用 Elias-Fano；同一行内列坐标严格递增，记录相邻差值 - 1（行首为列号本身，从 0 开始）
+template <typename T>
+void CoordinateList<T>::compressIndex()
+{
+    std::pmr::vector<uint64_t> xs(_workResource);
+    std::pmr::vector<uint32_t> gaps(_workResource);
+    std::visit([&](auto &xCoord, auto &yCoord)
+               {
+                   xs.assign(xCoord.begin() + 1, xCoord.end());
+                   gaps.reserve(yCoord.size() - 1);
+                   uint32_t nextY = 0;
+                   for (size_t idx = 1; idx < xCoord.size(); ++idx)
+                   {
+                       if (idx == 1 || xCoord[idx] != xCoord[idx - 1])
+                           nextY = 0;
+                       uint32_t y = static_cast<uint32_t>(yCoord[idx]) - 1;
+                       gaps.push_back(y - nextY);
+                       nextY = y + 1;
+                   }
+                   xCoord.resize(1);
+                   yCoord.resize(1); },
+               _compressedData.x_coord, _compressedData.y_coord);
+
+    EncodeEliasFano(xs, _compressedData.packedX);
+    EncodeGroupVarint(gaps, _compressedData.packedY);
+}
+
+template <typename T>
+uint64_t CoordinateList<T>::coordCount() const
+{
+    return _compressIndex ? _compressedData.packedX.count + 1 : IndexStorageCount(_compressedData.x_coord);
+}
+
+template <typename T>
+std::string CoordinateList<T>::modeName() const
+{
+    std::string name = "CoordinateList";
+    if (_packValues)
+        name += "-FOR";
+    if (_compressIndex)
+        name += "-CI";
+    return name;
+}
+
+template <typename T>
+int8_t CoordinateList<T>::GetResult(CalResult &ret) const
+{
+    ret = _result;
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+void CoordinateList<T>::Reset()
+{
+    ClearRows2D(_inputData2D.arrayData);
+    _inputData2D.rowCount = 0;
+    _inputData2D.colCount = 0;
+    IndexStorageClear(_compressedData.x_coord);
+    IndexStorageClear(_compressedData.y_coord);
+    _compressedData.value.clear();
+    PackedValuesClear(_compressedData.packedValue);
+    EliasFanoClear(_compressedData.packedX);
+    GroupVarintClear(_compressedData.packedY);
+    _result = CalResult();
+}
+
+template <typename T>
+int8_t CoordinateList<T>::Serialize(std::vector<uint8_t> &out) const
+{
+    ByteWriter writer(out);
+
+    // 1. 模式（规模与主值在各数组第 0 项）
+    writer.put(static_cast<uint8_t>(_packValues));
+    writer.put(static_cast<uint8_t>(_compressIndex));
+
+    // 2. 坐标与值
+    writer.putIndex(_compressedData.x_coord);
+    writer.putIndex(_compressedData.y_coord);
+    writer.putArray(_compressedData.value);
+    if (_packValues)
+        writer.putPacked(_compressedData.packedValue);
+    if (_compressIndex)
+    {
+        writer.putEliasFano(_compressedData.packedX);
+        writer.putGroupVarint(_compressedData.packedY);
+    }
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+int8_t CoordinateList<T>::Deserialize(const uint8_t *data, size_t size)
+{
+    ByteReader reader(data, size);
+    CoordInfo<T> compressed;
+    uint8_t packValues = 0;
+    uint8_t compressIndex = 0;
+
+    // 1. 模式
+    reader.get(packValues);
+    reader.get(compressIndex);
+
+    // 2. 坐标与值
+    reader.getIndex(compressed.x_coord);
+    reader.getIndex(compressed.y_coord);
+    reader.getArray(compressed.value);
+    if (packValues)
+        reader.getPacked(compressed.packedValue);
+    if (compressIndex)
+    {
+        reader.getEliasFano(compressed.packedX);
+        reader.getGroupVarint(compressed.packedY);
+    }
+
+    // 第 0 项（规模与主值）总是存在；压缩坐标时其余项只在 packedX / packedY 中
+    uint64_t valueCount = packValues ? compressed.packedValue.count + 1 : compressed.value.size();
+    uint64_t coordCount = compressIndex ? compressed.packedX.count + 1 : IndexStorageCount(compressed.x_coord);
+    bool valid = reader.finished() && !compressed.value.empty() && !IndexStorageEmpty(compressed.x_coord) &&
+                 !IndexStorageEmpty(compressed.y_coord) && coordCount == valueCount &&
+                 (compressIndex ? compressed.packedY.count == compressed.packedX.count &&
+                                      IndexStorageCount(compressed.x_coord) == 1 && IndexStorageCount(compressed.y_coord) == 1
+                                : IndexStorageCount(compressed.y_coord) == coordCount);
+
+    // 3. 坐标落在第 0 项记录的规模内；压缩坐标时行坐标单调不减，同行列差分累加后仍小于列数
+    if (valid)
+    {
+        uint64_t rows = std::visit([](const auto &x) { return static_cast<uint64_t>(x[0]); }, compressed.x_coord);
+        uint64_t cols = std::visit([](const auto &y) { return static_cast<uint64_t>(y[0]); }, compressed.y_coord);
+        valid = rows <= UINT32_MAX && cols <= UINT32_MAX;
+        rows = std::max<uint64_t>(rows, 1);
+        cols = std::max<uint64_t>(cols, 1);
+        if (valid && compressIndex)
+        {
+            std::vector<uint64_t> xCoord;
+            std::vector<uint32_t> gaps;
+            DecodeEliasFano(compressed.packedX, xCoord);
+            DecodeGroupVarint(compressed.packedY, gaps);
+            uint64_t prevX = 0;
+            uint64_t nextY = 0;
+            for (size_t idx = 0; valid && idx < xCoord.size(); ++idx)
+            {
+                if (xCoord[idx] != prevX)
+                {
+                    valid = xCoord[idx] > prevX && xCoord[idx] <= rows;
+                    prevX = xCoord[idx];
+                    nextY = 0;
+                }
+                nextY += gaps[idx];
+                valid = valid && nextY < cols;
+                ++nextY;
+            }
+        }
+        else if (valid)
+        {
+            valid = IndicesInRange(compressed.x_coord, 1, rows, 1) && IndicesInRange(compressed.y_coord, 1, cols, 1);
+        }
+    }
+    if (!valid)
+    {
+        std::cerr << LOG_ERROR << "Serialized CoordinateList is corrupted.\n";
+        return ERROR_PARAM_INVALID;
+    }
+
+    _packValues = packValues;
+    _compressIndex = compressIndex;
+    _arrayType = ARRAY_2D;
+    _inputData2D = ArrayData2D<T>();
+    _compressedData = std::move(compressed);
+    _result = CalResult();
+    _result.modeName = modeName();
+    return SAA_SUCCESS;
+}
+
+#if ALGORITHM_COORDINATE
+static bool coord_registered = []
+{
+    CompressorRegistry::Instance().Register("CoordinateList", [](ElemType type)
+                                            { return MakeTypedCompressor<CoordinateList>(type); });
+    CompressorRegistry::Instance().Register("CoordinateList-FOR", [](ElemType type)
+                                            { return MakeTypedCompressor<CoordinateList>(type, true); });
+    CompressorRegistry::Instance().Register("CoordinateList-CI", [](ElemType type)
+                                            { return MakeTypedCompressor<CoordinateList>(type, false, true); });
+    return true;
+}();
+#endif
@@ -1,111 +1,259 @@
-/*
- * @Author: FeOAr feoar@outlook.com
- * @Date: 2025-06-30 21:28:22
- * @LastEditors: FeOAr feoar@outlook.com
- * @LastEditTime: 2025-07-19 23:36:52
- * @FilePath: \SparseArrayAnalyzer\core\src\algorithm_dense.cpp
- * @Description:
- *
- */
-#include "sparse_array_analyzer.h"
-#include "common.h"
-#include <chrono>
-
-class DenseStorage : public SparseArrayCompressor
-{
-public:
-    int8_t Compress(const ArrayInput &input) override;
-
-    int8_t Decompress(ArrayInput &output) override;
-
-    int8_t GetResult(CalResult &ret) const override;
-
-private:
-    ArrayDimension _arrayType;
-    ArrayData1D _inputData1D;
-    ArrayData2D _inputData2D;
-    CalResult _result;
-};
-
-int8_t DenseStorage::Compress(const ArrayInput &input)
-{
-    // 1. 解析数据类型
-    if (std::holds_alternative<ArrayData1D>(input))
-    {
-        auto &vec = std::get<ArrayData1D>(input);
-        _inputData1D = vec;
-        _arrayType = ARRAY_1D;
-    }
-    else if (std::holds_alternative<ArrayData2D>(input))
-    {
-        auto &mat = std::get<ArrayData2D>(input);
-        _inputData2D = mat;
-        _arrayType = ARRAY_2D;
-    }
-    else
-    {
-        std::cerr << LOG_ERROR <<"Input data is empty.\n";
-        return ERROR_INPUT_EMPTY;
-    }
-
-    // 2. 计算压缩结果
-    _result.modeName = "DenseStorage(origin)";
-    _result.originElementCount = (_arrayType == ARRAY_1D)
-                                     ? GetArrayElemCount1D(_inputData1D.arrayData)
-                                     : GetArrayElemCount2D(_inputData2D.arrayData);
-    _result.compressedElementCount = _result.originElementCount;
-    _result.originSizeBytes = (_arrayType == ARRAY_1D)
-                                  ? GetArrayTotalSize1D(_inputData1D.arrayData)
-                                  : GetArrayTotalSize2D(_inputData2D.arrayData);
-    _result.compressedSizeBytes = _result.originSizeBytes;
-    _result.compressTimeMs = 0;
-    _result.decompressTimeMs = 0;
-    _result.compressionRatio = 100.0; // 无压缩
-
-    return SAA_SUCCESS;
-}
-
-int8_t DenseStorage::Decompress(ArrayInput &output)
-{
-    if (_arrayType == ARRAY_1D)
-    {
-        if (auto *ptr1d = std::get_if<ArrayData1D>(&output))
-        {
-            ptr1d->arrayData = _inputData1D.arrayData;
-        }
-        else
-        {
-            std::cerr << LOG_ERROR << "ArrayInput is not compatible with 1D array.\n";
-            return ERROR_PARAM_INVALID;
-        }
-    }
-    else if (_arrayType == ARRAY_2D)
-    {
-        if (auto *ptr2d = std::get_if<ArrayData2D>(&output))
-        {
-            ptr2d->arrayData = _inputData2D.arrayData;
-        }
-        else
-        {
-            std::cerr << LOG_ERROR << "ArrayInput is not compatible with 2D array.\n";
-            return ERROR_PARAM_INVALID;
-        }
-    }
-
-    return SAA_SUCCESS;
-}
-
-int8_t DenseStorage::GetResult(CalResult &ret) const
-{
-    ret = _result;
-    return SAA_SUCCESS;
-}
-
-#if ALGORITHM_DENSE
-static bool dense_registered = []
-{
-    CompressorRegistry::Instance().Register("DenseArray", []
-                                            { return std::make_unique<DenseStorage>(); });
-    return true;
-}();
-#endif
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2025-06-30 21:28:22
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2025-07-19 23:36:52
+ * @FilePath: \SparseArrayAnalyzer\core\src\algorithm_dense.cpp
+ * @Description:
+ *
+ */
+#include "sparse_array_analyzer.h"
+#include "common.h"
+#include "size_estimator.h"
+#include "serialization.hpp"
+#include <chrono>
+
+template <typename T>
+class DenseStorage : public SparseArrayCompressor
+{
+public:
+    int8_t Compress(const ArrayInput &input) override;
+
+    int8_t Decompress(ArrayInput &output) override;
+
+    int8_t GetResult(CalResult &ret) const override;
+    void Reset() override;
+    int8_t Serialize(std::vector<uint8_t> &out) const override;
+    int8_t Deserialize(const uint8_t *data, size_t size) override;
+    int8_t GetElement(uint64_t index, void *value) const override;
+    int8_t EstimateSize(const SampleStats &stats, SizeEstimate &estimate) const override;
+
+private:
+    ArrayDimension _arrayType;
+    ArrayData1D<T> _inputData1D;
+    ArrayData2D<T> _inputData2D;
+    CalResult _result;
+
+    // 反序列化后直接引用映射数据（零拷贝），行优先
+    ArrayView<T> _mapped;
+    uint32_t _mappedRows = 0;
+    uint32_t _mappedCols = 0;
+};
+
+template <typename T>
+int8_t DenseStorage<T>::Compress(const ArrayInput &input)
+{
+    // 0. 清空上一次的结果，保留容量
+    Reset();
+
+    // 1. 解析数据类型
+    if (std::holds_alternative<ArrayData1D<T>>(input))
+    {
+        auto &vec = std::get<ArrayData1D<T>>(input);
+        _inputData1D = vec;
+        _arrayType = ARRAY_1D;
+    }
+    else if (std::holds_alternative<ArrayData2D<T>>(input))
+    {
+        auto &mat = std::get<ArrayData2D<T>>(input);
+        _inputData2D = mat;
+        _arrayType = ARRAY_2D;
+    }
+    else
+    {
+        std::cerr << LOG_ERROR << "Input element type is not " << ElemTraits<T>::name << ".\n";
+        return ERROR_PARAM_INVALID;
+    }
+
+    // 2. 计算压缩结果
+    _result.modeName = "DenseStorage(origin)";
+    _result.originElementCount = (_arrayType == ARRAY_1D)
+                                     ? GetArrayElemCount1D(_inputData1D.arrayData)
+                                     : GetArrayElemCount2D(_inputData2D.arrayData);
+    _result.compressedElementCount = _result.originElementCount;
+    _result.originSizeBytes = (_arrayType == ARRAY_1D)
+                                  ? GetArrayTotalSize1D(_inputData1D.arrayData)
+                                  : GetArrayTotalSize2D(_inputData2D.arrayData);
+    _result.compressedSizeBytes = _result.originSizeBytes;
+    _result.compressTimeMs = 0;
+    _result.decompressTimeMs = 0;
+    _result.compressionRatio = 100.0; // 无压缩
+
+    _result.seqAccessOps = 1.0;
+    _result.randomAccessOps = 1.0;
+
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+int8_t DenseStorage<T>::Decompress(ArrayInput &output)
+{
+    // 0. 反序列化得到的对象直接从映射数据展开
+    if (_mapped.data)
+    {
+        if (auto *ptr1d = std::get_if<ArrayData1D<T>>(&output); ptr1d && _arrayType == ARRAY_1D)
+        {
+            ptr1d->arrayData.assign(_mapped.begin(), _mapped.end());
+            return SAA_SUCCESS;
+        }
+        if (auto *ptr2d = std::get_if<ArrayData2D<T>>(&output); ptr2d && _arrayType == ARRAY_2D)
+        {
+            ptr2d->rowCount = _mappedRows;
+            ptr2d->colCount = _mappedCols;
+            ptr2d->arrayData.resize(_mappedRows);
+            for (uint32_t r = 0; r < _mappedRows; ++r)
+            {
+                const T *row = _mapped.data + static_cast<size_t>(r) * _mappedCols;
+                ptr2d->arrayData[r].assign(row, row + _mappedCols);
+            }
+            return SAA_SUCCESS;
+        }
+        std::cerr << LOG_ERROR << "ArrayInput is not compatible with the serialized array.\n";
+        return ERROR_PARAM_INVALID;
+    }
+
+    if (_arrayType == ARRAY_1D)
+    {
+        if (auto *ptr1d = std::get_if<ArrayData1D<T>>(&output))
+        {
+            ptr1d->arrayData = _inputData1D.arrayData;
+        }
+        else
+        {
+            std::cerr << LOG_ERROR << "ArrayInput is not compatible with 1D array.\n";
+            return ERROR_PARAM_INVALID;
+        }
+    }
+    else if (_arrayType == ARRAY_2D)
+    {
+        if (auto *ptr2d = std::get_if<ArrayData2D<T>>(&output))
+        {
+            ptr2d->arrayData = _inputData2D.arrayData;
+        }
+        else
+        {
+            std::cerr << LOG_ERROR << "ArrayInput is not compatible with 2D array.\n";
+            return ERROR_PARAM_INVALID;
+        }
+    }
+
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+int8_t DenseStorage<T>::GetResult(CalResult &ret) const
+{
+    ret = _result;
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+void DenseStorage<T>::Reset()
+{
+    _inputData1D.arrayData.clear();
+    ClearRows2D(_inputData2D.arrayData);
+    _mapped = ArrayView<T>();
+    _mappedRows = 0;
+    _mappedCols = 0;
+    _result = CalResult();
+}
+
+template <typename T>
+int8_t DenseStorage<T>::Serialize(std::vector<uint8_t> &out) const
+{
+    ByteWriter writer(out);
+
+    // 1. 维度与形状
+    uint32_t rows = 1;
+    uint32_t cols = static_cast<uint32_t>(_inputData1D.arrayData.size());
+    if (_arrayType == ARRAY_2D)
+    {
+        rows = _inputData2D.rowCount;
+        cols = _inputData2D.colCount;
+    }
+    writer.put(static_cast<uint8_t>(_arrayType));
+    writer.put(rows);
+    writer.put(cols);
+
+    // 2. 原始数据，二维按行展平
+    if (_arrayType == ARRAY_1D)
+    {
+        writer.putArray(_inputData1D.arrayData);
+        return SAA_SUCCESS;
+    }
+
+    std::vector<T> flat;
+    flat.reserve(static_cast<size_t>(rows) * cols);
+    for (const auto &row : _inputData2D.arrayData)
+        flat.insert(flat.end(), row.begin(), row.end());
+    writer.putArray(flat);
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+int8_t DenseStorage<T>::Deserialize(const uint8_t *data, size_t size)
+{
+    ByteReader reader(data, size);
+    uint8_t dimension = 0;
+    reader.get(dimension);
+    reader.get(_mappedRows);
+    reader.get(_mappedCols);
+    reader.getView(_mapped);
+    if (!reader.finished() || dimension > ARRAY_2D ||
+        _mapped.count != static_cast<uint64_t>(_mappedRows) * _mappedCols)
+    {
+        std::cerr << LOG_ERROR << "Serialized DenseStorage is corrupted.\n";
+        _mapped = ArrayView<T>();
+        return ERROR_PARAM_INVALID;
+    }
+
+    _arrayType = static_cast<ArrayDimension>(dimension);
+    _inputData1D.arrayData.clear();
+    _inputData2D = ArrayData2D<T>();
+    _result = CalResult();
+    _result.modeName = "DenseStorage(origin)";
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+int8_t DenseStorage<T>::GetElement(uint64_t index, void *value) const
+{
+    T *out = static_cast<T *>(value);
+    if (_mapped.data)
+    {
+        if (index >= _mapped.count)
+            return ERROR_INDEX_OUT_OF_RANGE;
+        *out = _mapped[index];
+        return SAA_SUCCESS;
+    }
+
+    if (_arrayType == ARRAY_1D)
+    {
+        if (index >= _inputData1D.arrayData.size())
+            return ERROR_INDEX_OUT_OF_RANGE;
+        *out = _inputData1D.arrayData[index];
+        return SAA_SUCCESS;
+    }
+
+    if (_inputData2D.colCount == 0 || index / _inputData2D.colCount >= _inputData2D.rowCount)
+        return ERROR_INDEX_OUT_OF_RANGE;
+    *out = _inputData2D.arrayData[index / _inputData2D.colCount][index % _inputData2D.colCount];
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+int8_t DenseStorage<T>::EstimateSize(const SampleStats &stats, SizeEstimate &estimate) const
+{
+    estimate.modeName = "DenseStorage(origin)";
+    EstimateByNonMain(stats, static_cast<double>(stats.elemCount) * stats.elemBytes, 0.0, estimate);
+    return SAA_SUCCESS;
+}
+
+#if ALGORITHM_DENSE
+static bool dense_registered = []
+{
+    CompressorRegistry::Instance().Register("DenseArray", [](ElemType type)
+                                            { return MakeTypedCompressor<DenseStorage>(type); });
+    return true;
+}();
+#endif
@@ -1,334 +1,660 @@
-/*
- * @Author: FeOAr feoar@outlook.com
- * @Date: 2025-07-18 09:56:29
- * @LastEditors: FeOAr feoar@outlook.com
- * @LastEditTime: 2025-08-16 10:17:34
- * @FilePath: \SparseArrayAnalyzer\core\src\algorithm_dictionary.cpp
- * @Description:
- *
- */
-
-#include "sparse_array_analyzer.h"
-#include "common.h"
-#include <chrono>
-#include <cmath>
-#include "tool.hpp"
-
-typedef struct compress_dict
-{
-    std::vector<uint32_t> valueDict;
-    std::vector<uint8_t> indexBitTable;
-    uint8_t bitWidth; // index 位宽
-    uint32_t originCount;
-    uint32_t originArrayRow;
-    uint32_t originArrayCol;
-} CompressDict;
-
-class DictionaryEnc : public SparseArrayCompressor
-{
-    int8_t Compress(const ArrayInput &input) override;
-    int8_t Decompress(ArrayInput &output) override;
-    int8_t GetResult(CalResult &result) const override;
-
-private:
-    int8_t startCompress();
-    int8_t startDecompress(ArrayData1D &output);
-    void PrintBitPackedIndices(const std::vector<uint8_t> &vec, uint8_t bitWidth, uint8_t indicesPerLine = 16);
-
-    // Input
-    ArrayData1D _inputData1D;
-    ArrayDimension _arrayType;
-
-    // Output
-    CompressDict _compressedData;
-    CalResult _result;
-};
-
-int8_t DictionaryEnc::Compress(const ArrayInput &input)
-{
-    // 1. 预处理输入数据
-    if (std::holds_alternative<ArrayData1D>(input))
-    {
-        const auto &vec = std::get<ArrayData1D>(input);
-        _inputData1D = vec;
-        _arrayType = ARRAY_1D;
-    }
-    else if (std::holds_alternative<ArrayData2D>(input))
-    {
-        _arrayType = ARRAY_2D;
-        const auto &vec2d = std::get<ArrayData2D>(input);
-
-        _compressedData.originArrayRow = vec2d.rowCount;
-        _compressedData.originArrayCol = vec2d.colCount;
-
-        std::vector<uint32_t> flat;
-        flat.reserve(_compressedData.originArrayRow * _compressedData.originArrayCol);
-        for (const auto &row : vec2d.arrayData)
-        {
-            flat.insert(flat.end(), row.begin(), row.end());
-        }
-
-        _inputData1D.arrayData = std::move(flat);
-    }
-    else
-    {
-        std::cerr << LOG_ERROR << "Input data is empty.\n";
-        return ERROR_INPUT_EMPTY;
-    }
-
-    auto start = std::chrono::high_resolution_clock::now();
-    startCompress();
-    auto end = std::chrono::high_resolution_clock::now();
-
-    // 2. 计算压缩结果
-    _result.modeName = "HashDictionary";
-    _result.originElementCount = GetArrayElemCount1D(_inputData1D.arrayData);
-    _result.compressedElementCount = _compressedData.valueDict.size() + _compressedData.indexBitTable.size() + 4;
-
-    _result.originSizeBytes = GetArrayTotalSize1D(_inputData1D.arrayData);
-    _result.compressedSizeBytes = _compressedData.indexBitTable.size() + GetArrayTotalSize1D(_compressedData.valueDict) + 3 * sizeof(uint32_t) + 1;
-
-    _result.compressTimeMs = std::chrono::duration<double, std::milli>(end - start).count();
-    _result.decompressTimeMs = 0;
-
-    _result.compressionRatio = (static_cast<double>(_result.compressedSizeBytes) / _result.originSizeBytes) * 100.0;
-
-    return SAA_SUCCESS;
-}
-
-int8_t DictionaryEnc::startCompress()
-{
-#if 1
-    std::unordered_map<uint32_t, uint32_t> dictMap;
-    std::vector<uint32_t> tempIndexTable;
-
-    _compressedData.originCount = static_cast<uint32_t>(_inputData1D.arrayData.size());
-    _compressedData.valueDict.reserve(_inputData1D.arrayData.size());
-    tempIndexTable.reserve(_inputData1D.arrayData.size());
-
-    // 1. 数组取值，存储去重
-    for (const uint32_t &val : _inputData1D.arrayData)
-    {
-        auto it = dictMap.find(val);
-        if (it == dictMap.end())
-        {
-            uint32_t newIndex = dictMap.size();
-            dictMap[val] = newIndex;
-            _compressedData.valueDict.push_back(val);
-            tempIndexTable.push_back(newIndex);
-        }
-        else
-        {
-            tempIndexTable.push_back(it->second);
-        }
-    }
-
-    // 2. 压缩索引
-    uint8_t bitWidth = static_cast<uint8_t>(std::ceil(std::log2(dictMap.size())));
-    std::vector<uint8_t> packedBits;
-    packedBits.reserve((tempIndexTable.size() * bitWidth + 7) / 8); // 精确字节数，也进行了向上取整
-
-    uint8_t currentByte = 0;
-    uint8_t bitPos = 0;
-
-    for (uint32_t idx : tempIndexTable)
-    {
-        for (int8_t i = bitWidth - 1; i >= 0; --i) // 从高位到低位
-        {
-            uint8_t bit = (idx >> i) & 1;
-            currentByte = (currentByte << 1) | bit;
-            ++bitPos;
-
-            if (bitPos == 8)
-            {
-                packedBits.push_back(currentByte);
-                currentByte = 0;
-                bitPos = 0;
-            }
-        }
-    }
-
-    // 最后不足8位的补全
-    if (bitPos > 0)
-    {
-        currentByte <<= (8 - bitPos); // 左移补零，补在低位
-        packedBits.push_back(currentByte);
-    }
-    _compressedData.indexBitTable = std::move(packedBits);
-    _compressedData.bitWidth = bitWidth;
-
-    // PrintBuffer(_compressedData.indexBitTable);
-
-#if 0
-    std::cout << LOG_DEBUG << "Hash Dictionary info: (originCount: " << _compressedData.originCount
-              << " originArrayRow: " << _compressedData.originArrayRow
-              << " originArrayCol: " << _compressedData.originArrayCol
-              << " bitWidth: " << static_cast<int>(_compressedData.bitWidth)
-              << ")\n";
-
-    PrintVector1D(_compressedData.valueDict, "_compressedData.valueDict");
-    PrintBitPackedIndices(_compressedData.indexBitTable, _compressedData.bitWidth);
-
-#endif
-
-#endif
-    return SAA_SUCCESS;
-}
-
-int8_t DictionaryEnc::Decompress(ArrayInput &output)
-{
-    if (_inputData1D.arrayData.empty())
-    {
-        std::cerr << LOG_ERROR << "Input data is empty.\n";
-        return ERROR_INPUT_EMPTY;
-    }
-
-    if (_compressedData.valueDict.empty() && _compressedData.indexBitTable.empty())
-    {
-        std::cerr << LOG_ERROR << "Compressed data is empty.\n";
-        return ERROR_INPUT_EMPTY;
-    }
-
-    // 1. 解压
-    ArrayData1D tempData;
-    auto start = std::chrono::high_resolution_clock::now();
-    if (startDecompress(tempData) != SAA_SUCCESS)
-    {
-        std::cerr << LOG_ERROR << "Decompressed something error.\n";
-        return ERROR_CALCULATE_ERROR;
-    }
-    auto end = std::chrono::high_resolution_clock::now();
-
-    _result.decompressTimeMs = std::chrono::duration<double, std::milli>(end - start).count();
-
-    // 2. 校验
-    if (_inputData1D.arrayData != tempData.arrayData)
-    {
-        std::cerr << LOG_ERROR << "Decompressed result error.\n";
-        return ERROR_CALCULATE_ERROR;
-    }
-    
-    // 3. 维度恢复
-    if (_arrayType == ARRAY_1D)
-    {
-        // PrintVector1D(tempData.arrayData, "Decompressed Array 1D");
-
-        if (auto *ptr1d = std::get_if<ArrayData1D>(&output))
-        {
-            *ptr1d = std::move(tempData);
-        }
-        else
-        {
-            std::cerr << LOG_ERROR << "ArrayInput is not compatible with 1D array.\n";
-            return ERROR_PARAM_INVALID;
-        }
-    }
-    else if (_arrayType == ARRAY_2D)
-    {
-        if (auto *ptr2d = std::get_if<ArrayData2D>(&output))
-        {
-            ArrayData2D out;
-            out.arrayData.resize(_compressedData.originArrayRow);
-            out.rowCount = _compressedData.originArrayRow;
-            out.colCount = _compressedData.originArrayCol;
-            for (uint32_t r = 0; r < _compressedData.originArrayRow; ++r)
-            {
-                out.arrayData[r].assign(
-                    tempData.arrayData.begin() + r * _compressedData.originArrayCol,
-                    tempData.arrayData.begin() + (r + 1) * _compressedData.originArrayCol);
-            }
-            // PrintVector2D(out.arrayData, out.rowCount, out.colCount, "Decompressed Array 2D");
-            *ptr2d = std::move(out);
-        }
-        else
-        {
-            std::cerr << LOG_ERROR << "ArrayInput is not compatible with 2D array.\n";
-            return ERROR_PARAM_INVALID;
-        }
-    }
-
-    return SAA_SUCCESS;
-}
-
-int8_t DictionaryEnc::startDecompress(ArrayData1D &outData1D)
-{
-    const std::vector<uint8_t> &packed = _compressedData.indexBitTable;
-    const uint8_t bitWidth = _compressedData.bitWidth;
-    const uint32_t indexCount = _compressedData.originCount;
-
-    outData1D.arrayData.reserve(indexCount);
-
-    size_t bitPos = 0;
-    for (size_t i = 0; i < indexCount; ++i)
-    {
-        uint32_t idx = 0;
-
-        // 大端位序解码（高位在前）
-        for (uint8_t b = 0; b < bitWidth; ++b)
-        {
-            size_t byteIndex = (bitPos + b) / 8;
-            size_t bitOffset = 7 - ((bitPos + b) % 8); // 大端：高位优先
-
-            if (byteIndex >= packed.size())
-                return ERROR_INDEX_OUT_OF_RANGE;
-
-            uint8_t bit = (packed[byteIndex] >> bitOffset) & 1;
-            idx = (idx << 1) | bit;
-        }
-
-        if (idx >= _compressedData.valueDict.size())
-            return ERROR_INDEX_OUT_OF_RANGE;
-
-        outData1D.arrayData.push_back(_compressedData.valueDict[idx]);
-
-        bitPos += bitWidth;
-    }
-
-    return SAA_SUCCESS;
-}
-
-int8_t DictionaryEnc::GetResult(CalResult &ret) const
-{
-    ret = _result;
-    return SAA_SUCCESS;
-}
-
-void DictionaryEnc::PrintBitPackedIndices(const std::vector<uint8_t> &vec, uint8_t bitWidth, uint8_t indicesPerLine)
-{
-    std::cout << "Bit-packed indices (" << vec.size() << " entries, " << int(bitWidth) << " bits each, big-endian):\n";
-
-    uint32_t bitPos = 0;
-    for (uint32_t i = 0; i < vec.size(); ++i)
-    {
-        uint32_t value = 0;
-
-        for (uint32_t b = 0; b < bitWidth; ++b)
-        {
-            uint32_t bitIndex = bitPos + b;
-            uint32_t byteIndex = bitIndex / 8;
-            uint32_t bitOffset = 7 - (bitIndex % 8); // 高位在前（大端）
-
-            uint8_t bit = (vec[byteIndex] >> bitOffset) & 1;
-            std::cout << (bit ? '1' : '0');
-
-            value = (value << 1) | bit; // 从高位拼接
-        }
-
-        std::cout << " ";
-
-        if ((i + 1) % indicesPerLine == 0)
-            std::cout << '\n';
-        bitPos += bitWidth;
-    }
-
-    std::cout << '\n';
-}
-
-#if ALGORITHM_DICTIONARY
-static bool coord_registered = []
-{
-    CompressorRegistry::Instance().Register("HashDictionary", []
-                                            { return std::make_unique<DictionaryEnc>(); });
-    return true;
-}();
-#endif
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2025-07-18 09:56:29
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2025-08-16 10:17:34
+ * @FilePath: \SparseArrayAnalyzer\core\src\algorithm_dictionary.cpp
+ * @Description:
+ *
+ */
+
+#include "sparse_array_analyzer.h"
+#include "alloc_tracker.h"
+#include "perf_counters.h"
+#include "trace_events.h"
+#include "common.h"
+#include "size_estimator.h"
+#include "bit_packing.hpp"
+#include "entropy_codec.hpp"
+#include "flat_dictionary.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include "tool.hpp"
+#include "serialization.hpp"
+
+// 索引表的熵编码阶段（可选）
+typedef enum dict_entropy
+{
+    DICT_ENTROPY_NONE = 0,    // 定长位打包
+    DICT_ENTROPY_HUFFMAN = 1, // 范式 Huffman
+    DICT_ENTROPY_RANS = 2,    // 双路交错 rANS
+} DictEntropy;
+
+template <typename T>
+struct CompressDict
+{
+    std::vector<T> valueDict;
+    std::vector<uint8_t> indexBitTable;
+    uint8_t bitWidth; // index 位宽
+    uint64_t originCount;
+    uint32_t originArrayRow;
+    uint32_t originArrayCol;
+    HuffmanStream huffman; // 熵编码后的索引（可选）
+    RansStream rans;
+};
+
+template <typename T>
+class DictionaryEnc : public SparseArrayCompressor
+{
+public:
+    explicit DictionaryEnc(DictEntropy entropy = DICT_ENTROPY_NONE) : _entropy(entropy) {}
+
+    int8_t Compress(const ArrayInput &input) override;
+    int8_t Decompress(ArrayInput &output) override;
+    int8_t GetResult(CalResult &result) const override;
+    void Reset() override;
+    int8_t Serialize(std::vector<uint8_t> &out) const override;
+    int8_t Deserialize(const uint8_t *data, size_t size) override;
+    int8_t GetElement(uint64_t index, void *value) const override;
+    int8_t EstimateSize(const SampleStats &stats, SizeEstimate &estimate) const override;
+
+private:
+    int8_t startCompress();
+    int8_t startDecompress(ArrayData1D<T> &output);
+    void PrintBitPackedIndices(const std::vector<uint8_t> &vec, uint8_t bitWidth, uint8_t indicesPerLine = 16);
+    void orderByFrequency(std::vector<uint32_t> &indexTable);
+    uint64_t indexBytes() const;
+    std::string modeName() const;
+
+    DictEntropy _entropy; // 非 NONE 时字典按频率降序编号，索引做熵编码
+
+    // Input
+    ArrayData1D<T> _inputData1D;
+    ArrayData1D<T> _decodeBuffer; // 解压输出缓冲，与调用方的数组交换后在下一轮复用
+    std::vector<uint32_t> _indexScratch; // 压缩时的编号表 / 解压时熵解码出的索引，跨运行保留容量
+    ArrayDimension _arrayType;
+
+    // Output
+    CompressDict<T> _compressedData;
+    CalResult _result;
+};
+
+template <typename T>
+int8_t DictionaryEnc<T>::Compress(const ArrayInput &input)
+{
+    // 0. 清空上一次的结果，保留容量
+    Reset();
+
+    // 1. 预处理输入数据
+    if (std::holds_alternative<ArrayData1D<T>>(input))
+    {
+        const auto &vec = std::get<ArrayData1D<T>>(input);
+        _inputData1D = vec;
+        _arrayType = ARRAY_1D;
+        _compressedData.originArrayRow = 1;
+        _compressedData.originArrayCol = static_cast<uint32_t>(vec.arrayData.size());
+    }
+    else if (std::holds_alternative<ArrayData2D<T>>(input))
+    {
+        _arrayType = ARRAY_2D;
+        const auto &vec2d = std::get<ArrayData2D<T>>(input);
+
+        _compressedData.originArrayRow = vec2d.rowCount;
+        _compressedData.originArrayCol = vec2d.colCount;
+
+        // 直接展平到输入副本，复用其容量
+        _inputData1D.arrayData.clear();
+        _inputData1D.arrayData.reserve(static_cast<size_t>(_compressedData.originArrayRow) * _compressedData.originArrayCol);
+        for (const auto &row : vec2d.arrayData)
+        {
+            _inputData1D.arrayData.insert(_inputData1D.arrayData.end(), row.begin(), row.end());
+        }
+    }
+    else
+    {
+        std::cerr << LOG_ERROR << "Input element type is not " << ElemTraits<T>::name << ".\n";
+        return ERROR_PARAM_INVALID;
+    }
+
+    if (_inputData1D.arrayData.empty())
+    {
+        std::cerr << LOG_ERROR << "Input data is empty.\n";
+        return ERROR_INPUT_EMPTY;
+    }
+
+    TraceSpan compressTrace("compress");
+    AllocPhase compressAlloc(_result.compressAlloc);
+    PerfPhase compressPhase(_result.compressPerf);
+    auto start = std::chrono::high_resolution_clock::now();
+    int8_t ret = startCompress();
+    auto end = std::chrono::high_resolution_clock::now();
+    compressPhase.stop();
+    compressAlloc.stop();
+    compressTrace.stop();
+    if (ret != SAA_SUCCESS)
+    {
+        std::cerr << LOG_WARN << "Huffman code lengths cannot be limited to " << HUFF_MAX_BITS << " bits for "
+                  << _compressedData.valueDict.size() << " distinct values.\n";
+        return ret;
+    }
+
+    // 2. 计算压缩结果
+    _result.modeName = modeName();
+    _result.originElementCount = GetArrayElemCount1D(_inputData1D.arrayData);
+    _result.compressedElementCount = _compressedData.valueDict.size() + indexBytes() + 4;
+
+    _result.originSizeBytes = GetArrayTotalSize1D(_inputData1D.arrayData);
+    _result.compressedSizeBytes = indexBytes() + GetArrayTotalSize1D(_compressedData.valueDict) + 3 * sizeof(uint32_t) + 1;
+
+    _result.compressTimeMs = std::chrono::duration<double, std::milli>(end - start).count();
+    _result.decompressTimeMs = 0;
+
+    _result.compressionRatio = (static_cast<double>(_result.compressedSizeBytes) / _result.originSizeBytes) * 100.0;
+
+    // 逐位解码索引后查字典，顺序与随机访问开销相同
+    _result.seqAccessOps = 1.0 + _compressedData.bitWidth;
+    _result.randomAccessOps = 1.0 + _compressedData.bitWidth;
+    if (_entropy != DICT_ENTROPY_NONE)
+    {
+        // 熵编码变长：顺序每次查表（Huffman 可一次解多个符号）；随机访问需从头解码
+        _result.seqAccessOps = 2.0;
+        _result.randomAccessOps = 1.0 + _result.originElementCount / 2.0;
+    }
+
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+int8_t DictionaryEnc<T>::startCompress()
+{
+#if 1
+    std::vector<uint32_t> &tempIndexTable = _indexScratch;
+    _compressedData.originCount = static_cast<uint64_t>(_inputData1D.arrayData.size());
+
+    // 1. 数组取值，存储去重：小范围直接查表，否则开放寻址；大输入分块并行后合并
+    uint32_t threadCount = 1;
+    if (_inputData1D.arrayData.size() >= DICT_PARALLEL_MIN_ELEMS)
+    {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    BuildDictionary(_inputData1D.arrayData, _compressedData.valueDict, tempIndexTable, threadCount);
+
+    // 2. 熵编码：字典按频率降序重编号，常见值获得短码
+    if (_entropy != DICT_ENTROPY_NONE)
+    {
+        orderByFrequency(tempIndexTable);
+        _compressedData.bitWidth = 0;
+        if (_entropy == DICT_ENTROPY_HUFFMAN)
+        {
+            if (!EncodeHuffman(tempIndexTable, static_cast<uint32_t>(_compressedData.valueDict.size()), _compressedData.huffman))
+            {
+                return ERROR_UNSUPPORT_FEATURE;
+            }
+        }
+        else
+        {
+            EncodeRans(tempIndexTable, static_cast<uint32_t>(_compressedData.valueDict.size()), _compressedData.rans);
+        }
+        return SAA_SUCCESS;
+    }
+
+    // 3. 压缩索引；只有一个不同值时位宽为 0，索引表为空，解码时全部取 valueDict[0]
+    uint8_t bitWidth = BitWidthOf(_compressedData.valueDict.size() - 1);
+    std::vector<uint8_t> &packedBits = _compressedData.indexBitTable;
+    packedBits.reserve((static_cast<uint64_t>(tempIndexTable.size()) * bitWidth + 7) / 8); // 精确字节数，也进行了向上取整
+
+    uint8_t currentByte = 0;
+    uint8_t bitPos = 0;
+
+    for (uint32_t idx : tempIndexTable)
+    {
+        for (int8_t i = bitWidth - 1; i >= 0; --i) // 从高位到低位
+        {
+            uint8_t bit = (idx >> i) & 1;
+            currentByte = (currentByte << 1) | bit;
+            ++bitPos;
+
+            if (bitPos == 8)
+            {
+                packedBits.push_back(currentByte);
+                currentByte = 0;
+                bitPos = 0;
+            }
+        }
+    }
+
+    // 最后不足8位的补全
+    if (bitPos > 0)
+    {
+        currentByte <<= (8 - bitPos); // 左移补零，补在低位
+        packedBits.push_back(currentByte);
+    }
+    _compressedData.bitWidth = bitWidth;
+
+    // PrintBuffer(_compressedData.indexBitTable);
+
+#if 0
+    std::cout << LOG_DEBUG << "Hash Dictionary info: (originCount: " << _compressedData.originCount
+              << " originArrayRow: " << _compressedData.originArrayRow
+              << " originArrayCol: " << _compressedData.originArrayCol
+              << " bitWidth: " << static_cast<int>(_compressedData.bitWidth)
+              << ")\n";
+
+    PrintVector1D(_compressedData.valueDict, "_compressedData.valueDict");
+    PrintBitPackedIndices(_compressedData.indexBitTable, _compressedData.bitWidth);
+
+#endif
+
+#endif
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+void DictionaryEnc<T>::orderByFrequency(std::vector<uint32_t> &indexTable)
+{
+    // 1. 统计各编号出现次数，按次数降序（相同时保持首次出现顺序）排列
+    const uint32_t dictSize = static_cast<uint32_t>(_compressedData.valueDict.size());
+    std::pmr::vector<uint64_t> counts(dictSize, 0, _workResource);
+    for (uint32_t idx : indexTable)
+    {
+        counts[idx]++;
+    }
+
+    std::pmr::vector<uint32_t> order(dictSize, _workResource);
+    for (uint32_t i = 0; i < dictSize; ++i)
+    {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&counts](uint32_t a, uint32_t b)
+                     { return counts[a] > counts[b]; });
+
+    // 2. 重排字典并改写索引
+    std::pmr::vector<uint32_t> remap(dictSize, _workResource);
+    std::pmr::vector<T> sortedDict(dictSize, _workResource);
+    for (uint32_t rank = 0; rank < dictSize; ++rank)
+    {
+        remap[order[rank]] = rank;
+        sortedDict[rank] = _compressedData.valueDict[order[rank]];
+    }
+    _compressedData.valueDict.assign(sortedDict.begin(), sortedDict.end());
+    for (uint32_t &idx : indexTable)
+    {
+        idx = remap[idx];
+    }
+}
+
+template <typename T>
+int8_t DictionaryEnc<T>::Decompress(ArrayInput &output)
+{
+    if (_compressedData.valueDict.empty() && _compressedData.indexBitTable.empty())
+    {
+        std::cerr << LOG_ERROR << "Compressed data is empty.\n";
+        return ERROR_INPUT_EMPTY;
+    }
+
+    // 1. 解压
+    ArrayData1D<T> &tempData = _decodeBuffer; // 复用上一轮的缓冲，startDecompress 覆盖全部内容
+    TraceSpan decompressTrace("decompress");
+    AllocPhase decompressAlloc(_result.decompressAlloc);
+    PerfPhase decompressPhase(_result.decompressPerf);
+    auto start = std::chrono::high_resolution_clock::now();
+    if (startDecompress(tempData) != SAA_SUCCESS)
+    {
+        std::cerr << LOG_ERROR << "Decompressed something error.\n";
+        return ERROR_CALCULATE_ERROR;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    decompressPhase.stop();
+    decompressAlloc.stop();
+    decompressTrace.stop();
+
+    _result.decompressTimeMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+    // 2. 校验，反序列化得到的对象没有原始输入，跳过
+    TraceSpan verifyTrace("verify");
+    if (!_inputData1D.arrayData.empty() && !Compare1D(_inputData1D.arrayData, tempData.arrayData))
+    {
+        std::cerr << LOG_ERROR << "Decompressed result error.\n";
+        return ERROR_CALCULATE_ERROR;
+    }
+    verifyTrace.stop();
+    
+    // 3. 维度恢复
+    if (_arrayType == ARRAY_1D)
+    {
+        // PrintVector1D(tempData.arrayData, "Decompressed Array 1D");
+
+        if (auto *ptr1d = std::get_if<ArrayData1D<T>>(&output))
+        {
+            ptr1d->arrayData.swap(tempData.arrayData); // 与缓冲交换，两块内存在重复运行间轮流使用
+        }
+        else
+        {
+            std::cerr << LOG_ERROR << "ArrayInput is not compatible with 1D array.\n";
+            return ERROR_PARAM_INVALID;
+        }
+    }
+    else if (_arrayType == ARRAY_2D)
+    {
+        if (auto *ptr2d = std::get_if<ArrayData2D<T>>(&output))
+        {
+            ArrayData2D<T> &out = *ptr2d; // 复用调用方已有行的容量
+            out.arrayData.resize(_compressedData.originArrayRow);
+            out.rowCount = _compressedData.originArrayRow;
+            out.colCount = _compressedData.originArrayCol;
+            for (uint32_t r = 0; r < _compressedData.originArrayRow; ++r)
+            {
+                out.arrayData[r].assign(
+                    tempData.arrayData.begin() + static_cast<size_t>(r) * _compressedData.originArrayCol,
+                    tempData.arrayData.begin() + static_cast<size_t>(r + 1) * _compressedData.originArrayCol);
+            }
+            // PrintVector2D(out.arrayData, out.rowCount, out.colCount, "Decompressed Array 2D");
+        }
+        else
+        {
+            std::cerr << LOG_ERROR << "ArrayInput is not compatible with 2D array.\n";
+            return ERROR_PARAM_INVALID;
+        }
+    }
+
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+int8_t DictionaryEnc<T>::startDecompress(ArrayData1D<T> &outData1D)
+{
+    const std::vector<uint8_t> &packed = _compressedData.indexBitTable;
+    const uint8_t bitWidth = _compressedData.bitWidth;
+    const uint64_t indexCount = _compressedData.originCount;
+
+    // 熵编码：先整体解出索引，再批量查字典
+    if (_entropy != DICT_ENTROPY_NONE)
+    {
+        std::vector<uint32_t> &indices = _indexScratch;
+        if (_entropy == DICT_ENTROPY_HUFFMAN)
+        {
+            DecodeHuffman(_compressedData.huffman, indices);
+        }
+        else
+        {
+            DecodeRans(_compressedData.rans, indices);
+        }
+        if (indices.size() != indexCount)
+            return ERROR_INDEX_OUT_OF_RANGE;
+
+        outData1D.arrayData.resize(indexCount);
+        const T *dict = _compressedData.valueDict.data();
+        const uint32_t dictSize = static_cast<uint32_t>(_compressedData.valueDict.size());
+        for (uint64_t i = 0; i < indexCount; ++i)
+        {
+            if (indices[i] >= dictSize)
+                return ERROR_INDEX_OUT_OF_RANGE;
+            outData1D.arrayData[i] = dict[indices[i]];
+        }
+        return SAA_SUCCESS;
+    }
+
+    outData1D.arrayData.clear();
+    outData1D.arrayData.reserve(indexCount);
+
+    size_t bitPos = 0;
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        uint32_t idx = 0;
+
+        // 大端位序解码（高位在前）
+        for (uint8_t b = 0; b < bitWidth; ++b)
+        {
+            size_t byteIndex = (bitPos + b) / 8;
+            size_t bitOffset = 7 - ((bitPos + b) % 8); // 大端：高位优先
+
+            if (byteIndex >= packed.size())
+                return ERROR_INDEX_OUT_OF_RANGE;
+
+            uint8_t bit = (packed[byteIndex] >> bitOffset) & 1;
+            idx = (idx << 1) | bit;
+        }
+
+        if (idx >= _compressedData.valueDict.size())
+            return ERROR_INDEX_OUT_OF_RANGE;
+
+        outData1D.arrayData.push_back(_compressedData.valueDict[idx]);
+
+        bitPos += bitWidth;
+    }
+
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+int8_t DictionaryEnc<T>::EstimateSize(const SampleStats &stats, SizeEstimate &estimate) const
+{
+    // 字典大小 + 按位宽打包的索引表，区间由不同值数量的上下界决定
+    // 熵编码：假设非主值在其余取值上均匀分布，按信息熵估计每元素位数；
+    // Huffman 每个符号至少 1 位，rANS 额外计入频率表，码长表 / 频率表按字典大小计
+    const double p = stats.nonMainFraction;
+    const DictEntropy entropy = _entropy;
+    auto predict = [&stats, p, entropy](double distinct) -> double
+    {
+        double dictBytes = distinct * stats.elemBytes + 3 * sizeof(uint32_t) + 1;
+        if (entropy == DICT_ENTROPY_NONE)
+        {
+            double bitWidth = (distinct > 1.0) ? std::ceil(std::log2(distinct)) : 0.0;
+            return dictBytes + std::ceil(stats.elemCount * bitWidth / 8.0);
+        }
+
+        double otherBits = (distinct > 2.0) ? std::log2(distinct - 1.0) : 0.0;
+        double binary = (p > 0.0 && p < 1.0) ? -(p * std::log2(p) + (1.0 - p) * std::log2(1.0 - p)) : 0.0;
+        double bits = binary + p * otherBits;
+        if (entropy == DICT_ENTROPY_HUFFMAN)
+        {
+            bits = (distinct > 1.0) ? std::max(1.0, bits + 0.05) : 0.0;
+            return dictBytes + std::ceil(stats.elemCount * bits / 8.0) + distinct + sizeof(uint64_t) + sizeof(uint32_t);
+        }
+        double tableBytes = std::min(distinct, static_cast<double>(ANS_MAX_DIRECT) + 1.0) * sizeof(uint16_t);
+        return dictBytes + std::ceil(stats.elemCount * bits / 8.0) + tableBytes + 8 + sizeof(uint64_t) + sizeof(uint32_t);
+    };
+
+    estimate.modeName = modeName();
+    estimate.predictedBytes = predict(stats.distinctEstimate);
+    estimate.lowBytes = predict(stats.distinctLow);
+    estimate.highBytes = predict(stats.distinctHigh);
+    estimate.predictedRatio = estimate.predictedBytes / (static_cast<double>(stats.elemCount) * stats.elemBytes) * 100.0;
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+uint64_t DictionaryEnc<T>::indexBytes() const
+{
+    switch (_entropy)
+    {
+    case DICT_ENTROPY_HUFFMAN:
+        return HuffmanBytes(_compressedData.huffman);
+    case DICT_ENTROPY_RANS:
+        return RansBytes(_compressedData.rans);
+    default:
+        return _compressedData.indexBitTable.size();
+    }
+}
+
+template <typename T>
+std::string DictionaryEnc<T>::modeName() const
+{
+    switch (_entropy)
+    {
+    case DICT_ENTROPY_HUFFMAN:
+        return "HashDictionary-Huff";
+    case DICT_ENTROPY_RANS:
+        return "HashDictionary-rANS";
+    default:
+        return "HashDictionary";
+    }
+}
+
+template <typename T>
+int8_t DictionaryEnc<T>::GetResult(CalResult &ret) const
+{
+    ret = _result;
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+void DictionaryEnc<T>::Reset()
+{
+    _inputData1D.arrayData.clear();
+    _compressedData.valueDict.clear();
+    _compressedData.indexBitTable.clear();
+    _compressedData.originCount = 0;
+    _compressedData.huffman = HuffmanStream();
+    _compressedData.rans = RansStream();
+    _result = CalResult();
+}
+
+template <typename T>
+int8_t DictionaryEnc<T>::Serialize(std::vector<uint8_t> &out) const
+{
+    ByteWriter writer(out);
+
+    // 1. 模式与形状
+    writer.put(static_cast<uint8_t>(_entropy));
+    writer.put(static_cast<uint8_t>(_arrayType));
+    writer.put(_compressedData.bitWidth);
+    writer.put(_compressedData.originArrayRow);
+    writer.put(_compressedData.originArrayCol);
+    writer.put(_compressedData.originCount);
+
+    // 2. 字典与索引
+    writer.putArray(_compressedData.valueDict);
+    if (_entropy == DICT_ENTROPY_HUFFMAN)
+        writer.putHuffman(_compressedData.huffman);
+    else if (_entropy == DICT_ENTROPY_RANS)
+        writer.putRans(_compressedData.rans);
+    else
+        writer.putArray(_compressedData.indexBitTable);
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+int8_t DictionaryEnc<T>::Deserialize(const uint8_t *data, size_t size)
+{
+    ByteReader reader(data, size);
+    CompressDict<T> compressed;
+    uint8_t entropy = 0;
+    uint8_t dimension = 0;
+
+    // 1. 模式与形状
+    reader.get(entropy);
+    reader.get(dimension);
+    reader.get(compressed.bitWidth);
+    reader.get(compressed.originArrayRow);
+    reader.get(compressed.originArrayCol);
+    reader.get(compressed.originCount);
+
+    // 2. 字典与索引
+    reader.getArray(compressed.valueDict);
+    if (entropy == DICT_ENTROPY_HUFFMAN)
+        reader.getHuffman(compressed.huffman);
+    else if (entropy == DICT_ENTROPY_RANS)
+        reader.getRans(compressed.rans);
+    else
+        reader.getArray(compressed.indexBitTable);
+
+    // 索引流的结构由 ByteReader 校验，这里核对它与字典大小、元素数是否一致；越界的索引值在解压时检出
+    const uint64_t dictSize = compressed.valueDict.size();
+    bool indexValid = (entropy == DICT_ENTROPY_HUFFMAN) ? compressed.huffman.count == compressed.originCount &&
+                                                              compressed.huffman.codeLength.size() == dictSize
+                      : (entropy == DICT_ENTROPY_RANS)  ? compressed.rans.count == compressed.originCount &&
+                                                              compressed.rans.directSymbols == std::min<uint64_t>(dictSize, ANS_MAX_DIRECT)
+                                                        : dictSize && compressed.bitWidth == BitWidthOf(dictSize - 1) &&
+                                                              (compressed.bitWidth == 0 || compressed.originCount <= compressed.indexBitTable.size() * 8) &&
+                                                              compressed.indexBitTable.size() == (compressed.originCount * compressed.bitWidth + 7) / 8;
+    if (!reader.finished() || entropy > DICT_ENTROPY_RANS || dimension > ARRAY_2D || !indexValid ||
+        compressed.valueDict.empty() ||
+        compressed.originCount != static_cast<uint64_t>(compressed.originArrayRow) * compressed.originArrayCol)
+    {
+        std::cerr << LOG_ERROR << "Serialized HashDictionary is corrupted.\n";
+        return ERROR_PARAM_INVALID;
+    }
+
+    _entropy = static_cast<DictEntropy>(entropy);
+    _arrayType = static_cast<ArrayDimension>(dimension);
+    _inputData1D.arrayData.clear();
+    _compressedData = std::move(compressed);
+    _result = CalResult();
+    _result.modeName = modeName();
+    return SAA_SUCCESS;
+}
+
+// 定宽索引可直接按位置读取；熵编码索引是变长位流，不支持随机读取
+template <typename T>
+int8_t DictionaryEnc<T>::GetElement(uint64_t index, void *value) const
+{
+    if (_entropy != DICT_ENTROPY_NONE)
+    {
+        return ERROR_UNSUPPORT_FEATURE;
+    }
+    if (index >= _compressedData.originCount)
+    {
+        return ERROR_INDEX_OUT_OF_RANGE;
+    }
+
+    // 与解压相同的大端位序
+    uint32_t idx = 0;
+    uint64_t bitPos = index * _compressedData.bitWidth;
+    for (uint8_t b = 0; b < _compressedData.bitWidth; ++b, ++bitPos)
+    {
+        idx = (idx << 1) | ((_compressedData.indexBitTable[bitPos / 8] >> (7 - bitPos % 8)) & 1);
+    }
+    if (idx >= _compressedData.valueDict.size())
+    {
+        return ERROR_INDEX_OUT_OF_RANGE;
+    }
+    *static_cast<T *>(value) = _compressedData.valueDict[idx];
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+void DictionaryEnc<T>::PrintBitPackedIndices(const std::vector<uint8_t> &vec, uint8_t bitWidth, uint8_t indicesPerLine)
+{
+    std::cout << "Bit-packed indices (" << vec.size() << " entries, " << int(bitWidth) << " bits each, big-endian):\n";
+
+    uint32_t bitPos = 0;
+    for (uint32_t i = 0; i < vec.size(); ++i)
+    {
+        uint32_t value = 0;
+
+        for (uint32_t b = 0; b < bitWidth; ++b)
+        {
+            uint32_t bitIndex = bitPos + b;
+            uint32_t byteIndex = bitIndex / 8;
+            uint32_t bitOffset = 7 - (bitIndex % 8); // 高位在前（大端）
+
+            uint8_t bit = (vec[byteIndex] >> bitOffset) & 1;
+            std::cout << (bit ? '1' : '0');
+
+            value = (value << 1) | bit; // 从高位拼接
+        }
+
+        std::cout << " ";
+
+        if ((i + 1) % indicesPerLine == 0)
+            std::cout << '\n';
+        bitPos += bitWidth;
+    }
+
+    std::cout << '\n';
+}
+
+#if ALGORITHM_DICTIONARY
+static bool coord_registered = []
+{
+    CompressorRegistry::Instance().Register("HashDictionary", [](ElemType type)
+                                            { return MakeTypedCompressor<DictionaryEnc>(type); });
+    CompressorRegistry::Instance().Register("HashDictionary-Huff", [](ElemType type)
+                                            { return MakeTypedCompressor<DictionaryEnc>(type, DICT_ENTROPY_HUFFMAN); });
+    CompressorRegistry::Instance().Register("HashDictionary-rANS", [](ElemType type)
+                                            { return MakeTypedCompressor<DictionaryEnc>(type, DICT_ENTROPY_RANS); });
+    return true;
+}();
+#endif
@@ -0,0 +1,560 @@
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2026-10-19 16:05:00
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2026-10-19 16:05:00
+ * @FilePath: \SparseArrayAnalyzer\core\src\algorithm_pfor.cpp
+ * @Description: 带异常修补的参考帧编码（PFOR），每 128 个值一块，低位按 4 路纵向布局打包
+ *
+ */
+#include "sparse_array_analyzer.h"
+#include "alloc_tracker.h"
+#include "perf_counters.h"
+#include "trace_events.h"
+#include "common.h"
+#include "size_estimator.h"
+#include "bit_packing.hpp"
+#include "serialization.hpp"
+#include <chrono>
+#include <cmath>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define PFOR_BLOCK_SIZE   (128) // 每块值数量
+#define PFOR_LANES        (4)   // 纵向布局的通道数（一个 128 位寄存器）
+#define PFOR_MAX_WIDTH    (32)  // 低位最大位宽，超出部分一律作为异常
+#define PFOR_COVER_RATIO  (0.9) // 低位宽度需覆盖的块内值比例
+
+typedef struct pfor_block
+{
+    uint64_t base;          // 块内最小键
+    uint8_t bitWidth;       // 低位宽度
+    uint8_t exceptionCount; // 异常数量
+    uint32_t wordOffset;    // 低位在 words 中的起始位置
+    uint32_t exceptionOffset;
+} PforBlock;
+
+template <typename T>
+struct PforCompressed
+{
+    uint64_t count;
+    uint32_t rows;
+    uint32_t cols;
+    std::vector<PforBlock> blocks;
+    std::vector<uint32_t> words;             // 各块低位，按 4 路纵向交错
+    std::vector<uint8_t> exceptionPos;       // 异常在块内的位置
+    PackedValues<uint64_t> exceptionHigh;    // 异常的高位部分（delta >> bitWidth）
+};
+
+// 4 路纵向打包：第 i 个值落在通道 i % 4 的第 i / 4 个槽位，每个通道独立按位宽连续存放
+static void PackBlockVertical(const uint32_t *lows, uint32_t bitWidth, uint32_t *words)
+{
+    for (uint32_t lane = 0; lane < PFOR_LANES; ++lane)
+    {
+        uint32_t bitPos = 0;
+        for (uint32_t slot = 0; slot < PFOR_BLOCK_SIZE / PFOR_LANES; ++slot, bitPos += bitWidth)
+        {
+            uint64_t value = lows[slot * PFOR_LANES + lane];
+            uint32_t word = bitPos / 32;
+            uint32_t shift = bitPos % 32;
+            words[word * PFOR_LANES + lane] |= static_cast<uint32_t>(value << shift);
+            if (shift + bitWidth > 32)
+                words[(word + 1) * PFOR_LANES + lane] |= static_cast<uint32_t>(value >> (32 - shift));
+        }
+    }
+}
+
+static void UnpackBlockVertical(const uint32_t *words, uint32_t bitWidth, uint32_t *lows)
+{
+    if (bitWidth == 0)
+    {
+        std::fill(lows, lows + PFOR_BLOCK_SIZE, 0u);
+        return;
+    }
+
+#if defined(__SSE2__)
+    // 四个通道的移位量相同，一次处理一个寄存器
+    const __m128i mask = _mm_set1_epi32(bitWidth == 32 ? -1 : static_cast<int>((1u << bitWidth) - 1));
+    const __m128i *in = reinterpret_cast<const __m128i *>(words);
+    __m128i *out = reinterpret_cast<__m128i *>(lows);
+    __m128i cur = _mm_loadu_si128(in);
+    uint32_t shift = 0;
+    for (uint32_t slot = 0; slot < PFOR_BLOCK_SIZE / PFOR_LANES; ++slot)
+    {
+        __m128i value = _mm_srl_epi32(cur, _mm_cvtsi32_si128(shift));
+        shift += bitWidth;
+        if (shift >= 32)
+        {
+            shift -= 32;
+            if (slot + 1 < PFOR_BLOCK_SIZE / PFOR_LANES || shift > 0)
+            {
+                cur = _mm_loadu_si128(++in);
+                if (shift > 0)
+                    value = _mm_or_si128(value, _mm_sll_epi32(cur, _mm_cvtsi32_si128(bitWidth - shift)));
+            }
+        }
+        _mm_storeu_si128(out + slot, _mm_and_si128(value, mask));
+    }
+#else
+    const uint64_t mask = (1ull << bitWidth) - 1;
+    for (uint32_t lane = 0; lane < PFOR_LANES; ++lane)
+    {
+        uint32_t bitPos = 0;
+        for (uint32_t slot = 0; slot < PFOR_BLOCK_SIZE / PFOR_LANES; ++slot, bitPos += bitWidth)
+        {
+            uint32_t word = bitPos / 32;
+            uint32_t shift = bitPos % 32;
+            uint64_t value = words[word * PFOR_LANES + lane] >> shift;
+            if (shift + bitWidth > 32)
+                value |= static_cast<uint64_t>(words[(word + 1) * PFOR_LANES + lane]) << (32 - shift);
+            lows[slot * PFOR_LANES + lane] = static_cast<uint32_t>(value & mask);
+        }
+    }
+#endif
+}
+
+template <typename T>
+class PatchedFrameOfRef : public SparseArrayCompressor
+{
+public:
+    int8_t Compress(const ArrayInput &input) override;
+    int8_t Decompress(ArrayInput &output) override;
+    int8_t GetResult(CalResult &result) const override;
+    void Reset() override;
+    int8_t Serialize(std::vector<uint8_t> &out) const override;
+    int8_t Deserialize(const uint8_t *data, size_t size) override;
+    int8_t EstimateSize(const SampleStats &stats, SizeEstimate &estimate) const override;
+
+private:
+    int8_t startCompress();
+    int8_t startDecompress(ArrayData1D<T> &output);
+    uint64_t compressedBytes() const;
+
+    // Input
+    ArrayData1D<T> _inputData1D;
+    ArrayData1D<T> _decodeBuffer; // 解压输出缓冲，与调用方的数组交换后在下一轮复用
+    ArrayDimension _arrayType;
+
+    // Output
+    PforCompressed<T> _compressedData;
+    CalResult _result;
+};
+
+template <typename T>
+int8_t PatchedFrameOfRef<T>::Compress(const ArrayInput &input)
+{
+    // 0. 清空上一次的结果，保留容量
+    Reset();
+
+    // 1. 预处理输入数据，二维按行展平
+    if (std::holds_alternative<ArrayData1D<T>>(input))
+    {
+        _inputData1D = std::get<ArrayData1D<T>>(input);
+        _arrayType = ARRAY_1D;
+        _compressedData.rows = 1;
+        _compressedData.cols = static_cast<uint32_t>(_inputData1D.arrayData.size());
+    }
+    else if (std::holds_alternative<ArrayData2D<T>>(input))
+    {
+        _arrayType = ARRAY_2D;
+        const auto &vec2d = std::get<ArrayData2D<T>>(input);
+        _compressedData.rows = vec2d.rowCount;
+        _compressedData.cols = vec2d.colCount;
+
+        // 直接展平到输入副本，复用其容量
+        _inputData1D.arrayData.clear();
+        _inputData1D.arrayData.reserve(static_cast<size_t>(_compressedData.rows) * _compressedData.cols);
+        for (const auto &row : vec2d.arrayData)
+        {
+            _inputData1D.arrayData.insert(_inputData1D.arrayData.end(), row.begin(), row.end());
+        }
+    }
+    else
+    {
+        std::cerr << LOG_ERROR << "Input element type is not " << ElemTraits<T>::name << ".\n";
+        return ERROR_PARAM_INVALID;
+    }
+
+    if (_inputData1D.arrayData.empty())
+    {
+        std::cerr << LOG_ERROR << "Input data is empty.\n";
+        return ERROR_INPUT_EMPTY;
+    }
+
+    TraceSpan compressTrace("compress");
+    AllocPhase compressAlloc(_result.compressAlloc);
+    PerfPhase compressPhase(_result.compressPerf);
+    auto start = std::chrono::high_resolution_clock::now();
+    startCompress();
+    auto end = std::chrono::high_resolution_clock::now();
+    compressPhase.stop();
+    compressAlloc.stop();
+    compressTrace.stop();
+
+    // 2. 计算压缩结果
+    _result.modeName = "PatchedFOR";
+    _result.originElementCount = GetArrayElemCount1D(_inputData1D.arrayData);
+    _result.compressedElementCount = _compressedData.words.size() + _compressedData.exceptionPos.size() + _compressedData.blocks.size() * 3;
+
+    _result.originSizeBytes = GetArrayTotalSize1D(_inputData1D.arrayData);
+    _result.compressedSizeBytes = compressedBytes();
+
+    _result.compressTimeMs = std::chrono::duration<double, std::milli>(end - start).count();
+    _result.decompressTimeMs = 0;
+
+    _result.compressionRatio = (static_cast<double>(_result.compressedSizeBytes) / _result.originSizeBytes) * 100.0;
+
+    // 顺序：整块解包 + 修补异常；随机：定位块后单值解包，再在块内异常位置中查找
+    double exceptionRatio = static_cast<double>(_compressedData.exceptionPos.size()) / std::max<uint64_t>(_result.originElementCount, 1);
+    _result.seqAccessOps = 1.0 + exceptionRatio;
+    _result.randomAccessOps = 3.0 + std::log2(exceptionRatio * PFOR_BLOCK_SIZE + 1.0);
+
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+int8_t PatchedFrameOfRef<T>::startCompress()
+{
+    const auto &data = _inputData1D.arrayData;
+    _compressedData.count = data.size();
+
+    std::pmr::vector<uint64_t> exceptionHigh(_workResource);
+    uint64_t deltas[PFOR_BLOCK_SIZE];
+    uint32_t lows[PFOR_BLOCK_SIZE];
+
+    for (uint64_t begin = 0; begin < data.size(); begin += PFOR_BLOCK_SIZE)
+    {
+        uint64_t length = std::min<uint64_t>(PFOR_BLOCK_SIZE, data.size() - begin);
+
+        // 1. 块内参考帧，末块不足 128 个时补 0 差值
+        uint64_t base = ToOrderedKey(data[begin]);
+        for (uint64_t i = 1; i < length; ++i)
+            base = std::min(base, ToOrderedKey(data[begin + i]));
+
+        uint32_t widthCount[65] = {0};
+        for (uint64_t i = 0; i < PFOR_BLOCK_SIZE; ++i)
+        {
+            deltas[i] = (i < length) ? ToOrderedKey(data[begin + i]) - base : 0;
+            ++widthCount[BitWidthOf(deltas[i])];
+        }
+
+        // 2. 选取能覆盖约 90% 值的最小位宽，其余作为异常
+        uint32_t bitWidth = 0;
+        uint32_t covered = widthCount[0];
+        while (bitWidth < PFOR_MAX_WIDTH && covered < PFOR_COVER_RATIO * PFOR_BLOCK_SIZE)
+        {
+            covered += widthCount[++bitWidth];
+        }
+
+        PforBlock block;
+        block.base = base;
+        block.bitWidth = static_cast<uint8_t>(bitWidth);
+        block.exceptionCount = 0;
+        block.wordOffset = static_cast<uint32_t>(_compressedData.words.size());
+        block.exceptionOffset = static_cast<uint32_t>(_compressedData.exceptionPos.size());
+
+        uint64_t lowMask = (bitWidth == 64) ? ~0ull : ((1ull << bitWidth) - 1);
+        for (uint32_t i = 0; i < PFOR_BLOCK_SIZE; ++i)
+        {
+            lows[i] = static_cast<uint32_t>(deltas[i] & lowMask);
+            if (deltas[i] >> bitWidth)
+            {
+                _compressedData.exceptionPos.push_back(static_cast<uint8_t>(i));
+                exceptionHigh.push_back(deltas[i] >> bitWidth);
+                ++block.exceptionCount;
+            }
+        }
+
+        // 3. 低位纵向打包
+        _compressedData.words.resize(_compressedData.words.size() + bitWidth * PFOR_LANES, 0);
+        if (bitWidth)
+            PackBlockVertical(lows, bitWidth, _compressedData.words.data() + block.wordOffset);
+
+        _compressedData.blocks.push_back(block);
+    }
+
+    // 4. 异常高位统一做参考帧位打包
+    PackValues(exceptionHigh, _compressedData.exceptionHigh);
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+int8_t PatchedFrameOfRef<T>::Decompress(ArrayInput &output)
+{
+    // 0. 检查
+    if (_compressedData.blocks.empty())
+    {
+        std::cerr << LOG_ERROR << "Compressed data is empty.\n";
+        return ERROR_INPUT_EMPTY;
+    }
+
+    // 1. 解压
+    ArrayData1D<T> &tempData = _decodeBuffer; // 复用上一轮的缓冲，startDecompress 覆盖全部内容
+    TraceSpan decompressTrace("decompress");
+    AllocPhase decompressAlloc(_result.decompressAlloc);
+    PerfPhase decompressPhase(_result.decompressPerf);
+    auto start = std::chrono::high_resolution_clock::now();
+    if (startDecompress(tempData) != SAA_SUCCESS)
+    {
+        std::cerr << LOG_ERROR << "Decompressed something error.\n";
+        return ERROR_CALCULATE_ERROR;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    decompressPhase.stop();
+    decompressAlloc.stop();
+    decompressTrace.stop();
+
+    _result.decompressTimeMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+    // 2. 校验，反序列化得到的对象没有原始输入，跳过
+    TraceSpan verifyTrace("verify");
+    if (!_inputData1D.arrayData.empty() && !Compare1D(_inputData1D.arrayData, tempData.arrayData))
+    {
+        std::cerr << LOG_ERROR << "Decompressed result error.\n";
+        return ERROR_CALCULATE_ERROR;
+    }
+    verifyTrace.stop();
+
+    // 3. 维度复原
+    if (_arrayType == ARRAY_1D)
+    {
+        if (auto *ptr1d = std::get_if<ArrayData1D<T>>(&output))
+        {
+            ptr1d->arrayData.swap(tempData.arrayData); // 与缓冲交换，两块内存在重复运行间轮流使用
+        }
+        else
+        {
+            std::cerr << LOG_ERROR << "ArrayInput is not compatible with 1D array.\n";
+            return ERROR_PARAM_INVALID;
+        }
+    }
+    else if (_arrayType == ARRAY_2D)
+    {
+        if (auto *ptr2d = std::get_if<ArrayData2D<T>>(&output))
+        {
+            ArrayData2D<T> &out = *ptr2d; // 复用调用方已有行的容量
+            out.arrayData.resize(_compressedData.rows);
+            for (uint32_t r = 0; r < _compressedData.rows; ++r)
+            {
+                out.arrayData[r].assign(
+                    tempData.arrayData.begin() + static_cast<size_t>(r) * _compressedData.cols,
+                    tempData.arrayData.begin() + static_cast<size_t>(r + 1) * _compressedData.cols);
+            }
+            out.rowCount = _compressedData.rows;
+            out.colCount = _compressedData.cols;
+        }
+        else
+        {
+            std::cerr << LOG_ERROR << "ArrayInput is not compatible with 2D array.\n";
+            return ERROR_PARAM_INVALID;
+        }
+    }
+
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+int8_t PatchedFrameOfRef<T>::startDecompress(ArrayData1D<T> &outData1D)
+{
+    std::pmr::vector<uint64_t> exceptionHigh(_workResource);
+    UnpackValues(_compressedData.exceptionHigh, exceptionHigh);
+
+    outData1D.arrayData.resize(_compressedData.count);
+    alignas(16) uint32_t lows[PFOR_BLOCK_SIZE];
+    uint64_t deltas[PFOR_BLOCK_SIZE];
+
+    uint64_t begin = 0;
+    for (const auto &block : _compressedData.blocks)
+    {
+        // 1. 整块解包低位
+        UnpackBlockVertical(_compressedData.words.data() + block.wordOffset, block.bitWidth, lows);
+        for (uint32_t i = 0; i < PFOR_BLOCK_SIZE; ++i)
+            deltas[i] = lows[i];
+
+        // 2. 修补异常高位
+        for (uint32_t e = 0; e < block.exceptionCount; ++e)
+        {
+            uint32_t idx = block.exceptionOffset + e;
+            deltas[_compressedData.exceptionPos[idx]] |= exceptionHigh[idx] << block.bitWidth;
+        }
+
+        // 3. 加回参考帧
+        uint64_t length = std::min<uint64_t>(PFOR_BLOCK_SIZE, _compressedData.count - begin);
+        T *out = outData1D.arrayData.data() + begin;
+        for (uint64_t i = 0; i < length; ++i)
+            out[i] = FromOrderedKey<T>(block.base + deltas[i]);
+        begin += length;
+    }
+
+    return SAA_SUCCESS;
+}
+
+// 块头：参考帧（按元素宽度存储）+ 位宽 + 异常数；位置每个 1 字节；外加总数与行列
+template <typename T>
+uint64_t PatchedFrameOfRef<T>::compressedBytes() const
+{
+    uint64_t headerBytes = _compressedData.blocks.size() * (sizeof(T) + 2 * sizeof(uint8_t));
+    return headerBytes +
+           GetArrayTotalSize1D(_compressedData.words) +
+           _compressedData.exceptionPos.size() +
+           PackedValuesBytes(_compressedData.exceptionHigh) +
+           sizeof(uint64_t) + 2 * sizeof(uint32_t);
+}
+
+template <typename T>
+int8_t PatchedFrameOfRef<T>::EstimateSize(const SampleStats &stats, SizeEstimate &estimate) const
+{
+    // 非主值不足 10% 时位宽为 0，非主值都是异常；否则每个元素按非主值位宽打包
+    estimate.modeName = "PatchedFOR";
+    double blocks = std::ceil(stats.elemCount / static_cast<double>(PFOR_BLOCK_SIZE));
+    double fixedBytes = blocks * (stats.elemBytes + 2) + sizeof(uint64_t) + 2 * sizeof(uint32_t);
+    if (stats.nonMainFraction < 1.0 - PFOR_COVER_RATIO)
+    {
+        EstimateByNonMain(stats, fixedBytes, 1.0 + stats.packedBitWidth / 8.0, estimate);
+    }
+    else
+    {
+        double width = std::min<double>(stats.packedBitWidth, PFOR_MAX_WIDTH);
+        EstimateByNonMain(stats, fixedBytes, width / 8.0 / stats.nonMainFraction, estimate);
+    }
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+int8_t PatchedFrameOfRef<T>::GetResult(CalResult &ret) const
+{
+    ret = _result;
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+void PatchedFrameOfRef<T>::Reset()
+{
+    _inputData1D.arrayData.clear();
+    _compressedData.count = 0;
+    _compressedData.blocks.clear();
+    _compressedData.words.clear();
+    _compressedData.exceptionPos.clear();
+    PackedValuesClear(_compressedData.exceptionHigh);
+    _result = CalResult();
+}
+
+template <typename T>
+int8_t PatchedFrameOfRef<T>::Serialize(std::vector<uint8_t> &out) const
+{
+    ByteWriter writer(out);
+
+    // 1. 维度与形状
+    writer.put(static_cast<uint8_t>(_arrayType));
+    writer.put(_compressedData.count);
+    writer.put(_compressedData.rows);
+    writer.put(_compressedData.cols);
+
+    // 2. 块头按字段拆成数组，避免结构体填充字节
+    size_t blockCount = _compressedData.blocks.size();
+    std::vector<uint64_t> bases(blockCount);
+    std::vector<uint8_t> bitWidths(blockCount);
+    std::vector<uint8_t> exceptionCounts(blockCount);
+    std::vector<uint32_t> wordOffsets(blockCount);
+    std::vector<uint32_t> exceptionOffsets(blockCount);
+    for (size_t i = 0; i < blockCount; ++i)
+    {
+        const PforBlock &block = _compressedData.blocks[i];
+        bases[i] = block.base;
+        bitWidths[i] = block.bitWidth;
+        exceptionCounts[i] = block.exceptionCount;
+        wordOffsets[i] = block.wordOffset;
+        exceptionOffsets[i] = block.exceptionOffset;
+    }
+    writer.putArray(bases);
+    writer.putArray(bitWidths);
+    writer.putArray(exceptionCounts);
+    writer.putArray(wordOffsets);
+    writer.putArray(exceptionOffsets);
+
+    // 3. 低位与异常
+    writer.putArray(_compressedData.words);
+    writer.putArray(_compressedData.exceptionPos);
+    writer.putPacked(_compressedData.exceptionHigh);
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+int8_t PatchedFrameOfRef<T>::Deserialize(const uint8_t *data, size_t size)
+{
+    ByteReader reader(data, size);
+    PforCompressed<T> compressed;
+    uint8_t dimension = 0;
+
+    // 1. 维度与形状
+    reader.get(dimension);
+    reader.get(compressed.count);
+    reader.get(compressed.rows);
+    reader.get(compressed.cols);
+
+    // 2. 块头字段数组
+    std::vector<uint64_t> bases;
+    std::vector<uint8_t> bitWidths;
+    std::vector<uint8_t> exceptionCounts;
+    std::vector<uint32_t> wordOffsets;
+    std::vector<uint32_t> exceptionOffsets;
+    reader.getArray(bases);
+    reader.getArray(bitWidths);
+    reader.getArray(exceptionCounts);
+    reader.getArray(wordOffsets);
+    reader.getArray(exceptionOffsets);
+
+    // 3. 低位与异常
+    reader.getArray(compressed.words);
+    reader.getArray(compressed.exceptionPos);
+    reader.getPacked(compressed.exceptionHigh);
+
+    uint64_t blockCount = (compressed.count + PFOR_BLOCK_SIZE - 1) / PFOR_BLOCK_SIZE;
+    bool valid = reader.finished() && dimension <= ARRAY_2D &&
+                 compressed.count == static_cast<uint64_t>(compressed.rows) * compressed.cols &&
+                 bases.size() == blockCount && bitWidths.size() == blockCount && exceptionCounts.size() == blockCount &&
+                 wordOffsets.size() == blockCount && exceptionOffsets.size() == blockCount &&
+                 compressed.exceptionHigh.count == compressed.exceptionPos.size();
+
+    // 4. 逐块还原块头并检查偏移范围
+    for (uint64_t i = 0; valid && i < blockCount; ++i)
+    {
+        PforBlock block;
+        block.base = bases[i];
+        block.bitWidth = bitWidths[i];
+        block.exceptionCount = exceptionCounts[i];
+        block.wordOffset = wordOffsets[i];
+        block.exceptionOffset = exceptionOffsets[i];
+        valid = block.bitWidth <= PFOR_MAX_WIDTH &&
+                static_cast<uint64_t>(block.wordOffset) + block.bitWidth * PFOR_LANES <= compressed.words.size() &&
+                static_cast<uint64_t>(block.exceptionOffset) + block.exceptionCount <= compressed.exceptionPos.size();
+        compressed.blocks.push_back(block);
+    }
+    for (uint8_t pos : compressed.exceptionPos)
+    {
+        valid = valid && pos < PFOR_BLOCK_SIZE;
+    }
+
+    if (!valid)
+    {
+        std::cerr << LOG_ERROR << "Serialized PatchedFOR is corrupted.\n";
+        return ERROR_PARAM_INVALID;
+    }
+
+    _arrayType = static_cast<ArrayDimension>(dimension);
+    _inputData1D.arrayData.clear();
+    _compressedData = std::move(compressed);
+    _result = CalResult();
+    _result.modeName = "PatchedFOR";
+    return SAA_SUCCESS;
+}
+
+#if ALGORITHM_PFOR
+static bool coord_registered = []
+{
+    CompressorRegistry::Instance().Register("PatchedFOR", [](ElemType type)
+                                            { return MakeTypedCompressor<PatchedFrameOfRef>(type); });
+    return true;
+}();
+#endif
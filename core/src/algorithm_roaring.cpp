@@ -0,0 +1,656 @@
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2026-10-19 17:20:00
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2026-10-19 17:20:00
+ * @FilePath: \SparseArrayAnalyzer\core\src\algorithm_roaring.cpp
+ * @Description: Roaring 风格混合位图：下标按 64K 分块，每块按大小选择数组 / 位图 / 游程容器，非主值按下标顺序存放
+ *
+ */
+#include "sparse_array_analyzer.h"
+#include "alloc_tracker.h"
+#include "perf_counters.h"
+#include "trace_events.h"
+#include "common.h"
+#include "size_estimator.h"
+#include "serialization.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#define ROARING_CHUNK_BITS     (16)
+#define ROARING_CHUNK_SIZE     (1u << ROARING_CHUNK_BITS)
+#define ROARING_ARRAY_MAX      (4096)                 // 超过该基数时位图更小
+#define ROARING_BITMAP_WORDS   (ROARING_CHUNK_SIZE / 64)
+#define ROARING_BITMAP_BYTES   (ROARING_BITMAP_WORDS * sizeof(uint64_t))
+#define ROARING_VERIFY_STRIDE  (97)                   // 解压校验时抽查随机访问的步长
+
+typedef enum roaring_container_type
+{
+    ROARING_ARRAY = 0,  // 有序低 16 位数组
+    ROARING_BITMAP = 1, // 65536 位位图
+    ROARING_RUN = 2,    // (起点, 长度 - 1) 对
+} RoaringContainerType;
+
+typedef struct roaring_container
+{
+    uint32_t key;             // 下标高位
+    uint8_t type;             // RoaringContainerType
+    uint32_t cardinality;     // 本块非主值数量
+    uint32_t rankBase;        // 之前各块非主值总数，即本块首个值在 values 中的位置
+    std::vector<uint16_t> array; // ROARING_ARRAY: 低位；ROARING_RUN: 起点/长度交替
+    std::vector<uint64_t> bitmap;
+} RoaringContainer;
+
+template <typename T>
+struct RoaringCompressed
+{
+    uint64_t count;
+    T mainValue;
+    uint32_t rows;
+    uint32_t cols;
+    std::vector<RoaringContainer> containers;
+    std::vector<T> values;
+};
+
+// 容器序列化后的字节数（不含头）
+static uint64_t ContainerBytes(const RoaringContainer &container)
+{
+    if (container.type == ROARING_BITMAP)
+        return ROARING_BITMAP_BYTES;
+    return container.array.size() * sizeof(uint16_t);
+}
+
+// 由块内有序低位构造最小的容器，runs 为调用方提供的临时缓冲
+static void BuildContainer(const std::pmr::vector<uint16_t> &lows, std::pmr::vector<uint16_t> &runs, RoaringContainer &container)
+{
+    runs.clear();
+    for (size_t i = 0; i < lows.size(); ++i)
+    {
+        if (i == 0 || lows[i] != lows[i - 1] + 1)
+        {
+            runs.push_back(lows[i]);
+            runs.push_back(0);
+        }
+        else
+        {
+            ++runs.back();
+        }
+    }
+
+    uint64_t arrayBytes = lows.size() * sizeof(uint16_t);
+    uint64_t runBytes = runs.size() * sizeof(uint16_t);
+    container.cardinality = static_cast<uint32_t>(lows.size());
+
+    if (runBytes < std::min<uint64_t>(arrayBytes, ROARING_BITMAP_BYTES))
+    {
+        container.type = ROARING_RUN;
+        container.array.assign(runs.begin(), runs.end());
+    }
+    else if (lows.size() <= ROARING_ARRAY_MAX)
+    {
+        container.type = ROARING_ARRAY;
+        container.array.assign(lows.begin(), lows.end());
+    }
+    else
+    {
+        container.type = ROARING_BITMAP;
+        container.bitmap.assign(ROARING_BITMAP_WORDS, 0);
+        for (auto low : lows)
+            container.bitmap[low >> 6] |= 1ull << (low & 63);
+    }
+}
+
+// 块内 contains + rank：返回 low 是否存在，rank 为块内小于 low 的元素个数
+static bool ContainerRank(const RoaringContainer &container, uint16_t low, uint32_t &rank)
+{
+    switch (container.type)
+    {
+    case ROARING_ARRAY:
+    {
+        auto it = std::lower_bound(container.array.begin(), container.array.end(), low);
+        rank = static_cast<uint32_t>(it - container.array.begin());
+        return it != container.array.end() && *it == low;
+    }
+    case ROARING_BITMAP:
+    {
+        uint32_t word = low >> 6;
+        rank = 0;
+        for (uint32_t w = 0; w < word; ++w)
+            rank += __builtin_popcountll(container.bitmap[w]);
+        uint64_t bits = container.bitmap[word];
+        rank += __builtin_popcountll(bits & ((1ull << (low & 63)) - 1));
+        return (bits >> (low & 63)) & 1;
+    }
+    default:
+    {
+        rank = 0;
+        for (size_t i = 0; i < container.array.size(); i += 2)
+        {
+            uint32_t start = container.array[i];
+            uint32_t length = container.array[i + 1] + 1u;
+            if (low < start)
+                return false;
+            if (low < start + length)
+            {
+                rank += low - start;
+                return true;
+            }
+            rank += length;
+        }
+        return false;
+    }
+    }
+}
+
+// 反序列化校验：容器非空且基数与内容一致，低位严格递增、游程互不重叠，且都落在本块长度 chunkLength 内
+static bool ContainerValid(const RoaringContainer &container, uint32_t chunkLength)
+{
+    if (container.cardinality == 0)
+        return false;
+
+    switch (container.type)
+    {
+    case ROARING_ARRAY:
+    {
+        const auto &lows = container.array;
+        if (lows.size() != container.cardinality || lows.back() >= chunkLength)
+            return false;
+        for (size_t i = 1; i < lows.size(); ++i)
+        {
+            if (lows[i] <= lows[i - 1])
+                return false;
+        }
+        return true;
+    }
+    case ROARING_BITMAP:
+    {
+        if (container.bitmap.size() != ROARING_BITMAP_WORDS)
+            return false;
+        uint64_t ones = 0;
+        for (uint32_t w = 0; w < ROARING_BITMAP_WORDS; ++w)
+        {
+            uint64_t bits = container.bitmap[w];
+            ones += __builtin_popcountll(bits);
+            if (bits && w * 64 + 63 - __builtin_clzll(bits) >= chunkLength)
+                return false;
+        }
+        return ones == container.cardinality;
+    }
+    case ROARING_RUN:
+    {
+        const auto &runs = container.array;
+        if (runs.empty() || runs.size() % 2)
+            return false;
+        uint64_t total = 0;
+        uint64_t prevEnd = 0;
+        for (size_t i = 0; i < runs.size(); i += 2)
+        {
+            uint64_t start = runs[i];
+            uint64_t length = runs[i + 1] + 1ull;
+            if ((i && start <= prevEnd) || start + length > chunkLength)
+                return false;
+            prevEnd = start + length;
+            total += length;
+        }
+        return total == container.cardinality;
+    }
+    default:
+        return false;
+    }
+}
+
+template <typename T>
+class RoaringBitmapEnc : public SparseArrayCompressor
+{
+public:
+    int8_t Compress(const ArrayInput &input) override;
+    int8_t Decompress(ArrayInput &output) override;
+    int8_t GetResult(CalResult &result) const override;
+    void Reset() override;
+    int8_t Serialize(std::vector<uint8_t> &out) const override;
+    int8_t Deserialize(const uint8_t *data, size_t size) override;
+    int8_t GetElement(uint64_t index, void *value) const override;
+    int8_t EstimateSize(const SampleStats &stats, SizeEstimate &estimate) const override;
+
+private:
+    int8_t startCompress();
+    int8_t startDecompress(ArrayData1D<T> &output);
+    T lookup(uint64_t index) const;
+
+    // Input
+    ArrayData1D<T> _inputData1D;
+    ArrayData1D<T> _decodeBuffer; // 解压输出缓冲，与调用方的数组交换后在下一轮复用
+    ArrayDimension _arrayType;
+
+    // Output
+    RoaringCompressed<T> _compressedData;
+    CalResult _result;
+};
+
+template <typename T>
+int8_t RoaringBitmapEnc<T>::Compress(const ArrayInput &input)
+{
+    // 0. 清空上一次的结果，保留容量
+    Reset();
+
+    // 1. 预处理输入数据，二维按行展平
+    if (std::holds_alternative<ArrayData1D<T>>(input))
+    {
+        _inputData1D = std::get<ArrayData1D<T>>(input);
+        _arrayType = ARRAY_1D;
+        _compressedData.rows = 1;
+        _compressedData.cols = static_cast<uint32_t>(_inputData1D.arrayData.size());
+    }
+    else if (std::holds_alternative<ArrayData2D<T>>(input))
+    {
+        _arrayType = ARRAY_2D;
+        const auto &vec2d = std::get<ArrayData2D<T>>(input);
+        _compressedData.rows = vec2d.rowCount;
+        _compressedData.cols = vec2d.colCount;
+
+        // 直接展平到输入副本，复用其容量
+        _inputData1D.arrayData.clear();
+        _inputData1D.arrayData.reserve(static_cast<size_t>(_compressedData.rows) * _compressedData.cols);
+        for (const auto &row : vec2d.arrayData)
+        {
+            _inputData1D.arrayData.insert(_inputData1D.arrayData.end(), row.begin(), row.end());
+        }
+    }
+    else
+    {
+        std::cerr << LOG_ERROR << "Input element type is not " << ElemTraits<T>::name << ".\n";
+        return ERROR_PARAM_INVALID;
+    }
+
+    if (_inputData1D.arrayData.empty())
+    {
+        std::cerr << LOG_ERROR << "Input data is empty.\n";
+        return ERROR_INPUT_EMPTY;
+    }
+
+    TraceSpan compressTrace("compress");
+    AllocPhase compressAlloc(_result.compressAlloc);
+    PerfPhase compressPhase(_result.compressPerf);
+    auto start = std::chrono::high_resolution_clock::now();
+    startCompress();
+    auto end = std::chrono::high_resolution_clock::now();
+    compressPhase.stop();
+    compressAlloc.stop();
+    compressTrace.stop();
+
+    // 2. 计算压缩结果：每个容器头记 key(4) + 类型(1) + 基数(4) + rank 前缀(4)
+    uint64_t containerBytes = 0;
+    uint64_t containerElems = 0;
+    for (const auto &container : _compressedData.containers)
+    {
+        containerBytes += 4 + 1 + 4 + 4 + ContainerBytes(container);
+        containerElems += container.array.size() + container.bitmap.size() + 4;
+    }
+
+    _result.modeName = "RoaringBitmap";
+    _result.originElementCount = GetArrayElemCount1D(_inputData1D.arrayData);
+    _result.compressedElementCount = containerElems + _compressedData.values.size();
+
+    _result.originSizeBytes = GetArrayTotalSize1D(_inputData1D.arrayData);
+    _result.compressedSizeBytes = containerBytes + GetArrayTotalSize1D(_compressedData.values) +
+                                  sizeof(uint64_t) + 2 * sizeof(uint32_t) + sizeof(T);
+
+    _result.compressTimeMs = std::chrono::duration<double, std::milli>(end - start).count();
+    _result.decompressTimeMs = 0;
+
+    _result.compressionRatio = (static_cast<double>(_result.compressedSizeBytes) / _result.originSizeBytes) * 100.0;
+
+    // 顺序：按容器批量写入非主值；随机：二分定位容器 + 容器内二分 / popcount 求 rank
+    double nnz = static_cast<double>(_compressedData.values.size());
+    double containers = static_cast<double>(_compressedData.containers.size());
+    _result.seqAccessOps = 1.0 + 2.0 * nnz / std::max<uint64_t>(_result.originElementCount, 1);
+    _result.randomAccessOps = 2.0 + std::log2(containers + 1.0) + std::log2(nnz / std::max(containers, 1.0) + 1.0);
+
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+int8_t RoaringBitmapEnc<T>::startCompress()
+{
+    const auto &data = _inputData1D.arrayData;
+
+    // 1. 统计主值
+    std::pmr::unordered_map<uint64_t, uint64_t> valueCount(_workResource);
+    for (const auto &val : data)
+    {
+        valueCount[ToOrderedKey(val)]++;
+    }
+
+    _compressedData.mainValue = 0;
+    uint64_t mainValueCount = 0;
+    for (const auto &pair : valueCount)
+    {
+        if (pair.second > mainValueCount)
+        {
+            _compressedData.mainValue = FromOrderedKey<T>(pair.first);
+            mainValueCount = pair.second;
+        }
+    }
+    _compressedData.count = data.size();
+
+    // 2. 逐块收集非主值下标的低 16 位，选择容器；输入不足一块时不按整块预留
+    _compressedData.values.reserve(data.size() - mainValueCount);
+    std::pmr::vector<uint16_t> lows(_workResource);
+    std::pmr::vector<uint16_t> runs(_workResource);
+    lows.reserve(std::min<uint64_t>(ROARING_CHUNK_SIZE, data.size()));
+    for (uint64_t begin = 0; begin < data.size(); begin += ROARING_CHUNK_SIZE)
+    {
+        uint64_t end = std::min<uint64_t>(begin + ROARING_CHUNK_SIZE, data.size());
+        lows.clear();
+        for (uint64_t i = begin; i < end; ++i)
+        {
+            if (!SameBits(data[i], _compressedData.mainValue))
+            {
+                lows.push_back(static_cast<uint16_t>(i - begin));
+                _compressedData.values.push_back(data[i]);
+            }
+        }
+        if (lows.empty())
+            continue;
+
+        RoaringContainer container;
+        container.key = static_cast<uint32_t>(begin >> ROARING_CHUNK_BITS);
+        container.rankBase = static_cast<uint32_t>(_compressedData.values.size() - lows.size());
+        BuildContainer(lows, runs, container);
+        _compressedData.containers.push_back(std::move(container));
+    }
+
+    return SAA_SUCCESS;
+}
+
+// 单点读取：二分找容器，容器内 contains + rank 得到 values 下标
+template <typename T>
+T RoaringBitmapEnc<T>::lookup(uint64_t index) const
+{
+    uint32_t key = static_cast<uint32_t>(index >> ROARING_CHUNK_BITS);
+    auto it = std::lower_bound(_compressedData.containers.begin(), _compressedData.containers.end(), key,
+                               [](const RoaringContainer &container, uint32_t k)
+                               { return container.key < k; });
+    if (it == _compressedData.containers.end() || it->key != key)
+        return _compressedData.mainValue;
+
+    uint32_t rank = 0;
+    if (!ContainerRank(*it, static_cast<uint16_t>(index & (ROARING_CHUNK_SIZE - 1)), rank))
+        return _compressedData.mainValue;
+    return _compressedData.values[it->rankBase + rank];
+}
+
+template <typename T>
+int8_t RoaringBitmapEnc<T>::Decompress(ArrayInput &output)
+{
+    // 0. 检查
+    if (_compressedData.count == 0)
+    {
+        std::cerr << LOG_ERROR << "Compressed data is empty.\n";
+        return ERROR_INPUT_EMPTY;
+    }
+
+    // 1. 解压
+    ArrayData1D<T> &tempData = _decodeBuffer; // 复用上一轮的缓冲，startDecompress 覆盖全部内容
+    TraceSpan decompressTrace("decompress");
+    AllocPhase decompressAlloc(_result.decompressAlloc);
+    PerfPhase decompressPhase(_result.decompressPerf);
+    auto start = std::chrono::high_resolution_clock::now();
+    if (startDecompress(tempData) != SAA_SUCCESS)
+    {
+        std::cerr << LOG_ERROR << "Decompressed something error.\n";
+        return ERROR_CALCULATE_ERROR;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    decompressPhase.stop();
+    decompressAlloc.stop();
+    decompressTrace.stop();
+
+    _result.decompressTimeMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+    // 2. 校验整体解压与抽查随机访问，反序列化得到的对象没有原始输入，跳过
+    TraceSpan verifyTrace("verify");
+    if (!_inputData1D.arrayData.empty())
+    {
+        if (!Compare1D(_inputData1D.arrayData, tempData.arrayData))
+        {
+            std::cerr << LOG_ERROR << "Decompressed result error.\n";
+            return ERROR_CALCULATE_ERROR;
+        }
+        for (uint64_t i = 0; i < _compressedData.count; i += ROARING_VERIFY_STRIDE)
+        {
+            if (lookup(i) != _inputData1D.arrayData[i])
+            {
+                std::cerr << LOG_ERROR << "Random access result error at " << i << ".\n";
+                return ERROR_CALCULATE_ERROR;
+            }
+        }
+    }
+    verifyTrace.stop();
+
+    // 3. 维度复原
+    if (_arrayType == ARRAY_1D)
+    {
+        if (auto *ptr1d = std::get_if<ArrayData1D<T>>(&output))
+        {
+            ptr1d->arrayData.swap(tempData.arrayData); // 与缓冲交换，两块内存在重复运行间轮流使用
+        }
+        else
+        {
+            std::cerr << LOG_ERROR << "ArrayInput is not compatible with 1D array.\n";
+            return ERROR_PARAM_INVALID;
+        }
+    }
+    else if (_arrayType == ARRAY_2D)
+    {
+        if (auto *ptr2d = std::get_if<ArrayData2D<T>>(&output))
+        {
+            ArrayData2D<T> &out = *ptr2d; // 复用调用方已有行的容量
+            out.arrayData.resize(_compressedData.rows);
+            for (uint32_t r = 0; r < _compressedData.rows; ++r)
+            {
+                out.arrayData[r].assign(
+                    tempData.arrayData.begin() + static_cast<size_t>(r) * _compressedData.cols,
+                    tempData.arrayData.begin() + static_cast<size_t>(r + 1) * _compressedData.cols);
+            }
+            out.rowCount = _compressedData.rows;
+            out.colCount = _compressedData.cols;
+        }
+        else
+        {
+            std::cerr << LOG_ERROR << "ArrayInput is not compatible with 2D array.\n";
+            return ERROR_PARAM_INVALID;
+        }
+    }
+
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+int8_t RoaringBitmapEnc<T>::startDecompress(ArrayData1D<T> &outData1D)
+{
+    // 1. 整体填充主值
+    outData1D.arrayData.assign(_compressedData.count, _compressedData.mainValue);
+    T *out = outData1D.arrayData.data();
+    const T *values = _compressedData.values.data();
+
+    // 2. 按容器类型写入非主值
+    for (const auto &container : _compressedData.containers)
+    {
+        T *chunk = out + (static_cast<uint64_t>(container.key) << ROARING_CHUNK_BITS);
+        const T *src = values + container.rankBase;
+        switch (container.type)
+        {
+        case ROARING_ARRAY:
+            for (auto low : container.array)
+                chunk[low] = *src++;
+            break;
+        case ROARING_BITMAP:
+            for (uint32_t w = 0; w < ROARING_BITMAP_WORDS; ++w)
+            {
+                uint64_t bits = container.bitmap[w];
+                while (bits)
+                {
+                    chunk[w * 64 + __builtin_ctzll(bits)] = *src++;
+                    bits &= bits - 1;
+                }
+            }
+            break;
+        default:
+            for (size_t i = 0; i < container.array.size(); i += 2)
+            {
+                uint32_t length = container.array[i + 1] + 1u;
+                std::copy(src, src + length, chunk + container.array[i]);
+                src += length;
+            }
+            break;
+        }
+    }
+
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+int8_t RoaringBitmapEnc<T>::EstimateSize(const SampleStats &stats, SizeEstimate &estimate) const
+{
+    // 按平均块基数选择数组（每值 2 字节）或位图（每块 8 KB），游程容器不计入
+    estimate.modeName = "RoaringBitmap";
+    double chunks = std::ceil(stats.elemCount / static_cast<double>(ROARING_CHUNK_SIZE));
+    double chunkCard = stats.nonMainFraction * std::min<double>(stats.elemCount, ROARING_CHUNK_SIZE);
+    double fixedBytes = chunks * (4 + 1 + 4 + 4) + sizeof(uint64_t) + 2 * sizeof(uint32_t) + stats.elemBytes;
+    double indexBytes = sizeof(uint16_t);
+    if (chunkCard > ROARING_ARRAY_MAX)
+    {
+        fixedBytes += chunks * ROARING_BITMAP_BYTES;
+        indexBytes = 0.0;
+    }
+    EstimateByNonMain(stats, fixedBytes, indexBytes + stats.elemBytes, estimate);
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+int8_t RoaringBitmapEnc<T>::GetResult(CalResult &ret) const
+{
+    ret = _result;
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+void RoaringBitmapEnc<T>::Reset()
+{
+    _inputData1D.arrayData.clear();
+    _compressedData.count = 0;
+    _compressedData.containers.clear(); // 各容器的数组随之释放，外层容量保留
+    _compressedData.values.clear();
+    _result = CalResult();
+}
+
+template <typename T>
+int8_t RoaringBitmapEnc<T>::Serialize(std::vector<uint8_t> &out) const
+{
+    ByteWriter writer(out);
+
+    // 1. 维度与形状
+    writer.put(static_cast<uint8_t>(_arrayType));
+    writer.put(_compressedData.count);
+    writer.put(_compressedData.rows);
+    writer.put(_compressedData.cols);
+    writer.put(_compressedData.mainValue);
+
+    // 2. 容器：逐个写头部字段，再按类型写低位数组或位图
+    writer.put(static_cast<uint64_t>(_compressedData.containers.size()));
+    for (const auto &container : _compressedData.containers)
+    {
+        writer.put(container.key);
+        writer.put(container.cardinality);
+        writer.put(container.rankBase);
+        writer.put(container.type);
+        if (container.type == ROARING_BITMAP)
+            writer.putArray(container.bitmap);
+        else
+            writer.putArray(container.array);
+    }
+
+    // 3. 非主值
+    writer.putArray(_compressedData.values);
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+int8_t RoaringBitmapEnc<T>::Deserialize(const uint8_t *data, size_t size)
+{
+    ByteReader reader(data, size);
+    RoaringCompressed<T> compressed;
+    uint8_t dimension = 0;
+
+    // 1. 维度与形状
+    reader.get(dimension);
+    reader.get(compressed.count);
+    reader.get(compressed.rows);
+    reader.get(compressed.cols);
+    reader.get(compressed.mainValue);
+
+    // 2. 容器：键递增且不超过块数，rankBase 为之前各块基数之和，内容与基数一致（末块只到 count 为止）
+    uint64_t containerCount = 0;
+    reader.get(containerCount);
+    uint64_t chunkCount = (compressed.count + ROARING_CHUNK_SIZE - 1) / ROARING_CHUNK_SIZE;
+    bool valid = !reader.failed() && dimension <= ARRAY_2D && containerCount <= chunkCount &&
+                 compressed.count == static_cast<uint64_t>(compressed.rows) * compressed.cols;
+    uint64_t rank = 0;
+    for (uint64_t i = 0; valid && i < containerCount; ++i)
+    {
+        RoaringContainer container{};
+        reader.get(container.key);
+        reader.get(container.cardinality);
+        reader.get(container.rankBase);
+        reader.get(container.type);
+        if (container.type == ROARING_BITMAP)
+            reader.getArray(container.bitmap);
+        else
+            reader.getArray(container.array);
+
+        valid = !reader.failed() && container.key < chunkCount && container.rankBase == rank &&
+                (compressed.containers.empty() || compressed.containers.back().key < container.key) &&
+                ContainerValid(container, static_cast<uint32_t>(std::min<uint64_t>(
+                                              compressed.count - (static_cast<uint64_t>(container.key) << ROARING_CHUNK_BITS),
+                                              ROARING_CHUNK_SIZE)));
+        rank += container.cardinality;
+        compressed.containers.push_back(std::move(container));
+    }
+
+    // 3. 非主值
+    reader.getArray(compressed.values);
+    if (!valid || !reader.finished() || compressed.values.size() != rank)
+    {
+        std::cerr << LOG_ERROR << "Serialized RoaringBitmap is corrupted.\n";
+        return ERROR_PARAM_INVALID;
+    }
+
+    _arrayType = static_cast<ArrayDimension>(dimension);
+    _inputData1D.arrayData.clear();
+    _compressedData = std::move(compressed);
+    _result = CalResult();
+    _result.modeName = "RoaringBitmap";
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+int8_t RoaringBitmapEnc<T>::GetElement(uint64_t index, void *value) const
+{
+    if (index >= _compressedData.count)
+    {
+        return ERROR_INDEX_OUT_OF_RANGE;
+    }
+    *static_cast<T *>(value) = lookup(index);
+    return SAA_SUCCESS;
+}
+
+#if ALGORITHM_ROARING
+static bool coord_registered = []
+{
+    CompressorRegistry::Instance().Register("RoaringBitmap", [](ElemType type)
+                                            { return MakeTypedCompressor<RoaringBitmapEnc>(type); });
+    return true;
+}();
+#endif
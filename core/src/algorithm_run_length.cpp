@@ -8,92 +8,204 @@
  *
  */
 #include "sparse_array_analyzer.h"
+#include "alloc_tracker.h"
+#include "perf_counters.h"
+#include "trace_events.h"
 #include "common.h"
+#include "size_estimator.h"
+#include "bit_packing.hpp"
+#include "linear_order.hpp"
+#include "serialization.hpp"
+#include <algorithm>
 #include <chrono>
 #include <cmath>
 
-typedef struct rle_node
+template <typename T>
+struct RLE_Node
 {
-    uint32_t value;  
+    T value;  
     uint32_t count;
-}RLE_Node;
+};
 
+// 参考帧位打包后的游程：值与长度分两列各自打包
+template <typename T>
+struct RLE_Packed
+{
+    PackedValues<T> values;
+    PackedValues<uint32_t> counts;
+};
+
+template <typename T>
 class RunLengthEnc : public SparseArrayCompressor
 {
 public:
+    explicit RunLengthEnc(bool packValues = false, LinearOrder order = ORDER_AUTO)
+        : _packValues(packValues), _order(order), _usedOrder(ORDER_ROW_MAJOR) {}
+
     int8_t Compress(const ArrayInput &input) override;
     int8_t Decompress(ArrayInput &output) override;
     int8_t GetResult(CalResult &result) const override;
+    void Reset() override;
+    int8_t Serialize(std::vector<uint8_t> &out) const override;
+    int8_t Deserialize(const uint8_t *data, size_t size) override;
+    int8_t EstimateSize(const SampleStats &stats, SizeEstimate &estimate) const override;
 
 private:
     int8_t startCompress();
-    int8_t startDecompress(ArrayData1D &output);
+    int8_t startDecompress(ArrayData1D<T> &output);
+    void linearize(std::pmr::vector<T> &linear) const;
+    uint64_t countRuns(LinearOrder order) const;
+    std::string modeName() const;
+
+    bool _packValues;       // 游程是否做参考帧位打包
+    LinearOrder _order;     // 二维线性化顺序（ORDER_AUTO 时自动选择）
+    LinearOrder _usedOrder; // 实际使用的顺序
 
     // Input
     ArrayDimension _arrayType;
-    ArrayData1D _inputData1D;
+    ArrayData1D<T> _inputData1D;
+    ArrayData1D<T> _decodeBuffer; // 解压输出缓冲，与调用方的数组交换后在下一轮复用
+    uint64_t _count = 0; // 元素总数，一维输入可超过 32 位
+    uint32_t _rows = 0;  // 二维形状，一维时为 0
+    uint32_t _cols = 0;
     
     // Output
     CalResult _result;
-    std::vector<RLE_Node> _compressedData;
+    std::vector<RLE_Node<T>> _compressedData;
+    RLE_Packed<T> _packedData;
 };
 
-int8_t RunLengthEnc::Compress(const ArrayInput &input)
+template <typename T>
+int8_t RunLengthEnc<T>::Compress(const ArrayInput &input)
 {
+    // 0. 清空上一次的结果，保留容量
+    Reset();
+
     // 1. 解析数据类型
-    if(std::holds_alternative<ArrayData1D>(input))
+    if(std::holds_alternative<ArrayData1D<T>>(input))
     {
-        auto &mat = std::get<ArrayData1D>(input);
+        // 固定顺序只对二维有意义，一维时与行优先结果重复
+        if (_order != ORDER_AUTO)
+        {
+            std::cerr << LOG_WARN << "Input data is unsupported dimension.\n";
+            return ERROR_UNSUPPORT_DIMENSION;
+        }
+
+        auto &mat = std::get<ArrayData1D<T>>(input);
         _inputData1D = mat;
         _arrayType = ARRAY_1D;
+        _rows = 0;
+        _cols = 0;
     }
-    else if (std::holds_alternative<ArrayData2D>(input))
+    else if (std::holds_alternative<ArrayData2D<T>>(input))
     {
-        std::cerr << LOG_WARN << "Input data is unsupported dimension.\n";
-        return ERROR_UNSUPPORT_DIMENSION;
+        const auto &mat = std::get<ArrayData2D<T>>(input);
+        _arrayType = ARRAY_2D;
+        _rows = mat.rowCount;
+        _cols = mat.colCount;
+
+        _inputData1D.arrayData.clear();
+        _inputData1D.arrayData.reserve(static_cast<size_t>(_rows) * _cols);
+        for (const auto &row : mat.arrayData)
+        {
+            _inputData1D.arrayData.insert(_inputData1D.arrayData.end(), row.begin(), row.end());
+        }
     }
     else
+    {
+        std::cerr << LOG_ERROR << "Input element type is not " << ElemTraits<T>::name << ".\n";
+        return ERROR_PARAM_INVALID;
+    }
+
+    if (_inputData1D.arrayData.empty())
     {
         std::cerr << LOG_ERROR << "Input data is empty.\n";
         return ERROR_INPUT_EMPTY;
     }
+    _count = _inputData1D.arrayData.size();
 
+    TraceSpan compressTrace("compress");
+    AllocPhase compressAlloc(_result.compressAlloc);
+    PerfPhase compressPhase(_result.compressPerf);
     auto start = std::chrono::high_resolution_clock::now();
     startCompress();
     auto end = std::chrono::high_resolution_clock::now();
+    compressPhase.stop();
+    compressAlloc.stop();
+    compressTrace.stop();
 
-    // 2. 计算压缩结果
-    _result.modeName = "RunLengthEnc";
+    // 2. 计算压缩结果（二维额外记录行列数与线性化顺序）
+    _result.modeName = modeName();
     _result.originElementCount = GetArrayElemCount1D(_inputData1D.arrayData);
-    _result.compressedElementCount = _compressedData.size() * 2; // 每个坐标信息包含2个元素：value, count
+    _result.compressedElementCount = _packedData.counts.count * 2; // 每个坐标信息包含2个元素：value, count
 
     _result.originSizeBytes = GetArrayTotalSize1D(_inputData1D.arrayData);
-    _result.compressedSizeBytes = _compressedData.size() * sizeof(RLE_Node);
+    _result.compressedSizeBytes = _packValues ? PackedValuesBytes(_packedData.values) + PackedValuesBytes(_packedData.counts)
+                                              : _compressedData.size() * sizeof(RLE_Node<T>);
+    if (_arrayType == ARRAY_2D)
+    {
+        _result.compressedSizeBytes += 2 * sizeof(uint32_t) + sizeof(uint8_t);
+    }
 
     _result.compressTimeMs = std::chrono::duration<double, std::milli>(end - start).count();
     _result.decompressTimeMs = 0;
 
     _result.compressionRatio = (static_cast<double>(_result.compressedSizeBytes) / _result.originSizeBytes) * 100.0;
 
+    // 顺序：每游程一次批量填充；随机：无前缀和索引，需回放平均一半游程
+    double runs = static_cast<double>(_packedData.counts.count);
+    _result.seqAccessOps = 1.0 + runs / std::max<uint64_t>(_result.originElementCount, 1);
+    _result.randomAccessOps = 1.0 + runs / 2.0;
+
     return SAA_SUCCESS;
 }
 
-int8_t RunLengthEnc::startCompress() 
+template <typename T>
+int8_t RunLengthEnc<T>::startCompress() 
 {
 #if 1
-    uint32_t currentVal = _inputData1D.arrayData[0];
+    // 1. 二维输入选择线性化顺序：AUTO 时逐个统计游程数取最少者，相同时优先行优先
+    _usedOrder = ORDER_ROW_MAJOR;
+    if (_arrayType == ARRAY_2D && _order != ORDER_AUTO)
+    {
+        _usedOrder = _order;
+    }
+    else if (_arrayType == ARRAY_2D)
+    {
+        uint64_t bestRuns = countRuns(ORDER_ROW_MAJOR);
+        for (int order = ORDER_COL_MAJOR; order < ORDER_COUNT; ++order)
+        {
+            uint64_t runs = countRuns(static_cast<LinearOrder>(order));
+            if (runs < bestRuns)
+            {
+                bestRuns = runs;
+                _usedOrder = static_cast<LinearOrder>(order);
+            }
+        }
+    }
+
+    std::pmr::vector<T> reordered(_workResource);
+    if (_usedOrder != ORDER_ROW_MAJOR)
+    {
+        linearize(reordered);
+    }
+    const T *linear = (_usedOrder != ORDER_ROW_MAJOR) ? reordered.data() : _inputData1D.arrayData.data();
+    const size_t linearSize = _inputData1D.arrayData.size();
+
+    // 2. 游程编码
+    T currentVal = linear[0];
     uint32_t count = 1;
 
-    for (uint32_t i = 1; i < _inputData1D.arrayData.size(); i++)
+    for (size_t i = 1; i < linearSize; i++)
     {
-        if (_inputData1D.arrayData[i] == currentVal)
+        if (SameBits(linear[i], currentVal) && count < UINT32_MAX) // 超长游程拆分
         {
             ++count;
         }
         else
         {
             _compressedData.push_back({currentVal, count});
-            currentVal = _inputData1D.arrayData[i];
+            currentVal = linear[i];
             count = 1;
         }
     }
@@ -101,6 +213,27 @@ int8_t RunLengthEnc::startCompress()
     // The last run
     _compressedData.push_back({currentVal, count});
 
+    // 3. 位打包（可选），未打包时只记录游程数
+    if (_packValues)
+    {
+        std::pmr::vector<T> values(_workResource);
+        std::pmr::vector<uint32_t> counts(_workResource);
+        values.reserve(_compressedData.size());
+        counts.reserve(_compressedData.size());
+        for (const auto &node : _compressedData)
+        {
+            values.push_back(node.value);
+            counts.push_back(node.count);
+        }
+        PackValues(values, _packedData.values);
+        PackValues(counts, _packedData.counts);
+        _compressedData.clear();
+    }
+    else
+    {
+        _packedData.counts.count = _compressedData.size();
+    }
+
 #if 0
     std::cout << LOG_DEBUG << "CompressedData: \n";
     for (const auto &coord : _compressedData)
@@ -115,36 +248,21 @@ int8_t RunLengthEnc::startCompress()
     return SAA_SUCCESS;  // 返回值可以根据实际需要调整
 }
 
-int8_t RunLengthEnc::Decompress(ArrayInput &output)
+template <typename T>
+int8_t RunLengthEnc<T>::Decompress(ArrayInput &output)
 {
     // 0. 检查
-    if (_inputData1D.arrayData.empty())
-    {
-        std::cerr << LOG_ERROR << "Input data is empty.\n";
-        return ERROR_INPUT_EMPTY;
-    }
-
-    if (_arrayType != ARRAY_1D)
-    {
-        std::cerr << LOG_ERROR << "ArrayInput is not compatible with 1D array.\n";
-        return ERROR_UNSUPPORT_DIMENSION;
-    }
-
-    if (_compressedData.empty())
+    if (_packedData.counts.count == 0)
     {
         std::cerr << LOG_ERROR << "Compressed data is empty.\n";
         return ERROR_INPUT_EMPTY;
     }
 
-    auto *ptr1d = std::get_if<ArrayData1D>(&output);
-    if (!ptr1d)
-    {
-        std::cerr << LOG_ERROR << "ArrayInput is not compatible with 2D array.\n";
-        return ERROR_PARAM_INVALID;
-    }
-
     // 1. 解压
-    ArrayData1D tempData;
+    ArrayData1D<T> &tempData = _decodeBuffer; // 复用上一轮的缓冲，startDecompress 覆盖全部内容
+    TraceSpan decompressTrace("decompress");
+    AllocPhase decompressAlloc(_result.decompressAlloc);
+    PerfPhase decompressPhase(_result.decompressPerf);
     auto start = std::chrono::high_resolution_clock::now();
     if (startDecompress(tempData) != SAA_SUCCESS)
     {
@@ -152,41 +270,317 @@ int8_t RunLengthEnc::Decompress(ArrayInput &output)
         return ERROR_CALCULATE_ERROR;
     }
     auto end = std::chrono::high_resolution_clock::now();
-    *ptr1d = tempData;
-    
+    decompressPhase.stop();
+    decompressAlloc.stop();
+    decompressTrace.stop();
+
     _result.decompressTimeMs = std::chrono::duration<double, std::milli>(end - start).count();
 
-    // 2. 校验
-    if(_inputData1D.arrayData != tempData.arrayData)
+    // 2. 校验，反序列化得到的对象没有原始输入，跳过
+    TraceSpan verifyTrace("verify");
+    if (!_inputData1D.arrayData.empty() && !Compare1D(_inputData1D.arrayData, tempData.arrayData))
     {
         std::cerr << LOG_ERROR << "Decompressed result error.\n";
         return ERROR_CALCULATE_ERROR;
     }
+    verifyTrace.stop();
+
+    // 3. 维度复原
+    if (_arrayType == ARRAY_1D)
+    {
+        auto *ptr1d = std::get_if<ArrayData1D<T>>(&output);
+        if (!ptr1d)
+        {
+            std::cerr << LOG_ERROR << "ArrayInput is not compatible with 1D array.\n";
+            return ERROR_PARAM_INVALID;
+        }
+        ptr1d->arrayData.swap(tempData.arrayData); // 与缓冲交换，两块内存在重复运行间轮流使用
+    }
+    else
+    {
+        auto *ptr2d = std::get_if<ArrayData2D<T>>(&output);
+        if (!ptr2d)
+        {
+            std::cerr << LOG_ERROR << "ArrayInput is not compatible with 2D array.\n";
+            return ERROR_PARAM_INVALID;
+        }
+
+        ArrayData2D<T> &out = *ptr2d; // 复用调用方已有行的容量
+        out.rowCount = _rows;
+        out.colCount = _cols;
+        out.arrayData.resize(_rows);
+        for (uint32_t r = 0; r < _rows; ++r)
+        {
+            out.arrayData[r].assign(tempData.arrayData.begin() + static_cast<size_t>(r) * _cols,
+                                    tempData.arrayData.begin() + static_cast<size_t>(r + 1) * _cols);
+        }
+    }
     return SAA_SUCCESS;
 }
 
-int8_t RunLengthEnc::startDecompress(ArrayData1D &outData1D)
+template <typename T>
+int8_t RunLengthEnc<T>::startDecompress(ArrayData1D<T> &outData1D)
 {
-    for (const auto &pair : _compressedData)
+    // 1. 预分配后按游程整段填充；行优先直接写入输出，其它顺序先写入临时线性缓冲
+    const size_t total = static_cast<size_t>(_count);
+    std::pmr::vector<T> linear(_workResource);
+    T *dst = nullptr;
+    if (_usedOrder == ORDER_ROW_MAJOR)
     {
-        outData1D.arrayData.insert(outData1D.arrayData.end(), pair.count, pair.value);
+        outData1D.arrayData.resize(total);
+        dst = outData1D.arrayData.data();
+    }
+    else
+    {
+        linear.resize(total);
+        dst = linear.data();
+    }
+
+    if (_packValues)
+    {
+        std::pmr::vector<T> values(_workResource);
+        std::pmr::vector<uint32_t> counts(_workResource);
+        UnpackValues(_packedData.values, values);
+        UnpackValues(_packedData.counts, counts);
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            dst = std::fill_n(dst, counts[i], values[i]);
+        }
+    }
+    else
+    {
+        for (const auto &pair : _compressedData)
+        {
+            dst = std::fill_n(dst, pair.count, pair.value);
+        }
+    }
+
+    // 2. 非行优先顺序按线性化路径回填为行优先
+    if (_usedOrder != ORDER_ROW_MAJOR)
+    {
+        outData1D.arrayData.resize(total);
+        T *out = outData1D.arrayData.data();
+        const T *src = linear.data();
+        const uint32_t cols = _cols;
+        ForEachInOrder(_usedOrder, _rows, _cols, [&](uint32_t r, uint32_t c)
+                       { out[static_cast<size_t>(r) * cols + c] = *src++; });
     }
 
     // PrintVector1D(outData1D.arrayData);
     return SAA_SUCCESS;
 }
 
-int8_t RunLengthEnc::GetResult(CalResult &ret) const
+template <typename T>
+void RunLengthEnc<T>::linearize(std::pmr::vector<T> &linear) const
+{
+    linear.clear();
+    linear.reserve(_inputData1D.arrayData.size());
+    const T *src = _inputData1D.arrayData.data();
+    const uint32_t cols = _cols;
+    ForEachInOrder(_usedOrder, _rows, _cols, [&](uint32_t r, uint32_t c)
+                   { linear.push_back(src[static_cast<size_t>(r) * cols + c]); });
+}
+
+template <typename T>
+uint64_t RunLengthEnc<T>::countRuns(LinearOrder order) const
+{
+    // 只统计相邻值变化次数，不生成线性化副本
+    const T *src = _inputData1D.arrayData.data();
+    const uint32_t cols = _cols;
+    uint64_t runs = 0;
+    const T *prev = nullptr;
+    ForEachInOrder(order, _rows, _cols, [&](uint32_t r, uint32_t c)
+                   {
+                       const T *cur = src + static_cast<size_t>(r) * cols + c;
+                       if (!prev || *cur != *prev)
+                           ++runs;
+                       prev = cur; });
+    return runs;
+}
+
+template <typename T>
+std::string RunLengthEnc<T>::modeName() const
+{
+    std::string name = _packValues ? "RunLengthEnc-FOR" : "RunLengthEnc";
+    if (_order != ORDER_AUTO)
+    {
+        name += std::string("-") + LinearOrderName(_order);
+    }
+    else if (_arrayType == ARRAY_2D && _usedOrder != ORDER_ROW_MAJOR)
+    {
+        name += std::string("[") + LinearOrderName(_usedOrder) + "]"; // 自动选择的顺序
+    }
+    return name;
+}
+
+template <typename T>
+int8_t RunLengthEnc<T>::EstimateSize(const SampleStats &stats, SizeEstimate &estimate) const
+{
+    // 每个游程一个 RLE_Node；位打包时值按样本位宽、长度按 32 位上限保守估计
+    // 二维样本按行统计游程，即行优先顺序下的游程数，其他顺序只会在自动选择时更少
+    if (!stats.is2D && _order != ORDER_AUTO)
+    {
+        return ERROR_UNSUPPORT_DIMENSION;
+    }
+    estimate.modeName = _packValues ? "RunLengthEnc-FOR" : "RunLengthEnc";
+    if (_order != ORDER_AUTO)
+    {
+        estimate.modeName += std::string("-") + LinearOrderName(_order);
+    }
+    double fixedBytes = stats.is2D ? 2 * sizeof(uint32_t) + sizeof(uint8_t) : 0.0;
+    if (_packValues)
+    {
+        EstimateByRuns(stats, fixedBytes + 2 * (sizeof(uint64_t) + 1), (stats.packedBitWidth + 32) / 8.0, estimate);
+    }
+    else
+    {
+        EstimateByRuns(stats, fixedBytes, sizeof(RLE_Node<T>), estimate);
+    }
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+int8_t RunLengthEnc<T>::GetResult(CalResult &ret) const
 {
     ret = _result;
     return SAA_SUCCESS;
 }
 
+template <typename T>
+void RunLengthEnc<T>::Reset()
+{
+    _inputData1D.arrayData.clear();
+    _compressedData.clear();
+    PackedValuesClear(_packedData.values);
+    PackedValuesClear(_packedData.counts);
+    _result = CalResult();
+}
+
+template <typename T>
+int8_t RunLengthEnc<T>::Serialize(std::vector<uint8_t> &out) const
+{
+    ByteWriter writer(out);
+
+    // 1. 模式、顺序、维度与形状
+    writer.put(static_cast<uint8_t>(_packValues));
+    writer.put(static_cast<uint8_t>(_usedOrder));
+    writer.put(static_cast<uint8_t>(_arrayType));
+    writer.put(_count);
+    writer.put(_rows);
+    writer.put(_cols);
+
+    // 2. 游程：值与长度拆成两个数组，避免结构体填充字节
+    if (_packValues)
+    {
+        writer.putPacked(_packedData.values);
+        writer.putPacked(_packedData.counts);
+        return SAA_SUCCESS;
+    }
+
+    std::vector<T> values;
+    std::vector<uint32_t> counts;
+    values.reserve(_compressedData.size());
+    counts.reserve(_compressedData.size());
+    for (const auto &node : _compressedData)
+    {
+        values.push_back(node.value);
+        counts.push_back(node.count);
+    }
+    writer.putArray(values);
+    writer.putArray(counts);
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+int8_t RunLengthEnc<T>::Deserialize(const uint8_t *data, size_t size)
+{
+    ByteReader reader(data, size);
+    uint8_t packValues = 0;
+    uint8_t order = 0;
+    uint8_t dimension = 0;
+    uint64_t elemCount = 0;
+    uint32_t rows = 0;
+    uint32_t cols = 0;
+
+    // 1. 模式、顺序、维度与形状
+    reader.get(packValues);
+    reader.get(order);
+    reader.get(dimension);
+    reader.get(elemCount);
+    reader.get(rows);
+    reader.get(cols);
+
+    // 2. 游程：解包后检查总长度，解压时按此预分配
+    RLE_Packed<T> packed;
+    std::vector<T> values;
+    std::vector<uint32_t> counts;
+    if (packValues)
+    {
+        reader.getPacked(packed.values);
+        reader.getPacked(packed.counts);
+        // 每个游程至少一个元素，先比较数量再解包，避免按损坏的计数分配
+        if (!reader.failed() && packed.values.count == packed.counts.count && packed.counts.count <= elemCount)
+        {
+            UnpackValues(packed.counts, counts);
+            values.resize(packed.values.count);
+        }
+    }
+    else
+    {
+        reader.getArray(values);
+        reader.getArray(counts);
+    }
+
+    uint64_t total = 0;
+    for (uint32_t count : counts)
+        total += count;
+    bool shapeValid = (dimension == ARRAY_2D) ? elemCount == static_cast<uint64_t>(rows) * cols
+                                              : (order == ORDER_ROW_MAJOR && rows == 0 && cols == 0);
+    if (!reader.finished() || order >= ORDER_COUNT || dimension > ARRAY_2D || values.size() != counts.size() ||
+        counts.empty() || total != elemCount || !shapeValid)
+    {
+        std::cerr << LOG_ERROR << "Serialized RunLengthEnc is corrupted.\n";
+        return ERROR_PARAM_INVALID;
+    }
+
+    _packValues = packValues;
+    _usedOrder = static_cast<LinearOrder>(order);
+    _arrayType = static_cast<ArrayDimension>(dimension);
+    _count = elemCount;
+    _rows = rows;
+    _cols = cols;
+    _inputData1D.arrayData.clear();
+    _compressedData.clear();
+    if (packValues)
+    {
+        _packedData = std::move(packed);
+    }
+    else
+    {
+        _compressedData.reserve(values.size());
+        for (size_t i = 0; i < values.size(); ++i)
+            _compressedData.push_back({values[i], counts[i]});
+        _packedData = RLE_Packed<T>();
+        _packedData.counts.count = _compressedData.size();
+    }
+    _result = CalResult();
+    _result.modeName = modeName();
+    return SAA_SUCCESS;
+}
+
 #if ALGORITHM_RUN_LENGTH
 static bool coord_registered = []
 {
-    CompressorRegistry::Instance().Register("RunLengthEnc", []
-                                            { return std::make_unique<RunLengthEnc>(); });
+    CompressorRegistry::Instance().Register("RunLengthEnc", [](ElemType type)
+                                            { return MakeTypedCompressor<RunLengthEnc>(type); });
+    CompressorRegistry::Instance().Register("RunLengthEnc-FOR", [](ElemType type)
+                                            { return MakeTypedCompressor<RunLengthEnc>(type, true); });
+    CompressorRegistry::Instance().Register("RunLengthEnc-Col", [](ElemType type)
+                                            { return MakeTypedCompressor<RunLengthEnc>(type, false, ORDER_COL_MAJOR); });
+    CompressorRegistry::Instance().Register("RunLengthEnc-Morton", [](ElemType type)
+                                            { return MakeTypedCompressor<RunLengthEnc>(type, false, ORDER_MORTON); });
+    CompressorRegistry::Instance().Register("RunLengthEnc-Hilbert", [](ElemType type)
+                                            { return MakeTypedCompressor<RunLengthEnc>(type, false, ORDER_HILBERT); });
     return true;
 }();
 #endif
\ No newline at end of file
@@ -0,0 +1,227 @@
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2026-10-20 01:10:00
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2026-10-20 01:10:00
+ * @FilePath: \SparseArrayAnalyzer\core\src\alloc_tracker.cpp
+ * @Description: 全局 operator new / delete 改为 malloc / free 并按分配器实际块大小计数，释放时无需额外的大小头；
+ *               只有当前线程挂着阶段时才计数。对齐版本（align_val_t）未替换，仍走标准库实现且不计数
+ *
+ */
+#include "alloc_tracker.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#if defined(_WIN32)
+#include <malloc.h>
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
+
+struct AllocContext
+{
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<int64_t> live{0}; // 阶段开始前分配、阶段内释放的块会使其为负
+    std::atomic<int64_t> peak{0};
+};
+
+static std::atomic<bool> g_allocEnabled{false};
+static thread_local AllocContext *t_allocContext = nullptr;
+
+void EnableAllocTracking()
+{
+    g_allocEnabled = true;
+}
+
+bool AllocTrackingEnabled()
+{
+    return g_allocEnabled.load(std::memory_order_relaxed);
+}
+
+AllocContext *CurrentAllocContext()
+{
+    return t_allocContext;
+}
+
+static int64_t BlockSize(void *ptr)
+{
+#if defined(_WIN32)
+    return static_cast<int64_t>(_msize(ptr));
+#elif defined(__APPLE__)
+    return static_cast<int64_t>(malloc_size(ptr));
+#else
+    return static_cast<int64_t>(malloc_usable_size(ptr));
+#endif
+}
+
+static void RecordAlloc(void *ptr)
+{
+    AllocContext *context = t_allocContext;
+    if (!context || !ptr)
+    {
+        return;
+    }
+
+    int64_t size = BlockSize(ptr);
+    context->count.fetch_add(1, std::memory_order_relaxed);
+    context->bytes.fetch_add(static_cast<uint64_t>(size), std::memory_order_relaxed);
+    int64_t live = context->live.fetch_add(size, std::memory_order_relaxed) + size;
+    int64_t peak = context->peak.load(std::memory_order_relaxed);
+    while (live > peak && !context->peak.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+    {
+    }
+}
+
+static void RecordFree(void *ptr)
+{
+    AllocContext *context = t_allocContext;
+    if (context && ptr)
+    {
+        context->live.fetch_sub(BlockSize(ptr), std::memory_order_relaxed);
+    }
+}
+
+// 与标准实现一致：失败时调用 new_handler 后重试，没有 handler 时返回空
+static void *AllocateBlock(std::size_t size)
+{
+    if (size == 0)
+    {
+        size = 1;
+    }
+
+    void *ptr = nullptr;
+    while ((ptr = std::malloc(size)) == nullptr)
+    {
+        std::new_handler handler = std::get_new_handler();
+        if (!handler)
+        {
+            return nullptr;
+        }
+        handler();
+    }
+    RecordAlloc(ptr);
+    return ptr;
+}
+
+static void *AllocateBlockNoThrow(std::size_t size) noexcept
+{
+    try
+    {
+        return AllocateBlock(size);
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+static void FreeBlock(void *ptr) noexcept
+{
+    RecordFree(ptr);
+    std::free(ptr);
+}
+
+void *operator new(std::size_t size)
+{
+    void *ptr = AllocateBlock(size);
+    if (!ptr)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    return AllocateBlockNoThrow(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    return AllocateBlockNoThrow(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    FreeBlock(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    FreeBlock(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    FreeBlock(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept
+{
+    FreeBlock(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept
+{
+    FreeBlock(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept
+{
+    FreeBlock(ptr);
+}
+
+AllocPhase::AllocPhase(AllocStats &stats)
+{
+    if (!AllocTrackingEnabled() || t_allocContext)
+    {
+        return;
+    }
+
+    // 先分配计数再挂到线程上，计数本身不计入阶段
+    _context = new AllocContext();
+    _stats = &stats;
+    t_allocContext = _context;
+}
+
+AllocPhase::~AllocPhase()
+{
+    stop();
+}
+
+void AllocPhase::stop()
+{
+    if (!_context)
+    {
+        return;
+    }
+
+    t_allocContext = nullptr;
+    _stats->tracked = true;
+    _stats->allocCount = _context->count.load(std::memory_order_relaxed);
+    _stats->allocBytes = _context->bytes.load(std::memory_order_relaxed);
+    _stats->peakBytes = static_cast<uint64_t>(std::max<int64_t>(_context->peak.load(std::memory_order_relaxed), 0));
+    delete _context;
+    _context = nullptr;
+    _stats = nullptr;
+}
+
+AllocContextGuard::AllocContextGuard(AllocContext *context)
+{
+    _previous = t_allocContext;
+    t_allocContext = context;
+}
+
+AllocContextGuard::~AllocContextGuard()
+{
+    t_allocContext = _previous;
+}
@@ -0,0 +1,358 @@
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2026-10-19 23:40:00
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2026-10-19 23:40:00
+ * @FilePath: \SparseArrayAnalyzer\core\src\batch_analyzer.cpp
+ * @Description: 每个文件先作为一个加载任务，加载后把各算法作为子任务提交到本线程队列；
+ *               大文件的算法任务会被空闲线程窃取，输入数据在最后一个算法任务结束后释放
+ *
+ */
+#include "batch_analyzer.h"
+#include "trace_events.h"
+#include "work_arena.h"
+#include "work_stealing_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+
+static void AddJob(const fs::path &path, ElemType textType, const std::vector<std::string> &fields,
+                   std::vector<BatchJob> &jobs)
+{
+    BatchJob job;
+    job.path = path.string();
+    std::error_code ec;
+    job.fileBytes = fs::file_size(path, ec);
+    job.isBinary = IsBinaryArrayFile(job.path);
+    job.elemType = textType;
+
+    // 1. 二进制输入读取文件头
+    if (job.isBinary)
+    {
+        BinaryArrayHeader header;
+        if (ReadBinaryArrayHeader(job.path, header) != SAA_SUCCESS)
+            return;
+        job.elemType = header.elemType;
+        job.dimension = header.dimension;
+        job.rows = static_cast<uint32_t>(header.rows);
+        job.cols = static_cast<uint32_t>(header.cols);
+    }
+    // 2. 文本输入按清单给出的形状，字段顺序与命令行位置参数一致
+    else if (fields.size() >= 4 && fields[1] == "2")
+    {
+        job.dimension = ARRAY_2D;
+        job.cols = ParseInt(fields[2].c_str());
+        job.rows = ParseInt(fields[3].c_str());
+    }
+    jobs.push_back(job);
+}
+
+int8_t CollectBatchJobs(const std::string &source, ElemType textType, std::vector<BatchJob> &jobs)
+{
+    jobs.clear();
+    std::error_code ec;
+    if (fs::is_directory(source, ec))
+    {
+        for (const auto &entry : fs::directory_iterator(source, ec))
+        {
+            if (!entry.is_regular_file(ec))
+                continue;
+            std::string ext = entry.path().extension().string();
+            std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+            if (IsBinaryArrayFile(entry.path().string()) || ext == ".txt" || ext == ".csv")
+                AddJob(entry.path(), textType, {entry.path().string()}, jobs);
+        }
+    }
+    else
+    {
+        std::ifstream manifest(source);
+        if (!manifest.is_open())
+        {
+            std::cerr << LOG_ERROR << "Failed to open batch input: " << source << std::endl;
+            return ERROR_PARAM_INVALID;
+        }
+
+        fs::path base = fs::path(source).parent_path();
+        std::string line;
+        while (std::getline(manifest, line))
+        {
+            std::istringstream iss(line);
+            std::vector<std::string> fields;
+            for (std::string field; iss >> field;)
+                fields.push_back(field);
+            if (fields.empty() || fields[0][0] == '#')
+                continue;
+
+            fs::path path(fields[0]);
+            if (path.is_relative())
+                path = base / path;
+            if (!fs::is_regular_file(path, ec))
+            {
+                std::cerr << LOG_WARN << "Batch input not found, skipped: " << path.string() << "\n";
+                continue;
+            }
+            AddJob(path, textType, fields, jobs);
+        }
+    }
+
+    if (jobs.empty())
+    {
+        std::cerr << LOG_ERROR << "No array files found in " << source << std::endl;
+        return ERROR_INPUT_EMPTY;
+    }
+
+    // 大文件先调度，尾部只剩小任务，负载更均衡
+    std::stable_sort(jobs.begin(), jobs.end(), [](const BatchJob &a, const BatchJob &b)
+                     { return a.fileBytes > b.fileBytes; });
+    return SAA_SUCCESS;
+}
+
+// 报告逐条写出，多线程共用一把锁
+class BatchReportWriter
+{
+public:
+    int8_t open(const std::string &path)
+    {
+        _format = ReportFormatFromPath(path);
+        _file.open(path, std::ios::trunc);
+        if (!_file.is_open())
+        {
+            std::cerr << LOG_ERROR << "Failed to open file: " << path << std::endl;
+            return ERROR_PARAM_INVALID;
+        }
+        if (_format == REPORT_CSV)
+            _file << "file,type,dimension,rows,cols,algorithm,mode,origin_bytes,compressed_bytes,ratio_percent,compress_ms,decompress_ms,compress_peak_bytes,decompress_peak_bytes,status\n";
+        else
+            _file << "[";
+        return SAA_SUCCESS;
+    }
+
+    void write(const BatchJob &job, const std::string &algorithm, const CalResult &result, const std::string &status)
+    {
+        std::ostringstream row;
+        row << std::fixed << std::setprecision(3);
+        if (_format == REPORT_CSV)
+        {
+            row << CsvField(job.path) << ',' << ElemTypeName(job.elemType) << ',' << (job.dimension == ARRAY_2D ? 2 : 1) << ','
+                << job.rows << ',' << job.cols << ',' << CsvField(algorithm) << ',' << CsvField(result.modeName) << ','
+                << result.originSizeBytes << ',' << result.compressedSizeBytes << ',' << result.compressionRatio << ','
+                << result.compressTimeMs << ',' << result.decompressTimeMs << ',' << peakField(result.compressAlloc) << ','
+                << peakField(result.decompressAlloc) << ',' << status << '\n';
+        }
+        else
+        {
+            row << "\n  {\"file\": " << JsonString(job.path) << ", \"type\": \"" << ElemTypeName(job.elemType)
+                << "\", \"dimension\": " << (job.dimension == ARRAY_2D ? 2 : 1) << ", \"rows\": " << job.rows
+                << ", \"cols\": " << job.cols << ", \"algorithm\": " << JsonString(algorithm)
+                << ", \"mode\": " << JsonString(result.modeName) << ", \"origin_bytes\": " << result.originSizeBytes
+                << ", \"compressed_bytes\": " << result.compressedSizeBytes << ", \"ratio_percent\": " << result.compressionRatio
+                << ", \"compress_ms\": " << result.compressTimeMs << ", \"decompress_ms\": " << result.decompressTimeMs
+                << ", \"compress_peak_bytes\": " << peakField(result.compressAlloc)
+                << ", \"decompress_peak_bytes\": " << peakField(result.decompressAlloc) << ", \"status\": \"" << status << "\"}";
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_format == REPORT_JSON && _records > 0)
+            _file << ',';
+        _file << row.str();
+        ++_records;
+    }
+
+    int8_t close()
+    {
+        if (_format == REPORT_JSON)
+            _file << (_records ? "\n]\n" : "]\n");
+        _file.close();
+        return _file ? SAA_SUCCESS : ERROR_UNKNOW_ERROR;
+    }
+
+private:
+    // 未开启 --track-alloc 时 CSV 留空、JSON 为 null
+    std::string peakField(const AllocStats &stats) const
+    {
+        if (!stats.tracked)
+            return (_format == REPORT_JSON) ? "null" : "";
+        return std::to_string(stats.peakBytes);
+    }
+
+    ReportFormat _format = REPORT_CSV;
+    std::ofstream _file;
+    std::mutex _mutex;
+    uint64_t _records = 0;
+};
+
+struct BatchContext
+{
+    const std::vector<std::string> &algorithms;
+    WorkStealingPool &pool;
+    BatchReportWriter &writer;
+    std::atomic<uint64_t> failedFiles{0};
+    std::atomic<uint64_t> tasks{0};
+    std::atomic<uint64_t> failedTasks{0};
+};
+
+// 工作线程各自缓存压缩器实例与解压输出，同一（算法, 元素类型）在多个文件间复用容量；
+// 临时容器取自本线程的 WorkArena，每个任务开始时回卷
+struct CachedCompressor
+{
+    std::unique_ptr<SparseArrayCompressor> compressor;
+    ArrayInput output;
+};
+
+struct WorkerCache
+{
+    WorkArena arena;
+    std::unordered_map<std::string, CachedCompressor> compressors; // 键：算法名 + 元素类型
+};
+
+static thread_local WorkerCache t_workerCache;
+
+template <typename T>
+static CachedCompressor *AcquireCompressor(const std::string &mode, ArrayDimension dimension)
+{
+    std::string key = mode + "#" + ElemTraits<T>::name;
+    auto it = t_workerCache.compressors.find(key);
+    if (it == t_workerCache.compressors.end())
+    {
+        auto compressor = CompressorRegistry::Instance().Create(mode, ElemTraits<T>::type);
+        if (!compressor)
+            return nullptr;
+        compressor->SetMemoryResource(&t_workerCache.arena);
+        it = t_workerCache.compressors.emplace(key, CachedCompressor{std::move(compressor), ArrayInput{}}).first;
+    }
+
+    // 输出维度与上一个文件不同时换成对应的空数组
+    CachedCompressor &cached = it->second;
+    if (dimension == ARRAY_2D && !std::holds_alternative<ArrayData2D<T>>(cached.output))
+        cached.output = ArrayData2D<T>{};
+    else if (dimension != ARRAY_2D && !std::holds_alternative<ArrayData1D<T>>(cached.output))
+        cached.output = ArrayData1D<T>{};
+    return &cached;
+}
+
+template <typename T>
+static void CompressTask(const BatchJob &job, const ArrayInput &input, const std::string &mode, BatchContext &ctx)
+{
+    TraceSpan taskTrace("task", TracingEnabled() ? mode + " " + job.path : std::string());
+    CalResult result;
+    int8_t ret = ERROR_UNSUPPORT_FEATURE;
+    CachedCompressor *cached = AcquireCompressor<T>(mode, job.dimension);
+    if (cached)
+    {
+        SparseArrayCompressor *compressor = cached->compressor.get();
+        ArrayInput &output = cached->output;
+        t_workerCache.arena.Rewind();
+        ret = compressor->Compress(input);
+        if (ret == SAA_SUCCESS)
+            ret = compressor->Decompress(output);
+        if (ret == SAA_SUCCESS)
+            ret = compressor->GetResult(result);
+    }
+
+    // 不支持该维度（如一维输入上的 CSR）不计为失败
+    std::string status = "ok";
+    if (ret == ERROR_UNSUPPORT_DIMENSION)
+        status = "unsupported";
+    else if (ret != SAA_SUCCESS)
+        status = "error:" + std::to_string(ret);
+
+    ctx.tasks.fetch_add(1, std::memory_order_relaxed);
+    if (ret != SAA_SUCCESS && ret != ERROR_UNSUPPORT_DIMENSION)
+        ctx.failedTasks.fetch_add(1, std::memory_order_relaxed);
+    ctx.writer.write(job, mode, result, status);
+}
+
+template <typename T>
+static void LoadTask(const BatchJob &job, BatchContext &ctx)
+{
+    // 1. 加载数组
+    std::vector<T> data;
+    if (job.isBinary)
+    {
+        BinaryArrayHeader header;
+        LoadArrayFromBin<T>(job.path, header, data); // 失败时 data 为空，下面按加载失败处理
+    }
+    else
+    {
+        data = LoadArrayFromTxt<T>(job.path);
+    }
+
+    auto input = std::make_shared<ArrayInput>();
+    bool loaded = !data.empty();
+    if (loaded && job.dimension == ARRAY_2D)
+    {
+        ArrayData2D<T> array2D;
+        array2D.rowCount = job.rows;
+        array2D.colCount = job.cols;
+        loaded = ReshapeTo2D(data, job.rows, job.cols, array2D.arrayData) == SAA_SUCCESS;
+        *input = std::move(array2D);
+    }
+    else if (loaded)
+    {
+        ArrayData1D<T> array1D;
+        array1D.arrayData = std::move(data);
+        *input = std::move(array1D);
+    }
+
+    if (!loaded)
+    {
+        ctx.failedFiles.fetch_add(1, std::memory_order_relaxed);
+        ctx.writer.write(job, "", CalResult(), "load_failed");
+        return;
+    }
+
+    // 2. 各算法作为子任务提交到本线程队列，空闲线程可窃取
+    std::shared_ptr<const ArrayInput> shared = input;
+    for (const auto &mode : ctx.algorithms)
+    {
+        ctx.pool.submit([&job, &ctx, shared, &mode]
+                        { CompressTask<T>(job, *shared, mode, ctx); });
+    }
+}
+
+int8_t RunBatchAnalysis(const std::vector<BatchJob> &jobs, const std::vector<std::string> &algorithms,
+                        uint32_t threadCount, const std::string &reportPath, BatchStats &stats)
+{
+    BatchReportWriter writer;
+    int8_t ret = writer.open(reportPath);
+    if (ret != SAA_SUCCESS)
+    {
+        return ret;
+    }
+
+    std::vector<std::string> modes = algorithms.empty() ? CompressorRegistry::Instance().ListAlgorithms() : algorithms;
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    // 1. 加载任务轮流放入各线程队列；逆序提交，使每个队列尾部（本线程先取）为最大的文件
+    auto start = std::chrono::high_resolution_clock::now();
+    WorkStealingPool pool(threadCount);
+    BatchContext ctx{modes, pool, writer};
+    for (size_t i = jobs.size(); i-- > 0;)
+    {
+        const BatchJob &job = jobs[i];
+        pool.submit([&job, &ctx]
+                    { DispatchElemType(job.elemType, [&](auto tag)
+                                       { LoadTask<decltype(tag)>(job, ctx); }); },
+                    static_cast<uint32_t>(i));
+    }
+
+    // 2. 执行并汇总
+    stats.stolenTasks = pool.run();
+    stats.wallTimeMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    stats.fileCount = jobs.size();
+    stats.failedFiles = ctx.failedFiles.load();
+    stats.taskCount = ctx.tasks.load();
+    stats.failedTasks = ctx.failedTasks.load();
+    stats.threadCount = pool.threadCount();
+    return writer.close();
+}
@@ -0,0 +1,194 @@
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2026-10-19 15:20:00
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2026-10-19 15:20:00
+ * @FilePath: \SparseArrayAnalyzer\core\src\bit_packing.hpp
+ * @Description: 参考帧（Frame-of-Reference）位打包，各压缩格式可选的负载压缩阶段
+ *
+ */
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+// 元素与有序无符号键互相映射，键的大小顺序与元素一致：
+// 无符号数不变，有符号数翻转符号位，浮点数按 IEEE 754 位模式映射为全序
+template <typename T>
+inline uint64_t ToOrderedKey(T value)
+{
+    if constexpr (std::is_same_v<T, float>)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+    }
+    else if constexpr (std::is_signed_v<T>)
+    {
+        using U = std::make_unsigned_t<T>;
+        return static_cast<U>(value) ^ (U(1) << (sizeof(T) * 8 - 1));
+    }
+    else
+    {
+        return value;
+    }
+}
+
+template <typename T>
+inline T FromOrderedKey(uint64_t key)
+{
+    if constexpr (std::is_same_v<T, float>)
+    {
+        uint32_t bits = static_cast<uint32_t>(key);
+        bits = (bits & 0x80000000u) ? (bits & 0x7FFFFFFFu) : ~bits;
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    else if constexpr (std::is_signed_v<T>)
+    {
+        using U = std::make_unsigned_t<T>;
+        return static_cast<T>(static_cast<U>(key) ^ (U(1) << (sizeof(T) * 8 - 1)));
+    }
+    else
+    {
+        return static_cast<T>(key);
+    }
+}
+
+// 按位模式判等：NaN 与自身相等，+0.0 / -0.0 视为不同；主值与游程判断都用它，保证解压逐位还原
+template <typename T>
+inline bool SameBits(T a, T b)
+{
+    return ToOrderedKey(a) == ToOrderedKey(b);
+}
+
+template <typename T>
+struct PackedValues
+{
+    uint64_t count = 0;
+    uint64_t base = 0;           // 最小键（参考帧）
+    uint8_t bitWidth = 0;        // 每个值减去 base 后的位宽
+    std::vector<uint64_t> words; // 末尾多留一个填充字，解包时无需越界判断
+};
+
+inline uint8_t BitWidthOf(uint64_t maxDelta)
+{
+    uint8_t width = 0;
+    while (width < 64 && (maxDelta >> width) != 0)
+        ++width;
+    return width;
+}
+
+// 清空但保留 words 容量，压缩器 Reset 后复用
+template <typename T>
+inline void PackedValuesClear(PackedValues<T> &packed)
+{
+    packed.count = 0;
+    packed.base = 0;
+    packed.bitWidth = 0;
+    packed.words.clear();
+}
+
+template <typename T, typename Alloc>
+void PackValues(const std::vector<T, Alloc> &values, PackedValues<T> &packed)
+{
+    PackedValuesClear(packed);
+    packed.count = values.size();
+    if (values.empty())
+        return;
+
+    // 1. 求参考帧与位宽
+    uint64_t minKey = ToOrderedKey(values[0]);
+    uint64_t maxKey = minKey;
+    for (const auto &val : values)
+    {
+        uint64_t key = ToOrderedKey(val);
+        minKey = std::min(minKey, key);
+        maxKey = std::max(maxKey, key);
+    }
+    packed.base = minKey;
+    packed.bitWidth = BitWidthOf(maxKey - minKey);
+
+    // 2. 按位宽依次写入 64 位字，跨字的值拆成两段
+    uint64_t totalBits = packed.count * packed.bitWidth;
+    packed.words.assign(std::max<uint64_t>((totalBits + 63) / 64 + 1, 2), 0); // 位宽为 0 时读取第 1 个字也不越界
+    uint64_t bitPos = 0;
+    for (const auto &val : values)
+    {
+        uint64_t delta = ToOrderedKey(val) - minKey;
+        uint64_t word = bitPos >> 6;
+        uint32_t shift = bitPos & 63;
+        packed.words[word] |= delta << shift;
+        if (shift + packed.bitWidth > 64)
+            packed.words[word + 1] |= delta >> (64 - shift);
+        bitPos += packed.bitWidth;
+    }
+}
+
+// 不持有内存的打包视图，words 可指向 PackedValues::words 或映射的序列化数据
+template <typename T>
+struct PackedValuesView
+{
+    uint64_t count = 0;
+    uint64_t base = 0;
+    uint8_t bitWidth = 0;
+    const uint64_t *words = nullptr;
+};
+
+template <typename T>
+inline PackedValuesView<T> ViewOf(const PackedValues<T> &packed)
+{
+    return {packed.count, packed.base, packed.bitWidth, packed.words.data()};
+}
+
+// 单值读取：总是读相邻两个字再拼接，避免分支
+template <typename T>
+inline T UnpackValue(const PackedValuesView<T> &packed, uint64_t index)
+{
+    uint64_t mask = (packed.bitWidth == 64) ? ~0ull : ((1ull << packed.bitWidth) - 1);
+    uint64_t bitPos = index * packed.bitWidth;
+    uint64_t word = bitPos >> 6;
+    uint32_t shift = bitPos & 63;
+    uint64_t bits = (packed.words[word] >> shift) | ((packed.words[word + 1] << 1) << (63 - shift));
+    return FromOrderedKey<T>(packed.base + (bits & mask));
+}
+
+template <typename T>
+inline T UnpackValue(const PackedValues<T> &packed, uint64_t index)
+{
+    return UnpackValue(ViewOf(packed), index);
+}
+
+// 批量解包到 out（覆盖原内容）
+template <typename T, typename Alloc>
+void UnpackValues(const PackedValues<T> &packed, std::vector<T, Alloc> &out)
+{
+    out.resize(packed.count);
+    if (packed.bitWidth == 0)
+    {
+        std::fill(out.begin(), out.end(), FromOrderedKey<T>(packed.base));
+        return;
+    }
+
+    const uint64_t *words = packed.words.data();
+    const uint64_t mask = (packed.bitWidth == 64) ? ~0ull : ((1ull << packed.bitWidth) - 1);
+    const uint32_t width = packed.bitWidth;
+    uint64_t bitPos = 0;
+    for (uint64_t i = 0; i < packed.count; ++i, bitPos += width)
+    {
+        uint64_t word = bitPos >> 6;
+        uint32_t shift = bitPos & 63;
+        uint64_t bits = (words[word] >> shift) | ((words[word + 1] << 1) << (63 - shift));
+        out[i] = FromOrderedKey<T>(packed.base + (bits & mask));
+    }
+}
+
+// 序列化后的真实占用：打包位流 + 参考帧 + 位宽
+template <typename T>
+inline uint64_t PackedValuesBytes(const PackedValues<T> &packed)
+{
+    return (packed.count * packed.bitWidth + 7) / 8 + sizeof(packed.base) + sizeof(packed.bitWidth);
+}
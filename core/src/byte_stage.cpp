@@ -0,0 +1,229 @@
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2026-10-19 21:10:00
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2026-10-19 21:10:00
+ * @FilePath: \SparseArrayAnalyzer\core\src\byte_stage.cpp
+ * @Description: 序列：token(字面量长度高 4 位 | 匹配长度-4 低 4 位) + 长度扩展字节 + 字面量 + 16 位偏移 + 匹配长度扩展；
+ *               最后一个序列只有字面量
+ *
+ */
+#include "byte_stage.h"
+#include "common.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#define LZ_MIN_MATCH     (4)
+#define LZ_HASH_BITS     (14)
+#define LZ_MAX_OFFSET    (65535)
+#define LZ_LAST_LITERALS (5) // 末尾至少保留的字面量字节数，保证匹配不越过输入末尾
+#define LZ_HEADER_BYTES  (sizeof(uint64_t))
+
+static uint32_t ReadU32(const uint8_t *ptr)
+{
+    uint32_t value;
+    std::memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+static uint32_t HashSequence(uint32_t sequence)
+{
+    return (sequence * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+// 长度 >= 15 时，超出部分按 255 一组写扩展字节
+static void PutLengthExtension(uint64_t length, std::vector<uint8_t> &output)
+{
+    for (length -= 15; length >= 255; length -= 255)
+        output.push_back(255);
+    output.push_back(static_cast<uint8_t>(length));
+}
+
+static bool GetLengthExtension(const uint8_t *&ip, const uint8_t *end, uint64_t &length)
+{
+    uint8_t byte;
+    do
+    {
+        if (ip >= end)
+            return false;
+        byte = *ip++;
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+static void PutSequence(const uint8_t *literals, uint64_t literalLen, uint32_t offset, uint64_t matchLen,
+                        std::vector<uint8_t> &output)
+{
+    uint64_t matchCode = matchLen ? matchLen - LZ_MIN_MATCH : 0;
+    uint8_t token = static_cast<uint8_t>((std::min<uint64_t>(literalLen, 15) << 4) | std::min<uint64_t>(matchCode, 15));
+    output.push_back(token);
+    if (literalLen >= 15)
+        PutLengthExtension(literalLen, output);
+    output.insert(output.end(), literals, literals + literalLen);
+    if (matchLen == 0)
+        return;
+
+    output.push_back(static_cast<uint8_t>(offset & 0xFF));
+    output.push_back(static_cast<uint8_t>(offset >> 8));
+    if (matchCode >= 15)
+        PutLengthExtension(matchCode, output);
+}
+
+int8_t ParseStage2Codec(const std::string &name, Stage2Codec &codec)
+{
+    if (name == "none")
+        codec = STAGE2_NONE;
+    else if (name == "lz")
+        codec = STAGE2_LZ;
+    else
+        return ERROR_PARAM_INVALID;
+    return SAA_SUCCESS;
+}
+
+void LzCompress(const std::vector<uint8_t> &input, std::vector<uint8_t> &output)
+{
+    // 1. 头部：原始长度
+    output.clear();
+    output.reserve(LZ_HEADER_BYTES + input.size() + input.size() / 255 + 16);
+    uint64_t size = input.size();
+    const uint8_t *sizeBytes = reinterpret_cast<const uint8_t *>(&size);
+    output.insert(output.end(), sizeBytes, sizeBytes + sizeof(size));
+
+    // 2. 贪心匹配：哈希表记录每个 4 字节序列最近出现的位置
+    const uint8_t *base = input.data();
+    size_t anchor = 0;
+    size_t pos = 0;
+    if (input.size() > LZ_MIN_MATCH + LZ_LAST_LITERALS)
+    {
+        std::vector<uint32_t> table(1u << LZ_HASH_BITS, UINT32_MAX);
+        size_t matchLimit = input.size() - LZ_LAST_LITERALS;
+        while (pos + LZ_MIN_MATCH <= matchLimit)
+        {
+            uint32_t sequence = ReadU32(base + pos);
+            uint32_t &slot = table[HashSequence(sequence)];
+            size_t candidate = slot;
+            slot = static_cast<uint32_t>(pos);
+            if (candidate == UINT32_MAX || pos - candidate > LZ_MAX_OFFSET || ReadU32(base + candidate) != sequence)
+            {
+                ++pos;
+                continue;
+            }
+
+            size_t matchLen = LZ_MIN_MATCH;
+            while (pos + matchLen < matchLimit && base[candidate + matchLen] == base[pos + matchLen])
+                ++matchLen;
+
+            PutSequence(base + anchor, pos - anchor, static_cast<uint32_t>(pos - candidate), matchLen, output);
+            pos += matchLen;
+            anchor = pos;
+        }
+    }
+
+    // 3. 剩余字节作为最后一个只含字面量的序列
+    PutSequence(base + anchor, input.size() - anchor, 0, 0, output);
+}
+
+int8_t LzDecompress(const std::vector<uint8_t> &input, std::vector<uint8_t> &output)
+{
+    if (input.size() < LZ_HEADER_BYTES)
+        return ERROR_CALCULATE_ERROR;
+
+    uint64_t size;
+    std::memcpy(&size, input.data(), sizeof(size));
+    output.resize(size);
+
+    const uint8_t *ip = input.data() + LZ_HEADER_BYTES;
+    const uint8_t *end = input.data() + input.size();
+    uint8_t *op = output.data();
+    uint8_t *opEnd = output.data() + size;
+    while (true)
+    {
+        // 1. 字面量
+        if (ip >= end)
+            return ERROR_CALCULATE_ERROR;
+        uint8_t token = *ip++;
+        uint64_t literalLen = token >> 4;
+        if (literalLen == 15 && !GetLengthExtension(ip, end, literalLen))
+            return ERROR_CALCULATE_ERROR;
+        if (literalLen > static_cast<uint64_t>(end - ip) || literalLen > static_cast<uint64_t>(opEnd - op))
+            return ERROR_CALCULATE_ERROR;
+        std::memcpy(op, ip, literalLen);
+        ip += literalLen;
+        op += literalLen;
+        if (op == opEnd)
+            break;
+
+        // 2. 匹配：偏移小于长度时源与目标重叠，逐字节复制
+        if (end - ip < 2)
+            return ERROR_CALCULATE_ERROR;
+        uint32_t offset = ip[0] | (static_cast<uint32_t>(ip[1]) << 8);
+        ip += 2;
+        uint64_t matchLen = token & 0x0F;
+        if (matchLen == 15 && !GetLengthExtension(ip, end, matchLen))
+            return ERROR_CALCULATE_ERROR;
+        matchLen += LZ_MIN_MATCH;
+        if (offset == 0 || offset > static_cast<uint64_t>(op - output.data()) || matchLen > static_cast<uint64_t>(opEnd - op))
+            return ERROR_CALCULATE_ERROR;
+
+        const uint8_t *match = op - offset;
+        if (offset >= matchLen)
+        {
+            std::memcpy(op, match, matchLen);
+            op += matchLen;
+        }
+        else
+        {
+            for (uint64_t i = 0; i < matchLen; ++i)
+                *op++ = *match++;
+        }
+    }
+    return ip == end ? SAA_SUCCESS : ERROR_CALCULATE_ERROR;
+}
+
+int8_t RunStage2(const SparseArrayCompressor &compressor, Stage2Codec codec, uint64_t originSizeBytes,
+                 Stage2Result &result)
+{
+    // 1. 第一级序列化
+    std::vector<uint8_t> serialized;
+    int8_t ret = compressor.Serialize(serialized);
+    if (ret != SAA_SUCCESS)
+    {
+        return ret;
+    }
+    result.serializedBytes = serialized.size();
+
+    if (codec == STAGE2_NONE)
+    {
+        result.stage2Bytes = serialized.size();
+        result.compressTimeMs = 0;
+        result.decompressTimeMs = 0;
+        result.combinedRatio = originSizeBytes ? static_cast<double>(result.stage2Bytes) / originSizeBytes * 100.0 : 0.0;
+        return SAA_SUCCESS;
+    }
+
+    // 2. 第二级压缩
+    std::vector<uint8_t> packed;
+    auto start = std::chrono::high_resolution_clock::now();
+    LzCompress(serialized, packed);
+    auto end = std::chrono::high_resolution_clock::now();
+    result.compressTimeMs = std::chrono::duration<double, std::milli>(end - start).count();
+    result.stage2Bytes = packed.size();
+
+    // 3. 第二级解压并校验往返一致
+    std::vector<uint8_t> restored;
+    start = std::chrono::high_resolution_clock::now();
+    ret = LzDecompress(packed, restored);
+    end = std::chrono::high_resolution_clock::now();
+    result.decompressTimeMs = std::chrono::duration<double, std::milli>(end - start).count();
+    if (ret != SAA_SUCCESS || restored != serialized)
+    {
+        std::cerr << LOG_ERROR << "Stage 2 roundtrip mismatch for " << result.modeName << std::endl;
+        return ERROR_CALCULATE_ERROR;
+    }
+
+    result.combinedRatio = originSizeBytes ? static_cast<double>(result.stage2Bytes) / originSizeBytes * 100.0 : 0.0;
+    return SAA_SUCCESS;
+}
@@ -0,0 +1,157 @@
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2026-10-19 23:20:00
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2026-10-19 23:20:00
+ * @FilePath: \SparseArrayAnalyzer\core\src\chunk_pipeline.hpp
+ * @Description: 读取与编码流水线：读线程把块填入固定数量的循环缓冲，多个消费线程按顺序各自处理每一块，
+ *               所有消费者处理完后缓冲回收给读线程，总耗时趋近 max(I/O, 计算)
+ *
+ */
+#pragma once
+#include "trace_events.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define PIPELINE_BUFFER_COUNT (3) // 一块在读、其余供快慢不同的消费者错开处理
+
+typedef struct pipeline_timing
+{
+    double readMs = 0;    // 读线程在 produce 中的耗时
+    double computeMs = 0; // 最慢消费者在 consume 中的耗时
+    double wallMs = 0;    // 端到端耗时
+    double stallMs = 0;   // 最慢消费者等待数据的耗时
+} PipelineTiming;
+
+template <typename T>
+class ChunkPipeline
+{
+public:
+    // produce(buffer, capacity) 在读线程调用，返回填入的元素数，0 表示结束
+    using Producer = std::function<size_t(T *, size_t)>;
+    // consume(data, count) 在各自的消费线程调用，同一消费者按块顺序看到全部数据
+    using Consumer = std::function<void(const T *, size_t)>;
+
+    ChunkPipeline(size_t bufferElems, size_t bufferCount = PIPELINE_BUFFER_COUNT)
+        : _slots(std::max<size_t>(bufferCount, 2))
+    {
+        for (auto &slot : _slots)
+            slot.data.resize(bufferElems);
+    }
+
+    size_t bufferElems() const { return _slots[0].data.size(); }
+    size_t bufferBytes() const { return _slots.size() * bufferElems() * sizeof(T); }
+
+    // 运行到读线程返回 0；返回读取的块数
+    uint64_t run(const Producer &produce, const std::vector<Consumer> &consumers, PipelineTiming &timing)
+    {
+        using Clock = std::chrono::high_resolution_clock;
+        auto start = Clock::now();
+        _produced = 0;
+        _finished = false;
+        for (auto &slot : _slots)
+            slot.pending = 0;
+
+        std::vector<double> busyMs(consumers.size(), 0);
+        std::vector<double> waitMs(consumers.size(), 0);
+        std::vector<std::thread> workers;
+        workers.reserve(consumers.size());
+        for (size_t c = 0; c < consumers.size(); ++c)
+        {
+            workers.emplace_back([&, c]
+                                 {
+                                     SetTraceThreadName("consumer-" + std::to_string(c));
+                                     for (uint64_t seq = 0;; ++seq)
+                                     {
+                                         // 1. 等待第 seq 块发布
+                                         auto waitStart = Clock::now();
+                                         Slot &slot = _slots[seq % _slots.size()];
+                                         {
+                                             std::unique_lock<std::mutex> lock(_mutex);
+                                             _published.wait(lock, [&] { return _produced > seq || _finished; });
+                                             if (_produced <= seq)
+                                                 break;
+                                         }
+                                         auto workStart = Clock::now();
+                                         waitMs[c] += std::chrono::duration<double, std::milli>(workStart - waitStart).count();
+
+                                         // 2. 处理，最后一个消费者归还缓冲
+                                         {
+                                             TraceSpan chunkTrace("consume_chunk");
+                                             consumers[c](slot.data.data(), slot.count);
+                                         }
+                                         busyMs[c] += std::chrono::duration<double, std::milli>(Clock::now() - workStart).count();
+                                         std::lock_guard<std::mutex> lock(_mutex);
+                                         if (--slot.pending == 0)
+                                             _recycled.notify_one();
+                                     } });
+        }
+
+        // 读线程：等待缓冲回收后填充并发布
+        std::thread reader([&]
+                           {
+                               SetTraceThreadName("reader");
+                               for (uint64_t seq = 0;; ++seq)
+                               {
+                                   Slot &slot = _slots[seq % _slots.size()];
+                                   {
+                                       std::unique_lock<std::mutex> lock(_mutex);
+                                       _recycled.wait(lock, [&] { return slot.pending == 0; });
+                                   }
+
+                                   auto readStart = Clock::now();
+                                   TraceSpan readTrace("read_chunk");
+                                   size_t count = produce(slot.data.data(), slot.data.size());
+                                   readTrace.stop();
+                                   timing.readMs += std::chrono::duration<double, std::milli>(Clock::now() - readStart).count();
+
+                                   std::lock_guard<std::mutex> lock(_mutex);
+                                   if (count == 0 || consumers.empty())
+                                   {
+                                       _finished = true;
+                                       _chunks = seq + (count != 0);
+                                       _published.notify_all();
+                                       return;
+                                   }
+                                   slot.count = count;
+                                   slot.pending = static_cast<uint32_t>(consumers.size());
+                                   _produced = seq + 1;
+                                   _published.notify_all();
+                               } });
+
+        reader.join();
+        for (auto &worker : workers)
+            worker.join();
+
+        size_t slowest = std::max_element(busyMs.begin(), busyMs.end()) - busyMs.begin();
+        if (!consumers.empty())
+        {
+            timing.computeMs += busyMs[slowest];
+            timing.stallMs += waitMs[slowest];
+        }
+        timing.wallMs += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        return _chunks;
+    }
+
+private:
+    struct Slot
+    {
+        std::vector<T> data;
+        size_t count = 0;
+        uint32_t pending = 0; // 尚未处理此块的消费者数
+    };
+
+    std::vector<Slot> _slots;
+    std::mutex _mutex;
+    std::condition_variable _published;
+    std::condition_variable _recycled;
+    uint64_t _produced = 0;
+    uint64_t _chunks = 0;
+    bool _finished = false;
+};
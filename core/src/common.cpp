@@ -1,4 +1,5 @@
 #include "common.h"
+#include "trace_events.h"
 #include <fstream>
 #include <string>
 #include <sstream>
@@ -8,10 +9,63 @@
 #include <iostream>
 #include <iomanip>
 #include <bitset>
+#include <cerrno>
+#include <limits>
+#include <type_traits>
 
-std::vector<uint32_t> LoadArrayFromTxt(const std::string &filename)
+const char *ElemTypeName(ElemType type)
 {
-    std::vector<uint32_t> data;
+    return DispatchElemType(type, [](auto tag)
+                            { return ElemTraits<decltype(tag)>::name; });
+}
+
+int8_t ParseElemType(const std::string &name, ElemType &type)
+{
+    for (int i = 0; i < ELEM_TYPE_COUNT; ++i)
+    {
+        if (name == ElemTypeName(static_cast<ElemType>(i)))
+        {
+            type = static_cast<ElemType>(i);
+            return SAA_SUCCESS;
+        }
+    }
+    std::cerr << LOG_ERROR << "Unknown element type: " << name << " (use u8/u16/u32/u64/i32/f32)\n";
+    return ERROR_PARAM_INVALID;
+}
+
+template <typename T>
+bool ParseTextValue(const std::string &token, T &value)
+{
+    char *end = nullptr;
+    errno = 0;
+    if constexpr (std::is_floating_point<T>::value)
+    {
+        value = std::strtof(token.c_str(), &end);
+    }
+    else if constexpr (std::is_signed<T>::value)
+    {
+        long long v = std::strtoll(token.c_str(), &end, 10);
+        if (v < std::numeric_limits<T>::min() || v > std::numeric_limits<T>::max())
+            return false;
+        value = static_cast<T>(v);
+    }
+    else
+    {
+        if (token[0] == '-')
+            return false;
+        unsigned long long v = std::strtoull(token.c_str(), &end, 10);
+        if (v > std::numeric_limits<T>::max())
+            return false;
+        value = static_cast<T>(v);
+    }
+    return errno == 0 && end == token.c_str() + token.size();
+}
+
+template <typename T>
+std::vector<T> LoadArrayFromTxt(const std::string &filename)
+{
+    TraceSpan trace("LoadArrayFromTxt", filename);
+    std::vector<T> data;
 
     // 路径检查
     if (!std::filesystem::exists(filename))
@@ -27,30 +81,142 @@ std::vector<uint32_t> LoadArrayFromTxt(const std::string &filename)
         return data;
     }
 
-    uint32_t value;
-    while (file)
+    // 空白与逗号均视为分隔符
+    std::string word;
+    while (file >> word)
     {
-        file >> value;
-        if (file.fail())
+        std::stringstream ss(word);
+        std::string token;
+        while (std::getline(ss, token, ','))
         {
-            if (file.eof())
-                break;
-            std::cerr << "Warning: Invalid data encountered. Skipping...\n";
-            file.clear();                                                  // 清除错误状态
-            file.ignore(std::numeric_limits<std::streamsize>::max(), ','); // 跳过无效片段
-            continue;
-        }
-        data.push_back(value);
+            if (token.empty())
+                continue;
 
-        // 处理逗号分隔
-        if (file.peek() == ',')
-            file.ignore();
+            T value;
+            if (!ParseTextValue(token, value))
+            {
+                std::cerr << "Warning: Invalid data encountered. Skipping...\n";
+                continue;
+            }
+            data.push_back(value);
+        }
     }
 
     file.close();
     return data;
 }
 
+bool IsBinaryArrayFile(const std::string &filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+    char magic[4] = {0};
+    file.read(magic, sizeof(magic));
+    return file.gcount() == sizeof(magic) && std::memcmp(magic, SAA_BIN_MAGIC, sizeof(magic)) == 0;
+}
+
+int8_t ReadBinaryArrayHeader(const std::string &filename, BinaryArrayHeader &header)
+{
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cerr << LOG_ERROR << "Failed to open file: " << filename << std::endl;
+        return ERROR_PARAM_INVALID;
+    }
+
+    uint8_t raw[SAA_BIN_HEADER_SIZE] = {0};
+    file.read(reinterpret_cast<char *>(raw), sizeof(raw));
+    if (file.gcount() != SAA_BIN_HEADER_SIZE || std::memcmp(raw, SAA_BIN_MAGIC, 4) != 0)
+    {
+        std::cerr << LOG_ERROR << "Not a binary array file: " << filename << std::endl;
+        return ERROR_PARAM_INVALID;
+    }
+
+    if (raw[4] != SAA_BIN_VERSION || raw[5] >= ELEM_TYPE_COUNT || raw[6] > ARRAY_2D)
+    {
+        std::cerr << LOG_ERROR << "Unsupported binary array header in " << filename << std::endl;
+        return ERROR_PARAM_INVALID;
+    }
+
+    header.version = raw[4];
+    header.elemType = static_cast<ElemType>(raw[5]);
+    header.dimension = static_cast<ArrayDimension>(raw[6]);
+    std::memcpy(&header.rows, raw + 8, sizeof(uint64_t));
+    std::memcpy(&header.cols, raw + 16, sizeof(uint64_t));
+    return SAA_SUCCESS;
+}
+
+int8_t WriteBinaryArrayHeader(std::ostream &os, const BinaryArrayHeader &header)
+{
+    uint8_t raw[SAA_BIN_HEADER_SIZE] = {0};
+    std::memcpy(raw, SAA_BIN_MAGIC, 4);
+    raw[4] = header.version;
+    raw[5] = static_cast<uint8_t>(header.elemType);
+    raw[6] = static_cast<uint8_t>(header.dimension);
+    std::memcpy(raw + 8, &header.rows, sizeof(uint64_t));
+    std::memcpy(raw + 16, &header.cols, sizeof(uint64_t));
+    os.write(reinterpret_cast<const char *>(raw), sizeof(raw));
+    return os ? SAA_SUCCESS : ERROR_UNKNOW_ERROR;
+}
+
+template <typename T>
+int8_t LoadArrayFromBin(const std::string &filename, BinaryArrayHeader &header, std::vector<T> &data)
+{
+    TraceSpan trace("LoadArrayFromBin", filename);
+    data.clear();
+    int8_t ret = ReadBinaryArrayHeader(filename, header);
+    if (ret != SAA_SUCCESS)
+        return ret;
+
+    if (header.elemType != ElemTraits<T>::type)
+    {
+        std::cerr << LOG_ERROR << "Element type mismatch: file holds " << ElemTypeName(header.elemType)
+                  << ", requested " << ElemTraits<T>::name << std::endl;
+        return ERROR_PARAM_INVALID;
+    }
+
+    // 1. 元素数不溢出，且与文件实际大小一致，避免按损坏的头部分配
+    std::error_code error;
+    uint64_t fileSize = std::filesystem::file_size(filename, error);
+    if (error || fileSize < SAA_BIN_HEADER_SIZE)
+    {
+        std::cerr << LOG_ERROR << "Failed to get size of file: " << filename << std::endl;
+        return ERROR_PARAM_INVALID;
+    }
+    if (header.rows != 0 && header.cols > UINT64_MAX / header.rows)
+    {
+        std::cerr << LOG_ERROR << "Binary array shape overflows: " << header.rows << " x " << header.cols << std::endl;
+        return ERROR_PARAM_INVALID;
+    }
+    uint64_t count = header.rows * header.cols;
+    if (count > (fileSize - SAA_BIN_HEADER_SIZE) / sizeof(T) || fileSize - SAA_BIN_HEADER_SIZE != count * sizeof(T))
+    {
+        std::cerr << LOG_ERROR << "Binary array file size " << fileSize << " does not match its header ("
+                  << header.rows << " x " << header.cols << " " << ElemTraits<T>::name << "): " << filename << std::endl;
+        return ERROR_PARAM_INVALID;
+    }
+
+    // 2. 读取数据
+    std::ifstream file(filename, std::ios::binary);
+    file.seekg(SAA_BIN_HEADER_SIZE);
+    try
+    {
+        data.resize(count);
+    }
+    catch (const std::exception &)
+    {
+        std::cerr << LOG_ERROR << "Out of memory loading " << count << " elements from " << filename << std::endl;
+        return ERROR_UNKNOW_ERROR;
+    }
+    file.read(reinterpret_cast<char *>(data.data()), data.size() * sizeof(T));
+    if (static_cast<uint64_t>(file.gcount()) != data.size() * sizeof(T))
+    {
+        std::cerr << LOG_ERROR << "Binary array file is truncated: " << filename << std::endl;
+        data.clear();
+        return ERROR_PARAM_INVALID;
+    }
+    return SAA_SUCCESS;
+}
+
 uint32_t ParseInt(const char *str)
 {
     try
@@ -70,8 +236,10 @@ uint32_t ParseInt(const char *str)
     }
 }
 
-int8_t ReshapeTo2D(const std::vector<uint32_t> &input, const uint32_t row, const uint32_t col, std::vector<std::vector<uint32_t>> &output)
+template <typename T>
+int8_t ReshapeTo2D(const std::vector<T> &input, const uint32_t row, const uint32_t col, std::vector<std::vector<T>> &output)
 {
+    TraceSpan trace("ReshapeTo2D");
     if (input.empty())
     {
         std::cerr << LOG_ERROR << "Input data is empty.\n";
@@ -84,14 +252,14 @@ int8_t ReshapeTo2D(const std::vector<uint32_t> &input, const uint32_t row, const
         return ERROR_PARAM_INVALID;
     }
 
-    if (row * col != input.size())
+    if (static_cast<uint64_t>(row) * col != input.size())
     {
         std::cerr << LOG_ERROR << "The specified dimensions is not compatible with the input data size.\n";
         return ERROR_PARAM_INVALID;
     }
 
     output.clear();
-    output.resize(row, std::vector<uint32_t>(col, 0));
+    output.resize(row, std::vector<T>(col, 0));
 
     size_t index = 0;
     for (uint32_t rowIdx = 0; rowIdx < row; ++rowIdx)
@@ -130,14 +298,15 @@ void PrintBuffer(const std::vector<uint8_t>& vec, size_t perLine)
     PrintBuffer(vec.data(), vec.size(), perLine);
 }
 
-void PrintVector1D(const std::vector<uint32_t> &vec, const std::string commit, size_t elemsPerLine)
+template <typename T>
+void PrintVector1D(const std::vector<T> &vec, const std::string commit, size_t elemsPerLine)
 {
     std::cout << "----------------------------------------------------------------------------------------------------" << std::endl;
     std::cout << "Array commit: " << commit << std::endl;
     std::cout << "Array content (size = " << vec.size() << "):\n{\n    ";
     for (size_t i = 0; i < vec.size(); ++i)
     {
-        std::cout << std::setw(8) << vec[i];
+        std::cout << std::setw(8) << +vec[i]; // 一元加号避免 uint8_t 按字符输出
         if (i != vec.size() - 1)
         {
             std::cout << ",";
@@ -156,7 +325,8 @@ void PrintVector1D(const std::vector<uint32_t> &vec, const std::string commit, s
     std::cout << "----------------------------------------------------------------------------------------------------" << std::endl;
 }
 
-void PrintVector2D(const std::vector<std::vector<uint32_t>> &data, const uint32_t row, const uint32_t col, const std::string commit)
+template <typename T>
+void PrintVector2D(const std::vector<std::vector<T>> &data, const uint32_t row, const uint32_t col, const std::string commit)
 {
     std::cout << "----------------------------------------------------------------------------------------------------" << std::endl;
     std::cout << "Array commit: " << commit << std::endl;
@@ -166,7 +336,7 @@ void PrintVector2D(const std::vector<std::vector<uint32_t>> &data, const uint32_
     {
         for (uint32_t colIdx = 0; colIdx < col; ++colIdx)
         {
-            std::cout << std::setw(8) << data[rowIdx][colIdx];
+            std::cout << std::setw(8) << +data[rowIdx][colIdx];
             if (index != data.size() - 1)
             {
                 std::cout << ",";
@@ -178,44 +348,94 @@ void PrintVector2D(const std::vector<std::vector<uint32_t>> &data, const uint32_
     std::cout << "----------------------------------------------------------------------------------------------------" << std::endl;
 }
 
-uint32_t GetArrayTotalSize1D(const std::vector<uint32_t> &data)
+template <typename T>
+uint64_t GetArrayTotalSize1D(const std::vector<T> &data)
 {
-    uint32_t size = 0;
-    size = GetArrayElemCount1D(data) * sizeof(uint32_t);
+    uint64_t size = 0;
+    size = GetArrayElemCount1D(data) * sizeof(T);
     return size;
 }
 
-uint32_t GetArrayTotalSize2D(const std::vector<std::vector<uint32_t>> &data)
+template <typename T>
+uint64_t GetArrayTotalSize2D(const std::vector<std::vector<T>> &data)
 {
-    uint32_t size = 0;
-    size = GetArrayElemCount2D(data) * sizeof(uint32_t);
+    uint64_t size = 0;
+    size = GetArrayElemCount2D(data) * sizeof(T);
     return size;
 }
 
-uint32_t GetArrayElemCount1D(const std::vector<uint32_t> &data)
+template <typename T>
+uint64_t GetArrayElemCount1D(const std::vector<T> &data)
 {
-    return static_cast<uint32_t>(data.size());
+    return static_cast<uint64_t>(data.size());
 }
 
-uint32_t GetArrayElemCount2D(const std::vector<std::vector<uint32_t>> &data)
+template <typename T>
+uint64_t GetArrayElemCount2D(const std::vector<std::vector<T>> &data)
 {
-    uint32_t count = 0;
+    uint64_t count = 0;
     for (const auto &row : data)
     {
-        count += static_cast<uint32_t>(row.size());
+        count += static_cast<uint64_t>(row.size());
     }
     return count;
 }
 
-bool Compare2D(const std::vector<std::vector<uint32_t>> &a,
-               const std::vector<std::vector<uint32_t>> &b)
+template <typename T>
+bool Compare1D(const std::vector<T> &a, const std::vector<T> &b)
+{
+    return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+}
+
+template <typename T>
+bool Compare2D(const std::vector<std::vector<T>> &a,
+               const std::vector<std::vector<T>> &b)
 {
+    TraceSpan trace("Compare2D");
     if (a.size() != b.size())
         return false;
     for (size_t i = 0; i < a.size(); ++i)
     {
-        if (a[i] != b[i])
+        if (!Compare1D(a[i], b[i]))
             return false;
     }
     return true;
 }
+
+template <typename T>
+void ClearRows2D(std::vector<std::vector<T>> &data)
+{
+    for (auto &row : data)
+    {
+        row.clear();
+    }
+}
+
+template <typename T>
+void FillArray2D(std::vector<std::vector<T>> &data, uint32_t row, uint32_t col, T value)
+{
+    data.resize(row);
+    for (auto &line : data)
+    {
+        line.assign(col, value);
+    }
+}
+
+// 显式实例化所有支持的元素类型
+#define INSTANTIATE_COMMON(T)                                                                                      \
+    template bool ParseTextValue<T>(const std::string &, T &);                                                     \
+    template std::vector<T> LoadArrayFromTxt<T>(const std::string &);                                              \
+    template int8_t LoadArrayFromBin<T>(const std::string &, BinaryArrayHeader &, std::vector<T> &);               \
+    template int8_t ReshapeTo2D<T>(const std::vector<T> &, const uint32_t, const uint32_t, std::vector<std::vector<T>> &); \
+    template void PrintVector1D<T>(const std::vector<T> &, const std::string, size_t);                             \
+    template void PrintVector2D<T>(const std::vector<std::vector<T>> &, const uint32_t, const uint32_t, const std::string); \
+    template uint64_t GetArrayTotalSize1D<T>(const std::vector<T> &);                                              \
+    template uint64_t GetArrayTotalSize2D<T>(const std::vector<std::vector<T>> &);                                 \
+    template uint64_t GetArrayElemCount1D<T>(const std::vector<T> &);                                              \
+    template uint64_t GetArrayElemCount2D<T>(const std::vector<std::vector<T>> &);                                 \
+    template bool Compare1D<T>(const std::vector<T> &, const std::vector<T> &);                                    \
+    template bool Compare2D<T>(const std::vector<std::vector<T>> &, const std::vector<std::vector<T>> &);         \
+    template void ClearRows2D<T>(std::vector<std::vector<T>> &);                                                   \
+    template void FillArray2D<T>(std::vector<std::vector<T>> &, uint32_t, uint32_t, T);
+
+SAA_FOR_EACH_ELEM_TYPE(INSTANTIATE_COMMON)
@@ -0,0 +1,209 @@
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2026-10-19 21:40:00
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2026-10-19 21:40:00
+ * @FilePath: \SparseArrayAnalyzer\core\src\compressed_file.cpp
+ * @Description:
+ *
+ */
+#include "compressed_file.h"
+#include "common.h"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static uint64_t PayloadChecksum(const uint8_t *data, size_t size)
+{
+    // FNV-1a 64，按 8 字节一组处理以减少依赖链长度
+    uint64_t hash = 0xCBF29CE484222325ull;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+    {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * 0x100000001B3ull;
+    }
+    for (; i < size; ++i)
+    {
+        hash = (hash ^ data[i]) * 0x100000001B3ull;
+    }
+    return hash;
+}
+
+int8_t WriteCompressedFile(const std::string &path, CompressedFileHeader header, const SparseArrayCompressor &compressor)
+{
+    // 1. 序列化负载
+    std::vector<uint8_t> payload;
+    int8_t ret = compressor.Serialize(payload);
+    if (ret != SAA_SUCCESS)
+    {
+        return ret;
+    }
+
+    // 2. 填写头部
+    uint64_t nameEnd = SAA_PACK_HEADER_SIZE + header.algorithm.size();
+    header.version = SAA_PACK_VERSION;
+    header.payloadOffset = (nameEnd + SAA_PACK_ALIGN - 1) / SAA_PACK_ALIGN * SAA_PACK_ALIGN;
+    header.payloadBytes = payload.size();
+    header.checksum = PayloadChecksum(payload.data(), payload.size());
+
+    uint8_t raw[SAA_PACK_HEADER_SIZE] = {0};
+    uint32_t nameLength = static_cast<uint32_t>(header.algorithm.size());
+    std::memcpy(raw, SAA_PACK_MAGIC, 4);
+    std::memcpy(raw + 4, &header.version, sizeof(uint16_t));
+    raw[6] = static_cast<uint8_t>(header.elemType);
+    raw[7] = static_cast<uint8_t>(header.dimension);
+    std::memcpy(raw + 8, &header.rows, sizeof(uint32_t));
+    std::memcpy(raw + 12, &header.cols, sizeof(uint32_t));
+    std::memcpy(raw + 16, &header.payloadOffset, sizeof(uint64_t));
+    std::memcpy(raw + 24, &header.payloadBytes, sizeof(uint64_t));
+    std::memcpy(raw + 32, &header.checksum, sizeof(uint64_t));
+    std::memcpy(raw + 40, &nameLength, sizeof(uint32_t));
+
+    // 3. 头部 + 算法名 + 填充 + 负载
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        std::cerr << LOG_ERROR << "Failed to open file: " << path << std::endl;
+        return ERROR_PARAM_INVALID;
+    }
+    const char padding[SAA_PACK_ALIGN] = {0};
+    file.write(reinterpret_cast<const char *>(raw), sizeof(raw));
+    file.write(header.algorithm.data(), header.algorithm.size());
+    file.write(padding, header.payloadOffset - nameEnd);
+    file.write(reinterpret_cast<const char *>(payload.data()), payload.size());
+    return file ? SAA_SUCCESS : ERROR_UNKNOW_ERROR;
+}
+
+MappedCompressedFile::~MappedCompressedFile()
+{
+    Close();
+}
+
+int8_t MappedCompressedFile::Open(const std::string &path, bool verifyChecksum)
+{
+    Close();
+
+    // 1. 只读映射整个文件
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    LARGE_INTEGER fileSize;
+    if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &fileSize))
+    {
+        if (file != INVALID_HANDLE_VALUE)
+            CloseHandle(file);
+        std::cerr << LOG_ERROR << "Failed to open file: " << path << std::endl;
+        return ERROR_PARAM_INVALID;
+    }
+    _file = file;
+    _size = static_cast<size_t>(fileSize.QuadPart);
+    if (_size >= SAA_PACK_HEADER_SIZE)
+    {
+        _mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (_mapping)
+            _base = static_cast<const uint8_t *>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+    }
+#else
+    _fd = open(path.c_str(), O_RDONLY);
+    struct stat st;
+    if (_fd < 0 || fstat(_fd, &st) != 0)
+    {
+        std::cerr << LOG_ERROR << "Failed to open file: " << path << std::endl;
+        Close();
+        return ERROR_PARAM_INVALID;
+    }
+    _size = static_cast<size_t>(st.st_size);
+    if (_size >= SAA_PACK_HEADER_SIZE)
+    {
+        void *addr = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _fd, 0);
+        _base = (addr == MAP_FAILED) ? nullptr : static_cast<const uint8_t *>(addr);
+    }
+#endif
+
+    if (!_base || std::memcmp(_base, SAA_PACK_MAGIC, 4) != 0)
+    {
+        std::cerr << LOG_ERROR << "Not a compressed array file: " << path << std::endl;
+        Close();
+        return ERROR_PARAM_INVALID;
+    }
+
+    // 2. 解析头部
+    uint32_t nameLength = 0;
+    std::memcpy(&_header.version, _base + 4, sizeof(uint16_t));
+    _header.elemType = static_cast<ElemType>(_base[6]);
+    _header.dimension = static_cast<ArrayDimension>(_base[7]);
+    std::memcpy(&_header.rows, _base + 8, sizeof(uint32_t));
+    std::memcpy(&_header.cols, _base + 12, sizeof(uint32_t));
+    std::memcpy(&_header.payloadOffset, _base + 16, sizeof(uint64_t));
+    std::memcpy(&_header.payloadBytes, _base + 24, sizeof(uint64_t));
+    std::memcpy(&_header.checksum, _base + 32, sizeof(uint64_t));
+    std::memcpy(&nameLength, _base + 40, sizeof(uint32_t));
+
+    if (_header.version != SAA_PACK_VERSION || _base[6] >= ELEM_TYPE_COUNT || _base[7] > ARRAY_2D ||
+        nameLength > _size - SAA_PACK_HEADER_SIZE || _header.payloadOffset % SAA_PACK_ALIGN != 0 ||
+        _header.payloadOffset < SAA_PACK_HEADER_SIZE + nameLength || _header.payloadOffset > _size ||
+        _header.payloadBytes != _size - _header.payloadOffset)
+    {
+        std::cerr << LOG_ERROR << "Unsupported compressed array header in " << path << std::endl;
+        Close();
+        return ERROR_PARAM_INVALID;
+    }
+    _header.algorithm.assign(reinterpret_cast<const char *>(_base + SAA_PACK_HEADER_SIZE), nameLength);
+
+    // 3. 负载校验和（可选）
+    if (verifyChecksum && PayloadChecksum(Payload(), _header.payloadBytes) != _header.checksum)
+    {
+        std::cerr << LOG_ERROR << "Checksum mismatch in " << path << std::endl;
+        Close();
+        return ERROR_CALCULATE_ERROR;
+    }
+    return SAA_SUCCESS;
+}
+
+void MappedCompressedFile::Close()
+{
+#ifdef _WIN32
+    if (_base)
+        UnmapViewOfFile(_base);
+    if (_mapping)
+        CloseHandle(_mapping);
+    if (_file)
+        CloseHandle(_file);
+    _mapping = nullptr;
+    _file = nullptr;
+#else
+    if (_base)
+        munmap(const_cast<uint8_t *>(_base), _size);
+    if (_fd >= 0)
+        close(_fd);
+    _fd = -1;
+#endif
+    _base = nullptr;
+    _size = 0;
+    _header = CompressedFileHeader();
+}
+
+int8_t MappedCompressedFile::CreateCompressor(std::unique_ptr<SparseArrayCompressor> &compressor) const
+{
+    if (!_base)
+    {
+        return ERROR_INPUT_EMPTY;
+    }
+
+    compressor = CompressorRegistry::Instance().Create(_header.algorithm, _header.elemType);
+    if (!compressor)
+    {
+        std::cerr << LOG_ERROR << "Compressor \"" << _header.algorithm << "\" not found.\n";
+        return ERROR_UNSUPPORT_FEATURE;
+    }
+    return compressor->Deserialize(Payload(), _header.payloadBytes);
+}
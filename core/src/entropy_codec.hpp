@@ -0,0 +1,493 @@
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2026-10-19 19:50:00
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2026-10-19 19:50:00
+ * @FilePath: \SparseArrayAnalyzer\core\src\entropy_codec.hpp
+ * @Description: 符号流熵编码：范式 Huffman（查表一次解多个符号）与双路交错 rANS（查表解码，低频符号转义）
+ *
+ */
+#pragma once
+#include "bit_packing.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <queue>
+#include <vector>
+
+#define HUFF_MAX_BITS     (24) // 码长上限，超出时压平频率重建
+#define HUFF_TABLE_BITS   (11) // 解码表索引位数
+#define HUFF_MULTI_SYMS   (4)  // 每个表项最多解出的符号数
+#define HUFF_PADDING      (8)  // 位流尾部填充，整字读取无需越界判断
+
+#define ANS_SCALE_BITS    (12)        // 频率总和 = 1 << ANS_SCALE_BITS
+#define ANS_LOWER_BOUND   (1u << 23)  // 状态下界
+#define ANS_MAX_DIRECT    (255)       // 直接编码的符号数上限，其余统一走转义符号
+
+/* -------------------------------- Huffman --------------------------------- */
+typedef struct huffman_stream
+{
+    uint64_t count = 0;
+    uint32_t onlySymbol = 0;         // 只出现一个符号时不写位流，解码直接填充
+    std::vector<uint8_t> codeLength; // 每个符号的码长（0 表示未出现）
+    std::vector<uint8_t> bytes;      // 低位在前的位流，含 HUFF_PADDING 字节填充
+} HuffmanStream;
+
+namespace entropy_detail
+{
+    // 按频率计算码长：堆合并建树，超过 HUFF_MAX_BITS 时频率减半后重建；
+    // 频率减半最终趋于全 1，此时树深为 ceil(log2 m)，因此出现的符号数不能超过 2^HUFF_MAX_BITS
+    inline bool BuildCodeLengths(std::vector<uint64_t> freq, std::vector<uint8_t> &lengths)
+    {
+        lengths.assign(freq.size(), 0);
+        std::vector<uint32_t> used;
+        for (uint32_t s = 0; s < freq.size(); ++s)
+        {
+            if (freq[s])
+                used.push_back(s);
+        }
+        if (used.size() <= 1)
+            return true; // 只有一个符号时不需要任何位
+        if (used.size() > (1ull << HUFF_MAX_BITS))
+            return false;
+
+        while (true)
+        {
+            // 1. 叶子 0..m-1，内部节点依次追加，父节点编号总大于子节点
+            const size_t m = used.size();
+            std::vector<uint32_t> parent(2 * m - 1, 0);
+            using Node = std::pair<uint64_t, uint32_t>;
+            std::priority_queue<Node, std::vector<Node>, std::greater<Node>> heap;
+            for (uint32_t i = 0; i < m; ++i)
+                heap.push({freq[used[i]], i});
+
+            uint32_t next = static_cast<uint32_t>(m);
+            while (heap.size() > 1)
+            {
+                Node a = heap.top();
+                heap.pop();
+                Node b = heap.top();
+                heap.pop();
+                parent[a.second] = next;
+                parent[b.second] = next;
+                heap.push({a.first + b.first, next++});
+            }
+
+            // 2. 自根向下求深度
+            std::vector<uint8_t> depth(2 * m - 1, 0);
+            uint8_t maxDepth = 0;
+            for (int64_t node = static_cast<int64_t>(2 * m) - 3; node >= 0; --node)
+            {
+                depth[node] = static_cast<uint8_t>(std::min<uint32_t>(depth[parent[node]] + 1, 255));
+                if (node < static_cast<int64_t>(m))
+                    maxDepth = std::max(maxDepth, depth[node]);
+            }
+
+            if (maxDepth <= HUFF_MAX_BITS)
+            {
+                for (uint32_t i = 0; i < m; ++i)
+                    lengths[used[i]] = depth[i];
+                return true;
+            }
+
+            for (uint32_t s : used)
+                freq[s] = (freq[s] + 1) / 2;
+        }
+    }
+
+    inline uint32_t ReverseBits(uint32_t code, uint32_t length)
+    {
+        uint32_t rev = 0;
+        for (uint32_t i = 0; i < length; ++i, code >>= 1)
+            rev = (rev << 1) | (code & 1);
+        return rev;
+    }
+
+    // 范式码：按（码长，符号）顺序依次分配
+    inline void AssignCanonicalCodes(const std::vector<uint8_t> &lengths, std::vector<uint32_t> &codes)
+    {
+        uint32_t lengthCount[HUFF_MAX_BITS + 1] = {0};
+        for (uint8_t len : lengths)
+            lengthCount[len]++;
+        lengthCount[0] = 0;
+
+        uint32_t nextCode[HUFF_MAX_BITS + 2] = {0};
+        for (uint32_t len = 1; len <= HUFF_MAX_BITS; ++len)
+            nextCode[len + 1] = (nextCode[len] + lengthCount[len]) << 1;
+
+        codes.assign(lengths.size(), 0);
+        for (uint32_t s = 0; s < lengths.size(); ++s)
+        {
+            if (lengths[s])
+                codes[s] = nextCode[lengths[s]]++;
+        }
+    }
+
+    inline uint64_t PeekBits(const uint8_t *bytes, uint64_t bitPos)
+    {
+        uint64_t word;
+        std::memcpy(&word, bytes + (bitPos >> 3), sizeof(word));
+        return word >> (bitPos & 7);
+    }
+} // namespace entropy_detail
+
+// 出现的符号超过 2^HUFF_MAX_BITS 个时无法限长，返回 false，encoded 不可用
+inline bool EncodeHuffman(const std::vector<uint32_t> &symbols, uint32_t alphabetSize, HuffmanStream &encoded)
+{
+    encoded = HuffmanStream();
+    encoded.count = symbols.size();
+
+    // 1. 统计频率并求码长、范式码
+    std::vector<uint64_t> freq(alphabetSize, 0);
+    for (uint32_t s : symbols)
+        freq[s]++;
+    if (!entropy_detail::BuildCodeLengths(freq, encoded.codeLength))
+        return false;
+    if (!symbols.empty())
+        encoded.onlySymbol = symbols[0];
+
+    std::vector<uint32_t> codes;
+    entropy_detail::AssignCanonicalCodes(encoded.codeLength, codes);
+    for (uint32_t s = 0; s < alphabetSize; ++s)
+        codes[s] = entropy_detail::ReverseBits(codes[s], encoded.codeLength[s]); // 低位在前写入，码的高位先出
+
+    // 2. 64 位累加器写位流
+    uint64_t acc = 0;
+    uint32_t accBits = 0;
+    for (uint32_t s : symbols)
+    {
+        acc |= static_cast<uint64_t>(codes[s]) << accBits;
+        accBits += encoded.codeLength[s];
+        while (accBits >= 8)
+        {
+            encoded.bytes.push_back(static_cast<uint8_t>(acc));
+            acc >>= 8;
+            accBits -= 8;
+        }
+    }
+    if (accBits)
+        encoded.bytes.push_back(static_cast<uint8_t>(acc));
+    encoded.bytes.insert(encoded.bytes.end(), HUFF_PADDING, 0);
+    return true;
+}
+
+// 反序列化校验：码长不超过上限且恰好满足 Kraft 等式（完整前缀码），位流带填充；
+// 没有任何码时为单符号流，符号须在字母表内
+inline bool HuffmanStreamValid(const HuffmanStream &encoded)
+{
+    uint64_t kraft = 0;
+    for (uint8_t len : encoded.codeLength)
+    {
+        if (len > HUFF_MAX_BITS)
+            return false;
+        if (len)
+            kraft += 1ull << (HUFF_MAX_BITS - len);
+    }
+    if (kraft == 0)
+        return encoded.count == 0 || encoded.onlySymbol < encoded.codeLength.size();
+    return kraft == (1ull << HUFF_MAX_BITS) && encoded.bytes.size() >= HUFF_PADDING;
+}
+
+// 位流读过末尾（损坏）时 out 的长度小于 count
+inline void DecodeHuffman(const HuffmanStream &encoded, std::vector<uint32_t> &out)
+{
+    out.resize(encoded.count);
+    const uint32_t alphabetSize = static_cast<uint32_t>(encoded.codeLength.size());
+
+    // 0. 只有一个符号（码长全为 0）
+    bool anyCode = false;
+    for (uint32_t s = 0; s < alphabetSize; ++s)
+    {
+        anyCode |= encoded.codeLength[s] != 0;
+    }
+    if (!anyCode)
+    {
+        std::fill(out.begin(), out.end(), encoded.onlySymbol);
+        return;
+    }
+
+    // 1. 单符号表：低 HUFF_TABLE_BITS 位 -> (符号, 码长)，长码对应表项码长为 0
+    struct Single
+    {
+        uint32_t symbol;
+        uint8_t length;
+    };
+    const uint32_t tableSize = 1u << HUFF_TABLE_BITS;
+    const uint32_t tableMask = tableSize - 1;
+    std::vector<uint32_t> codes;
+    entropy_detail::AssignCanonicalCodes(encoded.codeLength, codes);
+    std::vector<Single> single(tableSize, {0, 0});
+    for (uint32_t s = 0; s < alphabetSize; ++s)
+    {
+        uint32_t len = encoded.codeLength[s];
+        if (len == 0 || len > HUFF_TABLE_BITS)
+            continue;
+        uint32_t rev = entropy_detail::ReverseBits(codes[s], len);
+        for (uint32_t fill = rev; fill < tableSize; fill += (1u << len))
+            single[fill] = {s, static_cast<uint8_t>(len)};
+    }
+
+    // 2. 多符号表：同一窗口内能完整解出的连续短码一次输出
+    struct Multi
+    {
+        uint8_t count;
+        uint8_t bits;
+        uint16_t symbols[HUFF_MULTI_SYMS];
+    };
+    std::vector<Multi> multi(tableSize);
+    for (uint32_t idx = 0; idx < tableSize; ++idx)
+    {
+        Multi entry = {0, 0, {0}};
+        while (entry.count < HUFF_MULTI_SYMS)
+        {
+            const Single &e = single[(idx >> entry.bits) & tableMask];
+            if (e.length == 0 || entry.bits + e.length > HUFF_TABLE_BITS || e.symbol > UINT16_MAX)
+                break;
+            entry.symbols[entry.count++] = static_cast<uint16_t>(e.symbol);
+            entry.bits += e.length;
+        }
+        multi[idx] = entry;
+    }
+
+    // 3. 长码走范式逐位解码
+    uint32_t lengthCount[HUFF_MAX_BITS + 1] = {0};
+    uint32_t firstCode[HUFF_MAX_BITS + 1] = {0};
+    uint32_t firstIndex[HUFF_MAX_BITS + 1] = {0};
+    std::vector<uint32_t> sorted;
+    sorted.reserve(alphabetSize);
+    for (uint32_t len = 1; len <= HUFF_MAX_BITS; ++len)
+    {
+        firstIndex[len] = static_cast<uint32_t>(sorted.size());
+        for (uint32_t s = 0; s < alphabetSize; ++s)
+        {
+            if (encoded.codeLength[s] == len)
+                sorted.push_back(s);
+        }
+        lengthCount[len] = static_cast<uint32_t>(sorted.size()) - firstIndex[len];
+        if (lengthCount[len])
+            firstCode[len] = codes[sorted[firstIndex[len]]];
+    }
+
+    const uint8_t *bytes = encoded.bytes.data();
+    const uint64_t bitLimit = (encoded.bytes.size() - HUFF_PADDING) * 8; // 窗口起点不超过此值时整字读取不越界
+    uint64_t bitPos = 0;
+    uint64_t i = 0;
+    while (i < encoded.count)
+    {
+        if (bitPos > bitLimit)
+            break;
+        uint64_t window = entropy_detail::PeekBits(bytes, bitPos);
+        const Multi &entry = multi[window & tableMask];
+        if (entry.count)
+        {
+            uint64_t n = std::min<uint64_t>(entry.count, encoded.count - i);
+            for (uint64_t k = 0; k < n; ++k)
+                out[i + k] = entry.symbols[k];
+            i += n;
+            bitPos += entry.bits;
+            continue;
+        }
+
+        uint32_t code = 0;
+        uint32_t len = 1;
+        for (; len <= HUFF_MAX_BITS; ++len)
+        {
+            code = (code << 1) | ((window >> (len - 1)) & 1);
+            if (lengthCount[len] && code - firstCode[len] < lengthCount[len])
+                break;
+        }
+        if (len > HUFF_MAX_BITS)
+        {
+            out.resize(i); // 位流损坏
+            return;
+        }
+        out[i++] = sorted[firstIndex[len] + code - firstCode[len]];
+        bitPos += len;
+    }
+    if (bitPos > bitLimit)
+        out.resize(i ? i - 1 : 0); // 最后的符号用到了填充位
+}
+
+// 真实占用：位流（不含填充）+ 每符号 1 字节码长 + 数量 / 单符号
+inline uint64_t HuffmanBytes(const HuffmanStream &encoded)
+{
+    uint64_t streamBytes = encoded.bytes.empty() ? 0 : encoded.bytes.size() - HUFF_PADDING;
+    return streamBytes + encoded.codeLength.size() + sizeof(encoded.count) + sizeof(encoded.onlySymbol);
+}
+
+/* ---------------------------------- rANS ---------------------------------- */
+// 前 directSymbols 个符号直接编码，其余编码为转义符号 directSymbols，原值 - directSymbols 另行位打包
+typedef struct rans_stream
+{
+    uint64_t count = 0;
+    uint32_t directSymbols = 0;
+    std::vector<uint16_t> freq; // directSymbols + 1 项，总和为 1 << ANS_SCALE_BITS
+    std::vector<uint8_t> bytes;
+    PackedValues<uint32_t> escapes;
+} RansStream;
+
+namespace entropy_detail
+{
+    // 计数量化为总和 1 << ANS_SCALE_BITS 的频率，出现过的符号至少为 1
+    inline void NormalizeFreq(const std::vector<uint64_t> &counts, std::vector<uint16_t> &freq)
+    {
+        const uint32_t total = 1u << ANS_SCALE_BITS;
+        uint64_t sum = 0;
+        for (uint64_t c : counts)
+            sum += c;
+
+        freq.assign(counts.size(), 0);
+        if (sum == 0)
+            return;
+        int64_t assigned = 0;
+        for (size_t s = 0; s < counts.size(); ++s)
+        {
+            if (!counts[s])
+                continue;
+            freq[s] = static_cast<uint16_t>(std::max<uint64_t>(1, (counts[s] * total + sum / 2) / sum));
+            assigned += freq[s];
+        }
+
+        // 误差逐个摊到当前频率最高（且仍大于 1）的符号上
+        while (assigned != total)
+        {
+            size_t best = std::max_element(freq.begin(), freq.end()) - freq.begin();
+            if (assigned < total)
+            {
+                freq[best] += static_cast<uint16_t>(total - assigned);
+                assigned = total;
+            }
+            else
+            {
+                uint16_t step = static_cast<uint16_t>(std::min<int64_t>(assigned - total, freq[best] - 1));
+                freq[best] -= step;
+                assigned -= step;
+            }
+        }
+    }
+} // namespace entropy_detail
+
+inline void EncodeRans(const std::vector<uint32_t> &symbols, uint32_t alphabetSize, RansStream &encoded)
+{
+    encoded = RansStream();
+    encoded.count = symbols.size();
+    encoded.directSymbols = std::min<uint32_t>(alphabetSize, ANS_MAX_DIRECT);
+    const uint32_t escape = encoded.directSymbols;
+
+    // 1. 统计并量化频率，收集转义值
+    std::vector<uint64_t> counts(encoded.directSymbols + 1, 0);
+    std::vector<uint32_t> escapes;
+    for (uint32_t s : symbols)
+    {
+        if (s < escape)
+        {
+            counts[s]++;
+        }
+        else
+        {
+            counts[escape]++;
+            escapes.push_back(s - escape);
+        }
+    }
+    entropy_detail::NormalizeFreq(counts, encoded.freq);
+    PackValues(escapes, encoded.escapes);
+
+    std::vector<uint32_t> start(encoded.freq.size() + 1, 0);
+    for (size_t s = 0; s < encoded.freq.size(); ++s)
+        start[s + 1] = start[s] + encoded.freq[s];
+
+    // 2. 倒序编码，两路状态按下标奇偶交替，字节从缓冲区尾部向前写
+    std::vector<uint8_t> buffer(symbols.size() * 4 + 16);
+    uint8_t *ptr = buffer.data() + buffer.size();
+    uint32_t state[2] = {ANS_LOWER_BOUND, ANS_LOWER_BOUND};
+    for (uint64_t i = symbols.size(); i-- > 0;)
+    {
+        uint32_t s = std::min(symbols[i], escape);
+        uint32_t &x = state[i & 1];
+        uint32_t freq = encoded.freq[s];
+        uint32_t xMax = ((ANS_LOWER_BOUND >> ANS_SCALE_BITS) << 8) * freq;
+        while (x >= xMax)
+        {
+            *--ptr = static_cast<uint8_t>(x);
+            x >>= 8;
+        }
+        x = ((x / freq) << ANS_SCALE_BITS) + (x % freq) + start[s];
+    }
+
+    // 3. 刷出状态：先写 state[1]，解码端先读到 state[0]
+    for (int k = 1; k >= 0; --k)
+    {
+        ptr -= 4;
+        for (int b = 0; b < 4; ++b)
+            ptr[b] = static_cast<uint8_t>(state[k] >> (8 * b));
+    }
+    encoded.bytes.assign(ptr, buffer.data() + buffer.size());
+}
+
+// 反序列化校验：频率表覆盖直接符号与转义符号且总和为 1 << ANS_SCALE_BITS，字节流至少含两路初始状态
+inline bool RansStreamValid(const RansStream &encoded)
+{
+    if (encoded.directSymbols > ANS_MAX_DIRECT || encoded.freq.size() != encoded.directSymbols + 1u ||
+        encoded.bytes.size() < 2 * sizeof(uint32_t) || encoded.escapes.count > encoded.count)
+        return false;
+    uint64_t sum = 0;
+    for (uint16_t freq : encoded.freq)
+        sum += freq;
+    return encoded.count == 0 || sum == (1u << ANS_SCALE_BITS);
+}
+
+// 字节流或转义值不足（损坏）时 out 的长度小于 count
+inline void DecodeRans(const RansStream &encoded, std::vector<uint32_t> &out)
+{
+    out.resize(encoded.count);
+    const uint32_t escape = encoded.directSymbols;
+    const uint32_t mask = (1u << ANS_SCALE_BITS) - 1;
+
+    // 1. 槽位 -> 符号查找表
+    std::vector<uint8_t> slotSymbol(1u << ANS_SCALE_BITS);
+    std::vector<uint32_t> start(encoded.freq.size(), 0);
+    uint32_t pos = 0;
+    for (size_t s = 0; s < encoded.freq.size(); ++s)
+    {
+        start[s] = pos;
+        std::fill_n(slotSymbol.begin() + pos, encoded.freq[s], static_cast<uint8_t>(s));
+        pos += encoded.freq[s];
+    }
+
+    std::vector<uint32_t> escapes;
+    UnpackValues(encoded.escapes, escapes);
+
+    // 2. 读取两路初始状态后按下标奇偶交替解码
+    const uint8_t *ptr = encoded.bytes.data();
+    const uint8_t *end = ptr + encoded.bytes.size();
+    uint32_t state[2] = {0, 0};
+    for (int k = 0; k < 2; ++k)
+    {
+        for (int b = 0; b < 4; ++b)
+            state[k] |= static_cast<uint32_t>(*ptr++) << (8 * b);
+    }
+
+    uint64_t escapeIndex = 0;
+    for (uint64_t i = 0; i < encoded.count; ++i)
+    {
+        uint32_t &x = state[i & 1];
+        uint32_t slot = x & mask;
+        uint32_t s = slotSymbol[slot];
+        x = encoded.freq[s] * (x >> ANS_SCALE_BITS) + slot - start[s];
+        while (x < ANS_LOWER_BOUND && ptr < end)
+            x = (x << 8) | *ptr++;
+        if (x < ANS_LOWER_BOUND || (s == escape && escapeIndex == escapes.size()))
+        {
+            out.resize(i);
+            return;
+        }
+        out[i] = (s == escape) ? escape + escapes[escapeIndex++] : s;
+    }
+}
+
+// 真实占用：字节流 + 频率表 + 转义值 + 数量
+inline uint64_t RansBytes(const RansStream &encoded)
+{
+    return encoded.bytes.size() + encoded.freq.size() * sizeof(uint16_t) + PackedValuesBytes(encoded.escapes) +
+           sizeof(encoded.count) + sizeof(encoded.directSymbols);
+}
@@ -0,0 +1,192 @@
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2026-10-19 20:40:00
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2026-10-19 20:40:00
+ * @FilePath: \SparseArrayAnalyzer\core\src\flat_dictionary.hpp
+ * @Description: 字典构建：取值范围小时直接查表，否则用开放寻址（线性探测）扁平哈希表；
+ *               可按线程分块各自建字典，再按块顺序合并并重映射编号
+ *
+ */
+#pragma once
+#include "alloc_tracker.h"
+#include "bit_packing.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#define DICT_DIRECT_RANGE       (1u << 16) // 键范围不超过此值时使用直接查找表
+#define DICT_INITIAL_CAPACITY   (64)       // 哈希表初始槽位数（2 的幂）
+#define DICT_EMPTY_SLOT         (UINT32_MAX)
+#define DICT_PARALLEL_MIN_ELEMS (1u << 20) // 元素数不少于此值才并行构建
+
+// 按元素位模式（有序键）判等，+0.0 / -0.0 视为不同值，保证解压逐位一致
+template <typename T>
+class FlatDictionary
+{
+public:
+    FlatDictionary() { rehash(DICT_INITIAL_CAPACITY); }
+
+    // 查找或插入，返回编号；一次探测完成
+    uint32_t insert(T value)
+    {
+        uint64_t key = ToOrderedKey(value);
+        size_t slot = hashKey(key) & _mask;
+        while (true)
+        {
+            uint32_t code = _slots[slot];
+            if (code == DICT_EMPTY_SLOT)
+                break;
+            if (_keys[code] == key)
+                return code;
+            slot = (slot + 1) & _mask;
+        }
+
+        uint32_t code = static_cast<uint32_t>(_values.size());
+        _slots[slot] = code;
+        _keys.push_back(key);
+        _values.push_back(value);
+        if (_values.size() * 2 > _slots.size()) // 负载因子不超过 0.5
+            rehash(_slots.size() * 2);
+        return code;
+    }
+
+    const std::vector<T> &values() const { return _values; }
+    std::vector<T> &values() { return _values; }
+
+private:
+    static uint64_t hashKey(uint64_t key)
+    {
+        // splitmix64 终结函数，打散连续整数
+        key ^= key >> 30;
+        key *= 0xBF58476D1CE4E5B9ull;
+        key ^= key >> 27;
+        key *= 0x94D049BB133111EBull;
+        return key ^ (key >> 31);
+    }
+
+    void rehash(size_t capacity)
+    {
+        _slots.assign(capacity, DICT_EMPTY_SLOT);
+        _mask = capacity - 1;
+        for (uint32_t code = 0; code < _keys.size(); ++code)
+        {
+            size_t slot = hashKey(_keys[code]) & _mask;
+            while (_slots[slot] != DICT_EMPTY_SLOT)
+                slot = (slot + 1) & _mask;
+            _slots[slot] = code;
+        }
+    }
+
+    std::vector<uint32_t> _slots; // 槽位 -> 编号
+    std::vector<uint64_t> _keys;  // 编号 -> 有序键
+    std::vector<T> _values;       // 编号 -> 值（首次出现顺序）
+    size_t _mask = 0;
+};
+
+namespace flat_dictionary_detail
+{
+    // 单线程构建 [begin, end) 区间的字典与编号
+    template <typename T>
+    void BuildRange(const T *data, size_t begin, size_t end, std::vector<T> &dict, uint32_t *codes)
+    {
+        if (begin >= end)
+        {
+            dict.clear();
+            return;
+        }
+
+        // 1. 键范围足够小时直接查表：键 - 最小键 即为表下标
+        uint64_t minKey = ToOrderedKey(data[begin]);
+        uint64_t maxKey = minKey;
+        for (size_t i = begin; i < end; ++i)
+        {
+            uint64_t key = ToOrderedKey(data[i]);
+            minKey = std::min(minKey, key);
+            maxKey = std::max(maxKey, key);
+        }
+
+        if (maxKey - minKey < DICT_DIRECT_RANGE)
+        {
+            std::vector<uint32_t> table(maxKey - minKey + 1, DICT_EMPTY_SLOT);
+            dict.clear();
+            for (size_t i = begin; i < end; ++i)
+            {
+                uint32_t &code = table[ToOrderedKey(data[i]) - minKey];
+                if (code == DICT_EMPTY_SLOT)
+                {
+                    code = static_cast<uint32_t>(dict.size());
+                    dict.push_back(data[i]);
+                }
+                codes[i] = code;
+            }
+            return;
+        }
+
+        // 2. 否则用开放寻址哈希表
+        FlatDictionary<T> table;
+        for (size_t i = begin; i < end; ++i)
+        {
+            codes[i] = table.insert(data[i]);
+        }
+        dict = std::move(table.values());
+    }
+} // namespace flat_dictionary_detail
+
+// 构建字典：dict 按首次出现顺序存放不同值，codes[i] 为 data[i] 的编号；
+// threadCount > 1 时分块并行构建，按块顺序合并后编号仍与单线程一致
+template <typename T>
+void BuildDictionary(const std::vector<T> &data, std::vector<T> &dict, std::vector<uint32_t> &codes, uint32_t threadCount = 1)
+{
+    codes.resize(data.size());
+    if (threadCount <= 1 || data.size() < threadCount)
+    {
+        flat_dictionary_detail::BuildRange(data.data(), 0, data.size(), dict, codes.data());
+        return;
+    }
+
+    // 1. 各线程构建局部字典
+    std::vector<std::vector<T>> localDicts(threadCount);
+    std::vector<size_t> bounds(threadCount + 1);
+    for (uint32_t t = 0; t <= threadCount; ++t)
+        bounds[t] = data.size() * t / threadCount;
+
+    AllocContext *allocContext = CurrentAllocContext(); // 工作线程的分配计入调用方所在阶段
+    std::vector<std::thread> workers;
+    workers.reserve(threadCount);
+    for (uint32_t t = 0; t < threadCount; ++t)
+    {
+        workers.emplace_back([&, t]
+                             {
+                                 AllocContextGuard allocGuard(allocContext);
+                                 flat_dictionary_detail::BuildRange(data.data(), bounds[t], bounds[t + 1], localDicts[t], codes.data()); });
+    }
+    for (auto &worker : workers)
+        worker.join();
+
+    // 2. 按块顺序合并，得到局部编号 -> 全局编号的映射
+    FlatDictionary<T> global;
+    std::vector<std::vector<uint32_t>> remaps(threadCount);
+    for (uint32_t t = 0; t < threadCount; ++t)
+    {
+        remaps[t].reserve(localDicts[t].size());
+        for (const T &value : localDicts[t])
+            remaps[t].push_back(global.insert(value));
+    }
+    dict = std::move(global.values());
+
+    // 3. 并行改写编号（第 0 块的映射恒为恒等，跳过）
+    workers.clear();
+    for (uint32_t t = 1; t < threadCount; ++t)
+    {
+        workers.emplace_back([&, t]
+                             {
+                                 AllocContextGuard allocGuard(allocContext);
+                                 const std::vector<uint32_t> &remap = remaps[t];
+                                 for (size_t i = bounds[t]; i < bounds[t + 1]; ++i)
+                                     codes[i] = remap[codes[i]]; });
+    }
+    for (auto &worker : workers)
+        worker.join();
+}
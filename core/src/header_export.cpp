@@ -0,0 +1,592 @@
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2026-10-19 22:20:00
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2026-10-19 22:20:00
+ * @FilePath: \SparseArrayAnalyzer\core\src\header_export.cpp
+ * @Description: 生成的头文件只依赖 <stdint.h>；查找用二分循环，比较结果以条件选择更新下标，循环内没有分支跳出
+ *
+ */
+#include "header_export.h"
+#include "index_storage.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <sstream>
+#include <unordered_map>
+
+#define HEADER_VALUES_PER_LINE (12)
+
+typedef struct header_layout_entry
+{
+    const char *prefix; // 注册名前缀
+    HeaderLayout layout;
+    const char *name;
+} HeaderLayoutEntry;
+
+static const HeaderLayoutEntry kHeaderLayouts[] = {
+    {"DenseArray", LAYOUT_DENSE, "dense"},
+    {"CSR", LAYOUT_CSR, "CSR"},
+    {"CSC", LAYOUT_CSC, "CSC"},
+    {"CoordinateList", LAYOUT_COORDINATE, "coordinate"},
+    {"BitmapPayloadEnc", LAYOUT_BITMAP, "bitmap + rank"},
+    {"RoaringBitmap", LAYOUT_BITMAP, "bitmap + rank"},
+    {"HashDictionary", LAYOUT_DICTIONARY, "dictionary"},
+    {"RunLengthEnc", LAYOUT_RUNS, "runs"},
+    {"CompactRLE", LAYOUT_RUNS, "runs"},
+};
+
+HeaderLayout SelectHeaderLayout(const std::string &algorithm)
+{
+    for (const auto &entry : kHeaderLayouts)
+    {
+        if (algorithm.rfind(entry.prefix, 0) == 0)
+            return entry.layout;
+    }
+    return LAYOUT_UNSUPPORTED;
+}
+
+static const char *HeaderLayoutName(HeaderLayout layout)
+{
+    for (const auto &entry : kHeaderLayouts)
+    {
+        if (entry.layout == layout)
+            return entry.name;
+    }
+    return "unsupported";
+}
+
+std::string HeaderSymbolFromPath(const std::string &path)
+{
+    std::string symbol = std::filesystem::path(path).stem().string();
+    for (auto &ch : symbol)
+    {
+        ch = std::isalnum(static_cast<unsigned char>(ch)) ? static_cast<char>(std::tolower(static_cast<unsigned char>(ch))) : '_';
+    }
+    if (symbol.empty() || std::isdigit(static_cast<unsigned char>(symbol[0])))
+        symbol = "saa_" + symbol;
+    return symbol;
+}
+
+static const char *IndexTypeName(uint32_t width)
+{
+    switch (width)
+    {
+    case sizeof(uint8_t):
+        return "uint8_t";
+    case sizeof(uint16_t):
+        return "uint16_t";
+    case sizeof(uint32_t):
+        return "uint32_t";
+    default:
+        return "uint64_t";
+    }
+}
+
+static std::string IndexLiteral(uint64_t value, uint32_t width)
+{
+    std::string text = std::to_string(value);
+    if (width == sizeof(uint64_t))
+        return text + "ULL";
+    if (width == sizeof(uint32_t))
+        return text + "u";
+    return text;
+}
+
+template <typename T>
+static const char *ValueTypeName()
+{
+    if constexpr (std::is_same_v<T, float>)
+        return "float";
+    else if constexpr (std::is_same_v<T, int32_t>)
+        return "int32_t";
+    else
+        return IndexTypeName(sizeof(T));
+}
+
+// 浮点按 9 位有效数字输出，可精确还原 float
+template <typename T>
+static std::string ValueLiteral(T value)
+{
+    if constexpr (std::is_same_v<T, float>)
+    {
+        std::ostringstream oss;
+        oss << std::setprecision(9) << value;
+        std::string text = oss.str();
+        if (text.find_first_of(".e") == std::string::npos)
+            text += ".0";
+        return text + "f";
+    }
+    else if constexpr (std::is_same_v<T, int32_t>)
+    {
+        return value == INT32_MIN ? "(-2147483647 - 1)" : std::to_string(value);
+    }
+    else
+    {
+        return IndexLiteral(value, sizeof(T));
+    }
+}
+
+// 按位模式区分取值，保证 -0.0f 等与主值不同的位模式原样导出
+template <typename T>
+static uint64_t ValueKey(T value)
+{
+    uint64_t key = 0;
+    std::memcpy(&key, &value, sizeof(T));
+    return key;
+}
+
+template <typename T>
+class HeaderBuilder
+{
+public:
+    HeaderBuilder(const std::string &symbol) : _symbol(symbol)
+    {
+        _macro = symbol;
+        for (auto &ch : _macro)
+            ch = static_cast<char>(std::toupper(static_cast<unsigned char>(ch)));
+    }
+
+    const std::string &symbol() const { return _symbol; }
+    const std::string &macro() const { return _macro; }
+    std::ostringstream &defines() { return _defines; }
+    std::ostringstream &accessors() { return _accessors; }
+
+    void valueArray(const std::string &suffix, const std::vector<T> &values)
+    {
+        array(ValueTypeName<T>(), suffix, values.size(), sizeof(T), [&](size_t i)
+              { return ValueLiteral(values[i]); });
+    }
+
+    // 按最大取值选择最小宽度
+    void indexArray(const std::string &suffix, const std::vector<uint64_t> &values, uint64_t maxValue)
+    {
+        uint32_t width = SelectIndexWidth(maxValue);
+        array(IndexTypeName(width), suffix, values.size(), width, [&](size_t i)
+              { return IndexLiteral(values[i], width); });
+    }
+
+    void wordArray(const std::string &suffix, const std::vector<uint64_t> &words)
+    {
+        array("uint64_t", suffix, words.size(), sizeof(uint64_t), [&](size_t i)
+              {
+                  std::ostringstream oss;
+                  oss << "0x" << std::hex << std::setw(16) << std::setfill('0') << words[i] << "ULL";
+                  return oss.str(); });
+    }
+
+    std::string build(const std::string &comment) const
+    {
+        std::ostringstream out;
+        out << "/*\n"
+            << " * Generated by sparse_array_analyzer, do not edit.\n"
+            << comment
+            << " * Table bytes: " << _tableBytes << "\n"
+            << " * C99 or C++. With C++14 and later the tables and accessors are constexpr,\n"
+            << " * so lookups of constant indices fold at compile time.\n"
+            << " */\n"
+            << "#ifndef SAA_" << _macro << "_H_\n"
+            << "#define SAA_" << _macro << "_H_\n\n"
+            << "#include <stdint.h>\n\n"
+            << "#if defined(__cplusplus) && __cplusplus >= 201402L\n"
+            << "#define " << _macro << "_CONST constexpr\n"
+            << "#define " << _macro << "_FN static constexpr\n"
+            << "#else\n"
+            << "#define " << _macro << "_CONST const\n"
+            << "#define " << _macro << "_FN static inline\n"
+            << "#endif\n\n"
+            << _defines.str()
+            << "#define " << _macro << "_TABLE_BYTES " << _tableBytes << "u\n\n"
+            << _tables.str() << "\n"
+            << _accessors.str() << "\n"
+            << "#endif /* SAA_" << _macro << "_H_ */\n";
+        return out.str();
+    }
+
+private:
+    void array(const char *ctype, const std::string &suffix, size_t count, uint32_t elemBytes,
+               const std::function<std::string(size_t)> &literal)
+    {
+        // C 不允许零长数组，空表补一个不会被访问的占位元素
+        size_t emitted = std::max<size_t>(count, 1);
+        _tables << "static " << _macro << "_CONST " << ctype << " " << _symbol << "_" << suffix << "[" << emitted << "] = {";
+        for (size_t i = 0; i < emitted; ++i)
+        {
+            _tables << ((i % HEADER_VALUES_PER_LINE) ? " " : "\n    ") << (i < count ? literal(i) : "0") << ",";
+        }
+        _tables << "\n};\n";
+        _tableBytes += count * elemBytes;
+    }
+
+    std::string _symbol;
+    std::string _macro;
+    std::ostringstream _defines;
+    std::ostringstream _tables;
+    std::ostringstream _accessors;
+    uint64_t _tableBytes = 0;
+};
+
+// 定长二分：返回 [lo, lo + n) 中最后一个满足 key[pos] <= target 的位置（不存在时为 lo）
+static void EmitSearchLoop(std::ostringstream &os, const std::string &keys, const std::string &target, uint32_t offset)
+{
+    os << "    while (n > 1)\n"
+       << "    {\n"
+       << "        uint64_t half = n / 2;\n"
+       << "        lo = (" << keys << "[lo + half" << (offset ? " - 1" : "") << "] <= " << target << ") ? lo + half : lo;\n"
+       << "        n -= half;\n"
+       << "    }\n";
+}
+
+template <typename T>
+static void EmitCompressedAxis(HeaderBuilder<T> &builder, const std::vector<T> &data, uint32_t rows, uint32_t cols,
+                               T mainValue, bool byRow)
+{
+    // 1. 外层按行（CSR）或按列（CSC）组织偏移
+    uint32_t outerCount = byRow ? rows : cols;
+    uint32_t innerCount = byRow ? cols : rows;
+    std::vector<uint64_t> offsets(1, 0);
+    std::vector<uint64_t> inner;
+    std::vector<T> values;
+    for (uint32_t outer = 0; outer < outerCount; ++outer)
+    {
+        for (uint32_t in = 0; in < innerCount; ++in)
+        {
+            uint64_t pos = byRow ? static_cast<uint64_t>(outer) * cols + in : static_cast<uint64_t>(in) * cols + outer;
+            if (ValueKey(data[pos]) != ValueKey(mainValue))
+            {
+                inner.push_back(in);
+                values.push_back(data[pos]);
+            }
+        }
+        offsets.push_back(values.size());
+    }
+
+    const std::string &s = builder.symbol();
+    const std::string &m = builder.macro();
+    std::string offsetName = byRow ? "row_offset" : "col_offset";
+    std::string innerName = byRow ? "col_index" : "row_index";
+    builder.defines() << "#define " << m << "_NNZ " << values.size() << "u\n";
+    builder.indexArray(offsetName, offsets, values.size());
+    builder.indexArray(innerName, inner, innerCount ? innerCount - 1 : 0);
+    builder.valueArray("values", values);
+
+    // 2. 外层定位区间，区间内对内层下标二分
+    std::string outerArg = byRow ? "row" : "col";
+    std::string innerArg = byRow ? "col" : "row";
+    auto &os = builder.accessors();
+    os << m << "_FN " << ValueTypeName<T>() << " " << s << "_at(uint32_t row, uint32_t col)\n"
+       << "{\n"
+       << "    uint64_t lo = " << s << "_" << offsetName << "[" << outerArg << "];\n"
+       << "    uint64_t n = " << s << "_" << offsetName << "[" << outerArg << " + 1] - lo;\n"
+       << "    if (n == 0)\n"
+       << "        return " << m << "_MAIN_VALUE;\n";
+    EmitSearchLoop(os, s + "_" + innerName, innerArg, 0);
+    os << "    return (" << s << "_" << innerName << "[lo] == " << innerArg << ") ? " << s << "_values[lo] : " << m << "_MAIN_VALUE;\n"
+       << "}\n\n"
+       << m << "_FN " << ValueTypeName<T>() << " " << s << "_get(uint64_t index)\n"
+       << "{\n"
+       << "    return " << s << "_at((uint32_t)(index / " << m << "_COLS), (uint32_t)(index % " << m << "_COLS));\n"
+       << "}\n";
+}
+
+template <typename T>
+static void EmitCoordinate(HeaderBuilder<T> &builder, const std::vector<T> &data, T mainValue)
+{
+    std::vector<uint64_t> positions;
+    std::vector<T> values;
+    for (uint64_t i = 0; i < data.size(); ++i)
+    {
+        if (ValueKey(data[i]) != ValueKey(mainValue))
+        {
+            positions.push_back(i);
+            values.push_back(data[i]);
+        }
+    }
+
+    const std::string &s = builder.symbol();
+    const std::string &m = builder.macro();
+    builder.defines() << "#define " << m << "_NNZ " << values.size() << "u\n";
+    builder.indexArray("position", positions, data.size() - 1);
+    builder.valueArray("values", values);
+
+    auto &os = builder.accessors();
+    os << m << "_FN " << ValueTypeName<T>() << " " << s << "_get(uint64_t index)\n"
+       << "{\n";
+    if (values.empty())
+    {
+        os << "    (void)index;\n"
+           << "    return " << m << "_MAIN_VALUE;\n"
+           << "}\n";
+        return;
+    }
+    os << "    uint64_t lo = 0;\n"
+       << "    uint64_t n = " << m << "_NNZ;\n";
+    EmitSearchLoop(os, s + "_position", "index", 0);
+    os << "    return (" << s << "_position[lo] == index) ? " << s << "_values[lo] : " << m << "_MAIN_VALUE;\n"
+       << "}\n";
+}
+
+template <typename T>
+static void EmitBitmap(HeaderBuilder<T> &builder, const std::vector<T> &data, T mainValue)
+{
+    // 1. 每 64 个元素一个位图字，rank 记录该字之前的非主值数量
+    std::vector<uint64_t> words((data.size() + 63) / 64, 0);
+    std::vector<uint64_t> rank(words.size(), 0);
+    std::vector<T> values;
+    for (uint64_t i = 0; i < data.size(); ++i)
+    {
+        if (i % 64 == 0)
+            rank[i / 64] = values.size();
+        if (ValueKey(data[i]) != ValueKey(mainValue))
+        {
+            words[i / 64] |= 1ull << (i % 64);
+            values.push_back(data[i]);
+        }
+    }
+
+    const std::string &s = builder.symbol();
+    const std::string &m = builder.macro();
+    builder.defines() << "#define " << m << "_NNZ " << values.size() << "u\n";
+    builder.wordArray("bits", words);
+    builder.indexArray("rank", rank, values.size());
+    builder.valueArray("values", values);
+
+    // 2. 可移植的 SWAR popcount，C 与 constexpr 均可用
+    auto &os = builder.accessors();
+    os << m << "_FN uint32_t " << s << "_popcount(uint64_t x)\n"
+       << "{\n"
+       << "    x = x - ((x >> 1) & 0x5555555555555555ULL);\n"
+       << "    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);\n"
+       << "    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;\n"
+       << "    return (uint32_t)((x * 0x0101010101010101ULL) >> 56);\n"
+       << "}\n\n"
+       << m << "_FN " << ValueTypeName<T>() << " " << s << "_get(uint64_t index)\n"
+       << "{\n"
+       << "    uint64_t word = " << s << "_bits[index >> 6];\n"
+       << "    uint64_t below = word & ((((uint64_t)1) << (index & 63)) - 1);\n"
+       << "    return ((word >> (index & 63)) & 1) ? " << s << "_values[" << s << "_rank[index >> 6] + " << s << "_popcount(below)] : "
+       << m << "_MAIN_VALUE;\n"
+       << "}\n";
+}
+
+template <typename T>
+static int8_t EmitDictionary(HeaderBuilder<T> &builder, const std::vector<T> &data,
+                             const std::vector<std::pair<T, uint64_t>> &byFrequency)
+{
+    // 1. 字典按频率降序，下标定宽位打包（低位在前），末尾多补一个字供跨字读取
+    uint32_t bitWidth = 0;
+    while ((1ull << bitWidth) < byFrequency.size())
+        ++bitWidth;
+    if (bitWidth > 32)
+        return ERROR_UNSUPPORT_FEATURE;
+
+    std::unordered_map<uint64_t, uint64_t> slot;
+    std::vector<T> dict;
+    for (const auto &entry : byFrequency)
+    {
+        slot[ValueKey(entry.first)] = dict.size();
+        dict.push_back(entry.first);
+    }
+
+    const std::string &s = builder.symbol();
+    const std::string &m = builder.macro();
+    builder.defines() << "#define " << m << "_DICT_SIZE " << dict.size() << "u\n"
+                      << "#define " << m << "_INDEX_BITS " << bitWidth << "u\n";
+    builder.valueArray("dict", dict);
+
+    auto &os = builder.accessors();
+    os << m << "_FN " << ValueTypeName<T>() << " " << s << "_get(uint64_t index)\n"
+       << "{\n";
+    if (bitWidth == 0)
+    {
+        os << "    (void)index;\n"
+           << "    return " << s << "_dict[0];\n"
+           << "}\n";
+        return SAA_SUCCESS;
+    }
+
+    std::vector<uint64_t> words((data.size() * bitWidth + 63) / 64 + 1, 0);
+    for (uint64_t i = 0; i < data.size(); ++i)
+    {
+        uint64_t code = slot[ValueKey(data[i])];
+        uint64_t bit = i * bitWidth;
+        words[bit / 64] |= code << (bit % 64);
+        if (bit % 64 + bitWidth > 64)
+            words[bit / 64 + 1] |= code >> (64 - bit % 64);
+    }
+    builder.wordArray("index_words", words);
+
+    // 2. 读相邻两个字拼出下标；(w << 1) << (63 - shift) 避免 shift 为 0 时左移 64 位
+    os << "    uint64_t bit = index * " << m << "_INDEX_BITS;\n"
+       << "    uint32_t shift = (uint32_t)(bit & 63);\n"
+       << "    uint64_t lo = " << s << "_index_words[bit >> 6] >> shift;\n"
+       << "    uint64_t hi = (" << s << "_index_words[(bit >> 6) + 1] << 1) << (63 - shift);\n"
+       << "    return " << s << "_dict[(lo | hi) & ((((uint64_t)1) << " << m << "_INDEX_BITS) - 1)];\n"
+       << "}\n";
+    return SAA_SUCCESS;
+}
+
+template <typename T>
+static void EmitRuns(HeaderBuilder<T> &builder, const std::vector<T> &data)
+{
+    // 1. 行优先游程，run_end 为每段的结束位置（不含）
+    std::vector<uint64_t> runEnd;
+    std::vector<T> values;
+    for (uint64_t i = 0; i < data.size(); ++i)
+    {
+        if (values.empty() || ValueKey(values.back()) != ValueKey(data[i]))
+        {
+            if (!values.empty())
+                runEnd.push_back(i);
+            values.push_back(data[i]);
+        }
+    }
+    runEnd.push_back(data.size());
+
+    const std::string &s = builder.symbol();
+    const std::string &m = builder.macro();
+    builder.defines() << "#define " << m << "_RUNS " << values.size() << "u\n";
+    builder.indexArray("run_end", runEnd, data.size());
+    builder.valueArray("values", values);
+
+    // 2. 第一个 run_end > index 的游程
+    auto &os = builder.accessors();
+    os << m << "_FN " << ValueTypeName<T>() << " " << s << "_get(uint64_t index)\n"
+       << "{\n"
+       << "    uint64_t lo = 0;\n"
+       << "    uint64_t n = " << m << "_RUNS;\n";
+    EmitSearchLoop(os, s + "_run_end", "index", 1);
+    os << "    return " << s << "_values[lo];\n"
+       << "}\n";
+}
+
+template <typename T>
+static int8_t ExportTyped(HeaderLayout layout, const std::string &algorithm, const std::vector<T> &data, bool is2D,
+                          uint32_t rows, uint32_t cols, const std::string &symbol, std::string &header)
+{
+    // 1. 检查输入
+    if (data.empty())
+    {
+        return ERROR_INPUT_EMPTY;
+    }
+    if (!is2D && (layout == LAYOUT_CSR || layout == LAYOUT_CSC))
+    {
+        return ERROR_UNSUPPORT_DIMENSION;
+    }
+    if constexpr (std::is_floating_point_v<T>)
+    {
+        if (std::any_of(data.begin(), data.end(), [](T v)
+                        { return !std::isfinite(v); }))
+        {
+            std::cerr << LOG_WARN << "Non-finite values cannot be exported as C literals.\n";
+            return ERROR_UNSUPPORT_FEATURE;
+        }
+    }
+
+    // 2. 统计取值频率，频率最高者为主值（同频取先出现者）
+    std::unordered_map<uint64_t, size_t> slot;
+    std::vector<std::pair<T, uint64_t>> byFrequency;
+    for (const auto &value : data)
+    {
+        auto it = slot.try_emplace(ValueKey(value), byFrequency.size()).first;
+        if (it->second == byFrequency.size())
+            byFrequency.push_back({value, 0});
+        ++byFrequency[it->second].second;
+    }
+    std::stable_sort(byFrequency.begin(), byFrequency.end(), [](const auto &a, const auto &b)
+                     { return a.second > b.second; });
+    T mainValue = byFrequency.front().first;
+
+    // 3. 形状与主值
+    HeaderBuilder<T> builder(symbol);
+    const std::string &m = builder.macro();
+    builder.defines() << "#define " << m << "_ROWS " << rows << "u\n"
+                      << "#define " << m << "_COLS " << cols << "u\n"
+                      << "#define " << m << "_COUNT " << data.size() << "u\n"
+                      << "#define " << m << "_MAIN_VALUE (" << ValueLiteral(mainValue) << ")\n";
+
+    // 4. 按布局生成表与访问函数
+    int8_t ret = SAA_SUCCESS;
+    switch (layout)
+    {
+    case LAYOUT_DENSE:
+        builder.valueArray("data", data);
+        builder.accessors() << m << "_FN " << ValueTypeName<T>() << " " << symbol << "_get(uint64_t index)\n"
+                            << "{\n"
+                            << "    return " << symbol << "_data[index];\n"
+                            << "}\n";
+        break;
+    case LAYOUT_CSR:
+    case LAYOUT_CSC:
+        EmitCompressedAxis(builder, data, rows, cols, mainValue, layout == LAYOUT_CSR);
+        break;
+    case LAYOUT_COORDINATE:
+        EmitCoordinate(builder, data, mainValue);
+        break;
+    case LAYOUT_BITMAP:
+        EmitBitmap(builder, data, mainValue);
+        break;
+    case LAYOUT_DICTIONARY:
+        ret = EmitDictionary(builder, data, byFrequency);
+        break;
+    case LAYOUT_RUNS:
+        EmitRuns(builder, data);
+        break;
+    default:
+        ret = ERROR_UNSUPPORT_FEATURE;
+        break;
+    }
+    if (ret != SAA_SUCCESS)
+    {
+        return ret;
+    }
+
+    // CSR / CSC 的 _at 已在布局中生成，其余二维布局补一个按行列访问的入口
+    if (is2D && layout != LAYOUT_CSR && layout != LAYOUT_CSC)
+    {
+        builder.accessors() << "\n"
+                            << m << "_FN " << ValueTypeName<T>() << " " << symbol << "_at(uint32_t row, uint32_t col)\n"
+                            << "{\n"
+                            << "    return " << symbol << "_get((uint64_t)row * " << m << "_COLS + col);\n"
+                            << "}\n";
+    }
+
+    std::ostringstream comment;
+    comment << " * Format: " << algorithm << " (" << HeaderLayoutName(layout) << " layout), element "
+            << ElemTraits<T>::name << ", " << (is2D ? "2D " : "1D ") << rows << "x" << cols << "\n"
+            << " * Dense bytes: " << data.size() * sizeof(T) << "\n";
+    header = builder.build(comment.str());
+    return SAA_SUCCESS;
+}
+
+int8_t ExportHeader(const std::string &algorithm, const ArrayInput &input, const std::string &symbol,
+                    std::string &header)
+{
+    HeaderLayout layout = SelectHeaderLayout(algorithm);
+    if (layout == LAYOUT_UNSUPPORTED)
+    {
+        return ERROR_UNSUPPORT_FEATURE;
+    }
+
+    return std::visit([&](const auto &array) -> int8_t
+                      {
+                          using Array = std::decay_t<decltype(array)>;
+                          using T = typename Array::value_type;
+                          if constexpr (IsArrayData2D<Array>::value)
+                          {
+                              std::vector<T> flat;
+                              flat.reserve(static_cast<uint64_t>(array.rowCount) * array.colCount);
+                              for (const auto &row : array.arrayData)
+                                  flat.insert(flat.end(), row.begin(), row.end());
+                              return ExportTyped(layout, algorithm, flat, true, array.rowCount, array.colCount, symbol, header);
+                          }
+                          else
+                          {
+                              return ExportTyped(layout, algorithm, array.arrayData, false, 1,
+                                                 static_cast<uint32_t>(array.arrayData.size()), symbol, header);
+                          } },
+                      input);
+}
@@ -0,0 +1,298 @@
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2026-10-19 16:40:00
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2026-10-19 16:40:00
+ * @FilePath: \SparseArrayAnalyzer\core\src\index_codec.hpp
+ * @Description: 有序索引流压缩：差分 + Group Varint（行内列号/行号），LEB128 Varint，Elias-Fano（单调偏移）
+ *
+ */
+#pragma once
+#include "bit_packing.hpp"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+#define GROUP_VARINT_PADDING (16) // 字节流尾部填充，解码时整字/整寄存器读取无需越界判断
+
+/* ------------------------------ Group Varint ------------------------------ */
+// 每 4 个值一组：1 字节控制位（每值 2 位，记录字节数 - 1）+ 各值的小端有效字节
+typedef struct group_varint
+{
+    uint64_t count = 0;
+    std::vector<uint8_t> bytes; // 含 GROUP_VARINT_PADDING 字节填充
+} GroupVarint;
+
+inline uint32_t VarintByteCount(uint32_t value)
+{
+    return (value < (1u << 8)) ? 1 : (value < (1u << 16)) ? 2 : (value < (1u << 24)) ? 3 : 4;
+}
+
+inline void GroupVarintClear(GroupVarint &encoded)
+{
+    encoded.count = 0;
+    encoded.bytes.clear();
+}
+
+template <typename Alloc>
+void EncodeGroupVarint(const std::vector<uint32_t, Alloc> &values, GroupVarint &encoded)
+{
+    encoded.count = values.size();
+    encoded.bytes.clear();
+    encoded.bytes.reserve(values.size() * 2 + values.size() / 4 + GROUP_VARINT_PADDING);
+
+    for (size_t group = 0; group < values.size(); group += 4)
+    {
+        size_t ctrlPos = encoded.bytes.size();
+        encoded.bytes.push_back(0);
+        uint8_t ctrl = 0;
+        for (size_t k = 0; k < 4; ++k)
+        {
+            uint32_t value = (group + k < values.size()) ? values[group + k] : 0;
+            uint32_t length = VarintByteCount(value);
+            ctrl |= static_cast<uint8_t>((length - 1) << (2 * k));
+            for (uint32_t b = 0; b < length; ++b)
+                encoded.bytes.push_back(static_cast<uint8_t>(value >> (8 * b)));
+        }
+        encoded.bytes[ctrlPos] = ctrl;
+    }
+    encoded.bytes.insert(encoded.bytes.end(), GROUP_VARINT_PADDING, 0);
+}
+
+#if defined(__SSSE3__)
+// 控制字节 -> pshufb 重排表 / 本组数据字节数
+struct GroupVarintTable
+{
+    alignas(16) uint8_t shuffle[256][16];
+    uint8_t length[256];
+
+    GroupVarintTable()
+    {
+        for (uint32_t ctrl = 0; ctrl < 256; ++ctrl)
+        {
+            uint8_t src = 0;
+            for (uint32_t k = 0; k < 4; ++k)
+            {
+                uint32_t len = ((ctrl >> (2 * k)) & 3) + 1;
+                for (uint32_t b = 0; b < 4; ++b)
+                    shuffle[ctrl][4 * k + b] = (b < len) ? src++ : 0x80; // 0x80 置零
+            }
+            length[ctrl] = src;
+        }
+    }
+};
+#endif
+
+// 批量解码到 out（覆盖原内容）
+template <typename Alloc>
+void DecodeGroupVarint(const GroupVarint &encoded, std::vector<uint32_t, Alloc> &out)
+{
+    out.resize((encoded.count + 3) / 4 * 4);
+    const uint8_t *in = encoded.bytes.data();
+    uint32_t *dst = out.data();
+
+#if defined(__SSSE3__)
+    static const GroupVarintTable table;
+    for (uint64_t group = 0; group < encoded.count; group += 4, dst += 4)
+    {
+        uint8_t ctrl = *in++;
+        __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in));
+        __m128i mask = _mm_load_si128(reinterpret_cast<const __m128i *>(table.shuffle[ctrl]));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), _mm_shuffle_epi8(data, mask));
+        in += table.length[ctrl];
+    }
+#else
+    static const uint32_t lengthMask[4] = {0xFFu, 0xFFFFu, 0xFFFFFFu, 0xFFFFFFFFu};
+    for (uint64_t group = 0; group < encoded.count; group += 4, dst += 4)
+    {
+        uint8_t ctrl = *in++;
+        for (uint32_t k = 0; k < 4; ++k)
+        {
+            uint32_t code = (ctrl >> (2 * k)) & 3;
+            uint32_t value;
+            std::memcpy(&value, in, sizeof(value)); // 小端整字读取后按长度截断
+            dst[k] = value & lengthMask[code];
+            in += code + 1;
+        }
+    }
+#endif
+    out.resize(encoded.count);
+}
+
+// 反序列化校验：逐组按控制字节累加长度，数据恰好用完且其后留有完整填充
+inline bool GroupVarintValid(const GroupVarint &encoded)
+{
+    if (encoded.bytes.size() < GROUP_VARINT_PADDING)
+        return false;
+    const uint64_t dataBytes = encoded.bytes.size() - GROUP_VARINT_PADDING;
+    uint64_t pos = 0;
+    for (uint64_t group = 0; group < encoded.count; group += 4)
+    {
+        if (pos >= dataBytes)
+            return false;
+        uint8_t ctrl = encoded.bytes[pos++];
+        for (uint32_t k = 0; k < 4; ++k)
+            pos += ((ctrl >> (2 * k)) & 3) + 1;
+    }
+    return pos == dataBytes;
+}
+
+// 反序列化校验：offsets 划分的每一段内，差分累加还原的坐标（next + gap，next 为上一坐标 + 1）都小于 bound
+template <typename OffsetVec, typename GapVec>
+bool SegmentGapsValid(const OffsetVec &offsets, const GapVec &gaps, uint64_t bound)
+{
+    for (size_t seg = 0; seg + 1 < offsets.size(); ++seg)
+    {
+        uint64_t next = 0;
+        for (uint64_t idx = offsets[seg]; idx < offsets[seg + 1]; ++idx)
+        {
+            next += gaps[idx];
+            if (next >= bound)
+                return false;
+            ++next;
+        }
+    }
+    return true;
+}
+
+// 真实占用：数据字节（不含填充）+ 数量
+inline uint64_t GroupVarintBytes(const GroupVarint &encoded)
+{
+    return encoded.bytes.size() - GROUP_VARINT_PADDING + sizeof(encoded.count);
+}
+
+/* -------------------------------- Varint ---------------------------------- */
+// LEB128：每字节低 7 位为数据，最高位表示后面还有字节
+inline void EncodeVarint(uint64_t value, std::vector<uint8_t> &bytes)
+{
+    while (value >= 0x80)
+    {
+        bytes.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back(static_cast<uint8_t>(value));
+}
+
+// 从 in 读取一个值并前移指针
+inline uint64_t DecodeVarint(const uint8_t *&in)
+{
+    uint64_t value = *in & 0x7F;
+    uint32_t shift = 7;
+    while (*in++ & 0x80)
+    {
+        value |= static_cast<uint64_t>(*in & 0x7F) << shift;
+        shift += 7;
+    }
+    return value;
+}
+
+// 带边界的读取：超过 end 或超过 64 位时返回 false
+inline bool DecodeVarintChecked(const uint8_t *&in, const uint8_t *end, uint64_t &value)
+{
+    value = 0;
+    for (uint32_t shift = 0; shift < 64 && in < end; shift += 7)
+    {
+        uint8_t byte = *in++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+/* ------------------------------- Elias-Fano ------------------------------- */
+// 单调不减序列：低 l 位定长打包，高位以一元码写入位向量（第 i 个值的高位 h 置位于 h + i）
+typedef struct elias_fano
+{
+    uint64_t count = 0;
+    uint64_t universe = 0; // 最大值
+    uint8_t lowBits = 0;
+    PackedValues<uint64_t> low;
+    std::vector<uint64_t> high;
+} EliasFano;
+
+// 清空但保留低位流与高位位向量的容量
+inline void EliasFanoClear(EliasFano &encoded)
+{
+    encoded.count = 0;
+    encoded.universe = 0;
+    encoded.lowBits = 0;
+    PackedValuesClear(encoded.low);
+    encoded.high.clear();
+}
+
+// 临时低位数组与 values 使用同一分配器
+template <typename Alloc>
+void EncodeEliasFano(const std::vector<uint64_t, Alloc> &values, EliasFano &encoded)
+{
+    EliasFanoClear(encoded);
+    encoded.count = values.size();
+    if (values.empty())
+        return;
+
+    encoded.universe = values.back();
+    while (encoded.lowBits < 63 && (encoded.universe >> (encoded.lowBits + 1)) >= encoded.count)
+        ++encoded.lowBits;
+
+    uint64_t lowMask = encoded.lowBits ? ((1ull << encoded.lowBits) - 1) : 0;
+    uint64_t highBits = encoded.count + (encoded.universe >> encoded.lowBits) + 1;
+    encoded.high.assign((highBits + 63) / 64, 0);
+
+    std::vector<uint64_t, Alloc> lows(values.get_allocator());
+    lows.reserve(values.size());
+    for (uint64_t i = 0; i < values.size(); ++i)
+    {
+        uint64_t pos = (values[i] >> encoded.lowBits) + i;
+        encoded.high[pos >> 6] |= 1ull << (pos & 63);
+        lows.push_back(values[i] & lowMask);
+    }
+    PackValues(lows, encoded.low);
+}
+
+// 顺序解码：逐字取最低置位（ctz）还原高位
+template <typename Alloc>
+void DecodeEliasFano(const EliasFano &encoded, std::vector<uint64_t, Alloc> &out)
+{
+    UnpackValues(encoded.low, out);
+    uint64_t index = 0;
+    for (uint64_t word = 0; word < encoded.high.size() && index < encoded.count; ++word)
+    {
+        uint64_t bits = encoded.high[word];
+        while (bits && index < encoded.count)
+        {
+            uint64_t pos = word * 64 + __builtin_ctzll(bits);
+            out[index] |= (pos - index) << encoded.lowBits;
+            ++index;
+            bits &= bits - 1;
+        }
+    }
+}
+
+// 反序列化校验：低位数量与总数一致，高位位向量长度与编码时相同且恰有 count 个置位；
+// 解码结果是否单调、是否在取值范围内由调用方检查
+inline bool EliasFanoValid(const EliasFano &encoded)
+{
+    if (encoded.count == 0)
+        return encoded.low.count == 0;
+    if (encoded.lowBits > 63 || encoded.low.count != encoded.count)
+        return false;
+
+    uint64_t ones = 0;
+    for (uint64_t word : encoded.high)
+        ones += __builtin_popcountll(word);
+    uint64_t highValue = encoded.universe >> encoded.lowBits;
+    if (ones != encoded.count || highValue > encoded.high.size() * 64)
+        return false;
+    return encoded.high.size() == (encoded.count + highValue + 1 + 63) / 64;
+}
+
+// 真实占用：低位流 + 高位位向量 + 数量/上界/位宽
+inline uint64_t EliasFanoBytes(const EliasFano &encoded)
+{
+    uint64_t highBits = encoded.count ? encoded.count + (encoded.universe >> encoded.lowBits) + 1 : 0;
+    return PackedValuesBytes(encoded.low) + (highBits + 7) / 8 +
+           sizeof(encoded.count) + sizeof(encoded.universe) + sizeof(encoded.lowBits);
+}
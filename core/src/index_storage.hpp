@@ -0,0 +1,126 @@
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2026-10-19 14:10:00
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2026-10-19 14:10:00
+ * @FilePath: \SparseArrayAnalyzer\core\src\index_storage.hpp
+ * @Description: 变宽索引存储，压缩时按取值上限选择最小可容纳的无符号类型
+ *
+ */
+#pragma once
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+// 各备选宽度，解压内核通过 std::visit 为每种宽度生成特化版本
+using IndexStorage = std::variant<std::vector<uint8_t>, std::vector<uint16_t>,
+                                  std::vector<uint32_t>, std::vector<uint64_t>>;
+
+// 按索引最大取值选择宽度（字节）
+inline uint32_t SelectIndexWidth(uint64_t maxValue)
+{
+    if (maxValue <= std::numeric_limits<uint8_t>::max())
+        return sizeof(uint8_t);
+    if (maxValue <= std::numeric_limits<uint16_t>::max())
+        return sizeof(uint16_t);
+    if (maxValue <= std::numeric_limits<uint32_t>::max())
+        return sizeof(uint32_t);
+    return sizeof(uint64_t);
+}
+
+inline IndexStorage MakeIndexStorage(uint64_t maxValue)
+{
+    switch (SelectIndexWidth(maxValue))
+    {
+    case sizeof(uint8_t):
+        return std::vector<uint8_t>();
+    case sizeof(uint16_t):
+        return std::vector<uint16_t>();
+    case sizeof(uint32_t):
+        return std::vector<uint32_t>();
+    default:
+        return std::vector<uint64_t>();
+    }
+}
+
+// 按取值上限重置为空：宽度不变时保留原有容量，供压缩器复用
+inline void ResetIndexStorage(IndexStorage &storage, uint64_t maxValue)
+{
+    uint32_t width = SelectIndexWidth(maxValue);
+    bool sameWidth = std::visit([&](auto &vec)
+                                {
+                                    vec.clear();
+                                    return sizeof(typename std::decay_t<decltype(vec)>::value_type) == width; },
+                                storage);
+    if (!sameWidth)
+        storage = MakeIndexStorage(maxValue);
+}
+
+inline void IndexStorageClear(IndexStorage &storage)
+{
+    std::visit([](auto &vec)
+               { vec.clear(); },
+               storage);
+}
+
+// 每个索引占用的字节数
+inline uint32_t IndexStorageWidth(const IndexStorage &storage)
+{
+    return std::visit([](const auto &vec)
+                      { return static_cast<uint32_t>(sizeof(typename std::decay_t<decltype(vec)>::value_type)); },
+                      storage);
+}
+
+inline uint64_t IndexStorageCount(const IndexStorage &storage)
+{
+    return std::visit([](const auto &vec)
+                      { return static_cast<uint64_t>(vec.size()); },
+                      storage);
+}
+
+inline uint64_t IndexStorageBytes(const IndexStorage &storage)
+{
+    return IndexStorageCount(storage) * IndexStorageWidth(storage);
+}
+
+inline bool IndexStorageEmpty(const IndexStorage &storage)
+{
+    return IndexStorageCount(storage) == 0;
+}
+
+// 反序列化校验：偏移从 0 开始单调不减，末项等于元素数
+template <typename Vec>
+bool OffsetsValid(const Vec &offsets, uint64_t total)
+{
+    if (offsets.empty() || offsets[0] != 0 || offsets[offsets.size() - 1] != total)
+        return false;
+    for (size_t i = 1; i < offsets.size(); ++i)
+    {
+        if (offsets[i] < offsets[i - 1])
+            return false;
+    }
+    return true;
+}
+
+inline bool OffsetsValid(const IndexStorage &offsets, uint64_t total)
+{
+    return std::visit([total](const auto &vec)
+                      { return OffsetsValid(vec, total); },
+                      offsets);
+}
+
+// 反序列化校验：从 first 起的每个索引都落在 [low, high] 内
+inline bool IndicesInRange(const IndexStorage &indices, uint64_t low, uint64_t high, size_t first = 0)
+{
+    return std::visit([=](const auto &vec)
+                      {
+                          for (size_t i = first; i < vec.size(); ++i)
+                          {
+                              if (vec[i] < low || vec[i] > high)
+                                  return false;
+                          }
+                          return true; },
+                      indices);
+}
@@ -0,0 +1,160 @@
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2026-10-19 18:30:00
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2026-10-19 18:30:00
+ * @FilePath: \SparseArrayAnalyzer\core\src\linear_order.hpp
+ * @Description: 二维数组线性化顺序：行优先、列优先、Morton（Z 序）、Hilbert，任意行列数均可
+ *
+ */
+#pragma once
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+typedef enum linear_order
+{
+    ORDER_ROW_MAJOR = 0, // 行优先
+    ORDER_COL_MAJOR = 1, // 列优先
+    ORDER_MORTON = 2,    // Z 序，四叉树递归（行列交织）
+    ORDER_HILBERT = 3,   // 广义 Hilbert 曲线，相邻两步总是相邻格子
+    ORDER_COUNT,
+    ORDER_AUTO = ORDER_COUNT, // 压缩时选游程最少的顺序
+} LinearOrder;
+
+inline const char *LinearOrderName(LinearOrder order)
+{
+    static const char *names[] = {"Row", "Col", "Morton", "Hilbert", "Auto"};
+    return names[order];
+}
+
+namespace linear_order_detail
+{
+    // Morton：覆盖行列的 2^k 方阵四分递归，越界象限整体剪掉
+    template <typename Fn>
+    void VisitMorton(uint32_t r0, uint32_t c0, uint32_t size, uint32_t rows, uint32_t cols, Fn &fn)
+    {
+        if (r0 >= rows || c0 >= cols)
+            return;
+        if (size == 1)
+        {
+            fn(r0, c0);
+            return;
+        }
+        uint32_t half = size / 2;
+        VisitMorton(r0, c0, half, rows, cols, fn);
+        VisitMorton(r0, c0 + half, half, rows, cols, fn);
+        VisitMorton(r0 + half, c0, half, rows, cols, fn);
+        VisitMorton(r0 + half, c0 + half, half, rows, cols, fn);
+    }
+
+    inline int64_t FloorHalf(int64_t v)
+    {
+        return (v >= 0) ? v / 2 : -((-v + 1) / 2);
+    }
+
+    inline int64_t Sign(int64_t v)
+    {
+        return (v > 0) - (v < 0);
+    }
+
+    // 广义 Hilbert（gilbert2d）：(x, y) 为起点，a 为主方向向量，b 为正交方向向量，
+    // 矩形不必是 2 的幂方阵；x 对应列、y 对应行
+    template <typename Fn>
+    void VisitHilbert(int64_t x, int64_t y, int64_t ax, int64_t ay, int64_t bx, int64_t by, Fn &fn)
+    {
+        int64_t w = std::llabs(ax + ay);
+        int64_t h = std::llabs(bx + by);
+        int64_t dax = Sign(ax), day = Sign(ay);
+        int64_t dbx = Sign(bx), dby = Sign(by);
+
+        // 1. 单行 / 单列直接走完
+        if (h == 1)
+        {
+            for (int64_t i = 0; i < w; ++i, x += dax, y += day)
+                fn(static_cast<uint32_t>(y), static_cast<uint32_t>(x));
+            return;
+        }
+        if (w == 1)
+        {
+            for (int64_t i = 0; i < h; ++i, x += dbx, y += dby)
+                fn(static_cast<uint32_t>(y), static_cast<uint32_t>(x));
+            return;
+        }
+
+        int64_t ax2 = FloorHalf(ax), ay2 = FloorHalf(ay);
+        int64_t bx2 = FloorHalf(bx), by2 = FloorHalf(by);
+        int64_t w2 = std::llabs(ax2 + ay2);
+        int64_t h2 = std::llabs(bx2 + by2);
+
+        if (2 * w > 3 * h)
+        {
+            // 2. 细长矩形：沿主方向一分为二，尽量保持偶数步长
+            if ((w2 % 2) && (w > 2))
+            {
+                ax2 += dax;
+                ay2 += day;
+            }
+            VisitHilbert(x, y, ax2, ay2, bx, by, fn);
+            VisitHilbert(x + ax2, y + ay2, ax - ax2, ay - ay2, bx, by, fn);
+        }
+        else
+        {
+            // 3. 一般情况：上、横、下三段
+            if ((h2 % 2) && (h > 2))
+            {
+                bx2 += dbx;
+                by2 += dby;
+            }
+            VisitHilbert(x, y, bx2, by2, ax2, ay2, fn);
+            VisitHilbert(x + bx2, y + by2, ax, ay, bx - bx2, by - by2, fn);
+            VisitHilbert(x + (ax - dax) + (bx2 - dbx), y + (ay - day) + (by2 - dby),
+                         -bx2, -by2, -(ax - ax2), -(ay - ay2), fn);
+        }
+    }
+} // namespace linear_order_detail
+
+// 按指定顺序依次访问 rows x cols 的每个格子，fn(row, col)
+template <typename Fn>
+void ForEachInOrder(LinearOrder order, uint32_t rows, uint32_t cols, Fn &&fn)
+{
+    if (rows == 0 || cols == 0)
+        return;
+
+    switch (order)
+    {
+    case ORDER_COL_MAJOR:
+        for (uint32_t c = 0; c < cols; ++c)
+            for (uint32_t r = 0; r < rows; ++r)
+                fn(r, c);
+        break;
+    case ORDER_MORTON:
+    {
+        uint32_t size = 1;
+        while (size < rows || size < cols)
+            size <<= 1;
+        linear_order_detail::VisitMorton(0, 0, size, rows, cols, fn);
+        break;
+    }
+    case ORDER_HILBERT:
+        if (cols >= rows)
+            linear_order_detail::VisitHilbert(0, 0, cols, 0, 0, rows, fn);
+        else
+            linear_order_detail::VisitHilbert(0, 0, 0, rows, cols, 0, fn);
+        break;
+    default:
+        for (uint32_t r = 0; r < rows; ++r)
+            for (uint32_t c = 0; c < cols; ++c)
+                fn(r, c);
+        break;
+    }
+}
+
+// 线性位置 -> 行优先下标的置换表
+inline void BuildOrderPermutation(LinearOrder order, uint32_t rows, uint32_t cols, std::vector<uint64_t> &perm)
+{
+    perm.clear();
+    perm.reserve(static_cast<size_t>(rows) * cols);
+    ForEachInOrder(order, rows, cols, [&](uint32_t r, uint32_t c)
+                   { perm.push_back(static_cast<uint64_t>(r) * cols + c); });
+}
@@ -0,0 +1,261 @@
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2026-10-20 00:40:00
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2026-10-20 00:40:00
+ * @FilePath: \SparseArrayAnalyzer\core\src\perf_counters.cpp
+ * @Description: 每个线程首次使用时打开一组独立计数器（inherit，含子线程；不用分组读取，因分组与 inherit 不兼容），
+ *               之后每个阶段只做 read / enable / disable / read 并取差值；计数器被复用时按运行时间比例缩放
+ *
+ */
+#include "perf_counters.h"
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static std::atomic<bool> g_perfEnabled{false};
+
+const char *PerfCounterName(PerfCounterId id)
+{
+    static const char *const names[PERF_COUNTER_COUNT] = {"cycles", "instructions", "L1D-misses", "LLC-misses", "branch-misses"};
+    return (id < PERF_COUNTER_COUNT) ? names[id] : "unknown";
+}
+
+bool PerfCountersEnabled()
+{
+    return g_perfEnabled.load(std::memory_order_relaxed);
+}
+
+#ifdef __linux__
+
+typedef struct counter_spec
+{
+    uint32_t type;
+    uint64_t config;
+} CounterSpec;
+
+static const CounterSpec COUNTER_SPECS[PERF_COUNTER_COUNT] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+};
+
+class ThreadCounters
+{
+public:
+    ~ThreadCounters()
+    {
+        for (int fd : _fds)
+        {
+            if (fd >= 0)
+                close(fd);
+        }
+    }
+
+    // 打开本线程的计数器，返回成功打开的数量，firstError 为第一个失败的 errno
+    uint32_t open(int &firstError)
+    {
+        if (_opened)
+        {
+            firstError = _firstError;
+            return _openCount;
+        }
+        _opened = true;
+
+        for (uint32_t i = 0; i < PERF_COUNTER_COUNT; ++i)
+        {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = COUNTER_SPECS[i].type;
+            attr.config = COUNTER_SPECS[i].config;
+            attr.disabled = 1;
+            attr.inherit = 1; // 统计阶段内创建的线程（如字典并行构建）
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+            _fds[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+            if (_fds[i] >= 0)
+                ++_openCount;
+            else if (_firstError == 0)
+                _firstError = errno;
+        }
+        firstError = _firstError;
+        return _openCount;
+    }
+
+    // 不用 IOC_RESET：inherit 计数器的值含已结束子线程的累计，RESET 只清父线程自身的部分，
+    // 因此开始时记下读数，结束时报告差值
+    void start()
+    {
+        for (uint32_t i = 0; i < PERF_COUNTER_COUNT; ++i)
+        {
+            if (_fds[i] < 0)
+                continue;
+            _startValid[i] = readRaw(i, _startData[i]);
+            ioctl(_fds[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    void stop(PerfCounterSample &sample)
+    {
+        for (int fd : _fds)
+        {
+            if (fd >= 0)
+                ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+
+        sample = PerfCounterSample();
+        for (uint32_t i = 0; i < PERF_COUNTER_COUNT; ++i)
+        {
+            uint64_t data[3] = {0}; // value, time_enabled, time_running
+            if (_fds[i] < 0 || !_startValid[i] || !readRaw(i, data))
+                continue;
+            uint64_t value = data[0] - _startData[i][0];
+            uint64_t enabled = data[1] - _startData[i][1];
+            uint64_t running = data[2] - _startData[i][2];
+            if (running == 0)
+                continue;
+            double scale = static_cast<double>(enabled) / running; // 计数器被复用时按运行时间外推
+            sample.values[i] = static_cast<uint64_t>(value * scale);
+            sample.validMask |= 1u << i;
+        }
+    }
+
+private:
+    bool readRaw(uint32_t i, uint64_t (&data)[3]) const
+    {
+        return read(_fds[i], data, sizeof(data)) == static_cast<ssize_t>(sizeof(data));
+    }
+
+    int _fds[PERF_COUNTER_COUNT] = {-1, -1, -1, -1, -1};
+    uint64_t _startData[PERF_COUNTER_COUNT][3] = {}; // 阶段开始时的 value, time_enabled, time_running
+    bool _startValid[PERF_COUNTER_COUNT] = {};
+    bool _opened = false;
+    uint32_t _openCount = 0;
+    int _firstError = 0;
+};
+
+static ThreadCounters &LocalCounters()
+{
+    static thread_local ThreadCounters counters;
+    return counters;
+}
+
+static std::string PerfErrorReason(int error)
+{
+    switch (error)
+    {
+    case EACCES:
+    case EPERM:
+    {
+        std::ifstream paranoid("/proc/sys/kernel/perf_event_paranoid");
+        std::string level;
+        paranoid >> level;
+        return "permission denied (perf_event_paranoid=" + (level.empty() ? std::string("?") : level) +
+               ", needs <= 2 or CAP_PERFMON)";
+    }
+    case ENOENT:
+    case EOPNOTSUPP:
+        return "no hardware PMU exposed (virtual machine or container?)";
+    case ENOSYS:
+        return "kernel built without perf events";
+    default:
+        return std::strerror(error);
+    }
+}
+
+int8_t EnablePerfCounters(std::string &reason)
+{
+    int error = 0;
+    uint32_t opened = LocalCounters().open(error);
+    if (opened == 0)
+    {
+        reason = PerfErrorReason(error);
+        return ERROR_UNSUPPORT_FEATURE;
+    }
+
+    reason.clear();
+    if (opened < PERF_COUNTER_COUNT)
+        reason = "some counters unavailable: " + PerfErrorReason(error);
+    g_perfEnabled = true;
+    return SAA_SUCCESS;
+}
+
+#else
+
+class ThreadCounters
+{
+public:
+    uint32_t open(int &firstError)
+    {
+        firstError = 0;
+        return 0;
+    }
+    void start() {}
+    void stop(PerfCounterSample &sample) { sample = PerfCounterSample(); }
+};
+
+static ThreadCounters &LocalCounters()
+{
+    static thread_local ThreadCounters counters;
+    return counters;
+}
+
+int8_t EnablePerfCounters(std::string &reason)
+{
+    reason = "hardware counters need Linux perf_event_open";
+    return ERROR_UNSUPPORT_FEATURE;
+}
+
+#endif
+
+// 同一线程上嵌套的阶段（如算法内部调用其他压缩器）只由最外层计数
+static thread_local uint32_t g_phaseDepth = 0;
+
+PerfPhase::PerfPhase(PerfCounterSample &sample)
+{
+    if (!PerfCountersEnabled())
+    {
+        return;
+    }
+    _counted = true;
+    if (g_phaseDepth++ > 0)
+    {
+        return;
+    }
+
+    int error = 0;
+    _sample = &sample;
+    LocalCounters().open(error);
+    LocalCounters().start();
+}
+
+PerfPhase::~PerfPhase()
+{
+    stop();
+}
+
+void PerfPhase::stop()
+{
+    if (_sample)
+    {
+        LocalCounters().stop(*_sample);
+        _sample = nullptr;
+    }
+    if (_counted)
+    {
+        --g_phaseDepth;
+        _counted = false;
+    }
+}
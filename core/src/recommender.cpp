@@ -0,0 +1,292 @@
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2026-10-19 11:02:00
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2026-10-19 11:02:00
+ * @FilePath: \SparseArrayAnalyzer\core\src\recommender.cpp
+ * @Description:
+ *
+ */
+#include "recommender.h"
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+static std::vector<DeviceProfile> BuiltinProfiles()
+{
+    std::vector<DeviceProfile> profiles;
+
+    // 典型 MCU：表放 Flash 原地访问，RAM 只有 64 KB，随机查表为主
+    DeviceProfile m4;
+    m4.name = "cortex-m4-64k";
+    m4.clockMHz = 168.0;
+    m4.cyclesPerOp = 2.0;
+    m4.flashBytes = 1024 * 1024;
+    m4.ramBytes = 64 * 1024;
+    m4.tableInFlash = true;
+    m4.decodeToRam = false;
+    m4.seqAccessRatio = 0.3;
+    m4.sizeWeight = 0.6;
+    m4.timeWeight = 0.4;
+    profiles.push_back(m4);
+
+    // 服务器：内存充裕，顺序扫描为主，解压开销取本机实测值
+    DeviceProfile x86;
+    x86.name = "x86-server";
+    x86.clockMHz = 3000.0;
+    x86.cyclesPerOp = 1.0;
+    x86.ramBytes = 16ull * 1024 * 1024 * 1024;
+    x86.useMeasuredTime = true;
+    x86.seqAccessRatio = 0.8;
+    x86.sizeWeight = 0.3;
+    x86.timeWeight = 0.7;
+    profiles.push_back(x86);
+
+    return profiles;
+}
+
+std::vector<std::string> ListBuiltinProfiles()
+{
+    std::vector<std::string> names;
+    for (const auto &profile : BuiltinProfiles())
+    {
+        names.push_back(profile.name);
+    }
+    return names;
+}
+
+static std::string Trim(const std::string &str)
+{
+    size_t begin = str.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos)
+        return "";
+    size_t end = str.find_last_not_of(" \t\r\n");
+    return str.substr(begin, end - begin + 1);
+}
+
+// 支持 K/M/G 后缀（1024 进制）
+static bool ParseBytes(const std::string &str, uint64_t &bytes)
+{
+    try
+    {
+        size_t idx = 0;
+        double value = std::stod(str, &idx);
+        std::string suffix = Trim(str.substr(idx));
+        uint64_t scale = 1;
+        if (suffix == "K" || suffix == "KB")
+            scale = 1024ull;
+        else if (suffix == "M" || suffix == "MB")
+            scale = 1024ull * 1024;
+        else if (suffix == "G" || suffix == "GB")
+            scale = 1024ull * 1024 * 1024;
+        else if (!suffix.empty() && suffix != "B")
+            return false;
+
+        if (value < 0)
+            return false;
+        bytes = static_cast<uint64_t>(value * scale);
+        return true;
+    }
+    catch (const std::exception &)
+    {
+        return false;
+    }
+}
+
+static bool ParseDouble(const std::string &str, double &value)
+{
+    try
+    {
+        size_t idx = 0;
+        value = std::stod(str, &idx);
+        return idx == str.size();
+    }
+    catch (const std::exception &)
+    {
+        return false;
+    }
+}
+
+static bool ParseBool(const std::string &str, bool &value)
+{
+    if (str == "1" || str == "true" || str == "yes")
+        value = true;
+    else if (str == "0" || str == "false" || str == "no")
+        value = false;
+    else
+        return false;
+    return true;
+}
+
+static int8_t LoadProfileFile(const std::string &filename, DeviceProfile &profile)
+{
+    std::ifstream file(filename);
+    if (!file.is_open())
+    {
+        std::cerr << LOG_ERROR << "Failed to open profile: " << filename << std::endl;
+        return ERROR_PARAM_INVALID;
+    }
+
+    profile = DeviceProfile();
+    profile.name = std::filesystem::path(filename).stem().string();
+
+    std::string line;
+    uint32_t lineNo = 0;
+    while (std::getline(file, line))
+    {
+        ++lineNo;
+        line = Trim(line.substr(0, line.find('#')));
+        if (line.empty())
+            continue;
+
+        size_t eq = line.find('=');
+        if (eq == std::string::npos)
+        {
+            std::cerr << LOG_ERROR << filename << ":" << lineNo << " expects key=value.\n";
+            return ERROR_PARAM_INVALID;
+        }
+
+        std::string key = Trim(line.substr(0, eq));
+        std::string value = Trim(line.substr(eq + 1));
+        bool ok = true;
+        if (key == "name")
+            profile.name = value;
+        else if (key == "clock_mhz")
+            ok = ParseDouble(value, profile.clockMHz) && profile.clockMHz > 0;
+        else if (key == "cycles_per_op")
+            ok = ParseDouble(value, profile.cyclesPerOp) && profile.cyclesPerOp > 0;
+        else if (key == "flash_bytes")
+            ok = ParseBytes(value, profile.flashBytes);
+        else if (key == "ram_bytes")
+            ok = ParseBytes(value, profile.ramBytes);
+        else if (key == "table_in_flash")
+            ok = ParseBool(value, profile.tableInFlash);
+        else if (key == "decode_to_ram")
+            ok = ParseBool(value, profile.decodeToRam);
+        else if (key == "use_measured_time")
+            ok = ParseBool(value, profile.useMeasuredTime);
+        else if (key == "seq_access_ratio")
+            ok = ParseDouble(value, profile.seqAccessRatio) && profile.seqAccessRatio >= 0 && profile.seqAccessRatio <= 1;
+        else if (key == "size_weight")
+            ok = ParseDouble(value, profile.sizeWeight) && profile.sizeWeight >= 0;
+        else if (key == "time_weight")
+            ok = ParseDouble(value, profile.timeWeight) && profile.timeWeight >= 0;
+        else
+            std::cerr << LOG_WARN << filename << ":" << lineNo << " unknown key \"" << key << "\" ignored.\n";
+
+        if (!ok)
+        {
+            std::cerr << LOG_ERROR << filename << ":" << lineNo << " invalid value for " << key << ": " << value << "\n";
+            return ERROR_PARAM_INVALID;
+        }
+    }
+
+    return SAA_SUCCESS;
+}
+
+int8_t LoadDeviceProfile(const std::string &nameOrPath, DeviceProfile &profile)
+{
+    for (const auto &builtin : BuiltinProfiles())
+    {
+        if (builtin.name == nameOrPath)
+        {
+            profile = builtin;
+            return SAA_SUCCESS;
+        }
+    }
+
+    if (!std::filesystem::exists(nameOrPath))
+    {
+        std::cerr << LOG_ERROR << "Unknown profile \"" << nameOrPath << "\" (not builtin and no such file).\n";
+        return ERROR_PARAM_INVALID;
+    }
+    return LoadProfileFile(nameOrPath, profile);
+}
+
+static std::string FormatBudget(uint64_t used, uint64_t budget)
+{
+    std::ostringstream oss;
+    oss << used << "/";
+    if (budget)
+        oss << budget;
+    else
+        oss << "unlimited";
+    oss << " B";
+    return oss.str();
+}
+
+int8_t RecommendCompression(const std::vector<CalResult> &results, const DeviceProfile &profile,
+                            std::vector<RecommendItem> &ranked)
+{
+    if (results.empty())
+    {
+        std::cerr << LOG_ERROR << "No result to recommend from.\n";
+        return ERROR_INPUT_EMPTY;
+    }
+
+    ranked.clear();
+    const double baseCycles = profile.cyclesPerOp; // Dense 每次访问 1 个操作
+
+    for (const auto &result : results)
+    {
+        RecommendItem item;
+        item.modeName = result.modeName;
+
+        // 1. 存储占用
+        uint64_t tableBytes = result.compressedSizeBytes;
+        item.flashUsed = profile.tableInFlash ? tableBytes : 0;
+        item.ramUsed = (profile.tableInFlash ? 0 : tableBytes) + (profile.decodeToRam ? result.originSizeBytes : 0);
+
+        // 2. 访问开销：整体解压后为 O(1) 访问，否则按结构的顺序/随机访问操作数
+        double seqCycles = result.seqAccessOps * profile.cyclesPerOp;
+        double randomCycles = result.randomAccessOps * profile.cyclesPerOp;
+        if (profile.decodeToRam)
+        {
+            seqCycles = randomCycles = baseCycles;
+        }
+        if (profile.useMeasuredTime && result.originElementCount)
+        {
+            double measured = result.decompressTimeMs * 1e3 * profile.clockMHz / result.originElementCount;
+            seqCycles = std::max(baseCycles, measured);
+        }
+        item.cyclesPerAccess = profile.seqAccessRatio * seqCycles + (1.0 - profile.seqAccessRatio) * randomCycles;
+
+        // 3. 约束与评分
+        std::ostringstream reason;
+        item.feasible = true;
+        if (profile.flashBytes && item.flashUsed > profile.flashBytes)
+        {
+            item.feasible = false;
+            reason << "needs " << item.flashUsed << " B flash > budget " << profile.flashBytes << " B";
+        }
+        else if (profile.ramBytes && item.ramUsed > profile.ramBytes)
+        {
+            item.feasible = false;
+            reason << "needs " << item.ramUsed << " B RAM > budget " << profile.ramBytes << " B";
+        }
+
+        double sizeRatio = result.originSizeBytes ? static_cast<double>(tableBytes) / result.originSizeBytes : 1.0;
+        item.score = profile.sizeWeight * sizeRatio + profile.timeWeight * item.cyclesPerAccess / baseCycles;
+
+        if (item.feasible)
+        {
+            reason << std::fixed << std::setprecision(1)
+                   << sizeRatio * 100.0 << "% of dense size, ~" << item.cyclesPerAccess << " cycles/access ("
+                   << std::setprecision(0) << profile.seqAccessRatio * 100.0 << "% sequential), flash "
+                   << FormatBudget(item.flashUsed, profile.flashBytes) << ", RAM "
+                   << FormatBudget(item.ramUsed, profile.ramBytes);
+        }
+        item.reason = reason.str();
+        ranked.push_back(item);
+    }
+
+    std::stable_sort(ranked.begin(), ranked.end(), [](const RecommendItem &a, const RecommendItem &b)
+                     {
+                         if (a.feasible != b.feasible)
+                             return a.feasible;
+                         return a.score < b.score; });
+
+    return SAA_SUCCESS;
+}
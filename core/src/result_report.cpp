@@ -0,0 +1,566 @@
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2026-10-20 00:10:00
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2026-10-20 00:10:00
+ * @FilePath: \SparseArrayAnalyzer\core\src\result_report.cpp
+ * @Description: 只解析本工具写出的报告格式：CSV 按表头列名取值，JSON 用一个最小的递归下降解析器
+ *
+ */
+#include "result_report.h"
+#include "perf_counters.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <thread>
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+#ifndef SAA_BUILD_FLAGS
+#define SAA_BUILD_FLAGS "unknown"
+#endif
+
+// 报告列，CSV 表头与 JSON 键名相同
+static const char *const REPORT_COLUMNS[] = {
+    "algorithm", "mode", "origin_elements", "compressed_elements", "origin_bytes", "compressed_bytes",
+    "compress_ms", "decompress_ms", "ratio_percent", "seq_access_ops", "random_access_ops",
+    "compress_mbps", "decompress_mbps"};
+
+int8_t ParseReportFormat(const std::string &name, ReportFormat &format)
+{
+    if (name == "csv")
+        format = REPORT_CSV;
+    else if (name == "json")
+        format = REPORT_JSON;
+    else
+        return ERROR_PARAM_INVALID;
+    return SAA_SUCCESS;
+}
+
+ReportFormat ReportFormatFromPath(const std::string &path)
+{
+    size_t dot = path.find_last_of('.');
+    std::string ext = (dot == std::string::npos) ? "" : path.substr(dot);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return (ext == ".json") ? REPORT_JSON : REPORT_CSV;
+}
+
+std::string CsvField(const std::string &text)
+{
+    if (text.find_first_of(",\"\n") == std::string::npos)
+        return text;
+    std::string quoted = "\"";
+    for (char ch : text)
+        quoted += (ch == '"') ? std::string("\"\"") : std::string(1, ch);
+    return quoted + "\"";
+}
+
+std::string JsonString(const std::string &text)
+{
+    std::string escaped = "\"";
+    for (char ch : text)
+    {
+        if (ch == '"' || ch == '\\')
+            escaped += '\\';
+        if (static_cast<unsigned char>(ch) < 0x20)
+            continue;
+        escaped += ch;
+    }
+    return escaped + "\"";
+}
+
+static std::string CpuModel()
+{
+    // 1. x86 直接读取 CPUID 品牌字符串
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int regs[12] = {0};
+    __cpuid(regs, 0x80000000);
+    if (static_cast<unsigned>(regs[0]) >= 0x80000004u)
+    {
+        for (int i = 0; i < 3; ++i)
+            __cpuid(regs + 4 * i, 0x80000002 + i);
+        std::string brand(reinterpret_cast<const char *>(regs), sizeof(regs));
+        brand = brand.c_str();
+        brand.erase(0, brand.find_first_not_of(' '));
+        if (!brand.empty())
+            return brand;
+    }
+#elif defined(__x86_64__) || defined(__i386__)
+    unsigned int regs[12] = {0};
+    if (__get_cpuid_max(0x80000000u, nullptr) >= 0x80000004u)
+    {
+        for (unsigned int i = 0; i < 3; ++i)
+            __get_cpuid(0x80000002u + i, &regs[4 * i], &regs[4 * i + 1], &regs[4 * i + 2], &regs[4 * i + 3]);
+        std::string brand(reinterpret_cast<const char *>(regs), sizeof(regs));
+        brand = brand.c_str();
+        brand.erase(0, brand.find_first_not_of(' '));
+        if (!brand.empty())
+            return brand;
+    }
+#endif
+
+    // 2. 其他架构取 /proc/cpuinfo
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line))
+    {
+        size_t colon = line.find(':');
+        if (colon == std::string::npos)
+            continue;
+        std::string key = line.substr(0, line.find_last_not_of(" \t", colon - 1) + 1);
+        if (key == "model name" || key == "Model" || key == "Hardware" || key == "cpu model")
+            return line.substr(line.find_first_not_of(" \t", colon + 1));
+    }
+    return "unknown";
+}
+
+void CollectEnvironment(const std::string &input, ReportEnvironment &env)
+{
+    env.cpuModel = CpuModel();
+    env.threadCount = std::thread::hardware_concurrency();
+#if defined(__clang__)
+    env.compiler = std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+    env.compiler = std::string("gcc ") + __VERSION__;
+#elif defined(_MSC_VER)
+    env.compiler = "msvc " + std::to_string(_MSC_FULL_VER);
+#else
+    env.compiler = "unknown";
+#endif
+    env.buildFlags = SAA_BUILD_FLAGS;
+    env.input = input;
+}
+
+// 硬件计数器列名：<phase>_<counter>，计数器名中的 '-' 换成 '_' 并转小写
+static std::string PerfColumn(const char *phase, uint32_t id)
+{
+    std::string name = std::string(phase) + "_" + PerfCounterName(static_cast<PerfCounterId>(id));
+    std::transform(name.begin(), name.end(), name.begin(), [](char ch)
+                   { return (ch == '-') ? '_' : static_cast<char>(std::tolower(static_cast<unsigned char>(ch))); });
+    return name;
+}
+
+// 不可用的计数器在 CSV 中留空，JSON 中为 null
+static std::string PerfValue(const PerfCounterSample &sample, uint32_t id, ReportFormat format)
+{
+    if (sample.validMask & (1u << id))
+        return std::to_string(sample.values[id]);
+    return (format == REPORT_JSON) ? "null" : "";
+}
+
+// 堆分配列名：<phase>_<field>，未统计时与计数器列一样留空 / 为 null
+static const char *const ALLOC_FIELDS[] = {"alloc_count", "alloc_bytes", "peak_bytes"};
+#define ALLOC_FIELD_COUNT (sizeof(ALLOC_FIELDS) / sizeof(ALLOC_FIELDS[0]))
+
+static std::string AllocValue(const AllocStats &stats, uint32_t field, ReportFormat format)
+{
+    if (!stats.tracked)
+        return (format == REPORT_JSON) ? "null" : "";
+    const uint64_t values[ALLOC_FIELD_COUNT] = {stats.allocCount, stats.allocBytes, stats.peakBytes};
+    return std::to_string(values[field]);
+}
+
+// 原始字节 / 耗时，MB/s
+static double Throughput(uint64_t bytes, double ms)
+{
+    return (ms > 0) ? bytes / (ms * 1000.0) : 0.0;
+}
+
+void WriteResultReport(std::ostream &out, ReportFormat format, const ReportEnvironment &env,
+                       const std::vector<ReportEntry> &entries)
+{
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision(10);
+    out << std::defaultfloat;
+
+    if (format == REPORT_CSV)
+    {
+        // 1. 环境注释 + 表头 + 每个结果一行
+        out << "# cpu_model: " << env.cpuModel << "\n# threads: " << env.threadCount << "\n# compiler: " << env.compiler
+            << "\n# build_flags: " << env.buildFlags << "\n# input: " << env.input << "\n";
+        for (size_t c = 0; c < sizeof(REPORT_COLUMNS) / sizeof(REPORT_COLUMNS[0]); ++c)
+            out << (c ? "," : "") << REPORT_COLUMNS[c];
+        for (const char *phase : {"compress", "decompress"})
+            for (uint32_t id = 0; id < PERF_COUNTER_COUNT; ++id)
+                out << ',' << PerfColumn(phase, id);
+        for (const char *phase : {"compress", "decompress"})
+            for (uint32_t field = 0; field < ALLOC_FIELD_COUNT; ++field)
+                out << ',' << phase << '_' << ALLOC_FIELDS[field];
+        out << "\n";
+        for (const auto &entry : entries)
+        {
+            const CalResult &r = entry.result;
+            out << CsvField(entry.algorithm) << ',' << CsvField(r.modeName) << ',' << r.originElementCount << ','
+                << r.compressedElementCount << ',' << r.originSizeBytes << ',' << r.compressedSizeBytes << ','
+                << r.compressTimeMs << ',' << r.decompressTimeMs << ',' << r.compressionRatio << ',' << r.seqAccessOps << ','
+                << r.randomAccessOps << ',' << Throughput(r.originSizeBytes, r.compressTimeMs) << ','
+                << Throughput(r.originSizeBytes, r.decompressTimeMs);
+            for (const PerfCounterSample *sample : {&r.compressPerf, &r.decompressPerf})
+                for (uint32_t id = 0; id < PERF_COUNTER_COUNT; ++id)
+                    out << ',' << PerfValue(*sample, id, format);
+            for (const AllocStats *stats : {&r.compressAlloc, &r.decompressAlloc})
+                for (uint32_t field = 0; field < ALLOC_FIELD_COUNT; ++field)
+                    out << ',' << AllocValue(*stats, field, format);
+            out << "\n";
+        }
+    }
+    else
+    {
+        out << "{\n  \"environment\": {\"cpu_model\": " << JsonString(env.cpuModel) << ", \"threads\": " << env.threadCount
+            << ", \"compiler\": " << JsonString(env.compiler) << ", \"build_flags\": " << JsonString(env.buildFlags)
+            << ", \"input\": " << JsonString(env.input) << "},\n  \"results\": [";
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            const CalResult &r = entries[i].result;
+            out << (i ? "," : "") << "\n    {\"algorithm\": " << JsonString(entries[i].algorithm)
+                << ", \"mode\": " << JsonString(r.modeName) << ", \"origin_elements\": " << r.originElementCount
+                << ", \"compressed_elements\": " << r.compressedElementCount << ", \"origin_bytes\": " << r.originSizeBytes
+                << ", \"compressed_bytes\": " << r.compressedSizeBytes << ", \"compress_ms\": " << r.compressTimeMs
+                << ", \"decompress_ms\": " << r.decompressTimeMs << ", \"ratio_percent\": " << r.compressionRatio
+                << ", \"seq_access_ops\": " << r.seqAccessOps << ", \"random_access_ops\": " << r.randomAccessOps
+                << ", \"compress_mbps\": " << Throughput(r.originSizeBytes, r.compressTimeMs)
+                << ", \"decompress_mbps\": " << Throughput(r.originSizeBytes, r.decompressTimeMs);
+            const char *phases[2] = {"compress", "decompress"};
+            const PerfCounterSample *samples[2] = {&r.compressPerf, &r.decompressPerf};
+            for (int p = 0; p < 2; ++p)
+                for (uint32_t id = 0; id < PERF_COUNTER_COUNT; ++id)
+                    out << ", \"" << PerfColumn(phases[p], id) << "\": " << PerfValue(*samples[p], id, format);
+            const AllocStats *allocs[2] = {&r.compressAlloc, &r.decompressAlloc};
+            for (int p = 0; p < 2; ++p)
+                for (uint32_t field = 0; field < ALLOC_FIELD_COUNT; ++field)
+                    out << ", \"" << phases[p] << '_' << ALLOC_FIELDS[field] << "\": " << AllocValue(*allocs[p], field, format);
+            out << "}";
+        }
+        out << (entries.empty() ? "]\n}\n" : "\n  ]\n}\n");
+    }
+
+    out.flags(flags);
+    out.precision(precision);
+}
+
+// 列名 -> 文本值，由 CSV 行或 JSON 对象得到
+using ReportFields = std::map<std::string, std::string>;
+
+static void FieldsToEntry(const ReportFields &fields, ReportEntry &entry)
+{
+    auto text = [&](const char *key) -> std::string
+    {
+        auto it = fields.find(key);
+        return (it == fields.end()) ? "" : it->second;
+    };
+    auto number = [&](const char *key)
+    { return std::strtod(text(key).c_str(), nullptr); };
+    auto integer = [&](const char *key)
+    { return static_cast<uint64_t>(std::strtoull(text(key).c_str(), nullptr, 10)); };
+
+    entry.algorithm = text("algorithm");
+    CalResult &r = entry.result;
+    r.modeName = text("mode");
+    r.originElementCount = integer("origin_elements");
+    r.compressedElementCount = integer("compressed_elements");
+    r.originSizeBytes = integer("origin_bytes");
+    r.compressedSizeBytes = integer("compressed_bytes");
+    r.compressTimeMs = number("compress_ms");
+    r.decompressTimeMs = number("decompress_ms");
+    r.compressionRatio = number("ratio_percent");
+    r.seqAccessOps = number("seq_access_ops");
+    r.randomAccessOps = number("random_access_ops");
+    const char *phases[2] = {"compress", "decompress"};
+    PerfCounterSample *samples[2] = {&r.compressPerf, &r.decompressPerf};
+    for (int p = 0; p < 2; ++p)
+    {
+        for (uint32_t id = 0; id < PERF_COUNTER_COUNT; ++id)
+        {
+            std::string value = text(PerfColumn(phases[p], id).c_str());
+            if (value.empty() || value == "null")
+                continue;
+            samples[p]->values[id] = std::strtoull(value.c_str(), nullptr, 10);
+            samples[p]->validMask |= 1u << id;
+        }
+    }
+    AllocStats *allocs[2] = {&r.compressAlloc, &r.decompressAlloc};
+    for (int p = 0; p < 2; ++p)
+    {
+        uint64_t values[ALLOC_FIELD_COUNT] = {0};
+        for (uint32_t field = 0; field < ALLOC_FIELD_COUNT; ++field)
+        {
+            std::string value = text((std::string(phases[p]) + "_" + ALLOC_FIELDS[field]).c_str());
+            if (value.empty() || value == "null")
+                continue;
+            values[field] = std::strtoull(value.c_str(), nullptr, 10);
+            allocs[p]->tracked = true;
+        }
+        allocs[p]->allocCount = values[0];
+        allocs[p]->allocBytes = values[1];
+        allocs[p]->peakBytes = values[2];
+    }
+}
+
+static void EnvironmentField(const std::string &key, const std::string &value, ReportEnvironment &env)
+{
+    if (key == "cpu_model")
+        env.cpuModel = value;
+    else if (key == "threads")
+        env.threadCount = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+    else if (key == "compiler")
+        env.compiler = value;
+    else if (key == "build_flags")
+        env.buildFlags = value;
+    else if (key == "input")
+        env.input = value;
+}
+
+static std::vector<std::string> SplitCsvLine(const std::string &line)
+{
+    std::vector<std::string> fields(1);
+    bool quoted = false;
+    for (size_t i = 0; i < line.size(); ++i)
+    {
+        char ch = line[i];
+        if (quoted && ch == '"' && i + 1 < line.size() && line[i + 1] == '"')
+            fields.back() += line[++i];
+        else if (ch == '"')
+            quoted = !quoted;
+        else if (ch == ',' && !quoted)
+            fields.emplace_back();
+        else if (ch != '\r')
+            fields.back() += ch;
+    }
+    return fields;
+}
+
+static int8_t ReadCsvReport(std::istream &in, ReportEnvironment &env, std::vector<ReportEntry> &entries)
+{
+    std::vector<std::string> header;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        if (line.empty())
+            continue;
+        if (line[0] == '#')
+        {
+            size_t colon = line.find(':');
+            if (colon != std::string::npos)
+            {
+                std::string key = line.substr(1, colon - 1);
+                key.erase(0, key.find_first_not_of(' '));
+                size_t start = line.find_first_not_of(' ', colon + 1);
+                EnvironmentField(key, (start == std::string::npos) ? "" : line.substr(start), env);
+            }
+            continue;
+        }
+
+        std::vector<std::string> fields = SplitCsvLine(line);
+        if (header.empty())
+        {
+            header = fields;
+            continue;
+        }
+        ReportFields row;
+        for (size_t c = 0; c < header.size() && c < fields.size(); ++c)
+            row[header[c]] = fields[c];
+        ReportEntry entry;
+        FieldsToEntry(row, entry);
+        entries.push_back(entry);
+    }
+    return header.empty() ? ERROR_INPUT_EMPTY : SAA_SUCCESS;
+}
+
+// 最小 JSON 解析：对象的标量成员收集为文本，"environment" 与 "results" 两个成员按报告结构解释
+class JsonReportParser
+{
+public:
+    JsonReportParser(const std::string &text, ReportEnvironment &env, std::vector<ReportEntry> &entries)
+        : _text(text), _env(env), _entries(entries)
+    {
+    }
+
+    int8_t parse()
+    {
+        if (!expect('{'))
+            return ERROR_PARAM_INVALID;
+        if (peek() == '}')
+            return SAA_SUCCESS;
+        do
+        {
+            std::string key;
+            if (!parseString(key) || !expect(':'))
+                return ERROR_PARAM_INVALID;
+
+            ReportFields fields;
+            bool ok = true;
+            if (key == "environment")
+            {
+                ok = parseObject(fields);
+                for (const auto &field : fields)
+                    EnvironmentField(field.first, field.second, _env);
+            }
+            else if (key == "results")
+            {
+                ok = expect('[');
+                if (ok && peek() != ']')
+                {
+                    do
+                    {
+                        fields.clear();
+                        ReportEntry entry;
+                        ok = parseObject(fields);
+                        FieldsToEntry(fields, entry);
+                        _entries.push_back(entry);
+                    } while (ok && consume(','));
+                }
+                ok = ok && expect(']');
+            }
+            else
+            {
+                std::string ignored;
+                ok = parseScalar(ignored);
+            }
+            if (!ok)
+                return ERROR_PARAM_INVALID;
+        } while (consume(','));
+        return expect('}') ? SAA_SUCCESS : ERROR_PARAM_INVALID;
+    }
+
+private:
+    char peek()
+    {
+        while (_pos < _text.size() && std::isspace(static_cast<unsigned char>(_text[_pos])))
+            ++_pos;
+        return (_pos < _text.size()) ? _text[_pos] : '\0';
+    }
+
+    bool consume(char ch)
+    {
+        if (peek() != ch)
+            return false;
+        ++_pos;
+        return true;
+    }
+
+    bool expect(char ch) { return consume(ch); }
+
+    bool parseString(std::string &out)
+    {
+        if (!consume('"'))
+            return false;
+        out.clear();
+        while (_pos < _text.size() && _text[_pos] != '"')
+        {
+            if (_text[_pos] == '\\' && _pos + 1 < _text.size())
+                ++_pos;
+            out += _text[_pos++];
+        }
+        return consume('"');
+    }
+
+    // 数字、true / false / null 原样保留文本
+    bool parseScalar(std::string &out)
+    {
+        if (peek() == '"')
+            return parseString(out);
+        size_t start = _pos;
+        while (_pos < _text.size() && (std::isalnum(static_cast<unsigned char>(_text[_pos])) || std::strchr("+-.", _text[_pos])))
+            ++_pos;
+        out = _text.substr(start, _pos - start);
+        return _pos > start;
+    }
+
+    bool parseObject(ReportFields &fields)
+    {
+        if (!expect('{'))
+            return false;
+        if (consume('}'))
+            return true;
+        do
+        {
+            std::string key;
+            std::string value;
+            if (!parseString(key) || !expect(':') || !parseScalar(value))
+                return false;
+            fields[key] = value;
+        } while (consume(','));
+        return expect('}');
+    }
+
+    const std::string &_text;
+    size_t _pos = 0;
+    ReportEnvironment &_env;
+    std::vector<ReportEntry> &_entries;
+};
+
+int8_t ReadResultReport(const std::string &path, ReportEnvironment &env, std::vector<ReportEntry> &entries)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cerr << LOG_ERROR << "Failed to open file: " << path << std::endl;
+        return ERROR_PARAM_INVALID;
+    }
+
+    entries.clear();
+    env = ReportEnvironment();
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string text = buffer.str();
+    size_t first = text.find_first_not_of(" \t\r\n");
+
+    int8_t ret = (first != std::string::npos && text[first] == '{')
+                     ? JsonReportParser(text, env, entries).parse()
+                     : ReadCsvReport(buffer, env, entries);
+    if (ret != SAA_SUCCESS)
+    {
+        std::cerr << LOG_ERROR << "Malformed result report: " << path << std::endl;
+    }
+    return ret;
+}
+
+uint32_t CompareReports(const std::vector<ReportEntry> &baseline, const std::vector<ReportEntry> &current,
+                        double ratioTol, double throughputTol, std::vector<CompareItem> &items)
+{
+    auto keyOf = [](const ReportEntry &entry)
+    { return entry.algorithm.empty() ? entry.result.modeName : entry.algorithm; };
+    // 一次压缩 + 解压的往返吞吐，流式报告没有解压耗时，只计压缩
+    auto roundTrip = [](const CalResult &r)
+    { return Throughput(r.originSizeBytes, r.compressTimeMs + r.decompressTimeMs); };
+
+    std::map<std::string, const CalResult *> currentByKey;
+    for (const auto &entry : current)
+        currentByKey[keyOf(entry)] = &entry.result;
+
+    items.clear();
+    uint32_t regressions = 0;
+    for (const auto &entry : baseline)
+    {
+        CompareItem item;
+        item.key = keyOf(entry);
+        item.baseRatio = entry.result.compressionRatio;
+        item.baseThroughput = roundTrip(entry.result);
+
+        auto it = currentByKey.find(item.key);
+        if (it == currentByKey.end())
+        {
+            item.missing = true;
+        }
+        else
+        {
+            item.currentRatio = it->second->compressionRatio;
+            item.currentThroughput = roundTrip(*it->second);
+            item.ratioRegressed = item.currentRatio > item.baseRatio * (1.0 + ratioTol / 100.0);
+            item.throughputRegressed = item.baseThroughput > 0 &&
+                                       item.currentThroughput < item.baseThroughput * (1.0 - throughputTol / 100.0);
+        }
+        if (item.missing || item.ratioRegressed || item.throughputRegressed)
+            ++regressions;
+        items.push_back(item);
+    }
+    return regressions;
+}
@@ -0,0 +1,305 @@
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2026-10-19 21:10:00
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2026-10-19 21:10:00
+ * @FilePath: \SparseArrayAnalyzer\core\src\serialization.hpp
+ * @Description: 压缩结构序列化：标量按小端原样写入，数组前写 64 位长度并按 SERIAL_ALIGN 对齐；
+ *               读取端可拷贝到 vector，也可只取指向原缓冲区的视图（零拷贝）
+ *
+ */
+#pragma once
+#include "bit_packing.hpp"
+#include "entropy_codec.hpp"
+#include "index_codec.hpp"
+#include "index_storage.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#define SERIAL_ALIGN (8) // 数组起始偏移对齐到 8 字节，映射后可直接按元素类型访问
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "Serialized layout is little-endian");
+
+class ByteWriter
+{
+public:
+    explicit ByteWriter(std::vector<uint8_t> &out) : _out(out) {}
+
+    template <typename V>
+    void put(const V &value)
+    {
+        static_assert(std::is_trivially_copyable_v<V>, "put() needs a trivially copyable type");
+        const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&value);
+        _out.insert(_out.end(), bytes, bytes + sizeof(V));
+    }
+
+    void align()
+    {
+        while (_out.size() % SERIAL_ALIGN)
+            _out.push_back(0);
+    }
+
+    // 长度 + 对齐填充 + 原始元素
+    template <typename V>
+    void putArray(const V *data, uint64_t count)
+    {
+        static_assert(std::is_trivially_copyable_v<V>, "putArray() needs a trivially copyable type");
+        put(count);
+        align();
+        const uint8_t *bytes = reinterpret_cast<const uint8_t *>(data);
+        _out.insert(_out.end(), bytes, bytes + count * sizeof(V));
+    }
+
+    template <typename V>
+    void putArray(const std::vector<V> &vec)
+    {
+        putArray(vec.data(), vec.size());
+    }
+
+    template <typename V>
+    void putPacked(const PackedValues<V> &packed)
+    {
+        put(packed.count);
+        put(packed.base);
+        put(packed.bitWidth);
+        putArray(packed.words);
+    }
+
+    // 宽度（字节）+ 数组
+    void putIndex(const IndexStorage &storage)
+    {
+        put(static_cast<uint8_t>(IndexStorageWidth(storage)));
+        std::visit([this](const auto &vec)
+                   { putArray(vec); },
+                   storage);
+    }
+
+    void putGroupVarint(const GroupVarint &encoded)
+    {
+        put(encoded.count);
+        putArray(encoded.bytes);
+    }
+
+    void putEliasFano(const EliasFano &encoded)
+    {
+        put(encoded.count);
+        put(encoded.universe);
+        put(encoded.lowBits);
+        putPacked(encoded.low);
+        putArray(encoded.high);
+    }
+
+    void putHuffman(const HuffmanStream &encoded)
+    {
+        put(encoded.count);
+        put(encoded.onlySymbol);
+        putArray(encoded.codeLength);
+        putArray(encoded.bytes);
+    }
+
+    void putRans(const RansStream &encoded)
+    {
+        put(encoded.count);
+        put(encoded.directSymbols);
+        putArray(encoded.freq);
+        putArray(encoded.bytes);
+        putPacked(encoded.escapes);
+    }
+
+private:
+    std::vector<uint8_t> &_out;
+};
+
+// 不持有内存的只读数组视图
+template <typename V>
+struct ArrayView
+{
+    const V *data = nullptr;
+    uint64_t count = 0;
+
+    const V &operator[](uint64_t index) const { return data[index]; }
+    uint64_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const V *begin() const { return data; }
+    const V *end() const { return data + count; }
+};
+
+template <typename V>
+inline ArrayView<V> ViewOf(const std::vector<V> &vec)
+{
+    return {vec.data(), vec.size()};
+}
+
+// 与 ByteWriter 对应的读取端；任一步越界后置失败标志，后续读取均为空操作，调用方最后检查 failed()
+class ByteReader
+{
+public:
+    // data 须按 SERIAL_ALIGN 对齐，否则视图中的数组指针不满足元素对齐
+    ByteReader(const uint8_t *data, size_t size)
+        : _data(data), _size(size), _failed(reinterpret_cast<uintptr_t>(data) % SERIAL_ALIGN != 0) {}
+
+    bool failed() const { return _failed; }
+    bool finished() const { return !_failed && _offset == _size; }
+
+    template <typename V>
+    void get(V &value)
+    {
+        static_assert(std::is_trivially_copyable_v<V>, "get() needs a trivially copyable type");
+        if (!reserve(sizeof(V)))
+            return;
+        std::memcpy(&value, _data + _offset, sizeof(V));
+        _offset += sizeof(V);
+    }
+
+    void align()
+    {
+        size_t padding = (SERIAL_ALIGN - _offset % SERIAL_ALIGN) % SERIAL_ALIGN;
+        if (reserve(padding))
+            _offset += padding;
+    }
+
+    // 零拷贝：view 指向原缓冲区
+    template <typename V>
+    void getView(ArrayView<V> &view)
+    {
+        uint64_t count = 0;
+        get(count);
+        align();
+        if (_failed || count > (_size - _offset) / sizeof(V))
+        {
+            _failed = true;
+            return;
+        }
+        view.data = reinterpret_cast<const V *>(_data + _offset);
+        view.count = count;
+        _offset += count * sizeof(V);
+    }
+
+    template <typename V>
+    void getArray(std::vector<V> &vec)
+    {
+        ArrayView<V> view;
+        getView(view);
+        vec.assign(view.begin(), view.end());
+    }
+
+    template <typename V>
+    void getPackedView(PackedValuesView<V> &packed)
+    {
+        ArrayView<uint64_t> words;
+        getPackedFields(packed.count, packed.base, packed.bitWidth, words);
+        packed.words = words.data;
+    }
+
+    template <typename V>
+    void getPacked(PackedValues<V> &packed)
+    {
+        ArrayView<uint64_t> words;
+        getPackedFields(packed.count, packed.base, packed.bitWidth, words);
+        packed.words.assign(words.begin(), words.end());
+    }
+
+    void getIndex(IndexStorage &storage)
+    {
+        uint8_t width = 0;
+        get(width);
+        switch (width)
+        {
+        case sizeof(uint8_t):
+            storage = std::vector<uint8_t>();
+            break;
+        case sizeof(uint16_t):
+            storage = std::vector<uint16_t>();
+            break;
+        case sizeof(uint32_t):
+            storage = std::vector<uint32_t>();
+            break;
+        case sizeof(uint64_t):
+            storage = std::vector<uint64_t>();
+            break;
+        default:
+            _failed = true;
+            return;
+        }
+        std::visit([this](auto &vec)
+                   { getArray(vec); },
+                   storage);
+    }
+
+    // 以下编码流读取后做结构校验，不自洽时置失败标志，保证解码不会越界
+
+    void getGroupVarint(GroupVarint &encoded)
+    {
+        get(encoded.count);
+        getArray(encoded.bytes);
+        if (!_failed && !GroupVarintValid(encoded))
+            _failed = true;
+    }
+
+    void getEliasFano(EliasFano &encoded)
+    {
+        get(encoded.count);
+        get(encoded.universe);
+        get(encoded.lowBits);
+        getPacked(encoded.low);
+        getArray(encoded.high);
+        if (!_failed && !EliasFanoValid(encoded))
+            _failed = true;
+    }
+
+    void getHuffman(HuffmanStream &encoded)
+    {
+        get(encoded.count);
+        get(encoded.onlySymbol);
+        getArray(encoded.codeLength);
+        getArray(encoded.bytes);
+        if (!_failed && !HuffmanStreamValid(encoded))
+            _failed = true;
+    }
+
+    void getRans(RansStream &encoded)
+    {
+        get(encoded.count);
+        get(encoded.directSymbols);
+        getArray(encoded.freq);
+        getArray(encoded.bytes);
+        getPacked(encoded.escapes);
+        if (!_failed && !RansStreamValid(encoded))
+            _failed = true;
+    }
+
+private:
+    void getPackedFields(uint64_t &count, uint64_t &base, uint8_t &bitWidth, ArrayView<uint64_t> &words)
+    {
+        get(count);
+        get(base);
+        get(bitWidth);
+        getView(words);
+        if (count > UINT64_MAX / 64)
+            _failed = true;
+        if (_failed)
+            return;
+        // 解包总会读取相邻两个字，字数不足视为损坏
+        uint64_t needWords = std::max<uint64_t>((count * bitWidth + 63) / 64 + 1, 2);
+        if ((bitWidth > 64 || (count && words.count < needWords)))
+            _failed = true;
+    }
+
+    bool reserve(size_t bytes)
+    {
+        if (_failed || bytes > _size - _offset)
+        {
+            _failed = true;
+            return false;
+        }
+        return true;
+    }
+
+    const uint8_t *_data;
+    size_t _size;
+    size_t _offset = 0;
+    bool _failed;
+};
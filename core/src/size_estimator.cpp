@@ -0,0 +1,273 @@
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2026-10-19 09:30:00
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2026-10-19 09:30:00
+ * @FilePath: \SparseArrayAnalyzer\core\src\size_estimator.cpp
+ * @Description:
+ *
+ */
+#include "size_estimator.h"
+#include "trace_events.h"
+#include "bit_packing.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+template <typename T>
+struct SampleUnit
+{
+    const T *data;
+    size_t length;
+};
+
+typedef struct unit_stat
+{
+    uint32_t stratum;
+    double nonMainFraction;
+    double runFraction;
+    uint32_t nonMainCount;
+} UnitStat;
+
+// 分层估计量：均值及其标准误差（每层 2 个样本时 s^2 = (x1 - x2)^2 / 2）
+static void StratifiedMean(const std::vector<UnitStat> &units,
+                           const std::vector<uint32_t> &strataSize,
+                           uint32_t totalUnits,
+                           double UnitStat::*field,
+                           double &mean, double &stdErr)
+{
+    std::vector<double> sum(strataSize.size(), 0.0);
+    std::vector<double> sumSq(strataSize.size(), 0.0);
+    std::vector<uint32_t> count(strataSize.size(), 0);
+    for (const auto &unit : units)
+    {
+        double x = unit.*field;
+        sum[unit.stratum] += x;
+        sumSq[unit.stratum] += x * x;
+        ++count[unit.stratum];
+    }
+
+    mean = 0.0;
+    double variance = 0.0;
+    for (size_t h = 0; h < strataSize.size(); ++h)
+    {
+        if (count[h] == 0)
+            continue;
+
+        double weight = static_cast<double>(strataSize[h]) / totalUnits;
+        double hMean = sum[h] / count[h];
+        mean += weight * hMean;
+
+        if (count[h] > 1)
+        {
+            double s2 = (sumSq[h] - count[h] * hMean * hMean) / (count[h] - 1);
+            double fpc = 1.0 - static_cast<double>(count[h]) / strataSize[h]; // 有限总体修正
+            variance += weight * weight * fpc * std::max(s2, 0.0) / count[h];
+        }
+    }
+    stdErr = std::sqrt(variance);
+}
+
+// 1. 划分抽样单元
+template <typename T>
+static void SplitUnits(const ArrayData1D<T> &data, SampleStats &stats, std::vector<SampleUnit<T>> &allUnits)
+{
+    const auto &vec = data.arrayData;
+    stats.is2D = false;
+    stats.rows = 1;
+    stats.cols = vec.size();
+    stats.elemCount = vec.size();
+    for (size_t pos = 0; pos < vec.size(); pos += SAMPLE_CHUNK_ELEMS)
+    {
+        allUnits.push_back({vec.data() + pos, std::min<size_t>(SAMPLE_CHUNK_ELEMS, vec.size() - pos)});
+    }
+}
+
+template <typename T>
+static void SplitUnits(const ArrayData2D<T> &data, SampleStats &stats, std::vector<SampleUnit<T>> &allUnits)
+{
+    stats.is2D = true;
+    stats.rows = data.rowCount;
+    stats.cols = data.colCount;
+    stats.elemCount = GetArrayElemCount2D(data.arrayData);
+    for (const auto &row : data.arrayData)
+    {
+        allUnits.push_back({row.data(), row.size()});
+    }
+}
+
+template <typename T, typename Data>
+static int8_t CollectSampleStatsImpl(const Data &data, uint32_t sampleUnits, SampleStats &stats)
+{
+    std::vector<SampleUnit<T>> allUnits;
+    stats = SampleStats();
+    stats.elemBytes = sizeof(T);
+    SplitUnits(data, stats, allUnits);
+
+    if (allUnits.empty() || stats.elemCount == 0)
+    {
+        std::cerr << LOG_ERROR << "Input data is empty.\n";
+        return ERROR_INPUT_EMPTY;
+    }
+
+    if (sampleUnits == 0)
+    {
+        std::cerr << LOG_ERROR << "Sample unit count cannot be zero.\n";
+        return ERROR_PARAM_INVALID;
+    }
+
+    // 2. 分层抽样，样本数不小于总体时直接全量统计
+    stats.totalUnits = static_cast<uint32_t>(allUnits.size());
+    uint32_t strataCount = (sampleUnits >= stats.totalUnits)
+                               ? stats.totalUnits
+                               : std::max(1u, std::min(sampleUnits / 2, stats.totalUnits / 2));
+
+    std::mt19937_64 rng(SAMPLE_RANDOM_SEED);
+    std::vector<uint32_t> strataSize(strataCount, 0);
+    std::vector<std::pair<uint32_t, uint32_t>> picked; // (stratum, unit index)
+    for (uint32_t h = 0; h < strataCount; ++h)
+    {
+        uint32_t lo = static_cast<uint32_t>(static_cast<uint64_t>(stats.totalUnits) * h / strataCount);
+        uint32_t hi = static_cast<uint32_t>(static_cast<uint64_t>(stats.totalUnits) * (h + 1) / strataCount);
+        strataSize[h] = hi - lo;
+        if (hi - lo <= 2)
+        {
+            for (uint32_t u = lo; u < hi; ++u)
+                picked.push_back({h, u});
+            continue;
+        }
+
+        std::uniform_int_distribution<uint32_t> dist(lo, hi - 1);
+        uint32_t first = dist(rng);
+        uint32_t second = dist(rng);
+        while (second == first)
+            second = dist(rng);
+        picked.push_back({h, first});
+        picked.push_back({h, second});
+    }
+    stats.sampledUnits = static_cast<uint32_t>(picked.size());
+
+    // 3. 统计样本取值分布，确定主值
+    std::unordered_map<uint64_t, uint64_t> valueCount;
+    T mainValue = 0;
+    for (const auto &pick : picked)
+    {
+        const SampleUnit<T> &unit = allUnits[pick.second];
+        for (size_t i = 0; i < unit.length; ++i)
+        {
+            valueCount[ToOrderedKey(unit.data[i])]++;
+        }
+        stats.sampledCount += unit.length;
+    }
+
+    uint64_t mainValueCount = 0;
+    uint64_t f1 = 0, f2 = 0; // 只出现 1 次 / 2 次的取值个数
+    for (const auto &pair : valueCount)
+    {
+        if (pair.second > mainValueCount)
+        {
+            mainValue = FromOrderedKey<T>(pair.first);
+            mainValueCount = pair.second;
+        }
+        if (pair.second == 1)
+            ++f1;
+        else if (pair.second == 2)
+            ++f2;
+    }
+
+    stats.mainValue = static_cast<double>(mainValue);
+
+    // 4. 逐单元统计非主值比例与游程数
+    std::vector<UnitStat> unitStats;
+    unitStats.reserve(picked.size());
+    uint64_t minKey = UINT64_MAX, maxKey = 0;
+    for (const auto &pick : picked)
+    {
+        const SampleUnit<T> &unit = allUnits[pick.second];
+        uint32_t nonMain = 0;
+        uint32_t runs = unit.length ? 1 : 0;
+        for (size_t i = 0; i < unit.length; ++i)
+        {
+            if (!SameBits(unit.data[i], mainValue))
+            {
+                ++nonMain;
+                uint64_t key = ToOrderedKey(unit.data[i]);
+                minKey = std::min(minKey, key);
+                maxKey = std::max(maxKey, key);
+            }
+            if (i > 0 && !SameBits(unit.data[i], unit.data[i - 1]))
+                ++runs;
+        }
+
+        double length = unit.length ? static_cast<double>(unit.length) : 1.0;
+        unitStats.push_back({pick.first, nonMain / length, runs / length, nonMain});
+    }
+
+    stats.packedBitWidth = (minKey <= maxKey) ? BitWidthOf(maxKey - minKey) : 0;
+
+    StratifiedMean(unitStats, strataSize, stats.totalUnits, &UnitStat::nonMainFraction,
+                   stats.nonMainFraction, stats.nonMainFractionSE);
+    StratifiedMean(unitStats, strataSize, stats.totalUnits, &UnitStat::runFraction,
+                   stats.runFraction, stats.runFractionSE);
+
+    double nnzSum = 0.0, nnzSumSq = 0.0;
+    for (const auto &unit : unitStats)
+    {
+        nnzSum += unit.nonMainCount;
+        nnzSumSq += static_cast<double>(unit.nonMainCount) * unit.nonMainCount;
+    }
+    stats.unitNnzMean = nnzSum / unitStats.size();
+    stats.unitNnzVar = (unitStats.size() > 1)
+                           ? std::max(0.0, (nnzSumSq - unitStats.size() * stats.unitNnzMean * stats.unitNnzMean) / (unitStats.size() - 1))
+                           : 0.0;
+
+    // 5. 不同值数量：全量统计时精确，否则用 Chao1 估计
+    double observed = static_cast<double>(valueCount.size());
+    double total = static_cast<double>(stats.elemCount);
+    if (stats.sampledCount >= stats.elemCount)
+    {
+        stats.distinctEstimate = stats.distinctLow = stats.distinctHigh = observed;
+    }
+    else
+    {
+        double chao1 = (f2 > 0) ? observed + (static_cast<double>(f1) * f1) / (2.0 * f2)
+                                : observed + (static_cast<double>(f1) * (f1 > 0 ? f1 - 1 : 0)) / 2.0;
+        double upper = observed + f1 * (total - stats.sampledCount) / static_cast<double>(stats.sampledCount);
+        stats.distinctLow = observed;
+        stats.distinctHigh = std::min(total, std::max(upper, observed));
+        stats.distinctEstimate = std::min(std::max(chao1, observed), stats.distinctHigh);
+    }
+
+    return SAA_SUCCESS;
+}
+
+int8_t CollectSampleStats(const ArrayInput &input, uint32_t sampleUnits, SampleStats &stats)
+{
+    TraceSpan trace("CollectSampleStats");
+    return std::visit([&](const auto &data)
+                      { return CollectSampleStatsImpl<typename std::decay_t<decltype(data)>::value_type>(data, sampleUnits, stats); },
+                      input);
+}
+
+static void FillEstimate(const SampleStats &stats, double fixedBytes, double perUnitBytes,
+                         double fraction, double fractionSE, SizeEstimate &estimate)
+{
+    double total = static_cast<double>(stats.elemCount);
+    double low = std::max(0.0, fraction - SAMPLE_Z_95 * fractionSE);
+    double high = std::min(1.0, fraction + SAMPLE_Z_95 * fractionSE);
+
+    estimate.predictedBytes = fixedBytes + perUnitBytes * fraction * total;
+    estimate.lowBytes = fixedBytes + perUnitBytes * low * total;
+    estimate.highBytes = fixedBytes + perUnitBytes * high * total;
+    estimate.predictedRatio = estimate.predictedBytes / (total * stats.elemBytes) * 100.0;
+}
+
+void EstimateByNonMain(const SampleStats &stats, double fixedBytes, double bytesPerNonMain, SizeEstimate &estimate)
+{
+    FillEstimate(stats, fixedBytes, bytesPerNonMain, stats.nonMainFraction, stats.nonMainFractionSE, estimate);
+}
+
+void EstimateByRuns(const SampleStats &stats, double fixedBytes, double bytesPerRun, SizeEstimate &estimate)
+{
+    FillEstimate(stats, fixedBytes, bytesPerRun, stats.runFraction, stats.runFractionSE, estimate);
+}
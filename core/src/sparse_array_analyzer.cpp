@@ -10,6 +10,7 @@
 
 #include <stdio.h>
 #include "sparse_array_analyzer.h"
+#include <algorithm>
 
 CompressorRegistry &CompressorRegistry::Instance()
 {
@@ -22,12 +23,12 @@ void CompressorRegistry::Register(const std::string &name, CompressorFactory fac
     _factories[name] = std::move(factory);
 }
 
-std::unique_ptr<SparseArrayCompressor> CompressorRegistry::Create(const std::string &name) const
+std::unique_ptr<SparseArrayCompressor> CompressorRegistry::Create(const std::string &name, ElemType type) const
 {
     auto it = _factories.find(name);
     if (it != _factories.end())
     {
-        return it->second(); // 调用工厂函数返回实例
+        return it->second(type); // 调用工厂函数返回对应元素类型的实例
     }
     else
     {
@@ -35,7 +36,7 @@ std::unique_ptr<SparseArrayCompressor> CompressorRegistry::Create(const std::str
     }
 }
 
-// 列出所有注册的算法名称
+// 列出所有注册的算法名称（按名称排序，同一算法的各变体在报告中相邻）
 std::vector<std::string> CompressorRegistry::ListAlgorithms() const
 {
     std::vector<std::string> names;
@@ -43,5 +44,6 @@ std::vector<std::string> CompressorRegistry::ListAlgorithms() const
     {
         names.push_back(pair.first);
     }
+    std::sort(names.begin(), names.end());
     return names;
 }
\ No newline at end of file
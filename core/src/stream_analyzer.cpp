@@ -0,0 +1,591 @@
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2026-10-19 22:50:00
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2026-10-19 22:50:00
+ * @FilePath: \SparseArrayAnalyzer\core\src\stream_analyzer.cpp
+ * @Description: 内存预算按 1/4 块缓冲、1/4 主值频率表、1/2 字典划分；其余编码器只保存常数大小的状态，
+ *               压缩结果按与内存版相同的公式累计，不保留编码输出
+ *
+ */
+#include "stream_analyzer.h"
+#include "bit_packing.hpp"
+#include "chunk_pipeline.hpp"
+#include "flat_dictionary.hpp"
+#include "index_storage.hpp"
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <unordered_map>
+
+#define STREAM_TEXT_BLOCK     (64 * 1024) // 文本输入每次读取的字节数
+#define STREAM_MAX_TOKEN      (64)        // 单个数值文本的最大长度，超出视为非法
+#define STREAM_FREQ_ENTRY     (48)        // 频率表每项估计占用（节点 + 桶）
+#define STREAM_DICT_ENTRY(T)  (sizeof(T) + sizeof(uint64_t) + 4 * sizeof(uint32_t)) // 值 + 键 + 槽位（负载因子 0.5，扩容前后）
+
+int8_t ParseMemLimit(const std::string &text, uint64_t &bytes)
+{
+    char *end = nullptr;
+    errno = 0;
+    unsigned long long value = std::strtoull(text.c_str(), &end, 10);
+    if (errno != 0 || end == text.c_str() || text[0] == '-')
+        return ERROR_PARAM_INVALID;
+
+    std::string suffix(end);
+    if (!suffix.empty() && (suffix.back() == 'B' || suffix.back() == 'b'))
+        suffix.pop_back();
+    uint32_t shift = 0;
+    if (suffix == "K" || suffix == "k")
+        shift = 10;
+    else if (suffix == "M" || suffix == "m")
+        shift = 20;
+    else if (suffix == "G" || suffix == "g")
+        shift = 30;
+    else if (!suffix.empty())
+        return ERROR_PARAM_INVALID;
+
+    if (value > (UINT64_MAX >> shift) || (value << shift) < STREAM_MIN_MEM_LIMIT)
+        return ERROR_PARAM_INVALID;
+    bytes = value << shift;
+    return SAA_SUCCESS;
+}
+
+// 按块读取数组文件，可回到开头重新读取
+template <typename T>
+class ChunkReader
+{
+public:
+    int8_t open(const StreamSource &source)
+    {
+        _source = source;
+        _file.open(source.path, std::ios::binary);
+        if (!_file.is_open())
+        {
+            std::cerr << LOG_ERROR << "Failed to open file: " << source.path << std::endl;
+            return ERROR_PARAM_INVALID;
+        }
+        _raw.resize(STREAM_TEXT_BLOCK);
+        rewind();
+        return SAA_SUCCESS;
+    }
+
+    void rewind()
+    {
+        _file.clear();
+        _file.seekg(_source.isBinary ? SAA_BIN_HEADER_SIZE : 0);
+        _consumed = 0;
+        _rawPos = 0;
+        _rawLen = 0;
+        _token.clear();
+        _quiet = _passes++ > 0; // 非法数值只在第一遍提示
+    }
+
+    bool failed() const { return _failed; }
+
+    // 读取最多 capacity 个元素，返回实际数量，0 表示结束
+    size_t read(T *buffer, size_t capacity)
+    {
+        if (_source.isBinary)
+        {
+            uint64_t total = _source.rows * _source.cols;
+            size_t count = static_cast<size_t>(std::min<uint64_t>(capacity, total - _consumed));
+            _file.read(reinterpret_cast<char *>(buffer), count * sizeof(T));
+            if (static_cast<size_t>(_file.gcount()) != count * sizeof(T))
+            {
+                std::cerr << LOG_ERROR << "Binary array file is truncated: " << _source.path << std::endl;
+                _failed = true;
+                return 0;
+            }
+            _consumed += count;
+            return count;
+        }
+
+        size_t count = 0;
+        while (count < capacity && nextText(buffer[count]))
+            ++count;
+        _consumed += count;
+        return count;
+    }
+
+private:
+    // 空白与逗号均视为分隔符，与 LoadArrayFromTxt 一致
+    bool nextText(T &value)
+    {
+        while (true)
+        {
+            if (_rawPos == _rawLen)
+            {
+                _file.read(_raw.data(), _raw.size());
+                _rawLen = static_cast<size_t>(_file.gcount());
+                _rawPos = 0;
+                if (_rawLen == 0)
+                    return !_token.empty() && takeToken(value);
+            }
+
+            char ch = _raw[_rawPos++];
+            if (std::isspace(static_cast<unsigned char>(ch)) || ch == ',')
+            {
+                if (!_token.empty() && takeToken(value))
+                    return true;
+            }
+            else if (_token.size() <= STREAM_MAX_TOKEN)
+            {
+                _token.push_back(ch);
+            }
+        }
+    }
+
+    bool takeToken(T &value)
+    {
+        bool valid = _token.size() <= STREAM_MAX_TOKEN && ParseTextValue(_token, value);
+        if (!valid && !_quiet)
+            std::cerr << "Warning: Invalid data encountered. Skipping...\n";
+        _token.clear();
+        return valid;
+    }
+
+    StreamSource _source;
+    std::ifstream _file;
+    uint64_t _consumed = 0;
+    bool _failed = false;
+    bool _quiet = false;
+    uint32_t _passes = 0;
+
+    std::vector<char> _raw;
+    size_t _rawPos = 0;
+    size_t _rawLen = 0;
+    std::string _token;
+};
+
+// Misra-Gries 频率摘要：表未满时为精确计数；表满后出现次数超过 n / (capacity + 1) 的值一定保留
+template <typename T>
+class MainValueCounter
+{
+public:
+    explicit MainValueCounter(size_t capacity) : _capacity(std::max<size_t>(capacity, 2)) {}
+
+    void feed(const T *data, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto it = _counts.find(ToOrderedKey(data[i]));
+            if (it != _counts.end())
+            {
+                ++it->second;
+                continue;
+            }
+            if (_counts.size() < _capacity)
+            {
+                _counts.emplace(ToOrderedKey(data[i]), 1);
+                _peak = std::max<uint64_t>(_peak, _counts.size());
+                continue;
+            }
+
+            _exact = false;
+            for (it = _counts.begin(); it != _counts.end();)
+                it = (--it->second == 0) ? _counts.erase(it) : std::next(it);
+        }
+    }
+
+    // 次数相同时取有序键较小者，保证结果与读取顺序无关
+    T mainValue() const
+    {
+        T best = 0;
+        uint64_t bestCount = 0;
+        for (const auto &pair : _counts)
+        {
+            if (pair.second > bestCount || (pair.second == bestCount && pair.first < ToOrderedKey(best)))
+            {
+                best = FromOrderedKey<T>(pair.first);
+                bestCount = pair.second;
+            }
+        }
+        return best;
+    }
+
+    bool exact() const { return _exact; }
+    uint64_t peakBytes() const { return _peak * STREAM_FREQ_ENTRY; }
+
+private:
+    size_t _capacity;
+    uint64_t _peak = 0;
+    bool _exact = true;
+    std::unordered_map<uint64_t, uint64_t> _counts; // 键为位模式，与压缩器判断主值一致
+};
+
+template <typename T>
+struct StreamContext
+{
+    T mainValue = 0;
+    uint64_t elemCount = 0;
+    uint64_t rows = 1;
+    uint64_t cols = 0;
+    bool is2D = false;
+};
+
+// 跟踪参考帧位打包所需的取值范围，字节数与 PackedValuesBytes 一致
+template <typename V>
+class PackedRange
+{
+public:
+    void add(V value)
+    {
+        uint64_t key = ToOrderedKey(value);
+        _min = std::min(_min, key);
+        _max = std::max(_max, key);
+    }
+
+    uint64_t bytes(uint64_t count) const
+    {
+        PackedValues<V> packed;
+        packed.count = count;
+        packed.bitWidth = count ? BitWidthOf(_max - _min) : 0;
+        return PackedValuesBytes(packed);
+    }
+
+private:
+    uint64_t _min = UINT64_MAX;
+    uint64_t _max = 0;
+};
+
+template <typename T>
+class StreamEncoder
+{
+public:
+    explicit StreamEncoder(const StreamContext<T> &ctx) : _ctx(ctx) {}
+    virtual ~StreamEncoder() = default;
+
+    // 按行优先顺序依次传入各块
+    virtual void feed(const T *data, size_t count) = 0;
+    virtual int8_t finish(CalResult &result) = 0;
+    virtual uint64_t stateBytes() const { return 0; }
+
+    double elapsedMs = 0;
+
+protected:
+    void fillResult(CalResult &result, const std::string &name, uint64_t compressedBytes, uint64_t compressedElems) const
+    {
+        result.modeName = name;
+        result.originElementCount = _ctx.elemCount;
+        result.compressedElementCount = compressedElems;
+        result.originSizeBytes = _ctx.elemCount * sizeof(T);
+        result.compressedSizeBytes = compressedBytes;
+        result.compressTimeMs = elapsedMs;
+        result.decompressTimeMs = 0;
+        result.compressionRatio = static_cast<double>(compressedBytes) / result.originSizeBytes * 100.0;
+    }
+
+    const StreamContext<T> &_ctx;
+};
+
+template <typename T>
+class StreamBitmap : public StreamEncoder<T>
+{
+public:
+    StreamBitmap(const StreamContext<T> &ctx, bool packValues) : StreamEncoder<T>(ctx), _packValues(packValues) {}
+
+    void feed(const T *data, size_t count) override
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (!SameBits(data[i], this->_ctx.mainValue))
+            {
+                ++_nnz;
+                _range.add(data[i]);
+            }
+        }
+    }
+
+    int8_t finish(CalResult &result) override
+    {
+        uint64_t bitmapBytes = (this->_ctx.elemCount + 7) / 8;
+        uint64_t valueBytes = _packValues ? _range.bytes(_nnz) : _nnz * sizeof(T);
+        this->fillResult(result, _packValues ? "BitmapPayload-FOR" : "BitmapPayload",
+                         bitmapBytes + valueBytes + 3 * sizeof(uint32_t) + sizeof(T), bitmapBytes + _nnz + 4);
+        result.seqAccessOps = 1.0 + static_cast<double>(_nnz) / this->_ctx.elemCount;
+        result.randomAccessOps = 2.0 + bitmapBytes / 2.0;
+        return SAA_SUCCESS;
+    }
+
+private:
+    bool _packValues;
+    uint64_t _nnz = 0;
+    PackedRange<T> _range;
+};
+
+template <typename T>
+class StreamRunLength : public StreamEncoder<T>
+{
+public:
+    StreamRunLength(const StreamContext<T> &ctx, bool packValues) : StreamEncoder<T>(ctx), _packValues(packValues) {}
+
+    // 游程可跨块延续，超长游程按 UINT32_MAX 拆分
+    void feed(const T *data, size_t count) override
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (_count && SameBits(data[i], _current) && _count < UINT32_MAX)
+            {
+                ++_count;
+                continue;
+            }
+            if (_count)
+                closeRun();
+            _current = data[i];
+            _count = 1;
+        }
+    }
+
+    int8_t finish(CalResult &result) override
+    {
+        if (_count)
+            closeRun();
+        _count = 0;
+
+        struct RunNode // 与 RunLengthEnc 的游程节点布局一致
+        {
+            T value;
+            uint32_t count;
+        };
+        uint64_t bytes = _packValues ? _values.bytes(_runs) + _counts.bytes(_runs) : _runs * sizeof(RunNode);
+        if (this->_ctx.is2D)
+            bytes += 2 * sizeof(uint32_t) + sizeof(uint8_t);
+        this->fillResult(result, _packValues ? "RunLengthEnc-FOR" : "RunLengthEnc", bytes, _runs * 2);
+        result.seqAccessOps = 1.0 + static_cast<double>(_runs) / this->_ctx.elemCount;
+        result.randomAccessOps = 1.0 + _runs / 2.0;
+        return SAA_SUCCESS;
+    }
+
+private:
+    void closeRun()
+    {
+        ++_runs;
+        _values.add(_current);
+        _counts.add(_count);
+    }
+
+    bool _packValues;
+    T _current = 0;
+    uint32_t _count = 0;
+    uint64_t _runs = 0;
+    PackedRange<T> _values;
+    PackedRange<uint32_t> _counts;
+};
+
+template <typename T>
+class StreamDictionary : public StreamEncoder<T>
+{
+public:
+    StreamDictionary(const StreamContext<T> &ctx, uint64_t maxEntries) : StreamEncoder<T>(ctx), _maxEntries(maxEntries) {}
+
+    // 不同值数量超出预算后放弃字典并释放内存
+    void feed(const T *data, size_t count) override
+    {
+        for (size_t i = 0; i < count && !_overflow; ++i)
+        {
+            _dict.insert(data[i]);
+            if (_dict.values().size() > _maxEntries)
+            {
+                _overflow = true;
+                _dict = FlatDictionary<T>();
+            }
+        }
+    }
+
+    int8_t finish(CalResult &result) override
+    {
+        if (_overflow)
+        {
+            std::cerr << LOG_WARN << "HashDictionary skipped: more than " << _maxEntries
+                      << " distinct values do not fit the memory limit.\n";
+            return ERROR_UNSUPPORT_FEATURE;
+        }
+
+        uint64_t dictSize = _dict.values().size();
+        uint8_t bitWidth = BitWidthOf(dictSize - 1);
+        uint64_t indexBytes = (this->_ctx.elemCount * bitWidth + 7) / 8;
+        this->fillResult(result, "HashDictionary", indexBytes + dictSize * sizeof(T) + 3 * sizeof(uint32_t) + 1,
+                         dictSize + indexBytes + 4);
+        result.seqAccessOps = 1.0 + bitWidth;
+        result.randomAccessOps = 1.0 + bitWidth;
+        return SAA_SUCCESS;
+    }
+
+    uint64_t stateBytes() const override { return _dict.values().size() * STREAM_DICT_ENTRY(T); }
+
+private:
+    uint64_t _maxEntries;
+    bool _overflow = false;
+    FlatDictionary<T> _dict;
+};
+
+template <typename T>
+class StreamCSR : public StreamEncoder<T>
+{
+public:
+    StreamCSR(const StreamContext<T> &ctx, bool packValues) : StreamEncoder<T>(ctx), _packValues(packValues) {}
+
+    // 行偏移只取决于每行非主值个数，按位置逐行累计即可
+    void feed(const T *data, size_t count) override
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (!SameBits(data[i], this->_ctx.mainValue))
+            {
+                ++_nnz;
+                _range.add(data[i]);
+            }
+        }
+    }
+
+    int8_t finish(CalResult &result) override
+    {
+        uint64_t rows = this->_ctx.rows;
+        uint64_t cols = this->_ctx.cols;
+        uint64_t indexBytes = _nnz * SelectIndexWidth(cols ? cols - 1 : 0) + (rows + 1) * SelectIndexWidth(rows * cols);
+        uint64_t valueBytes = _packValues ? _range.bytes(_nnz) : _nnz * sizeof(T);
+        this->fillResult(result, _packValues ? "CompressedSparseRow-FOR" : "CompressedSparseRow",
+                         valueBytes + indexBytes + 2 * sizeof(uint32_t) + sizeof(T), _nnz + _nnz + rows + 1);
+        double nnz = static_cast<double>(_nnz);
+        result.seqAccessOps = 1.0 + 2.0 * nnz / this->_ctx.elemCount;
+        result.randomAccessOps = 2.0 + std::log2(nnz / std::max<uint64_t>(rows, 1) + 1.0);
+        return SAA_SUCCESS;
+    }
+
+private:
+    bool _packValues;
+    uint64_t _nnz = 0;
+    PackedRange<T> _range;
+};
+
+template <typename T>
+static int8_t StreamTyped(const StreamSource &source, uint64_t memLimit, std::vector<CalResult> &results,
+                          StreamStats &stats)
+{
+    // 1. 按预算划分内存：块缓冲池共占 1/4
+    uint64_t chunkElems = std::max<uint64_t>(memLimit / 4 / PIPELINE_BUFFER_COUNT / sizeof(T), 1);
+    ChunkPipeline<T> pipeline(chunkElems);
+    uint64_t dictEntries = memLimit / 2 / STREAM_DICT_ENTRY(T);
+
+    ChunkReader<T> reader;
+    int8_t ret = reader.open(source);
+    if (ret != SAA_SUCCESS)
+    {
+        return ret;
+    }
+    auto produce = [&](T *buffer, size_t capacity)
+    { return reader.read(buffer, capacity); };
+
+    // 2. 第一遍：元素数量与主值，频率表在第二遍开始前释放
+    StreamContext<T> ctx;
+    PipelineTiming timing;
+    uint64_t chunks = 0;
+    uint64_t counterBytes = 0;
+    {
+        MainValueCounter<T> counter(memLimit / 4 / STREAM_FREQ_ENTRY);
+        chunks = pipeline.run(produce, {[&](const T *data, size_t count)
+                                        {
+                                            counter.feed(data, count);
+                                            ctx.elemCount += count;
+                                        }},
+                              timing);
+        ctx.mainValue = counter.mainValue();
+        counterBytes = counter.peakBytes();
+        stats.mainValueExact = counter.exact();
+    }
+    if (reader.failed())
+    {
+        return ERROR_PARAM_INVALID;
+    }
+    if (ctx.elemCount == 0)
+    {
+        std::cerr << LOG_ERROR << "Input data is empty.\n";
+        return ERROR_INPUT_EMPTY;
+    }
+
+    ctx.is2D = source.dimension == ARRAY_2D;
+    ctx.rows = source.rows;
+    ctx.cols = (source.cols == 0) ? ctx.elemCount : source.cols;
+    if (ctx.rows * ctx.cols != ctx.elemCount)
+    {
+        std::cerr << LOG_ERROR << "Read " << ctx.elemCount << " elements, expected " << ctx.rows * ctx.cols << ".\n";
+        return ERROR_PARAM_INVALID;
+    }
+
+    // 3. 第二遍：编码器轮流分给各消费线程，每个线程按块顺序喂给自己的编码器
+    std::vector<std::unique_ptr<StreamEncoder<T>>> encoders;
+    encoders.emplace_back(new StreamBitmap<T>(ctx, false));
+    encoders.emplace_back(new StreamBitmap<T>(ctx, true));
+    encoders.emplace_back(new StreamRunLength<T>(ctx, false));
+    encoders.emplace_back(new StreamRunLength<T>(ctx, true));
+    encoders.emplace_back(new StreamDictionary<T>(ctx, dictEntries));
+    if (ctx.is2D)
+    {
+        encoders.emplace_back(new StreamCSR<T>(ctx, false));
+        encoders.emplace_back(new StreamCSR<T>(ctx, true));
+    }
+
+    uint32_t hardware = std::thread::hardware_concurrency();
+    size_t workerCount = std::min<size_t>(encoders.size(), (hardware > 1) ? hardware - 1 : 1); // 留一个核给读线程
+    std::vector<uint64_t> workerState(workerCount, 0);
+    std::vector<typename ChunkPipeline<T>::Consumer> consumers;
+    for (size_t w = 0; w < workerCount; ++w)
+    {
+        consumers.push_back([&, w](const T *data, size_t count)
+                            {
+                                uint64_t chunkState = 0;
+                                for (size_t e = w; e < encoders.size(); e += workerCount)
+                                {
+                                    auto start = std::chrono::high_resolution_clock::now();
+                                    encoders[e]->feed(data, count);
+                                    encoders[e]->elapsedMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+                                    chunkState += encoders[e]->stateBytes();
+                                }
+                                workerState[w] = std::max(workerState[w], chunkState); });
+    }
+
+    reader.rewind();
+    pipeline.run(produce, consumers, timing);
+    if (reader.failed())
+    {
+        return ERROR_PARAM_INVALID;
+    }
+    uint64_t stateBytes = 0;
+    for (uint64_t bytes : workerState)
+        stateBytes += bytes;
+
+    // 4. 汇总结果
+    results.clear();
+    for (auto &encoder : encoders)
+    {
+        CalResult result;
+        if (encoder->finish(result) == SAA_SUCCESS)
+            results.push_back(result);
+    }
+
+    stats.elemCount = ctx.elemCount;
+    stats.chunkElems = chunkElems;
+    stats.chunkCount = chunks;
+    stats.workerCount = static_cast<uint32_t>(workerCount);
+    stats.peakBytes = pipeline.bufferBytes() + std::max(counterBytes, stateBytes);
+    stats.readTimeMs = timing.readMs;
+    stats.encodeTimeMs = timing.computeMs;
+    stats.wallTimeMs = timing.wallMs;
+    return SAA_SUCCESS;
+}
+
+int8_t RunStreamAnalysis(const StreamSource &source, uint64_t memLimit, std::vector<CalResult> &results,
+                         StreamStats &stats)
+{
+    if (memLimit < STREAM_MIN_MEM_LIMIT)
+    {
+        return ERROR_PARAM_INVALID;
+    }
+
+    return DispatchElemType(source.elemType, [&](auto tag)
+                            { return StreamTyped<decltype(tag)>(source, memLimit, results, stats); });
+}
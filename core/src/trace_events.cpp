@@ -0,0 +1,207 @@
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2026-10-20 02:20:00
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2026-10-20 02:20:00
+ * @FilePath: \SparseArrayAnalyzer\core\src\trace_events.cpp
+ * @Description: 每个线程首次记录时在全局登记一块事件缓冲，之后只由本线程追加、不加锁；
+ *               缓冲归登记表所有，线程退出后事件仍保留到写出
+ *
+ */
+#include "trace_events.h"
+#include "common.h"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+typedef struct trace_event
+{
+    const char *name;
+    std::string detail;
+    int64_t startNs;
+    int64_t durationNs;
+} TraceEvent;
+
+typedef struct thread_trace
+{
+    uint32_t tid;
+    std::string name;
+    std::vector<TraceEvent> events;
+} ThreadTrace;
+
+static std::atomic<bool> g_traceEnabled{false};
+static std::chrono::steady_clock::time_point g_traceEpoch;
+static std::mutex g_traceMutex; // 保护登记表与线程名
+static std::vector<std::unique_ptr<ThreadTrace>> g_threadTraces;
+static thread_local ThreadTrace *t_threadTrace = nullptr;
+
+static int64_t TraceNowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - g_traceEpoch).count();
+}
+
+static ThreadTrace &CurrentThreadTrace()
+{
+    if (!t_threadTrace)
+    {
+        auto trace = std::make_unique<ThreadTrace>();
+        trace->events.reserve(TRACE_THREAD_RESERVE);
+        std::lock_guard<std::mutex> lock(g_traceMutex);
+        trace->tid = static_cast<uint32_t>(g_threadTraces.size()) + 1;
+        trace->name = "thread-" + std::to_string(trace->tid);
+        t_threadTrace = trace.get();
+        g_threadTraces.push_back(std::move(trace));
+    }
+    return *t_threadTrace;
+}
+
+void EnableTracing()
+{
+    if (!g_traceEnabled.exchange(true))
+    {
+        g_traceEpoch = std::chrono::steady_clock::now();
+    }
+}
+
+bool TracingEnabled()
+{
+    return g_traceEnabled.load(std::memory_order_relaxed);
+}
+
+void SetTraceThreadName(const std::string &name)
+{
+    if (!TracingEnabled())
+    {
+        return;
+    }
+
+    ThreadTrace &trace = CurrentThreadTrace();
+    std::lock_guard<std::mutex> lock(g_traceMutex);
+    trace.name = name;
+}
+
+// 与报告中的 JsonString 相同的转义；本文件随 common.o 链接进生成工具，不依赖报告模块
+static std::string TraceJsonString(const std::string &text)
+{
+    std::string escaped = "\"";
+    for (char ch : text)
+    {
+        if (ch == '"' || ch == '\\')
+            escaped += '\\';
+        if (static_cast<unsigned char>(ch) < 0x20)
+            continue;
+        escaped += ch;
+    }
+    return escaped + "\"";
+}
+
+// 微秒，保留到纳秒
+static void WriteMicros(std::ostream &out, int64_t ns)
+{
+    out << ns / 1000 << "." << std::setw(3) << std::setfill('0') << ns % 1000 << std::setfill(' ');
+}
+
+int8_t WriteTrace(const std::string &path)
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        std::cerr << LOG_ERROR << "Failed to open file: " << path << std::endl;
+        return ERROR_PARAM_INVALID;
+    }
+
+    // 1. 进程与线程名元数据，之后是各线程的完整事件
+    std::lock_guard<std::mutex> lock(g_traceMutex);
+    uint64_t eventCount = 0;
+    file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    file << "  {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0, \"args\": {\"name\": \"sparse_array_analyzer\"}}";
+    for (const auto &trace : g_threadTraces)
+    {
+        file << ",\n  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << trace->tid
+             << ", \"args\": {\"name\": " << TraceJsonString(trace->name) << "}}";
+    }
+    for (const auto &trace : g_threadTraces)
+    {
+        for (const auto &event : trace->events)
+        {
+            file << ",\n  {\"name\": " << TraceJsonString(event.name) << ", \"cat\": \"saa\", \"ph\": \"X\", \"pid\": 1, \"tid\": "
+                 << trace->tid << ", \"ts\": ";
+            WriteMicros(file, event.startNs);
+            file << ", \"dur\": ";
+            WriteMicros(file, event.durationNs);
+            if (!event.detail.empty())
+            {
+                file << ", \"args\": {\"detail\": " << TraceJsonString(event.detail) << "}";
+            }
+            file << "}";
+            ++eventCount;
+        }
+    }
+    file << "\n]}\n";
+
+    if (!file)
+    {
+        std::cerr << LOG_ERROR << "Failed to write trace file: " << path << std::endl;
+        return ERROR_UNKNOW_ERROR;
+    }
+    std::cerr << LOG_INFO << "Trace written to " << path << " (" << eventCount << " events, "
+              << g_threadTraces.size() << " threads).\n";
+    return SAA_SUCCESS;
+}
+
+TraceSpan::TraceSpan(const char *name)
+{
+    if (TracingEnabled())
+    {
+        _name = name;
+        _startNs = TraceNowNs();
+    }
+}
+
+TraceSpan::TraceSpan(const char *name, const std::string &detail)
+{
+    if (TracingEnabled())
+    {
+        _name = name;
+        _detail = detail;
+        _startNs = TraceNowNs();
+    }
+}
+
+TraceSpan::~TraceSpan()
+{
+    stop();
+}
+
+void TraceSpan::stop()
+{
+    if (!_name)
+    {
+        return;
+    }
+
+    int64_t endNs = TraceNowNs();
+    CurrentThreadTrace().events.push_back({_name, std::move(_detail), _startNs, endNs - _startNs});
+    _name = nullptr;
+}
+
+TraceSession::TraceSession(const std::string &path) : _path(path)
+{
+    if (!_path.empty())
+    {
+        EnableTracing();
+        SetTraceThreadName("main");
+    }
+}
+
+TraceSession::~TraceSession()
+{
+    if (!_path.empty())
+    {
+        WriteTrace(_path);
+    }
+}
@@ -0,0 +1,90 @@
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2026-10-20 01:40:00
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2026-10-20 01:40:00
+ * @FilePath: \SparseArrayAnalyzer\core\src\work_arena.cpp
+ * @Description: 块链表上的指针碰撞分配；块从全局 operator new 申请，--track-alloc 能看到上游申请次数
+ *
+ */
+#include "work_arena.h"
+#include <algorithm>
+#include <new>
+
+WorkArena::~WorkArena()
+{
+    for (const auto &block : _blocks)
+    {
+        ::operator delete(block.data);
+    }
+}
+
+size_t WorkArena::CapacityBytes() const
+{
+    size_t total = 0;
+    for (const auto &block : _blocks)
+    {
+        total += block.size;
+    }
+    return total;
+}
+
+void WorkArena::addBlock(size_t bytes)
+{
+    _blocks.push_back({static_cast<char *>(::operator new(bytes)), bytes});
+    ++_upstreamAllocations;
+}
+
+void *WorkArena::do_allocate(size_t bytes, size_t alignment)
+{
+    // 1. 依次尝试当前块及其后已有的块（回卷后保留下来的块）
+    for (; _current < _blocks.size(); ++_current, _offset = 0)
+    {
+        ArenaBlock &block = _blocks[_current];
+        uintptr_t base = reinterpret_cast<uintptr_t>(block.data);
+        uintptr_t aligned = (base + _offset + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+        if (aligned + bytes <= base + block.size)
+        {
+            _offset = aligned + bytes - base;
+            return reinterpret_cast<void *>(aligned);
+        }
+    }
+
+    // 2. 都放不下时追加新块，大小至少为已有容量，保证块数按对数增长
+    size_t size = std::max({_initialBytes, CapacityBytes(), bytes + alignment});
+    addBlock(size);
+    _current = _blocks.size() - 1;
+    uintptr_t base = reinterpret_cast<uintptr_t>(_blocks[_current].data);
+    uintptr_t aligned = (base + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+    _offset = aligned + bytes - base;
+    return reinterpret_cast<void *>(aligned);
+}
+
+void WorkArena::do_deallocate(void *ptr, size_t bytes, size_t alignment)
+{
+    // 线性分配不单独回收，Rewind() 时整体复用
+    (void)ptr;
+    (void)bytes;
+    (void)alignment;
+}
+
+bool WorkArena::do_is_equal(const std::pmr::memory_resource &other) const noexcept
+{
+    return this == &other;
+}
+
+void WorkArena::Rewind()
+{
+    if (_blocks.size() > 1)
+    {
+        size_t total = CapacityBytes();
+        for (const auto &block : _blocks)
+        {
+            ::operator delete(block.data);
+        }
+        _blocks.clear();
+        addBlock(total);
+    }
+    _current = 0;
+    _offset = 0;
+}
@@ -0,0 +1,129 @@
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2026-10-19 23:40:00
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2026-10-19 23:40:00
+ * @FilePath: \SparseArrayAnalyzer\core\src\work_stealing_pool.hpp
+ * @Description: 工作窃取线程池：每个线程一个双端队列，自己从尾部取（后进先出，刚加载的数据仍在缓存中），
+ *               空闲时从其他线程队列头部窃取（最早提交、通常最大的任务）；任务内可继续提交子任务
+ *
+ */
+#pragma once
+#include "trace_events.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define POOL_IDLE_SPINS    (64)  // 空闲时先让出若干次再休眠
+#define POOL_IDLE_SLEEP_US (100)
+
+class WorkStealingPool
+{
+public:
+    using Task = std::function<void()>;
+
+    explicit WorkStealingPool(uint32_t threadCount)
+        : _queues(std::max<uint32_t>(threadCount, 1))
+    {
+    }
+
+    uint32_t threadCount() const { return static_cast<uint32_t>(_queues.size()); }
+
+    // 运行前提交：按 worker 指定初始队列；运行中提交：放入当前线程的队列尾部
+    void submit(Task task, uint32_t worker = 0)
+    {
+        uint32_t target = (CurrentWorker() >= 0) ? static_cast<uint32_t>(CurrentWorker()) : worker % threadCount();
+        _pending.fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(_queues[target].mutex);
+        _queues[target].tasks.push_back(std::move(task));
+    }
+
+    // 阻塞直到所有任务（含运行中提交的子任务）完成；返回被窃取的任务数
+    uint64_t run()
+    {
+        _steals = 0;
+        std::vector<std::thread> workers;
+        for (uint32_t w = 0; w < threadCount(); ++w)
+        {
+            workers.emplace_back([this, w]
+                                 {
+                                     CurrentWorker() = static_cast<int32_t>(w);
+                                     SetTraceThreadName("worker-" + std::to_string(w));
+                                     workerLoop(w);
+                                     CurrentWorker() = -1; });
+        }
+        for (auto &worker : workers)
+            worker.join();
+        return _steals.load();
+    }
+
+private:
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    static int32_t &CurrentWorker()
+    {
+        static thread_local int32_t index = -1;
+        return index;
+    }
+
+    bool popLocal(uint32_t w, Task &task)
+    {
+        std::lock_guard<std::mutex> lock(_queues[w].mutex);
+        if (_queues[w].tasks.empty())
+            return false;
+        task = std::move(_queues[w].tasks.back());
+        _queues[w].tasks.pop_back();
+        return true;
+    }
+
+    bool steal(uint32_t w, Task &task)
+    {
+        for (uint32_t i = 1; i < threadCount(); ++i)
+        {
+            WorkQueue &victim = _queues[(w + i) % threadCount()];
+            std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+            if (!lock.owns_lock() || victim.tasks.empty())
+                continue;
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            _steals.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    void workerLoop(uint32_t w)
+    {
+        uint32_t idle = 0;
+        while (_pending.load(std::memory_order_acquire) > 0)
+        {
+            Task task;
+            if (popLocal(w, task) || steal(w, task))
+            {
+                idle = 0;
+                task();
+                _pending.fetch_sub(1, std::memory_order_acq_rel); // 子任务在返回前已计入，计数不会提前归零
+                continue;
+            }
+
+            if (++idle < POOL_IDLE_SPINS)
+                std::this_thread::yield();
+            else
+                std::this_thread::sleep_for(std::chrono::microseconds(POOL_IDLE_SLEEP_US));
+        }
+    }
+
+    std::vector<WorkQueue> _queues;
+    std::atomic<uint64_t> _pending{0};
+    std::atomic<uint64_t> _steals{0};
+};
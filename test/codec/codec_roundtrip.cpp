@@ -0,0 +1,257 @@
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2026-10-20 09:40:00
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2026-10-20 09:40:00
+ * @FilePath: \SparseArrayAnalyzer\test\codec\codec_roundtrip.cpp
+ * @Description: 编解码回归：每个已注册格式 × 每种输入做 压缩 -> 解压 -> 序列化 -> 反序列化 -> 解压 / GetElement，
+ *               逐元素按位比较；再对序列化结果做截断与字节翻转，反序列化须拒绝或解压不越界（配合 ASan 运行）
+ *
+ */
+#include "sparse_array_analyzer.h"
+#include "common.h"
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+#if defined(__linux__) && !defined(__SANITIZE_ADDRESS__)
+#include <sys/resource.h>
+#endif
+
+#define ROUNDTRIP_FLIPS_PER_BLOB (64)        // 每个序列化结果做的随机字节翻转次数
+#define ROUNDTRIP_ADDRESS_LIMIT  (2ULL << 30) // 地址空间上限，翻转出的超大形状在分配时失败而不是耗尽内存
+
+typedef struct roundtrip_case
+{
+    std::string name;
+    ArrayInput input;
+} RoundtripCase;
+
+static uint64_t g_checks = 0;
+static uint64_t g_failures = 0;
+
+static void Fail(const std::string &where, const std::string &what)
+{
+    ++g_failures;
+    std::cerr << LOG_ERROR << where << ": " << what << "\n";
+}
+
+// 行优先展平，按位比较（NaN 与 -0.0 也须原样还原）
+template <typename T>
+static std::vector<T> Flatten(const ArrayInput &data)
+{
+    if (const auto *flat = std::get_if<ArrayData1D<T>>(&data))
+        return flat->arrayData;
+
+    std::vector<T> out;
+    for (const auto &row : std::get<ArrayData2D<T>>(data).arrayData)
+        out.insert(out.end(), row.begin(), row.end());
+    return out;
+}
+
+template <typename T>
+static bool SameBits(const std::vector<T> &a, const std::vector<T> &b)
+{
+    return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+}
+
+template <typename T>
+static ArrayInput EmptyLike(const ArrayInput &input)
+{
+    return std::holds_alternative<ArrayData2D<T>>(input) ? ArrayInput{ArrayData2D<T>()} : ArrayInput{ArrayData1D<T>()};
+}
+
+// 数据须按 8 字节对齐，用 uint64_t 缓冲承载
+static std::vector<uint64_t> AlignedCopy(const std::vector<uint8_t> &blob)
+{
+    std::vector<uint64_t> buffer((blob.size() + 7) / 8 + 1, 0);
+    if (!blob.empty())
+        std::memcpy(buffer.data(), blob.data(), blob.size());
+    return buffer;
+}
+
+// 1. 构造输入：二维稀疏、一维游程、随机稠密、常量，浮点额外带 NaN / -0.0
+template <typename T>
+static std::vector<RoundtripCase> MakeCases()
+{
+    std::vector<RoundtripCase> cases;
+    std::mt19937_64 rng(20261020);
+    auto value = [&rng](uint32_t range) { return static_cast<T>(1 + rng() % range); };
+
+    ArrayData2D<T> sparse;
+    sparse.rowCount = 67;
+    sparse.colCount = 300; // 跨 8 位列号
+    sparse.arrayData.assign(sparse.rowCount, std::vector<T>(sparse.colCount, 0));
+    for (auto &row : sparse.arrayData)
+        for (auto &elem : row)
+            if (rng() % 10 == 0)
+                elem = value(100);
+    cases.push_back({"sparse-2d", sparse});
+
+    ArrayData1D<T> runs;
+    while (runs.arrayData.size() < 140000) // 跨 Roaring 块与 CompactRLE 并行阈值以下
+    {
+        T v = (rng() % 3) ? T(0) : value(50);
+        runs.arrayData.insert(runs.arrayData.end(), 1 + rng() % 40, v);
+    }
+    cases.push_back({"runs-1d", runs});
+
+    ArrayData1D<T> dense;
+    for (uint32_t i = 0; i < 5000; ++i)
+        dense.arrayData.push_back(value(250));
+    cases.push_back({"dense-1d", dense});
+
+    ArrayData2D<T> constant;
+    constant.rowCount = 3;
+    constant.colCount = 5;
+    constant.arrayData.assign(3, std::vector<T>(5, T(7)));
+    cases.push_back({"constant-2d", constant});
+
+    if constexpr (std::is_floating_point_v<T>)
+    {
+        ArrayData1D<T> special;
+        special.arrayData.assign(2000, T(0));
+        for (size_t i = 0; i < special.arrayData.size(); i += 7)
+            special.arrayData[i] = std::numeric_limits<T>::quiet_NaN();
+        for (size_t i = 3; i < special.arrayData.size(); i += 11)
+            special.arrayData[i] = -T(0);
+        cases.push_back({"nan-negzero-1d", special});
+    }
+    return cases;
+}
+
+// 2. 截断与随机字节翻转：只要求不崩溃、不越界；反序列化成功时继续解压与随机读取。
+//    翻转行列数得到的仍是合法的稀疏描述，只是展开后过大，分配失败视为拒绝
+static void CorruptBlob(const std::string &algorithm, ElemType type, const std::vector<uint8_t> &blob, std::mt19937_64 &rng)
+{
+    auto tryLoad = [&](const std::vector<uint8_t> &bytes)
+    {
+        auto compressor = CompressorRegistry::Instance().Create(algorithm, type);
+        std::vector<uint64_t> buffer = AlignedCopy(bytes);
+        if (compressor->Deserialize(reinterpret_cast<const uint8_t *>(buffer.data()), bytes.size()) != SAA_SUCCESS)
+            return;
+
+        try
+        {
+            DispatchElemType(type, [&](auto tag)
+                             {
+                                 using T = decltype(tag);
+                                 T elem{};
+                                 for (uint64_t index : {uint64_t(0), uint64_t(1), uint64_t(777), uint64_t(100000)})
+                                     compressor->GetElement(index, &elem);
+                                 ArrayInput out1d = ArrayData1D<T>();
+                                 ArrayInput out2d = ArrayData2D<T>();
+                                 if (compressor->Decompress(out1d) != SAA_SUCCESS)
+                                     compressor->Decompress(out2d);
+                                 return 0; });
+        }
+        catch (const std::bad_alloc &)
+        {
+        }
+        catch (const std::length_error &)
+        {
+        }
+    };
+
+    for (size_t cut : {size_t(0), size_t(1), blob.size() / 2, blob.size() - 1})
+    {
+        if (cut < blob.size())
+            tryLoad(std::vector<uint8_t>(blob.begin(), blob.begin() + cut));
+    }
+    for (uint32_t i = 0; i < ROUNDTRIP_FLIPS_PER_BLOB && !blob.empty(); ++i)
+    {
+        std::vector<uint8_t> bytes = blob;
+        bytes[rng() % bytes.size()] ^= static_cast<uint8_t>(1u << (rng() % 8));
+        tryLoad(bytes);
+    }
+}
+
+template <typename T>
+static void RunType()
+{
+    std::mt19937_64 rng(7);
+    for (const auto &testCase : MakeCases<T>())
+    {
+        const std::vector<T> expected = Flatten<T>(testCase.input);
+        for (const auto &algorithm : CompressorRegistry::Instance().ListAlgorithms())
+        {
+            std::string where = std::string(ElemTraits<T>::name) + " " + testCase.name + " " + algorithm;
+            auto compressor = CompressorRegistry::Instance().Create(algorithm, ElemTraits<T>::type);
+
+            // 压缩 + 解压（含格式自带的校验）
+            int8_t ret = compressor->Compress(testCase.input);
+            if (ret == ERROR_UNSUPPORT_DIMENSION || ret == ERROR_UNSUPPORT_FEATURE)
+                continue;
+            ++g_checks;
+            ArrayInput output = EmptyLike<T>(testCase.input);
+            if (ret != SAA_SUCCESS || (ret = compressor->Decompress(output)) != SAA_SUCCESS)
+            {
+                Fail(where, "compress/decompress returned " + std::to_string(ret));
+                continue;
+            }
+            if (!SameBits(expected, Flatten<T>(output)))
+            {
+                Fail(where, "decompressed data differs");
+                continue;
+            }
+
+            // 序列化后在新实例上反序列化、解压、逐个随机读取
+            std::vector<uint8_t> blob;
+            if (compressor->Serialize(blob) == ERROR_UNSUPPORT_FEATURE)
+                continue;
+            std::vector<uint64_t> buffer = AlignedCopy(blob);
+            auto loaded = CompressorRegistry::Instance().Create(algorithm, ElemTraits<T>::type);
+            if ((ret = loaded->Deserialize(reinterpret_cast<const uint8_t *>(buffer.data()), blob.size())) != SAA_SUCCESS)
+            {
+                Fail(where, "deserialize returned " + std::to_string(ret));
+                continue;
+            }
+            ArrayInput reloaded = EmptyLike<T>(testCase.input);
+            if ((ret = loaded->Decompress(reloaded)) != SAA_SUCCESS || !SameBits(expected, Flatten<T>(reloaded)))
+            {
+                Fail(where, "deserialized data differs (ret " + std::to_string(ret) + ")");
+                continue;
+            }
+            for (uint64_t i = 0; i < expected.size(); ++i)
+            {
+                T elem{};
+                ret = loaded->GetElement(i, &elem);
+                if (ret == ERROR_UNSUPPORT_FEATURE)
+                    break;
+                if (ret != SAA_SUCCESS || std::memcmp(&elem, &expected[i], sizeof(T)) != 0)
+                {
+                    Fail(where, "GetElement differs at " + std::to_string(i));
+                    break;
+                }
+            }
+
+            CorruptBlob(algorithm, ElemTraits<T>::type, blob, rng);
+        }
+    }
+}
+
+int main()
+{
+#if defined(__linux__) && !defined(__SANITIZE_ADDRESS__)
+    struct rlimit limit = {ROUNDTRIP_ADDRESS_LIMIT, ROUNDTRIP_ADDRESS_LIMIT};
+    setrlimit(RLIMIT_AS, &limit);
+#endif
+    // 格式内部的校验失败会打印日志，损坏输入的拒绝信息不属于失败，统一丢弃
+    std::ostringstream discard;
+    std::streambuf *stderrBuf = std::cerr.rdbuf(discard.rdbuf());
+    RunType<uint8_t>();
+    RunType<uint32_t>();
+    RunType<uint64_t>();
+    RunType<float>();
+    std::cerr.rdbuf(stderrBuf);
+
+    std::cout << "codec roundtrip: " << g_checks << " format/input pairs, " << g_failures << " failures\n";
+    if (g_failures)
+    {
+        std::cerr << discard.str();
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,69 @@
+/*
+ * @Author: FeOAr feoar@outlook.com
+ * @Date: 2026-10-20 10:10:00
+ * @LastEditors: FeOAr feoar@outlook.com
+ * @LastEditTime: 2026-10-20 10:10:00
+ * @FilePath: \SparseArrayAnalyzer\test\header\check_header.c
+ * @Description: --export-header 生成结果的校验程序：包含导出的 lut.h，逐元素与源文本数组比较；
+ *               同一份源码分别按 C99 与 C++14（constexpr 表）编译，由 check_headers.sh 驱动
+ *
+ *   编译参数：-DCHECK_FLOAT 元素为 f32，-DCHECK_2D 额外校验 lut_at(row, col)
+ */
+#include "lut.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char **argv)
+{
+    FILE *file;
+    char token[64];
+    uint64_t index = 0;
+    uint64_t mismatches = 0;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "usage: %s <array.txt>\n", argv[0]);
+        return 2;
+    }
+    file = fopen(argv[1], "r");
+    if (!file)
+    {
+        fprintf(stderr, "cannot open %s\n", argv[1]);
+        return 2;
+    }
+
+    /* 源数组按行优先、空白分隔，与分析器读取文本输入的顺序一致 */
+    while (fscanf(file, "%63s", token) == 1)
+    {
+#ifdef CHECK_FLOAT
+        float expected = (float)strtod(token, NULL);
+        float actual = lut_get(index);
+        int same = memcmp(&expected, &actual, sizeof(float)) == 0;
+#else
+        uint64_t expected = (uint64_t)strtoull(token, NULL, 10);
+        uint64_t actual = (uint64_t)lut_get(index);
+        int same = expected == actual;
+#endif
+#ifdef CHECK_2D
+        same = same && lut_at((uint32_t)(index / LUT_COLS), (uint32_t)(index % LUT_COLS)) == actual;
+#endif
+        if (!same && mismatches++ < 10)
+            fprintf(stderr, "element %llu differs: expected %s\n", (unsigned long long)index, token);
+        ++index;
+    }
+    fclose(file);
+
+    if (index != LUT_COUNT)
+    {
+        fprintf(stderr, "source has %llu elements, header has %llu\n", (unsigned long long)index,
+                (unsigned long long)LUT_COUNT);
+        return 1;
+    }
+    if (mismatches)
+    {
+        fprintf(stderr, "%llu of %llu elements differ\n", (unsigned long long)mismatches, (unsigned long long)index);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,85 @@
+#!/bin/sh
+# @Author: FeOAr feoar@outlook.com
+# @Date: 2026-10-20 10:10:00
+# @FilePath: \SparseArrayAnalyzer\test\header\check_headers.sh
+# @Description: 生成多组输入 -> 分析器 --export-header -> 校验程序按 C99 / C++14 以 -Wall -Wextra -Werror 编译 -> 逐元素比较
+#
+# 用法：check_headers.sh <bin 目录>，由 make test 调用
+
+BIN_DIR=${1:-build/release/bin}
+ANALYZER="$BIN_DIR/sparse_array_analyzer"
+GENERATOR="$BIN_DIR/generate_sparse_matrix"
+CHECKER_SRC=$(dirname "$0")/check_header.c
+WORK_DIR=$(mktemp -d)
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+CC=${CC:-gcc}
+CXX=${CXX:-g++}
+WARN="-Wall -Wextra -Werror"
+failures=0
+cases=0
+
+# 参数：名称 类型 维度 行 列 图样 稀疏度 最小值 最大值 [设备档案]，档案影响推荐的格式以覆盖更多布局
+check_case()
+{
+    name=$1 type=$2 dim=$3 rows=$4 cols=$5 pattern=$6 sparsity=$7 min=$8 max=$9 profile=${10}
+    dir="$WORK_DIR/$name"
+    mkdir -p "$dir"
+    cases=$((cases + 1))
+
+    # 1. 生成输入并导出头文件
+    if ! "$GENERATOR" -r "$rows" -c "$cols" -p "$pattern" -s "$sparsity" -m "$min" -n "$max" -o "$dir/array.txt" >/dev/null; then
+        echo "FAIL $name: generator failed"
+        failures=$((failures + 1))
+        return
+    fi
+    if [ "$dim" = 2 ]; then
+        shape="2 $rows $cols"
+    else
+        shape="1 0 0"
+    fi
+    [ -n "$profile" ] && shape="$shape --profile $profile"
+    if ! "$ANALYZER" "$dir/array.txt" $shape --type "$type" --export-header "$dir/lut.h" >"$dir/analyzer.log" 2>&1; then
+        echo "FAIL $name: analyzer failed, see log below"
+        cat "$dir/analyzer.log"
+        failures=$((failures + 1))
+        return
+    fi
+    format=$(sed -n 's/^ \* Format: \([^ ]*\).*/\1/p' "$dir/lut.h")
+
+    # 2. 按 C99 与 C++14 分别编译校验程序并比较每个元素
+    defs=""
+    [ "$type" = f32 ] && defs="$defs -DCHECK_FLOAT"
+    [ "$dim" = 2 ] && defs="$defs -DCHECK_2D"
+    before=$failures
+    for lang in c99 c++14; do
+        if [ "$lang" = c99 ]; then
+            compile="$CC -std=c99 -x c"
+        else
+            compile="$CXX -std=c++14 -x c++"
+        fi
+        if ! $compile $WARN $defs -I"$dir" "$CHECKER_SRC" -o "$dir/check_$lang" 2>"$dir/compile_$lang.log"; then
+            echo "FAIL $name ($format, $lang): checker does not compile"
+            cat "$dir/compile_$lang.log"
+            failures=$((failures + 1))
+        elif ! "$dir/check_$lang" "$dir/array.txt"; then
+            echo "FAIL $name ($format, $lang): exported values differ"
+            failures=$((failures + 1))
+        fi
+    done
+    [ "$failures" -eq "$before" ] && echo "ok   $name -> $format"
+}
+
+check_case sparse-u32-2d  u32 2 120 300 diagonal 0.97 1 1000
+check_case banded-u8-2d   u8  2 64  64  banded   0.80 1 200
+check_case block-u16-2d   u16 2 90  200 block    0.60 1 3
+check_case dense-u64-2d   u64 2 40  50  block    0.05 1 65535
+check_case sparse-i32-1d  i32 1 1   4000 diagonal 0.99 1 100000
+check_case runs-u32-1d    u32 1 200 100 block    0.50 7 7
+check_case small-f32-2d   f32 2 30  30  banded   0.70 1 9
+check_case dense-f32-1d   f32 1 1   3000 block   0.01 1 30000
+check_case mcu-u32-2d     u32 2 400 400 diagonal 0.995 1 4000000 cortex-m4-64k
+check_case server-u32-2d  u32 2 50  2000 banded  0.90 1 100000 x86-server
+
+echo "header export: $cases cases, $failures failures"
+[ "$failures" -eq 0 ]
@@ -15,23 +15,215 @@
 #include <sstream>
 #include <string>
 #include "common.h"
-
-// TODO：兼容整形和浮点型
+#include "size_estimator.h"
+#include "recommender.h"
+#include "byte_stage.h"
+#include "compressed_file.h"
+#include "header_export.h"
+#include "stream_analyzer.h"
+#include "batch_analyzer.h"
+#include "result_report.h"
+#include "perf_counters.h"
+#include "alloc_tracker.h"
+#include "work_arena.h"
+#include "trace_events.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
 
 #define FILE_PATH (1)
 #define ARRAY_DIMENSION (2)
 #define ARRAY_COL (3)
 #define ARRAY_ROW (4)
+#define POSITIONAL_COUNT (5)
+
+typedef struct analyzer_options
+{
+    std::vector<std::string> positional; // argv[0] 及位置参数
+    bool estimateMode = false;           // 抽样预估模式
+    uint32_t estimateTopK = 3;           // 预估后完整压缩的候选数量
+    uint32_t sampleUnits = SAMPLE_DEFAULT_UNITS;
+    std::string profile;                 // 目标设备配置（内置名或文件路径）
+    ElemType elemType = ELEM_UINT32;     // 元素类型，二进制输入以文件头为准
+    bool elemTypeGiven = false;
+    Stage2Codec stage2 = STAGE2_NONE;    // 第二级字节压缩
+    std::string savePath;                // 分析后保存最优格式的容器文件
+    std::string loadPath;                // 直接映射并解压的容器文件
+    std::string exportPath;              // 分析后导出最优格式的 C/C++ 头文件
+    bool streamMode = false;             // 分块流式分析，不加载整个数组
+    uint64_t memLimit = STREAM_DEFAULT_MEM_LIMIT;
+    std::string batchSource;             // 批量分析的目录或清单文件
+    std::string reportPath = "batch_report.csv";
+    uint32_t jobs = 0;                   // 批量分析线程数，0 为硬件线程数
+    bool formatGiven = false;            // 以 CSV / JSON 输出结果，人读信息改到标准错误
+    ReportFormat format = REPORT_CSV;
+    std::ostream *reportOut = nullptr;   // 机器可读报告的输出流（原标准输出）
+    bool perfCounters = false;           // 采集压缩 / 解压阶段的硬件计数器
+    uint32_t repeat = 1;                 // 同一压缩器实例 Reset 后重复运行的次数，报告最后一轮
+    std::string tracePath;               // Chrome trace-event 时间线输出文件
+} AnalyzerOptions;
 
 void printUsage()
 {
     std::cout << COLOR_STR("Usage:", COLOR_BLUE) << "sparse_array_analyzer <array.txt> [1/2] [ROW] [COL]\n";
     std::cout << "  1: Analyze as 1D array, eg: <array.txt> 1\n";
     std::cout << "  2: Analyze as 2D array with specified ROWxCOL, eg: <array.txt> 2 9 30\n";
+    std::cout << "  Binary input (" << SAA_BIN_MAGIC << " header) carries type and shape: <array.bin>\n";
+    std::cout << COLOR_STR("Options:", COLOR_BLUE) << "\n";
+    std::cout << "  --type <T>       Element type of text input: u8 | u16 | u32 | u64 | i32 | f32 (default u32)\n";
+    std::cout << "  --estimate <K>   Predict sizes from a stratified sample, then fully compress only the top K\n";
+    std::cout << "  --sample <N>     Number of sampled rows (2D) or " << SAMPLE_CHUNK_ELEMS << "-element chunks (1D), default " << SAMPLE_DEFAULT_UNITS << "\n";
+    std::cout << "  --profile <P>    Recommend a format for a device profile (builtin:";
+    for (const auto &name : ListBuiltinProfiles())
+        std::cout << " " << name;
+    std::cout << ", or a key=value profile file)\n";
+    std::cout << "  --stage2 <C>     Chain a byte compressor after each format: none | lz (default none)\n";
+    std::cout << "  --save <F>       Write the best format (recommended, else smallest) to a " << SAA_PACK_MAGIC << " container\n";
+    std::cout << "  --export-header <F>  Emit the best format as a C/C++ header with constexpr accessors\n";
+    std::cout << "  --load <F>       Map a " << SAA_PACK_MAGIC << " container, deserialize and decompress it (no input array needed)\n";
+    std::cout << "  --stream         Analyze in chunks without loading the array (Bitmap, RLE, Dictionary, CSR)\n";
+    std::cout << "  --mem-limit <S>  Working memory bound for --stream, e.g. 256M or 2G (implies --stream, default 64M)\n";
+    std::cout << "  --batch <D|M>    Analyze every array in a directory or manifest (lines: <file> [1/2] [ROW] [COL])\n";
+    std::cout << "  --report <F>     Batch report path, .json for JSON, otherwise CSV (default batch_report.csv)\n";
+    std::cout << "  --jobs <N>       Batch worker threads (default: hardware threads)\n";
+    std::cout << "  --format=<F>     Print results as csv | json on stdout (every result field + environment), other output goes to stderr\n";
+    std::cout << "  --perf-counters  Count cycles, instructions, L1D/LLC and branch misses per phase (Linux perf_event_open)\n";
+    std::cout << "  --track-alloc    Count heap allocations, bytes and peak live bytes per phase, next to the compressed size\n";
+    std::cout << "  --repeat <N>     Run each compressor N times on one reused instance and report the last (steady-state) run\n";
+    std::cout << "  --trace <F>      Write a Chrome trace-event timeline (load, reshape, sampling, each phase) for Perfetto\n";
+    std::cout << COLOR_STR("Compare:", COLOR_BLUE) << "sparse_array_analyzer compare <baseline> <current> [--ratio-tol <P>] [--throughput-tol <P>]\n";
+    std::cout << "  Flags formats whose ratio grew more than P% (default " << REPORT_DEFAULT_RATIO_TOL
+              << ") or whose throughput dropped more than P% (default " << REPORT_DEFAULT_THROUGHPUT_TOL
+              << "), or that are missing; exit code 1 on regression, 2 on invalid input\n";
+}
+
+int8_t ParseOptions(int argc, char *argv[], AnalyzerOptions &opts)
+{
+    for (int i = 0; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--estimate" || arg == "--sample" || arg == "--jobs" || arg == "--repeat")
+        {
+            if (i + 1 >= argc)
+            {
+                std::cerr << LOG_ERROR << "Option " << arg << " requires a value.\n";
+                return ERROR_PARAM_INVALID;
+            }
+
+            uint32_t value = ParseInt(argv[++i]);
+            if (value == 0)
+            {
+                std::cerr << LOG_ERROR << "Option " << arg << " must be positive.\n";
+                return ERROR_PARAM_INVALID;
+            }
+
+            if (arg == "--estimate")
+            {
+                opts.estimateMode = true;
+                opts.estimateTopK = value;
+            }
+            else if (arg == "--jobs")
+            {
+                opts.jobs = value;
+            }
+            else if (arg == "--repeat")
+            {
+                opts.repeat = value;
+            }
+            else
+            {
+                opts.sampleUnits = value;
+            }
+        }
+        else if (arg == "--type")
+        {
+            if (i + 1 >= argc || ParseElemType(argv[i + 1], opts.elemType) != SAA_SUCCESS)
+            {
+                std::cerr << LOG_ERROR << "Option " << arg << " requires a valid element type.\n";
+                return ERROR_PARAM_INVALID;
+            }
+            opts.elemTypeGiven = true;
+            ++i;
+        }
+        else if (arg == "--profile")
+        {
+            if (i + 1 >= argc)
+            {
+                std::cerr << LOG_ERROR << "Option " << arg << " requires a value.\n";
+                return ERROR_PARAM_INVALID;
+            }
+            opts.profile = argv[++i];
+        }
+        else if (arg == "--save" || arg == "--load" || arg == "--export-header")
+        {
+            if (i + 1 >= argc)
+            {
+                std::cerr << LOG_ERROR << "Option " << arg << " requires a value.\n";
+                return ERROR_PARAM_INVALID;
+            }
+            (arg == "--save" ? opts.savePath : arg == "--load" ? opts.loadPath : opts.exportPath) = argv[++i];
+        }
+        else if (arg == "--batch" || arg == "--report" || arg == "--trace")
+        {
+            if (i + 1 >= argc)
+            {
+                std::cerr << LOG_ERROR << "Option " << arg << " requires a value.\n";
+                return ERROR_PARAM_INVALID;
+            }
+            (arg == "--batch" ? opts.batchSource : arg == "--report" ? opts.reportPath : opts.tracePath) = argv[++i];
+        }
+        else if (arg == "--format" || arg.rfind("--format=", 0) == 0)
+        {
+            std::string value = (arg == "--format") ? ((i + 1 < argc) ? argv[++i] : "") : arg.substr(9);
+            if (ParseReportFormat(value, opts.format) != SAA_SUCCESS)
+            {
+                std::cerr << LOG_ERROR << "Option --format requires csv or json.\n";
+                return ERROR_PARAM_INVALID;
+            }
+            opts.formatGiven = true;
+        }
+        else if (arg == "--stream")
+        {
+            opts.streamMode = true;
+        }
+        else if (arg == "--perf-counters")
+        {
+            opts.perfCounters = true;
+        }
+        else if (arg == "--track-alloc")
+        {
+            EnableAllocTracking();
+        }
+        else if (arg == "--mem-limit")
+        {
+            if (i + 1 >= argc || ParseMemLimit(argv[i + 1], opts.memLimit) != SAA_SUCCESS)
+            {
+                std::cerr << LOG_ERROR << "Option " << arg << " requires a size of at least 1M (e.g. 1M, 64M, 2G).\n";
+                return ERROR_PARAM_INVALID;
+            }
+            opts.streamMode = true;
+            ++i;
+        }
+        else if (arg == "--stage2")
+        {
+            if (i + 1 >= argc || ParseStage2Codec(argv[i + 1], opts.stage2) != SAA_SUCCESS)
+            {
+                std::cerr << LOG_ERROR << "Option " << arg << " requires none or lz.\n";
+                return ERROR_PARAM_INVALID;
+            }
+            ++i;
+        }
+        else
+        {
+            opts.positional.push_back(arg);
+        }
+    }
+    return SAA_SUCCESS;
 }
 
 // 适用于整数
-std::string FormatWithUnit(uint32_t value, const std::string &unit, size_t totalWidth)
+std::string FormatWithUnit(uint64_t value, const std::string &unit, size_t totalWidth)
 {
     std::ostringstream oss;
     oss << value << " " << unit;
@@ -56,7 +248,7 @@ void PrintResultTable(const std::vector<CalResult> &results)
 {
     // 表头
     std::cout << std::left
-              << std::setw(24) << "Algorithm"
+              << std::setw(28) << "Algorithm"
               << std::setw(10) << "Count"
               << std::setw(18) << "Compressed Cnt"
               << std::setw(15) << "Origin Size"
@@ -66,13 +258,13 @@ void PrintResultTable(const std::vector<CalResult> &results)
               << std::setw(10) << "Ratio"
               << "\n";
 
-    std::cout << std::string(134, '-') << "\n";
+    std::cout << std::string(138, '-') << "\n";
 
     // 每一行输出一个 CalResult
     for (const auto &result : results)
     {
         std::cout << std::left
-                  << std::setw(24) << result.modeName
+                  << std::setw(28) << result.modeName
                   << std::setw(10) << result.originElementCount
                   << std::setw(18) << result.compressedElementCount
                   << FormatWithUnit(result.originSizeBytes, "Byte", 15)
@@ -86,52 +278,537 @@ void PrintResultTable(const std::vector<CalResult> &results)
     std::cout << std::endl;
 }
 
-int main(int argc, char *argv[])
+// 硬件计数器：IPC 与每元素缺失数，不可用的计数器显示为 -
+std::string FormatPerfRatio(const PerfCounterSample &sample, PerfCounterId numerator, PerfCounterId denominator,
+                            uint64_t elemCount, size_t width)
 {
-    if (argc < 5)
+    std::ostringstream oss;
+    bool perElem = (denominator == PERF_COUNTER_COUNT);
+    uint64_t base = perElem ? elemCount : sample.values[denominator];
+    bool valid = (sample.validMask & (1u << numerator)) && (perElem || (sample.validMask & (1u << denominator))) && base > 0;
+    if (valid)
+        oss << std::fixed << std::setprecision(perElem ? 4 : 2) << static_cast<double>(sample.values[numerator]) / base;
+    else
+        oss << "-";
+    std::string text = oss.str();
+    return text + std::string(width > text.size() ? width - text.size() : 1, ' ');
+}
+
+void PrintPerfTable(const std::vector<CalResult> &results)
+{
+    std::cout << COLOR_STR("==== Hardware Counters (compress | decompress) ====", COLOR_PURPLE) << "\n";
+    std::cout << std::left << std::setw(28) << "Algorithm";
+    for (const char *phase : {"C-", "D-"})
     {
-        if (argc == 2 && std::string(argv[FILE_PATH]) == "--help")
+        std::cout << std::setw(8) << (std::string(phase) + "IPC") << std::setw(13) << (std::string(phase) + "L1D/elem")
+                  << std::setw(13) << (std::string(phase) + "LLC/elem") << std::setw(13) << (std::string(phase) + "BrMis/elem");
+    }
+    std::cout << "\n" << std::string(122, '-') << "\n";
+
+    for (const auto &result : results)
+    {
+        std::cout << std::left << std::setw(28) << result.modeName;
+        for (const PerfCounterSample *sample : {&result.compressPerf, &result.decompressPerf})
         {
-            printUsage();
-            return 0;
+            std::cout << FormatPerfRatio(*sample, PERF_INSTRUCTIONS, PERF_CYCLES, 0, 8)
+                      << FormatPerfRatio(*sample, PERF_L1D_MISSES, PERF_COUNTER_COUNT, result.originElementCount, 13)
+                      << FormatPerfRatio(*sample, PERF_LLC_MISSES, PERF_COUNTER_COUNT, result.originElementCount, 13)
+                      << FormatPerfRatio(*sample, PERF_BRANCH_MISSES, PERF_COUNTER_COUNT, result.originElementCount, 13);
         }
-        else if (argc == 3 && std::string(argv[1]) == "--version")
+        std::cout << "\n";
+    }
+    std::cout << std::endl;
+}
+
+// 堆分配：理论压缩大小旁列出各阶段的分配次数、累计字节与存活峰值
+void PrintAllocTable(const std::vector<CalResult> &results)
+{
+    std::cout << COLOR_STR("==== Heap Usage (compress | decompress) ====", COLOR_PURPLE) << "\n";
+    std::cout << std::left << std::setw(28) << "Algorithm" << std::setw(18) << "Compressed Size";
+    for (const char *phase : {"C-", "D-"})
+    {
+        std::cout << std::setw(10) << (std::string(phase) + "Allocs") << std::setw(16) << (std::string(phase) + "Alloc Bytes")
+                  << std::setw(16) << (std::string(phase) + "Peak");
+    }
+    std::cout << "\n" << std::string(130, '-') << "\n";
+
+    for (const auto &result : results)
+    {
+        std::cout << std::left << std::setw(28) << result.modeName << FormatWithUnit(result.compressedSizeBytes, "Byte", 18);
+        for (const AllocStats *stats : {&result.compressAlloc, &result.decompressAlloc})
         {
-            std::cout << "Sparse Array Analyzer v1.0.0\n";
-            return 0;
+            if (stats->tracked)
+                std::cout << std::setw(10) << stats->allocCount << FormatWithUnit(stats->allocBytes, "Byte", 16)
+                          << FormatWithUnit(stats->peakBytes, "Byte", 16);
+            else
+                std::cout << std::setw(10) << "-" << std::setw(16) << "-" << std::setw(16) << "-";
         }
-        else
+        std::cout << "\n";
+    }
+    std::cout << std::endl;
+}
+
+void PrintStage2Table(const std::vector<Stage2Result> &results)
+{
+    std::cout << COLOR_STR("==== Stage 2 (LZ) Report ====", COLOR_PURPLE) << "\n";
+    std::cout << std::left
+              << std::setw(28) << "Algorithm"
+              << std::setw(18) << "Serialized"
+              << std::setw(18) << "Stage2 Size"
+              << std::setw(18) << "Combined Ratio"
+              << std::setw(18) << "+Compress"
+              << std::setw(18) << "+Decompress"
+              << "\n";
+
+    std::cout << std::string(118, '-') << "\n";
+
+    for (const auto &result : results)
+    {
+        std::cout << std::left
+                  << std::setw(28) << result.modeName
+                  << FormatWithUnit(result.serializedBytes, "Byte", 18)
+                  << FormatWithUnit(result.stage2Bytes, "Byte", 18)
+                  << FormatWithUnit(result.combinedRatio, "%", 18)
+                  << FormatWithUnit(result.compressTimeMs, "ms", 18)
+                  << FormatWithUnit(result.decompressTimeMs, "ms", 18)
+                  << std::endl;
+    }
+
+    std::cout << std::endl;
+}
+
+void PrintEstimateTable(const SampleStats &stats, const std::vector<SizeEstimate> &estimates)
+{
+    std::cout << "Sampled " << stats.sampledUnits << "/" << stats.totalUnits << " units ("
+              << stats.sampledCount << " elements), main value " << stats.mainValue
+              << ", non-main " << std::fixed << std::setprecision(3) << stats.nonMainFraction * 100.0
+              << " % +/- " << SAMPLE_Z_95 * stats.nonMainFractionSE * 100.0
+              << " %, distinct ~" << std::setprecision(0) << stats.distinctEstimate
+              << ", nnz/unit var " << std::setprecision(1) << stats.unitNnzVar << "\n";
+    std::cout.unsetf(std::ios::floatfield);
+
+    std::cout << std::left
+              << std::setw(28) << "Algorithm"
+              << std::setw(20) << "Predicted Size"
+              << std::setw(34) << "95% Interval"
+              << std::setw(10) << "Ratio"
+              << "\n";
+
+    std::cout << std::string(92, '-') << "\n";
+
+    for (const auto &est : estimates)
+    {
+        std::ostringstream interval;
+        interval << std::fixed << std::setprecision(0) << "[" << est.lowBytes << ", " << est.highBytes << "] Byte";
+
+        std::cout << std::left
+                  << std::setw(28) << est.modeName
+                  << FormatWithUnit(est.predictedBytes, "Byte", 20, 0)
+                  << std::setw(34) << interval.str()
+                  << FormatWithUnit(est.predictedRatio, "%", 10)
+                  << std::endl;
+    }
+
+    std::cout << std::endl;
+}
+
+void PrintRecommendation(const DeviceProfile &profile, const std::vector<RecommendItem> &ranked)
+{
+    std::cout << COLOR_STR("==== Recommendation for " + profile.name + " ====", COLOR_PURPLE) << "\n";
+    std::cout << std::left
+              << std::setw(28) << "Algorithm"
+              << std::setw(10) << "Score"
+              << std::setw(18) << "Cycles/Access"
+              << "Note"
+              << "\n";
+
+    std::cout << std::string(114, '-') << "\n";
+
+    for (const auto &item : ranked)
+    {
+        std::cout << std::left
+                  << std::setw(28) << item.modeName
+                  << FormatWithUnit(item.score, "", 10)
+                  << FormatWithUnit(item.cyclesPerAccess, "cyc", 18, 1)
+                  << (item.feasible ? item.reason : COLOR_STR("infeasible: " + item.reason, COLOR_RED))
+                  << std::endl;
+    }
+
+    if (!ranked.empty() && ranked.front().feasible)
+    {
+        std::cout << "\n" << COLOR_STR("Best:", COLOR_GREEN) << ranked.front().modeName
+                  << " - " << ranked.front().reason << "\n";
+    }
+    else
+    {
+        std::cout << "\n" << COLOR_STR("No format fits the budget of " + profile.name, COLOR_RED) << "\n";
+    }
+    std::cout << std::endl;
+}
+
+// 候选格式顺序：有推荐结果时取可行项的推荐顺序，否则按压缩后大小
+std::vector<size_t> CandidateOrder(const std::vector<CalResult> &results, const std::vector<RecommendItem> &ranked)
+{
+    std::vector<size_t> order;
+    for (const auto &item : ranked)
+    {
+        for (size_t i = 0; item.feasible && i < results.size(); ++i)
         {
-            std::cerr << LOG_ERROR << "Invalid arguments.\n";
-            printUsage();
-            return 0;
+            if (results[i].modeName == item.modeName)
+                order.push_back(i);
         }
     }
+    if (order.empty())
+    {
+        for (size_t i = 0; i < results.size(); ++i)
+            order.push_back(i);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b)
+                         { return results[a].compressedSizeBytes < results[b].compressedSizeBytes; });
+    }
+    return order;
+}
 
-    std::cout << COLOR_STR("======= [Start analyze!] =======", COLOR_GREEN) << "\n";
+// 按候选顺序依次尝试，写出第一个支持序列化的格式
+template <typename T>
+int8_t SaveBestFormat(const std::string &path, const ArrayInput &input, const std::vector<CalResult> &results,
+                      const std::vector<std::string> &resultModes, const std::vector<RecommendItem> &ranked)
+{
+    // 1. 容器头
+    CompressedFileHeader header;
+    header.elemType = ElemTraits<T>::type;
+    header.dimension = GetInputDimension(input);
+    if (header.dimension == ARRAY_2D)
+    {
+        header.rows = std::get<ArrayData2D<T>>(input).rowCount;
+        header.cols = std::get<ArrayData2D<T>>(input).colCount;
+    }
+    else
+    {
+        header.rows = 1;
+        header.cols = static_cast<uint32_t>(std::get<ArrayData1D<T>>(input).arrayData.size());
+    }
+
+    // 2. 重新压缩候选格式并写出
+    for (size_t i : CandidateOrder(results, ranked))
+    {
+        auto compressor = CompressorRegistry::Instance().Create(resultModes[i], header.elemType);
+        if (!compressor || compressor->Compress(input) != SAA_SUCCESS)
+            continue;
+
+        header.algorithm = resultModes[i];
+        int8_t ret = WriteCompressedFile(path, header, *compressor);
+        if (ret == ERROR_UNSUPPORT_FEATURE)
+            continue;
+        if (ret == SAA_SUCCESS)
+            std::cout << COLOR_STR("Saved:", COLOR_GREEN) << results[i].modeName << " -> " << path << "\n\n";
+        return ret;
+    }
+
+    std::cerr << LOG_ERROR << "No analyzed format supports serialization.\n";
+    return ERROR_UNSUPPORT_FEATURE;
+}
+
+// 按候选顺序导出第一个有头文件布局的格式
+int8_t ExportBestHeader(const std::string &path, const ArrayInput &input, const std::vector<CalResult> &results,
+                        const std::vector<std::string> &resultModes, const std::vector<RecommendItem> &ranked)
+{
+    for (size_t i : CandidateOrder(results, ranked))
+    {
+        std::string header;
+        int8_t ret = ExportHeader(resultModes[i], input, HeaderSymbolFromPath(path), header);
+        if (ret == ERROR_UNSUPPORT_FEATURE)
+            continue;
+        if (ret != SAA_SUCCESS)
+            return ret;
+
+        std::ofstream file(path, std::ios::trunc);
+        if (!file.is_open() || !(file << header))
+        {
+            std::cerr << LOG_ERROR << "Failed to write header: " << path << "\n";
+            return ERROR_PARAM_INVALID;
+        }
+        std::cout << COLOR_STR("Exported:", COLOR_GREEN) << results[i].modeName << " -> " << path
+                  << " (symbol " << HeaderSymbolFromPath(path) << ")\n\n";
+        return SAA_SUCCESS;
+    }
+
+    std::cerr << LOG_ERROR << "No analyzed format has a header layout.\n";
+    return ERROR_UNSUPPORT_FEATURE;
+}
+
+// 映射容器文件，计时反序列化与解压，并抽查随机访问结果
+template <typename T>
+int RunLoad(const MappedCompressedFile &file)
+{
+    const CompressedFileHeader &header = file.Header();
+    std::cout << "Container: " << header.algorithm << ", " << ElemTypeName(header.elemType) << ", "
+              << (header.dimension == ARRAY_2D ? "2D " : "1D ") << header.rows << "x" << header.cols
+              << ", payload " << header.payloadBytes << " Byte\n";
+
+    // 1. 反序列化
+    std::unique_ptr<SparseArrayCompressor> compressor;
+    auto start = std::chrono::high_resolution_clock::now();
+    int8_t ret = file.CreateCompressor(compressor);
+    auto end = std::chrono::high_resolution_clock::now();
+    if (ret != SAA_SUCCESS)
+    {
+        std::cerr << LOG_ERROR << "Deserialize failed for " << header.algorithm << ". Error code: " << static_cast<int>(ret) << "\n";
+        return 1;
+    }
+    double loadMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+    // 2. 解压
+    ArrayInput output = (header.dimension == ARRAY_2D) ? ArrayInput{ArrayData2D<T>()} : ArrayInput{ArrayData1D<T>()};
+    start = std::chrono::high_resolution_clock::now();
+    ret = compressor->Decompress(output);
+    end = std::chrono::high_resolution_clock::now();
+    if (ret != SAA_SUCCESS)
+    {
+        std::cerr << LOG_ERROR << "Decompression failed for " << header.algorithm << ". Error code: " << static_cast<int>(ret) << "\n";
+        return 1;
+    }
+    double decompressMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+    std::vector<T> flat;
+    if (header.dimension == ARRAY_2D)
+    {
+        for (const auto &row : std::get<ArrayData2D<T>>(output).arrayData)
+            flat.insert(flat.end(), row.begin(), row.end());
+    }
+    else
+    {
+        flat = std::get<ArrayData1D<T>>(output).arrayData;
+    }
+    if (flat.size() != static_cast<uint64_t>(header.rows) * header.cols)
+    {
+        std::cerr << LOG_ERROR << "Decompressed " << flat.size() << " elements, header says "
+                  << static_cast<uint64_t>(header.rows) * header.cols << ".\n";
+        return 1;
+    }
+
+    // 3. 等间隔抽查 GetElement 与解压结果一致
+    std::string access = "unsupported";
+    uint64_t step = std::max<uint64_t>(flat.size() / 1000, 1);
+    for (uint64_t i = 0; i < flat.size(); i += step)
+    {
+        T value{};
+        ret = compressor->GetElement(i, &value);
+        if (ret == ERROR_UNSUPPORT_FEATURE)
+            break;
+        if (ret != SAA_SUCCESS || std::memcmp(&value, &flat[i], sizeof(T)) != 0)
+        {
+            std::cerr << LOG_ERROR << "GetElement mismatch at index " << i << ".\n";
+            return 1;
+        }
+        access = "verified";
+    }
+
+    std::cout << "Open + deserialize: " << FormatWithUnit(loadMs, "ms", 0)
+              << "\nDecompress: " << FormatWithUnit(decompressMs, "ms", 0)
+              << "\nRandom access: " << access << "\n";
+    return 0;
+}
 
+// 按 --format 输出机器可读报告
+void WriteFormattedResults(const AnalyzerOptions &opts, const std::string &input, const std::vector<CalResult> &results,
+                           const std::vector<std::string> &resultModes)
+{
+    if (!opts.reportOut)
+    {
+        return;
+    }
+
+    ReportEnvironment env;
+    CollectEnvironment(input, env);
+    std::vector<ReportEntry> entries;
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        entries.push_back({i < resultModes.size() ? resultModes[i] : "", results[i]});
+    }
+    WriteResultReport(*opts.reportOut, opts.format, env, entries);
+}
+
+// 比较两份报告，有回退时返回 1，输入无效返回 2
+int RunCompare(int argc, char *argv[])
+{
+    std::vector<std::string> paths;
+    double ratioTol = REPORT_DEFAULT_RATIO_TOL;
+    double throughputTol = REPORT_DEFAULT_THROUGHPUT_TOL;
+    for (int i = 2; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if ((arg == "--ratio-tol" || arg == "--throughput-tol") && i + 1 < argc)
+            (arg == "--ratio-tol" ? ratioTol : throughputTol) = std::strtod(argv[++i], nullptr);
+        else
+            paths.push_back(arg);
+    }
+    if (paths.size() != 2 || ratioTol < 0 || throughputTol < 0)
+    {
+        printUsage();
+        return 2;
+    }
+
+    ReportEnvironment baseEnv, currentEnv;
+    std::vector<ReportEntry> baseline, current;
+    if (ReadResultReport(paths[0], baseEnv, baseline) != SAA_SUCCESS ||
+        ReadResultReport(paths[1], currentEnv, current) != SAA_SUCCESS)
+    {
+        return 2;
+    }
+    if (baseEnv.cpuModel != currentEnv.cpuModel || baseEnv.buildFlags != currentEnv.buildFlags)
+    {
+        std::cerr << LOG_WARN << "Reports come from different environments, throughput is not directly comparable.\n";
+    }
+    if (baseEnv.input != currentEnv.input)
+    {
+        std::cerr << LOG_WARN << "Reports describe different inputs: \"" << baseEnv.input << "\" vs \"" << currentEnv.input << "\".\n";
+    }
+
+    std::vector<CompareItem> items;
+    uint32_t regressions = CompareReports(baseline, current, ratioTol, throughputTol, items);
+
+    std::cout << COLOR_STR("==== Report Comparison ====", COLOR_PURPLE) << "\n";
+    std::cout << std::left << std::setw(28) << "Algorithm" << std::setw(24) << "Ratio (base -> cur)"
+              << std::setw(30) << "Throughput MB/s (base -> cur)" << "Status\n";
+    std::cout << std::string(100, '-') << "\n";
+    for (const auto &item : items)
+    {
+        std::ostringstream ratio, throughput;
+        ratio << std::fixed << std::setprecision(3) << item.baseRatio << " -> " << item.currentRatio;
+        throughput << std::fixed << std::setprecision(1) << item.baseThroughput << " -> " << item.currentThroughput;
+        std::string status = item.missing ? "MISSING" : (item.ratioRegressed && item.throughputRegressed) ? "RATIO+THROUGHPUT"
+                                                    : item.ratioRegressed                                ? "RATIO"
+                                                    : item.throughputRegressed                           ? "THROUGHPUT"
+                                                                                                         : "ok";
+        std::cout << std::left << std::setw(28) << item.key << std::setw(24) << (item.missing ? "-" : ratio.str())
+                  << std::setw(30) << (item.missing ? "-" : throughput.str())
+                  << (status == "ok" ? COLOR_STR(status, COLOR_GREEN) : COLOR_STR(status, COLOR_RED)) << "\n";
+    }
+    std::cout << "\n" << regressions << " regression(s) at ratio tolerance " << ratioTol << "%, throughput tolerance "
+              << throughputTol << "%\n";
+    return regressions ? 1 : 0;
+}
+
+// 流式分析：两遍按块读取，结果表与推荐沿用内存模式的输出
+int RunStream(const AnalyzerOptions &opts, bool isBinary, const DeviceProfile &profile)
+{
+    if (opts.estimateMode || opts.stage2 != STAGE2_NONE || !opts.savePath.empty() || !opts.exportPath.empty())
+    {
+        std::cerr << LOG_WARN << "--estimate, --stage2, --save and --export-header are ignored in streaming mode.\n";
+    }
+
+    // 1. 输入描述
+    StreamSource source;
+    source.path = opts.positional[FILE_PATH];
+    source.isBinary = isBinary;
+    source.elemType = opts.elemType;
+    if (opts.positional[ARRAY_DIMENSION] == "2")
+    {
+        source.dimension = ARRAY_2D;
+        source.rows = ParseInt(opts.positional[ARRAY_ROW].c_str());
+        source.cols = ParseInt(opts.positional[ARRAY_COL].c_str());
+    }
+    else if (opts.positional[ARRAY_DIMENSION] == "1")
+    {
+        BinaryArrayHeader header;
+        if (isBinary && ReadBinaryArrayHeader(source.path, header) == SAA_SUCCESS)
+            source.cols = header.rows * header.cols;
+    }
+    else
+    {
+        std::cout << LOG_ERROR << "Invalid dimension argument. Use 1 for 1D or 2 for 2D.\n";
+        return 1;
+    }
+
+    // 2. 分块分析
+    std::vector<CalResult> results;
+    StreamStats stats;
+    if (RunStreamAnalysis(source, opts.memLimit, results, stats) != SAA_SUCCESS)
+    {
+        std::cerr << LOG_ERROR << "Streaming analysis failed.\n";
+        return 1;
+    }
+
+    std::cout << COLOR_STR("==== Streaming Compression Report ====", COLOR_PURPLE) << "\n";
+    std::cout << "Input size: " << COLOR_STR(std::to_string(stats.elemCount), COLOR_BLUE) << "elements, "
+              << stats.chunkCount << " chunks of " << stats.chunkElems << ", " << stats.workerCount << " encoder threads\n";
+    std::cout << "Pipeline (2 passes): read " << FormatWithUnit(stats.readTimeMs, "ms", 0) << ", encode "
+              << FormatWithUnit(stats.encodeTimeMs, "ms", 0) << ", wall " << FormatWithUnit(stats.wallTimeMs, "ms", 0) << "\n";
+    std::cout << "Working memory: ~" << stats.peakBytes / 1024 << " KB of " << opts.memLimit / 1024 << " KB limit, main value "
+              << (stats.mainValueExact ? "exact" : "approximate (frequency table exceeded the limit)") << "\n\n";
+    PrintResultTable(results);
+    WriteFormattedResults(opts, source.path + " " + ElemTypeName(source.elemType) + " stream", results, {});
+
+    // 3. 按目标设备给出压缩建议
+    std::vector<RecommendItem> ranked;
+    if (!opts.profile.empty() && RecommendCompression(results, profile, ranked) == SAA_SUCCESS)
+    {
+        PrintRecommendation(profile, ranked);
+    }
+    return 0;
+}
+
+// 批量分析：一个进程内完成所有文件，结果写入同一份报告
+int RunBatch(const AnalyzerOptions &opts)
+{
+    std::vector<BatchJob> jobs;
+    if (CollectBatchJobs(opts.batchSource, opts.elemType, jobs) != SAA_SUCCESS)
+    {
+        return 1;
+    }
+
+    BatchStats stats;
+    if (RunBatchAnalysis(jobs, {}, opts.jobs, opts.reportPath, stats) != SAA_SUCCESS)
+    {
+        std::cerr << LOG_ERROR << "Batch analysis failed.\n";
+        return 1;
+    }
+
+    double seconds = stats.wallTimeMs / 1000.0;
+    std::cout << COLOR_STR("==== Batch Analysis ====", COLOR_PURPLE) << "\n";
+    std::cout << "Files: " << stats.fileCount << " (" << stats.failedFiles << " failed), tasks: " << stats.taskCount
+              << " (" << stats.failedTasks << " failed, " << stats.stolenTasks << " stolen), threads: " << stats.threadCount << "\n";
+    std::cout << "Wall time: " << FormatWithUnit(stats.wallTimeMs, "ms", 0) << ", "
+              << FormatWithUnit(seconds > 0 ? stats.fileCount / seconds : 0.0, "files/s", 0, 1) << "\n";
+    std::cout << "Report: " << opts.reportPath << "\n";
+    return (stats.failedFiles || stats.failedTasks) ? 1 : 0;
+}
+
+template <typename T>
+int RunAnalysis(const AnalyzerOptions &opts, bool isBinary, const DeviceProfile &profile)
+{
     // 1. 加载数组数据
-    std::vector<uint32_t> data = LoadArrayFromTxt(argv[FILE_PATH]);
+    std::vector<T> data;
+    if (isBinary)
+    {
+        BinaryArrayHeader header;
+        if (LoadArrayFromBin<T>(opts.positional[FILE_PATH], header, data) != SAA_SUCCESS)
+            return 1;
+    }
+    else
+    {
+        data = LoadArrayFromTxt<T>(opts.positional[FILE_PATH]);
+    }
 
-    ArrayData1D inputData1D;
-    ArrayData2D inputData2D;
-    ArrayData1D outputData1D;
-    ArrayData2D outputData2D;
+    ArrayData1D<T> inputData1D;
+    ArrayData2D<T> inputData2D;
+    ArrayData1D<T> outputData1D;
+    ArrayData2D<T> outputData2D;
     ArrayDimension inputDimension = ARRAY_1D;
 
-    if (argv[ARRAY_DIMENSION] && std::string(argv[ARRAY_DIMENSION]) == "1")
+    if (opts.positional[ARRAY_DIMENSION] == "1")
     {
         // 一维数组
-        printf("Input array is 1D array.\n");
+        std::cout << "Input array is 1D array.\n";
         inputData1D.arrayData = data;
         PrintVector1D(data);
     }
-    else if (argv[ARRAY_DIMENSION] && std::string(argv[ARRAY_DIMENSION]) == "2")
+    else if (opts.positional[ARRAY_DIMENSION] == "2")
     {
         // 二维数组
-        printf("Input array is 2D array.\n");
-        inputData2D.rowCount = ParseInt(argv[ARRAY_ROW]);
-        inputData2D.colCount = ParseInt(argv[ARRAY_COL]);
+        std::cout << "Input array is 2D array.\n";
+        inputData2D.rowCount = ParseInt(opts.positional[ARRAY_ROW].c_str());
+        inputData2D.colCount = ParseInt(opts.positional[ARRAY_COL].c_str());
         if (ReshapeTo2D(data, inputData2D.rowCount, inputData2D.colCount, inputData2D.arrayData) == SAA_SUCCESS)
         {
             // PrintVector2D(inputData2D.arrayData, inputData2D.rowCount, inputData2D.colCount);
@@ -150,7 +827,7 @@ int main(int argc, char *argv[])
     }
 
     // 2. 获取所有已注册算法
-    const auto &allModes = CompressorRegistry::Instance().ListAlgorithms();
+    std::vector<std::string> allModes = CompressorRegistry::Instance().ListAlgorithms();
 
     std::cout << COLOR_STR("==== Compression Comparison Report ====", COLOR_PURPLE) << "\n";
     std::cout << "Input size: " << COLOR_STR(std::to_string(data.size()), COLOR_BLUE) << "elements\n\n";
@@ -158,28 +835,72 @@ int main(int argc, char *argv[])
     ArrayInput input = (inputDimension == ARRAY_1D) ? ArrayInput{inputData1D} : ArrayInput{inputData2D};
     ArrayInput output = (inputDimension == ARRAY_1D) ? ArrayInput{outputData1D} : ArrayInput{outputData2D};
     std::vector<CalResult> results;
+    std::vector<std::string> resultModes; // 与 results 一一对应的注册名
+    std::vector<Stage2Result> stage2Results;
+
+    // 2.1 预估模式：按抽样预测的大小排序，只保留前 K 个算法完整压缩
+    if (opts.estimateMode)
+    {
+        SampleStats stats;
+        if (CollectSampleStats(input, opts.sampleUnits, stats) != SAA_SUCCESS)
+        {
+            std::cerr << LOG_ERROR << "Failed to collect sample statistics.\n";
+            return 1;
+        }
+
+        std::vector<std::pair<SizeEstimate, std::string>> ranked;
+        for (const auto &mode : allModes)
+        {
+            auto compressor = CompressorRegistry::Instance().Create(mode, ElemTraits<T>::type);
+            SizeEstimate est;
+            if (compressor && compressor->EstimateSize(stats, est) == SAA_SUCCESS)
+            {
+                ranked.push_back({est, mode});
+            }
+        }
+
+        std::sort(ranked.begin(), ranked.end(), [](const auto &a, const auto &b)
+                  { return a.first.predictedBytes < b.first.predictedBytes; });
+
+        std::vector<SizeEstimate> estimates;
+        allModes.clear();
+        for (const auto &item : ranked)
+        {
+            estimates.push_back(item.first);
+            if (allModes.size() < opts.estimateTopK)
+                allModes.push_back(item.second);
+        }
 
-    // 3. 遍历每种压缩算法进行测试
+        std::cout << COLOR_STR("==== Sampling Size Prediction ====", COLOR_PURPLE) << "\n";
+        PrintEstimateTable(stats, estimates);
+    }
+
+    // 3. 遍历每种压缩算法进行测试；临时容器取自共用的 WorkArena，--repeat 时同一实例重复运行，结果取最后一轮
+    WorkArena arena;
     for (const auto &mode : allModes)
     {
-        auto compressor = CompressorRegistry::Instance().Create(mode);
+        auto compressor = CompressorRegistry::Instance().Create(mode, ElemTraits<T>::type);
         if (!compressor)
         {
             std::cerr << LOG_WARN << "Compressor \"" << mode << "\" not found.\n";
             continue;
         }
+        compressor->SetMemoryResource(&arena);
+        TraceSpan modeTrace("analyze", mode);
 
-        int8_t ret = compressor->Compress(input);
-        if (ret != SAA_SUCCESS)
+        int8_t ret = SAA_SUCCESS;
+        const char *failedStep = nullptr;
+        for (uint32_t run = 0; run < opts.repeat && !failedStep; ++run)
         {
-            std::cerr << LOG_ERROR << "Compression failed for " << mode << ". Error code: " << static_cast<int>(ret) << "\n";
-            continue;
+            arena.Rewind();
+            if ((ret = compressor->Compress(input)) != SAA_SUCCESS)
+                failedStep = "Compression";
+            else if ((ret = compressor->Decompress(output)) != SAA_SUCCESS)
+                failedStep = "Decompression";
         }
-
-        ret = compressor->Decompress(output);
-        if (ret != SAA_SUCCESS)
+        if (failedStep)
         {
-            std::cerr << LOG_ERROR << "Decompression failed for " << mode << ". Error code: " << static_cast<int>(ret) << "\n";
+            std::cerr << LOG_ERROR << failedStep << " failed for " << mode << ". Error code: " << static_cast<int>(ret) << "\n";
             continue;
         }
 
@@ -190,10 +911,175 @@ int main(int argc, char *argv[])
             continue;
         }
         results.push_back(rst);
+        resultModes.push_back(mode);
+
+        // 3.1 第二级字节压缩
+        if (opts.stage2 != STAGE2_NONE)
+        {
+            Stage2Result stage2;
+            stage2.modeName = rst.modeName;
+            ret = RunStage2(*compressor, opts.stage2, rst.originSizeBytes, stage2);
+            if (ret == SAA_SUCCESS)
+                stage2Results.push_back(stage2);
+            else if (ret != ERROR_UNSUPPORT_FEATURE)
+                std::cerr << LOG_ERROR << "Stage 2 failed for " << mode << ". Error code: " << static_cast<int>(ret) << "\n";
+        }
     }
 
     // 4. 打印所有结果
     PrintResultTable(results);
+    if (PerfCountersEnabled())
+    {
+        PrintPerfTable(results);
+    }
+    if (AllocTrackingEnabled())
+    {
+        PrintAllocTable(results);
+    }
+    std::string shape = (inputDimension == ARRAY_2D) ? std::to_string(inputData2D.rowCount) + "x" + std::to_string(inputData2D.colCount)
+                                                     : std::to_string(data.size());
+    WriteFormattedResults(opts, opts.positional[FILE_PATH] + " " + ElemTypeName(ElemTraits<T>::type) + " " + shape, results, resultModes);
+    if (opts.stage2 != STAGE2_NONE)
+    {
+        PrintStage2Table(stage2Results);
+    }
+
+    // 5. 按目标设备给出压缩建议
+    std::vector<RecommendItem> ranked;
+    if (!opts.profile.empty())
+    {
+        if (RecommendCompression(results, profile, ranked) == SAA_SUCCESS)
+        {
+            PrintRecommendation(profile, ranked);
+        }
+    }
+
+    // 6. 保存最优格式
+    if (!opts.savePath.empty() && SaveBestFormat<T>(opts.savePath, input, results, resultModes, ranked) != SAA_SUCCESS)
+    {
+        return 1;
+    }
+
+    // 7. 导出固件头文件
+    if (!opts.exportPath.empty() && ExportBestHeader(opts.exportPath, input, results, resultModes, ranked) != SAA_SUCCESS)
+    {
+        return 1;
+    }
 
     return 0;
 }
+
+int main(int argc, char *argv[])
+{
+    if (argc >= 2 && std::string(argv[1]) == "compare")
+    {
+        return RunCompare(argc, argv);
+    }
+
+    AnalyzerOptions opts;
+    if (ParseOptions(argc, argv, opts) != SAA_SUCCESS)
+    {
+        printUsage();
+        return 1;
+    }
+
+    // 追踪在 main 返回时写出，覆盖所有返回路径
+    TraceSession trace(opts.tracePath);
+
+    // 硬件计数器不可用时只提示，继续分析
+    if (opts.perfCounters)
+    {
+        std::string reason;
+        if (EnablePerfCounters(reason) != SAA_SUCCESS)
+            std::cerr << LOG_WARN << "Hardware counters unavailable: " << reason << ". Continuing without them.\n";
+        else if (!reason.empty())
+            std::cerr << LOG_WARN << "Hardware counters partially available, " << reason << ".\n";
+    }
+
+    // 机器可读输出独占标准输出，其余信息改到标准错误
+    std::ostream reportOut(std::cout.rdbuf());
+    if (opts.formatGiven)
+    {
+        std::cout.rdbuf(std::cerr.rdbuf());
+        opts.reportOut = &reportOut;
+    }
+
+    // 直接加载容器文件，不需要位置参数
+    if (!opts.loadPath.empty())
+    {
+        MappedCompressedFile file;
+        if (file.Open(opts.loadPath) != SAA_SUCCESS)
+        {
+            return 1;
+        }
+        return DispatchElemType(file.Header().elemType, [&](auto tag)
+                                { return RunLoad<decltype(tag)>(file); });
+    }
+
+    if (!opts.batchSource.empty())
+    {
+        return RunBatch(opts);
+    }
+
+    bool isBinary = opts.positional.size() > FILE_PATH && IsBinaryArrayFile(opts.positional[FILE_PATH]);
+    if (opts.positional.size() < POSITIONAL_COUNT && !isBinary)
+    {
+        if (argc == 2 && std::string(argv[FILE_PATH]) == "--help")
+        {
+            printUsage();
+            return 0;
+        }
+        else if (argc == 3 && std::string(argv[1]) == "--version")
+        {
+            std::cout << "Sparse Array Analyzer v1.0.0\n";
+            return 0;
+        }
+        else
+        {
+            std::cerr << LOG_ERROR << "Invalid arguments.\n";
+            printUsage();
+            return 0;
+        }
+    }
+
+    std::cout << COLOR_STR("======= [Start analyze!] =======", COLOR_GREEN) << "\n";
+
+    DeviceProfile profile;
+    if (!opts.profile.empty() && LoadDeviceProfile(opts.profile, profile) != SAA_SUCCESS)
+    {
+        return 1;
+    }
+
+    // 1. 确定元素类型与形状：二进制输入以文件头为准，文本输入取 --type
+    if (isBinary)
+    {
+        BinaryArrayHeader header;
+        if (ReadBinaryArrayHeader(opts.positional[FILE_PATH], header) != SAA_SUCCESS)
+        {
+            return 1;
+        }
+
+        if (opts.elemTypeGiven && opts.elemType != header.elemType)
+        {
+            std::cerr << LOG_WARN << "--type " << ElemTypeName(opts.elemType) << " ignored, file holds "
+                      << ElemTypeName(header.elemType) << ".\n";
+        }
+        opts.elemType = header.elemType;
+
+        if (opts.positional.size() < POSITIONAL_COUNT)
+        {
+            opts.positional.resize(POSITIONAL_COUNT);
+            opts.positional[ARRAY_DIMENSION] = (header.dimension == ARRAY_2D) ? "2" : "1";
+            opts.positional[ARRAY_ROW] = std::to_string(header.rows);
+            opts.positional[ARRAY_COL] = std::to_string(header.cols);
+        }
+    }
+
+    std::cout << "Element type: " << ElemTypeName(opts.elemType) << "\n";
+    if (opts.streamMode)
+    {
+        return RunStream(opts, isBinary, profile);
+    }
+    return DispatchElemType(opts.elemType, [&](auto tag)
+                            { return RunAnalysis<decltype(tag)>(opts, isBinary, profile); });
+}